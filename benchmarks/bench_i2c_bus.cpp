@@ -0,0 +1,104 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <cstdio>
+#include <memory>
+
+#include "I2CBus.h"
+
+// Two kinds of numbers for the simulated I2C bus. Host cost: how many
+// simulated transactions per second the host can run against a bus with
+// eight devices, which bounds how fast a sensor loop can poll the simulator.
+// Modelled capacity: how many of the same transactions a real bus at each
+// standard speed carries per second, and whether a cabin polling plan fits.
+
+static const int DEVICE_COUNT = 8;
+static const int ITERATIONS = 2000000;
+static const qint64 MS = 1000000;
+
+static QVector<I2CRegisterSpec> registerMap()
+{
+    return {
+        {0x00, "STATUS", 1, I2CAccess::ReadOnly, 0x01},
+        {0x01, "DATA", 16, I2CAccess::ReadOnly, 0},
+        {0x20, "CONTROL", 1, I2CAccess::ReadWrite, 0},
+        {0x21, "THRESHOLD", 2, I2CAccess::ReadWrite, 0}
+    };
+}
+
+static const char* speedName(I2CBusSpeed speed)
+{
+    switch (speed) {
+        case I2CBusSpeed::Standard: return "100 kHz";
+        case I2CBusSpeed::Fast: return "400 kHz";
+        case I2CBusSpeed::FastPlus: return "1 MHz";
+    }
+    return "?";
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    I2CBus bus;
+    for (int i = 0; i < DEVICE_COUNT; ++i) {
+        bus.attach(std::make_unique<I2CDevice>(0x40 + i, QString("device %1").arg(i), registerMap()));
+    }
+    
+    std::printf("%-28s %14s %10s\n", "host transaction", "per second", "ns each");
+    quint8 data[16];
+    quint32 checksum = 0;
+    QElapsedTimer timer;
+    
+    struct Case { const char* name; bool write; int length; };
+    const Case cases[] = {
+        {"read 1 byte", false, 1},
+        {"burst read 16 bytes", false, 16},
+        {"write 2 bytes", true, 2}
+    };
+    for (const Case& test : cases) {
+        timer.start();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            const quint8 address = 0x40 + (i % DEVICE_COUNT);
+            if (test.write) {
+                data[0] = static_cast<quint8>(i);
+                bus.write(address, 0x21, data, test.length);
+            } else {
+                bus.read(address, 0x00, data, test.length);
+                checksum += data[test.length - 1];
+            }
+        }
+        const double elapsedNs = timer.nsecsElapsed();
+        std::printf("%-28s %14.0f %10.1f\n", test.name, ITERATIONS * 1e9 / elapsedNs, elapsedNs / ITERATIONS);
+    }
+    
+    const I2CBusSpeed speeds[] = {I2CBusSpeed::Standard, I2CBusSpeed::Fast, I2CBusSpeed::FastPlus};
+    std::printf("\n%-28s %14s %14s %14s\n", "modelled bus capacity/s", "read 1", "burst 16", "write 2");
+    for (I2CBusSpeed speed : speeds) {
+        bus.setSpeed(speed);
+        std::printf("%-28s %14.0f %14.0f %14.0f\n", speedName(speed),
+                    1e9 / bus.readDurationNs(1), 1e9 / bus.readDurationNs(16), 1e9 / bus.writeDurationNs(2));
+    }
+    
+    // Cabin plan: climate sensor at 1 kHz, seven slower sensors bursting
+    // 16 bytes at 100 Hz each
+    QVector<I2CPoll> plan = {{0x40, 0x01, 8, 1 * MS}};
+    for (int i = 1; i < DEVICE_COUNT; ++i) {
+        plan.append({static_cast<quint8>(0x40 + i), 0x01, 16, 10 * MS});
+    }
+    std::printf("\n%-28s %12s %6s %14s %14s\n", "polling plan (1 s)", "utilization", "fits", "max lat (us)", "missed");
+    for (I2CBusSpeed speed : speeds) {
+        bus.setSpeed(speed);
+        I2CScheduleReport report = bus.simulateSchedule(plan, 1000 * MS);
+        qint64 maxLatencyNs = 0;
+        quint64 missed = 0;
+        for (const I2CPollResult& result : report.polls) {
+            maxLatencyNs = qMax(maxLatencyNs, result.maxLatencyNs);
+            missed += result.missed;
+        }
+        std::printf("%-28s %11.1f%% %6s %14.1f %14llu\n", speedName(speed), report.utilization * 100.0,
+                    report.fits ? "yes" : "no", maxLatencyNs / 1e3, static_cast<unsigned long long>(missed));
+    }
+    
+    std::printf("\n(checksum %u)\n", checksum);
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QVector>
+#include <cstdio>
+
+#include "BinaryLogSink.h"
+#include "BinaryLogReader.h"
+#include "LogRecord.h"
+
+// Compares the text sink format ("[timestamp] [LEVEL] [module] message",
+// flushed per line as Logger does) against BinaryLogSink on a mix of
+// sensor-style formatted entries and plain Bluetooth/USB messages.
+
+static const int RECORD_COUNT = 200000;
+
+static QVector<LogRecord> makeRecords()
+{
+    QVector<LogRecord> records;
+    records.reserve(RECORD_COUNT);
+    qint64 wall = QDateTime::currentMSecsSinceEpoch();
+    qint64 monotonic = 0;
+    
+    for (int i = 0; i < RECORD_COUNT; ++i) {
+        LogRecord record;
+        monotonic += 1000000 + (i % 7) * 13000;
+        record.timestamp = wall + monotonic / 1000000;
+        record.monotonicNs = monotonic;
+        
+        switch (i % 3) {
+            case 0:
+                record.level = LogLevel::DEBUG;
+                record.module = "MockI2C";
+                record.format = "Sensor data updated: T=%1°C, H=%2%%, P=%3 hPa, L=%4 lux";
+                record.arguments = {21.5 + (i % 30) * 0.1, 48.2, 1013.2, double(400 + i % 200)};
+                break;
+            case 1:
+                record.level = LogLevel::DEBUG;
+                record.module = "BluetoothSim";
+                record.message = QString("Signal strength for device BT_%1 changed to %2 dBm").arg(i % 5).arg(-40 - i % 30);
+                break;
+            default:
+                record.level = LogLevel::INFO;
+                record.module = "USBMonitor";
+                record.message = QString("Scanned %1 media files from device USB_1700000000").arg(i % 500);
+                break;
+        }
+        records.append(record);
+    }
+    return records;
+}
+
+static QString levelToString(LogLevel level)
+{
+    switch (level) {
+        case LogLevel::DEBUG:   return "DEBUG";
+        case LogLevel::INFO:    return "INFO";
+        case LogLevel::WARNING: return "WARNING";
+        case LogLevel::ERROR:   return "ERROR";
+        case LogLevel::CRITICAL: return "CRITICAL";
+        default:               return "UNKNOWN";
+    }
+}
+
+static qint64 runTextSink(const QVector<LogRecord>& records, const QString& path, int flushEvery)
+{
+    QFile file(path);
+    file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+    QTextStream stream(&file);
+    
+    QElapsedTimer timer;
+    timer.start();
+    int pending = 0;
+    for (const LogRecord& record : records) {
+        QString line = QString("[%1] [%2] [%3] %4")
+            .arg(QDateTime::fromMSecsSinceEpoch(record.timestamp).toString("yyyy-MM-dd hh:mm:ss.zzz"),
+                 levelToString(record.level), record.module, record.renderMessage());
+        stream << line << '\n';
+        if (++pending >= flushEvery) {
+            stream.flush();
+            pending = 0;
+        }
+    }
+    stream.flush();
+    return timer.nsecsElapsed();
+}
+
+static qint64 runBinarySink(const QVector<LogRecord>& records, const QString& path)
+{
+    QFile::remove(path);
+    BinaryLogSink sink;
+    sink.open(path);
+    
+    QElapsedTimer timer;
+    timer.start();
+    for (const LogRecord& record : records) {
+        sink.append(record);
+        sink.flushIfDue();
+    }
+    sink.flush();
+    return timer.nsecsElapsed();
+}
+
+static qint64 runBinaryDecode(const QString& path, int& decoded)
+{
+    BinaryLogReader reader;
+    reader.open(path);
+    BinaryLogEntry entry;
+    decoded = 0;
+    
+    QElapsedTimer timer;
+    timer.start();
+    while (reader.readNext(entry)) {
+        ++decoded;
+    }
+    return timer.nsecsElapsed();
+}
+
+static void printRow(const char* name, qint64 elapsedNs, const QString& path)
+{
+    qint64 bytes = QFileInfo(path).size();
+    std::printf("%-26s %14.0f %12.1f %14lld %10.1f\n", name,
+                RECORD_COUNT / (elapsedNs / 1e9), elapsedNs / 1e6,
+                static_cast<long long>(bytes), double(bytes) / RECORD_COUNT);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    const QString textPath = QDir::tempPath() + "/autodash_bench_sink.log";
+    const QString binaryPath = QDir::tempPath() + "/autodash_bench_sink.blog";
+    const QVector<LogRecord> records = makeRecords();
+    
+    std::printf("%-26s %14s %12s %14s %10s\n", "sink", "entries/s", "total (ms)", "file bytes", "B/entry");
+    printRow("text, flush per line", runTextSink(records, textPath, 1), textPath);
+    printRow("text, flush per 256", runTextSink(records, textPath, 256), textPath);
+    printRow("binary", runBinarySink(records, binaryPath), binaryPath);
+    
+    int decoded = 0;
+    qint64 decodeNs = runBinaryDecode(binaryPath, decoded);
+    std::printf("\nbinary decode: %d entries in %.1f ms (%.0f entries/s)\n",
+                decoded, decodeNs / 1e6, decoded / (decodeNs / 1e9));
+    
+    QFile::remove(textPath);
+    QFile::remove(binaryPath);
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <cstdio>
+#include <random>
+
+#include "LogStore.h"
+
+// Builds a 10M-entry LogStore with a realistic module/level mix and times
+// the filter queries the Log Viewer issues. Target: under 100 ms each.
+
+static const qint64 ENTRY_COUNT = 10000000;
+static const double TARGET_MS = 100.0;
+
+static void runQuery(const LogStore& store, const char* name, const LogFilter& filter)
+{
+    QElapsedTimer timer;
+    timer.start();
+    LogSelection selection = store.query(filter);
+    double elapsedMs = timer.nsecsElapsed() / 1e6;
+    
+    // Touch a few rows the way a view would after the query
+    std::mt19937 rng(7);
+    qint64 checksum = 0;
+    QElapsedTimer rowTimer;
+    rowTimer.start();
+    const int rowSamples = selection.isEmpty() ? 0 : 1000;
+    for (int i = 0; i < rowSamples; ++i) {
+        int row = static_cast<int>(rng() % selection.count());
+        checksum += store.entry(selection.entryAt(row)).timestamp & 1;
+    }
+    double rowUs = rowSamples ? rowTimer.nsecsElapsed() / 1e3 / rowSamples : 0.0;
+    
+    std::printf("%-34s %10d %10.1f %12.2f  %s\n", name, selection.count(), elapsedMs, rowUs,
+                elapsedMs < TARGET_MS ? "ok" : "SLOW");
+    (void)checksum;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    const QStringList modules = {"MockI2C", "USBMonitor", "BluetoothSim", "ConfigManager", "MediaPlayer",
+                                 "MainWindow", "Logger", "Main", "ClimateControl", "CameraModule",
+                                 "Navigation", "Diagnostics"};
+    std::mt19937 rng(42);
+    std::discrete_distribution<int> levelDistribution({60, 30, 7, 2.5, 0.5});
+    std::discrete_distribution<int> moduleDistribution({40, 10, 15, 3, 8, 4, 2, 1, 6, 5, 4, 2});
+    
+    LogStore store;
+    QElapsedTimer timer;
+    timer.start();
+    qint64 timestamp = 1700000000000LL;
+    for (qint64 i = 0; i < ENTRY_COUNT; ++i) {
+        timestamp += rng() % 3;
+        store.append(timestamp, static_cast<LogLevel>(levelDistribution(rng)),
+                     modules[moduleDistribution(rng)], QStringLiteral("Sensor data updated: T=22.5°C"));
+    }
+    std::printf("appended %lld entries in %.0f ms\n\n", static_cast<long long>(store.size()),
+                timer.nsecsElapsed() / 1e6);
+    
+    std::printf("%-34s %10s %10s %12s\n", "query", "matches", "ms", "row (us)");
+    
+    LogFilter all;
+    runQuery(store, "all entries", all);
+    
+    LogFilter warnings;
+    warnings.levelMask = LogFilter::levelsAtLeast(LogLevel::WARNING);
+    runQuery(store, "level >= WARNING", warnings);
+    
+    LogFilter module;
+    module.modules << "BluetoothSim";
+    runQuery(store, "module = BluetoothSim", module);
+    
+    LogFilter moduleAndLevel;
+    moduleAndLevel.modules << "MockI2C";
+    moduleAndLevel.levelMask = LogFilter::levelsAtLeast(LogLevel::ERROR);
+    runQuery(store, "module = MockI2C, level >= ERROR", moduleAndLevel);
+    
+    LogFilter rareModule;
+    rareModule.modules << "Main";
+    rareModule.levelMask = LogFilter::levelsAtLeast(LogLevel::CRITICAL);
+    runQuery(store, "module = Main, level = CRITICAL", rareModule);
+    
+    LogFilter lastTenth;
+    lastTenth.since = timestamp - (timestamp - 1700000000000LL) / 10;
+    lastTenth.modules << "USBMonitor" << "MediaPlayer";
+    runQuery(store, "last 10%, two modules", lastTenth);
+    
+    return 0;
+}
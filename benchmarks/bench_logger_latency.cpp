@@ -0,0 +1,101 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+#include "Logger.h"
+
+// Measures the caller-side cost of LOG_INFO from 1, 4 and 16 threads with the
+// synchronous backend, with the async writer thread, and synchronously with
+// the black box enabled (mapped copy, text file flushed once a second).
+
+static const int MESSAGES_PER_THREAD = 20000;
+static const int THREAD_COUNTS[] = {1, 4, 16};
+
+struct LatencyResult {
+    double p50Ns;
+    double p99Ns;
+    double maxNs;
+};
+
+static LatencyResult runScenario(int threadCount)
+{
+    QVector<QVector<qint64>> samples(threadCount);
+    QVector<QThread*> threads;
+    
+    for (int t = 0; t < threadCount; ++t) {
+        threads.append(QThread::create([&samples, t]() {
+            QVector<qint64>& latencies = samples[t];
+            latencies.reserve(MESSAGES_PER_THREAD);
+            const QString message = QString("Benchmark message from thread %1").arg(t);
+            QElapsedTimer timer;
+            for (int i = 0; i < MESSAGES_PER_THREAD; ++i) {
+                timer.start();
+                LOG_INFO("Bench", message);
+                latencies.append(timer.nsecsElapsed());
+            }
+        }));
+    }
+    
+    for (QThread* thread : threads) {
+        thread->start();
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    
+    QVector<qint64> all;
+    all.reserve(threadCount * MESSAGES_PER_THREAD);
+    for (const QVector<qint64>& latencies : samples) {
+        all.append(latencies);
+    }
+    std::sort(all.begin(), all.end());
+    
+    LatencyResult result;
+    result.p50Ns = all[all.size() / 2];
+    result.p99Ns = all[static_cast<int>(all.size() * 0.99)];
+    result.maxNs = all.last();
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    Logger& logger = Logger::getInstance();
+    logger.setConsoleOutput(false);
+    logger.setLogLevel(LogLevel::INFO);
+    logger.setLogFile(QDir::tempPath() + "/autodash_bench_logger.log");
+    
+    std::printf("%-8s %-8s %12s %12s %12s %10s\n", "mode", "threads", "p50 (ns)", "p99 (ns)", "max (ns)", "dropped");
+    
+    const QString blackBoxPath = QDir::tempPath() + "/autodash_bench_logger.blackbox";
+    const char* modes[] = {"sync", "async", "blackbox"};
+    for (const char* mode : modes) {
+        const bool async = qstrcmp(mode, "async") == 0;
+        logger.setAsyncMode(async);
+        if (qstrcmp(mode, "blackbox") == 0) {
+            logger.setBlackBoxFile(blackBoxPath);
+        }
+        for (int threadCount : THREAD_COUNTS) {
+            quint64 droppedBefore = logger.getDroppedMessageCount();
+            LatencyResult result = runScenario(threadCount);
+            logger.flush();
+            std::printf("%-8s %-8d %12.0f %12.0f %12.0f %10llu\n",
+                        mode, threadCount,
+                        result.p50Ns, result.p99Ns, result.maxNs,
+                        static_cast<unsigned long long>(logger.getDroppedMessageCount() - droppedBefore));
+        }
+    }
+    
+    logger.setAsyncMode(false);
+    logger.setBlackBoxFile(QString());
+    QFile::remove(QDir::tempPath() + "/autodash_bench_logger.log");
+    QFile::remove(blackBoxPath);
+    return 0;
+}
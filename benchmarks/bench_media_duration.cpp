@@ -0,0 +1,184 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <cmath>
+#include <cstdio>
+
+#include "MediaDurationReader.h"
+
+// Durations of a synthetic corpus of 60 s tracks: a 320 kbit/s CBR MP3, a
+// VBR MP3 with a Xing/LAME header, a VBR MP3 without one (sampled), 96 kHz
+// 24-bit FLAC, 48 kHz 24-bit WAV and an M4A with moov after mdat.
+// MediaDurationReader is compared with the size-based guess MediaScanner
+// used to make (128 kbit/s MP3, 44.1 kHz 16-bit stereo WAV, nothing else):
+// files per second with a warm page cache, and the mean error against the
+// true length.
+
+static const int FILES_PER_FORMAT = 50;
+static const int TRACK_SECONDS = 60;
+static const int RUNS = 3;
+
+static const int MPEG1_L3_BITRATES[15] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320};
+
+static QByteArray bigEndian32(quint32 value)
+{
+    QByteArray bytes(4, '\0');
+    qToBigEndian(value, bytes.data());
+    return bytes;
+}
+
+static QByteArray littleEndian32(quint32 value)
+{
+    QByteArray bytes(4, '\0');
+    qToLittleEndian(value, bytes.data());
+    return bytes;
+}
+
+static QByteArray atom(const char* type, const QByteArray& body)
+{
+    return bigEndian32(8 + body.size()) + QByteArray(type, 4) + body;
+}
+
+// MPEG-1 layer III at 48 kHz: 1152 samples, 24 ms, per frame
+static QByteArray mpegFrame(int bitrateIndex, const QByteArray& body = QByteArray())
+{
+    const int length = 144 * MPEG1_L3_BITRATES[bitrateIndex] * 1000 / 48000;
+    QByteArray frame = bigEndian32(0xfffb0440 | (quint32(bitrateIndex) << 12)) + body;
+    frame.resize(length);
+    return frame;
+}
+
+static QByteArray mp3(bool constant, bool xingHeader)
+{
+    const int frameCount = TRACK_SECONDS * 1000 / 24;
+    QByteArray data;
+    if (xingHeader) {
+        // A LAME delay and padding of 576 samples each add up to the Xing frame itself
+        data += mpegFrame(9, QByteArray(32, '\0') + "Xing" + bigEndian32(1) + bigEndian32(frameCount + 1)
+                             + "LAME3.100" + QByteArray(12, '\0') + QByteArray("\x24\x02\x40", 3));
+    }
+    for (int i = 0; i < frameCount; ++i) {
+        data += mpegFrame(constant ? 14 : 9 + QRandomGenerator::global()->bounded(6));
+    }
+    return data;
+}
+
+static QByteArray flac()
+{
+    const quint64 samples = 96000ULL * TRACK_SECONDS;
+    QByteArray info(34, '\0');
+    info[10] = char(96000 >> 12);
+    info[11] = char((96000 >> 4) & 0xff);
+    info[12] = char(((96000 & 0x0f) << 4) | (1 << 1));
+    info[13] = char((23 << 4) | (samples >> 32));
+    info.replace(14, 4, bigEndian32(quint32(samples)));
+    return "fLaC" + QByteArray("\x80\0\0\x22", 4) + info;
+}
+
+static QByteArray wavHeader()
+{
+    QByteArray format(16, '\0');
+    qToLittleEndian<quint16>(1, format.data());
+    qToLittleEndian<quint16>(2, format.data() + 2);
+    qToLittleEndian<quint32>(48000, format.data() + 4);
+    qToLittleEndian<quint32>(48000 * 6, format.data() + 8);
+    qToLittleEndian<quint16>(6, format.data() + 12);
+    qToLittleEndian<quint16>(24, format.data() + 14);
+    return "RIFF" + littleEndian32(0) + "WAVE" + "fmt " + littleEndian32(16) + format
+         + "data" + littleEndian32(48000 * 6 * TRACK_SECONDS);
+}
+
+static QByteArray m4aTrailer()
+{
+    const QByteArray mvhd = QByteArray(12, '\0') + bigEndian32(44100) + bigEndian32(44100 * TRACK_SECONDS)
+                          + QByteArray(80, '\0');
+    return atom("moov", atom("mvhd", mvhd) + atom("trak", QByteArray(16384, '\0')));
+}
+
+// Writes the file and returns its size; FLAC, WAV and M4A audio is sparse
+static qint64 writeTrack(const QString& path, const QString& kind)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return 0;
+    }
+    if (kind == "mp3 cbr") {
+        file.write(mp3(true, false));
+    } else if (kind == "mp3 xing") {
+        file.write(mp3(false, true));
+    } else if (kind == "mp3 sampled") {
+        file.write(mp3(false, false));
+    } else if (kind == "flac") {
+        file.write(flac());
+        file.resize(file.size() + 96000LL * 6 * TRACK_SECONDS / 2);
+    } else if (kind == "wav") {
+        file.write(wavHeader());
+        file.resize(file.size() + 48000LL * 6 * TRACK_SECONDS);
+    } else {
+        file.write(atom("ftyp", "M4A " + QByteArray(4, '\0')));
+        file.write(bigEndian32(8 + 256000 / 8 * TRACK_SECONDS) + "mdat");
+        file.resize(file.size() + 256000 / 8 * TRACK_SECONDS);
+        file.seek(file.size());
+        file.write(m4aTrailer());
+    }
+    return file.size();
+}
+
+// MediaScanner::estimateDuration() before the duration reader
+static qint64 legacyEstimateMs(const QString& kind, qint64 size)
+{
+    if (kind.startsWith("mp3")) {
+        return (size * 8) / (128 * 1024) * 1000;
+    }
+    if (kind == "wav") {
+        return size / (44100 * 2 * 2) * 1000;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    const QString root = QDir::tempPath() + "/autodash_bench_media_duration";
+    QDir(root).removeRecursively();
+    QDir().mkpath(root);
+    
+    const QStringList kinds = {"mp3 cbr", "mp3 xing", "mp3 sampled", "flac", "wav", "m4a"};
+    const double trueMs = TRACK_SECONDS * 1000.0;
+    std::printf("%-12s %8s %12s %12s %12s\n", "format", "files", "files/s", "error %", "legacy err %");
+    for (const QString& kind : kinds) {
+        QStringList paths;
+        QList<qint64> sizes;
+        for (int i = 0; i < FILES_PER_FORMAT; ++i) {
+            const QString path = QString("%1/%2 %3").arg(root, kind).arg(i);
+            sizes << writeTrack(path, kind);
+            paths << path;
+        }
+        
+        double best = 0.0;
+        double error = 0.0;
+        for (int run = 0; run < RUNS; ++run) {
+            QElapsedTimer timer;
+            timer.start();
+            error = 0.0;
+            for (const QString& path : paths) {
+                error += std::fabs(MediaDurationReader::read(path) - trueMs) / trueMs;
+            }
+            best = qMax(best, paths.size() / (timer.nsecsElapsed() / 1e9));
+        }
+        double legacyError = 0.0;
+        for (qint64 size : sizes) {
+            legacyError += std::fabs(legacyEstimateMs(kind, size) - trueMs) / trueMs;
+        }
+        std::printf("%-12s %8d %12.0f %12.2f %12.2f\n", qPrintable(kind), int(paths.size()), best,
+                    100.0 * error / paths.size(), 100.0 * legacyError / paths.size());
+    }
+    
+    QDir(root).removeRecursively();
+    return 0;
+}
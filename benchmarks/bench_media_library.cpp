@@ -0,0 +1,190 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+
+#include "MediaLibraryIndex.h"
+
+// Cold-start cost of the saved USB media library at 100k files: the pretty
+// JSON device list USBMonitor::loadDeviceList() used to parse in full at
+// startup, against MediaLibraryIndex loading its file and then decoding the
+// one volume that was plugged in. Each load runs on a fresh object, from a
+// file the page cache already holds.
+
+static const int FILE_COUNT = 100000;
+static const int ARTIST_COUNT = 400;
+static const int ALBUMS_PER_ARTIST = 5;
+static const int RUNS = 5;
+
+static USBDevice makeDevice()
+{
+    USBDevice device;
+    device.deviceId = "USB_1700000000000";
+    device.volumeId = "uuid:1A2B-3C4D";
+    device.deviceName = "USB_DRIVE_01";
+    device.mountPoint = QDir::tempPath() + "/autodash_bench_usb";
+    device.totalSpace = 32000000000LL;
+    device.freeSpace = 28000000000LL;
+    device.fileSystem = "FAT32";
+    device.isConnected = true;
+    device.connectedTime = QDateTime::currentDateTime();
+
+    const QDateTime modified = QDateTime::fromMSecsSinceEpoch(1700000000000LL);
+    for (int i = 0; i < FILE_COUNT; ++i) {
+        const int artist = i % ARTIST_COUNT;
+        const int album = (i / ARTIST_COUNT) % ALBUMS_PER_ARTIST;
+        MediaFile file;
+        file.fileName = QString("%1 - Track %2.mp3").arg(artist).arg(i);
+        file.filePath = QString("%1/Artist %2/Album %3/%4").arg(device.mountPoint).arg(artist).arg(album).arg(file.fileName);
+        file.title = QString("Track %1").arg(i);
+        file.artist = QString("Artist %1").arg(artist);
+        file.album = QString("Album %1").arg(album);
+        file.duration = QString("0%1:%2").arg(i % 7).arg(10 + i % 50);
+        file.fileSize = 3000000 + i;
+        file.fileType = "mp3";
+        file.lastModified = modified.addSecs(i);
+        device.mediaFiles.append(file);
+    }
+    return device;
+}
+
+static void saveLegacy(const QString& path, const USBDevice& device)
+{
+    QJsonObject deviceObj;
+    deviceObj["deviceId"] = device.deviceId;
+    deviceObj["deviceName"] = device.deviceName;
+    deviceObj["mountPoint"] = device.mountPoint;
+    deviceObj["totalSpace"] = device.totalSpace;
+    deviceObj["freeSpace"] = device.freeSpace;
+    deviceObj["fileSystem"] = device.fileSystem;
+    deviceObj["isConnected"] = device.isConnected;
+    deviceObj["connectedTime"] = device.connectedTime.toString(Qt::ISODate);
+
+    QJsonArray mediaArray;
+    for (const auto& media : device.mediaFiles) {
+        QJsonObject mediaObj;
+        mediaObj["fileName"] = media.fileName;
+        mediaObj["filePath"] = media.filePath;
+        mediaObj["title"] = media.title;
+        mediaObj["artist"] = media.artist;
+        mediaObj["album"] = media.album;
+        mediaObj["duration"] = media.duration;
+        mediaObj["fileSize"] = media.fileSize;
+        mediaObj["fileType"] = media.fileType;
+        mediaObj["lastModified"] = media.lastModified.toString(Qt::ISODate);
+        mediaArray.append(mediaObj);
+    }
+    deviceObj["mediaFiles"] = mediaArray;
+
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(QJsonArray{deviceObj}).toJson());
+    }
+}
+
+static int loadLegacy(const QString& path)
+{
+    QList<USBDevice> devices;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    for (const QJsonValue& value : doc.array()) {
+        QJsonObject deviceObj = value.toObject();
+        USBDevice device;
+        device.deviceId = deviceObj["deviceId"].toString();
+        device.deviceName = deviceObj["deviceName"].toString();
+        device.mountPoint = deviceObj["mountPoint"].toString();
+        device.totalSpace = deviceObj["totalSpace"].toVariant().toLongLong();
+        device.freeSpace = deviceObj["freeSpace"].toVariant().toLongLong();
+        device.fileSystem = deviceObj["fileSystem"].toString();
+        device.isConnected = deviceObj["isConnected"].toBool();
+        device.connectedTime = QDateTime::fromString(deviceObj["connectedTime"].toString(), Qt::ISODate);
+
+        QJsonArray mediaArray = deviceObj["mediaFiles"].toArray();
+        for (const QJsonValue& mediaValue : mediaArray) {
+            QJsonObject mediaObj = mediaValue.toObject();
+            MediaFile media;
+            media.fileName = mediaObj["fileName"].toString();
+            media.filePath = mediaObj["filePath"].toString();
+            media.title = mediaObj["title"].toString();
+            media.artist = mediaObj["artist"].toString();
+            media.album = mediaObj["album"].toString();
+            media.duration = mediaObj["duration"].toString();
+            media.fileSize = mediaObj["fileSize"].toVariant().toLongLong();
+            media.fileType = mediaObj["fileType"].toString();
+            media.lastModified = QDateTime::fromString(mediaObj["lastModified"].toString(), Qt::ISODate);
+            device.mediaFiles.append(media);
+        }
+        devices.append(device);
+    }
+    return devices.isEmpty() ? 0 : devices.first().mediaFiles.size();
+}
+
+template <typename Load>
+static double bestOf(Load load, int& files)
+{
+    double best = 0.0;
+    for (int run = 0; run < RUNS; ++run) {
+        QElapsedTimer timer;
+        timer.start();
+        files = load();
+        const double ms = timer.nsecsElapsed() / 1e6;
+        best = run == 0 ? ms : qMin(best, ms);
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const QString jsonPath = QDir::tempPath() + "/autodash_bench_usb_devices.json";
+    const QString indexPath = QDir::tempPath() + "/autodash_bench_media_library.idx";
+    const USBDevice device = makeDevice();
+
+    QElapsedTimer timer;
+    timer.start();
+    saveLegacy(jsonPath, device);
+    const double jsonSaveMs = timer.nsecsElapsed() / 1e6;
+
+    timer.start();
+    MediaLibraryIndex writer;
+    writer.load(indexPath);
+    writer.store(device, device.volumeId);
+    writer.save();
+    const double indexSaveMs = timer.nsecsElapsed() / 1e6;
+
+    int jsonFiles = 0;
+    int indexFiles = 0;
+    int restoredFiles = 0;
+    const double jsonLoadMs = bestOf([&jsonPath]() { return loadLegacy(jsonPath); }, jsonFiles);
+    const double indexLoadMs = bestOf([&indexPath, &device]() {
+        MediaLibraryIndex index;
+        index.load(indexPath);
+        return index.fileCount(device.volumeId);
+    }, indexFiles);
+    const double restoreMs = bestOf([&indexPath, &device]() {
+        MediaLibraryIndex index;
+        index.load(indexPath);
+        return int(index.files(device.volumeId, device.mountPoint).size());
+    }, restoredFiles);
+
+    std::printf("%-28s %10s %10s %10s %12s\n", "format", "files", "MB", "save ms", "load ms");
+    std::printf("%-28s %10d %10.1f %10.1f %12.1f\n", "json device list", jsonFiles,
+                QFileInfo(jsonPath).size() / 1e6, jsonSaveMs, jsonLoadMs);
+    std::printf("%-28s %10d %10.1f %10.1f %12.1f\n", "index, startup", indexFiles,
+                QFileInfo(indexPath).size() / 1e6, indexSaveMs, indexLoadMs);
+    std::printf("%-28s %10d %10s %10s %12.1f\n", "index, startup + insertion", restoredFiles, "", "", restoreMs);
+
+    QFile::remove(jsonPath);
+    QFile::remove(indexPath);
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+
+#include "MediaScanner.h"
+
+// Scans a directory of 50k media files the way USBMonitor::scanMediaFiles()
+// used to, on the calling thread with a JSON metadata round trip per file,
+// then with MediaScanner: a cold scan, a rescan of the unchanged directory
+// and a rescan after 1% of the files changed. The same files are then
+// spread over artist/album directories two levels down, which the legacy
+// scan never looked into. Times include delivering the results back to the
+// calling thread's event loop.
+
+static const int FILE_COUNT = 50000;
+static const int CHANGED_COUNT = FILE_COUNT / 100;
+static const int ARTIST_COUNT = 100;
+static const int ALBUMS_PER_ARTIST = 5;
+static const QStringList FORMATS = {"mp3", "wav", "flac", "aac", "ogg", "wma", "m4a"};
+
+static QString trackPath(const QString& root, int index)
+{
+    return QString("%1/Artist %2 - Track %3.mp3").arg(root).arg(index % 500).arg(index);
+}
+
+static QString nestedTrackPath(const QString& root, int index)
+{
+    const int artist = index % ARTIST_COUNT;
+    const int album = (index / ARTIST_COUNT) % ALBUMS_PER_ARTIST;
+    return QString("%1/Artist %2/Album %3/%4 - Track %5.mp3").arg(root).arg(artist).arg(album).arg(artist).arg(index);
+}
+
+static void writeTrack(const QString& path, int size)
+{
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.resize(size);
+    }
+}
+
+static QString legacyMetadata(const QFileInfo& fileInfo)
+{
+    QString fileName = fileInfo.baseName();
+    qint64 size = fileInfo.size();
+    int durationSeconds = (size * 8) / (128 * 1024);
+    
+    QJsonObject metadata;
+    metadata["title"] = fileName;
+    metadata["artist"] = "Unknown Artist";
+    metadata["album"] = "Unknown Album";
+    metadata["duration"] = QString("%1:%2").arg(durationSeconds / 60, 2, 10, QChar('0'))
+                                           .arg(durationSeconds % 60, 2, 10, QChar('0'));
+    if (fileName.contains(" - ")) {
+        QStringList parts = fileName.split(" - ");
+        metadata["artist"] = parts[0].trimmed();
+        metadata["title"] = parts[1].trimmed();
+    }
+    return QJsonDocument(metadata).toJson();
+}
+
+static qint64 legacyScan(const QString& root)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QStringList filters;
+    for (const QString& format : FORMATS) {
+        filters << QString("*.%1").arg(format);
+    }
+    
+    QList<MediaFile> mediaFiles;
+    for (const QFileInfo& fileInfo : QDir(root).entryInfoList(filters, QDir::Files)) {
+        MediaFile mediaFile;
+        mediaFile.fileName = fileInfo.fileName();
+        mediaFile.filePath = fileInfo.absoluteFilePath();
+        mediaFile.fileSize = fileInfo.size();
+        mediaFile.fileType = fileInfo.suffix().toLower();
+        mediaFile.lastModified = fileInfo.lastModified();
+        QJsonObject obj = QJsonDocument::fromJson(legacyMetadata(fileInfo).toUtf8()).object();
+        mediaFile.title = obj["title"].toString();
+        mediaFile.artist = obj["artist"].toString();
+        mediaFile.album = obj["album"].toString();
+        mediaFile.duration = obj["duration"].toString();
+        mediaFiles.append(mediaFile);
+    }
+    const qint64 elapsed = timer.elapsed();
+    if (mediaFiles.size() != FILE_COUNT) {
+        std::printf("legacy scan found %lld files\n", static_cast<long long>(mediaFiles.size()));
+    }
+    return elapsed;
+}
+
+static void scan(MediaScanner& scanner, const QString& root, const char* name)
+{
+    QEventLoop loop;
+    QElapsedTimer timer;
+    qint64 firstBatchMs = -1;
+    int reported = 0;
+    MediaScanStats result;
+    QObject::connect(&scanner, &MediaScanner::filesFound, &loop,
+        [&](const QString&, const QList<MediaFile>& files) {
+            if (firstBatchMs < 0) {
+                firstBatchMs = timer.elapsed();
+            }
+            reported += files.size();
+        });
+    QObject::connect(&scanner, &MediaScanner::scanFinished, &loop,
+        [&](const QString&, const QStringList& removedPaths, const MediaScanStats& stats) {
+            reported += removedPaths.size();
+            result = stats;
+            loop.quit();
+        });
+    
+    timer.start();
+    scanner.scan("USB_BENCH", root);
+    loop.exec();
+    const qint64 totalMs = timer.elapsed();
+    
+    std::printf("%-22s %10lld %12lld %10d %10d %10.0f\n", name, static_cast<long long>(totalMs),
+                static_cast<long long>(firstBatchMs), result.files, reported, result.filesPerSecond);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    const QString root = QDir::tempPath() + "/autodash_bench_media_scan";
+    QDir(root).removeRecursively();
+    QDir().mkpath(root);
+    for (int i = 0; i < FILE_COUNT; ++i) {
+        writeTrack(trackPath(root, i), 4096);
+    }
+    
+    std::printf("%-22s %10s %12s %10s %10s %10s\n", "scan", "total ms", "1st batch ms", "files", "reported", "files/s");
+    std::printf("%-22s %10lld %12s %10d\n", "legacy (GUI thread)", static_cast<long long>(legacyScan(root)),
+                "-", FILE_COUNT);
+    
+    MediaScanner scanner;
+    scanner.setSupportedFormats(FORMATS);
+    scan(scanner, root, "cold");
+    scan(scanner, root, "unchanged");
+    
+    for (int i = 0; i < CHANGED_COUNT; ++i) {
+        writeTrack(trackPath(root, i * (FILE_COUNT / CHANGED_COUNT)), 8192);
+    }
+    scan(scanner, root, "1% changed");
+    scan(scanner, root, "unchanged");
+    
+    QDir(root).removeRecursively();
+    for (int artist = 0; artist < ARTIST_COUNT; ++artist) {
+        for (int album = 0; album < ALBUMS_PER_ARTIST; ++album) {
+            QDir().mkpath(QString("%1/Artist %2/Album %3").arg(root).arg(artist).arg(album));
+        }
+    }
+    for (int i = 0; i < FILE_COUNT; ++i) {
+        writeTrack(nestedTrackPath(root, i), 4096);
+    }
+    MediaScanner nestedScanner;
+    nestedScanner.setSupportedFormats(FORMATS);
+    scan(nestedScanner, root, "nested cold");
+    scan(nestedScanner, root, "nested unchanged");
+    
+    QDir(root).removeRecursively();
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <cstdio>
+#include <random>
+
+#include "SensorBatch.h"
+
+// Samples per second through calibration (offset + clamp) and smoothing at
+// each SIMD level, on 4-channel blocks the size of a 10 Hz delivery at
+// 1 kHz acquisition and of a replay chunk. The per-sample path is the old
+// MockI2C::applyCalibration(): std::clamp on one array-of-structs sample at
+// a time. Every timed round starts from a fresh copy of the block, in both
+// paths.
+
+static const int TOTAL_SAMPLES = 8 * 1024 * 1024;
+static const int BLOCK_SIZES[] = {100, 4096};
+
+static SensorBlock makeBlock(int size)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> noise(-0.5, 0.5);
+    SensorBlock block;
+    for (int i = 0; i < size; ++i) {
+        SensorSample sample;
+        sample.timestamp = i;
+        sample.setValue(SensorChannel::Temperature, 21.0 + noise(rng));
+        sample.setValue(SensorChannel::Humidity, 50.0 + noise(rng));
+        sample.setValue(SensorChannel::Pressure, 1013.0 + noise(rng));
+        sample.setValue(SensorChannel::Light, 500.0 + 100.0 * noise(rng));
+        block.append(sample);
+    }
+    return block;
+}
+
+static void report(const char* name, const char* level, int blockSize, double elapsedNs, double checksum)
+{
+    std::printf("%-24s %-8s %8d %16.1f %14.3f\n", name, level, blockSize,
+                TOTAL_SAMPLES / (elapsedNs / 1e9) / 1e6, checksum);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    SensorCalibration calibration;
+    calibration.offsets[0] = 0.25;
+    calibration.offsets[2] = -1.5;
+    
+    std::printf("detected: %s\n\n", SensorBatch::simdLevelName(SensorBatch::detectedSimdLevel()));
+    std::printf("%-24s %-8s %8s %16s %14s\n", "operation", "level", "block", "Msamples/s", "checksum");
+    
+    QElapsedTimer timer;
+    for (int blockSize : BLOCK_SIZES) {
+        const SensorBlock source = makeBlock(blockSize);
+        const int rounds = TOTAL_SAMPLES / blockSize;
+        
+        // Per-sample baseline
+        {
+            QVector<SensorSample> samples;
+            for (int i = 0; i < blockSize; ++i) {
+                samples.append(source.sample(i));
+            }
+            double checksum = 0.0;
+            timer.start();
+            for (int round = 0; round < rounds; ++round) {
+                QVector<SensorSample> batch = samples;
+                for (SensorSample& sample : batch) {
+                    SensorBatch::calibrate(sample, calibration);
+                }
+                checksum += batch.last().values[0];
+            }
+            report("calibrate per sample", "scalar", blockSize, timer.nsecsElapsed(), checksum / rounds);
+        }
+        
+        const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX};
+        for (SimdLevel level : levels) {
+            if (level > SensorBatch::detectedSimdLevel()) {
+                continue;
+            }
+            SensorBatch::setSimdLevel(level);
+            const char* name = SensorBatch::simdLevelName(level);
+            
+            struct Case { const char* name; SensorFilter filter; };
+            Case cases[] = {
+                {"calibrate batch", SensorFilter()},
+                {"calibrate + FIR 8", SensorFilter::movingAverage(8)},
+                {"calibrate + FIR 32", SensorFilter::movingAverage(32)},
+                {"calibrate + exponential", SensorFilter::exponential(0.1)}
+            };
+            for (Case& test : cases) {
+                double checksum = 0.0;
+                SensorBlock block;
+                timer.start();
+                for (int round = 0; round < rounds; ++round) {
+                    block = source;
+                    SensorBatch::calibrate(block, calibration);
+                    test.filter.process(block);
+                    checksum += block.values[0].back();
+                }
+                report(test.name, name, blockSize, timer.nsecsElapsed(), checksum / rounds);
+            }
+        }
+        SensorBatch::setSimdLevel(SensorBatch::detectedSimdLevel());
+        std::printf("\n");
+    }
+    
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cmath>
+#include <cstdio>
+
+#include "SensorGorilla.h"
+#include "SensorSignalModel.h"
+
+// Bytes per sample and encode/decode throughput of the Gorilla chunk
+// encoding SensorSeriesStore seals chunks with, against the raw columns it
+// replaces and the JSON array MockI2C::logData() used to write. Gorilla
+// streams restart every SensorSeriesStore::CHUNK_SAMPLES samples as in the
+// store. The data comes from the cabin model at 1 s and at the 1 kHz
+// acquisition rate, the same rounded to the sensors' resolution, and a
+// sensor that reads the same value all the time.
+
+static const int SAMPLE_COUNT = 200000;
+static const qint64 BASE_TIMESTAMP = 1700000000000LL;
+static const char* LEGACY_TIME_FORMAT = "yyyy-MM-dd hh:mm:ss.zzz";
+// Temperature 0.01 C, humidity 0.01 %, pressure 0.01 hPa, light 1 lux
+static const double RESOLUTION[SensorSample::CHANNEL_COUNT] = {0.01, 0.01, 0.01, 1.0};
+
+static QVector<SensorSample> makeSamples(qint64 stepMs, bool quantized, bool constant)
+{
+    std::unique_ptr<SensorSignalModel> model = SensorSignalModel::create("cabin", 42);
+    QVector<SensorSample> samples(SAMPLE_COUNT);
+    for (int i = 0; i < SAMPLE_COUNT; ++i) {
+        SensorSample& sample = samples[i];
+        sample.timestamp = BASE_TIMESTAMP + i * stepMs;
+        if (constant && i > 0) {
+            std::copy(samples[0].values, samples[0].values + SensorSample::CHANNEL_COUNT, sample.values);
+            continue;
+        }
+        model->generate(sample);
+        if (quantized) {
+            for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+                sample.values[c] = std::round(sample.values[c] / RESOLUTION[c]) * RESOLUTION[c];
+            }
+        }
+    }
+    return samples;
+}
+
+static void report(const char* data, const char* format, qint64 bytes, double encodeNs, double decodeNs)
+{
+    std::printf("%-18s %-8s %12.2f %14.2f %14.2f\n", data, format, double(bytes) / SAMPLE_COUNT,
+                SAMPLE_COUNT / (encodeNs / 1e9) / 1e6, SAMPLE_COUNT / (decodeNs / 1e9) / 1e6);
+}
+
+static double benchJson(const char* data, const QVector<SensorSample>& samples)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QJsonArray points;
+    for (const SensorSample& sample : samples) {
+        QJsonObject point;
+        point["timestamp"] = QDateTime::fromMSecsSinceEpoch(sample.timestamp).toString(LEGACY_TIME_FORMAT);
+        point["temperature"] = sample.value(SensorChannel::Temperature);
+        point["humidity"] = sample.value(SensorChannel::Humidity);
+        point["pressure"] = sample.value(SensorChannel::Pressure);
+        point["light_level"] = sample.value(SensorChannel::Light);
+        points.append(point);
+    }
+    const QByteArray json = QJsonDocument(points).toJson(QJsonDocument::Compact);
+    const double encodeNs = timer.nsecsElapsed();
+    
+    timer.start();
+    double checksum = 0.0;
+    const QJsonArray decoded = QJsonDocument::fromJson(json).array();
+    for (const QJsonValue& value : decoded) {
+        const QJsonObject point = value.toObject();
+        checksum += QDateTime::fromString(point["timestamp"].toString(), LEGACY_TIME_FORMAT).toMSecsSinceEpoch() % 1000;
+        checksum += point["temperature"].toDouble() + point["humidity"].toDouble()
+            + point["pressure"].toDouble() + point["light_level"].toDouble();
+    }
+    const double decodeNs = timer.nsecsElapsed();
+    
+    report(data, "json", json.size(), encodeNs, decodeNs);
+    return checksum;
+}
+
+static double benchGorilla(const char* data, const QVector<SensorSample>& samples)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QVector<QVector<QByteArray>> chunks;
+    SensorGorillaEncoder encoder;
+    for (const SensorSample& sample : samples) {
+        encoder.append(sample);
+        if (encoder.count() == SensorSeriesStore::CHUNK_SAMPLES) {
+            chunks.append(encoder.finish());
+        }
+    }
+    if (encoder.count() > 0) {
+        chunks.append(encoder.finish());
+    }
+    const double encodeNs = timer.nsecsElapsed();
+    
+    qint64 bytes = 0;
+    for (const QVector<QByteArray>& columns : chunks) {
+        for (const QByteArray& column : columns) {
+            bytes += column.size();
+        }
+    }
+    
+    timer.start();
+    double checksum = 0.0;
+    int remaining = samples.size();
+    for (const QVector<QByteArray>& columns : chunks) {
+        SensorGorillaDecoder decoder(columns, qMin(remaining, SensorSeriesStore::CHUNK_SAMPLES));
+        SensorSample sample;
+        while (decoder.next(sample)) {
+            checksum += sample.timestamp % 1000;
+            checksum += sample.values[0] + sample.values[1] + sample.values[2] + sample.values[3];
+            --remaining;
+        }
+    }
+    const double decodeNs = timer.nsecsElapsed();
+    
+    report(data, "gorilla", bytes, encodeNs, decodeNs);
+    if (remaining != 0) {
+        std::printf("gorilla decode lost %d samples\n", remaining);
+    }
+    return checksum;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    struct Dataset {
+        const char* name;
+        qint64 stepMs;
+        bool quantized;
+        bool constant;
+    };
+    const Dataset datasets[] = {
+        {"cabin 1 s", 1000, false, false},
+        {"cabin 1 ms", 1, false, false},
+        {"cabin 1 s, 0.01", 1000, true, false},
+        {"constant 1 s", 1000, false, true},
+    };
+    
+    std::printf("%-18s %-8s %12s %14s %14s\n", "data", "format", "bytes/sample", "enc Msamples/s", "dec Msamples/s");
+    std::printf("%-18s %-8s %12d\n", "any", "raw", 8 * (1 + SensorSample::CHANNEL_COUNT));
+    for (const Dataset& dataset : datasets) {
+        const QVector<SensorSample> samples = makeSamples(dataset.stepMs, dataset.quantized, dataset.constant);
+        const double jsonChecksum = benchJson(dataset.name, samples);
+        const double gorillaChecksum = benchGorilla(dataset.name, samples);
+        if (std::abs(jsonChecksum - gorillaChecksum) > 1e-6 * std::abs(jsonChecksum)) {
+            std::printf("checksum mismatch: %.6f vs %.6f\n", jsonChecksum, gorillaChecksum);
+        }
+    }
+    
+    return 0;
+}
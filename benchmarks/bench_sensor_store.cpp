@@ -0,0 +1,136 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+#include <random>
+
+#include "SensorSeriesStore.h"
+
+// Appends 1M samples (11.5 days at 1 Hz) to a SensorSeriesStore, then times
+// reopening the file and the range reads a history graph issues. The old
+// MockI2C::logData() rewrote a JSON array per sample; it is measured at a
+// few thousand samples, which already shows its O(n) per-sample cost.
+
+static const int SAMPLE_COUNT = 1000000;
+static const int LEGACY_SAMPLE_COUNTS[] = {1000, 2000, 4000};
+static const qint64 BASE_TIMESTAMP = 1700000000000LL;
+
+static SensorSample makeSample(std::mt19937& rng, int index)
+{
+    std::uniform_real_distribution<double> noise(-0.5, 0.5);
+    SensorSample sample;
+    sample.timestamp = BASE_TIMESTAMP + qint64(index) * 1000;
+    sample.setValue(SensorChannel::Temperature, 21.0 + noise(rng));
+    sample.setValue(SensorChannel::Humidity, 50.0 + noise(rng));
+    sample.setValue(SensorChannel::Pressure, 1013.0 + noise(rng));
+    sample.setValue(SensorChannel::Light, 500.0 + 100.0 * noise(rng));
+    return sample;
+}
+
+static void legacyAppend(const QString& path, const SensorSample& sample)
+{
+    QJsonObject dataPoint;
+    dataPoint["timestamp"] = QString::number(sample.timestamp);
+    dataPoint["temperature"] = sample.value(SensorChannel::Temperature);
+    dataPoint["humidity"] = sample.value(SensorChannel::Humidity);
+    dataPoint["pressure"] = sample.value(SensorChannel::Pressure);
+    dataPoint["light_level"] = sample.value(SensorChannel::Light);
+    
+    QFile logFile(path);
+    QJsonArray dataArray;
+    if (logFile.exists() && logFile.open(QIODevice::ReadOnly)) {
+        dataArray = QJsonDocument::fromJson(logFile.readAll()).array();
+        logFile.close();
+    }
+    dataArray.append(dataPoint);
+    if (logFile.open(QIODevice::WriteOnly)) {
+        logFile.write(QJsonDocument(dataArray).toJson());
+    }
+}
+
+static void report(const char* name, double elapsedMs, qint64 rows)
+{
+    std::printf("%-36s %12.2f %12lld\n", name, elapsedMs, static_cast<long long>(rows));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    const QString path = QDir::tempPath() + "/autodash_bench_sensor.series";
+    const QString legacyPath = QDir::tempPath() + "/autodash_bench_sensor.json";
+    QFile::remove(path);
+    std::mt19937 rng(42);
+    
+    std::printf("%-36s %12s %12s\n", "operation", "ms", "rows");
+    
+    QElapsedTimer timer;
+    {
+        SensorSeriesStore store;
+        store.open(path);
+        timer.start();
+        for (int i = 0; i < SAMPLE_COUNT; ++i) {
+            store.append(makeSample(rng, i));
+            store.flushIfDue();
+        }
+        store.flush();
+        const double appendMs = timer.nsecsElapsed() / 1e6;
+        report("append 1M samples", appendMs, store.size());
+        std::printf("%-36s %12.1f\n", "  per sample (ns)", appendMs * 1e6 / SAMPLE_COUNT);
+        std::printf("%-36s %12.1f\n", "  file size (MB)", QFileInfo(path).size() / (1024.0 * 1024.0));
+    }
+    
+    SensorSeriesStore store;
+    timer.start();
+    store.open(path);
+    report("reopen (load chunk headers)", timer.nsecsElapsed() / 1e6, store.chunkCount());
+    
+    const qint64 lastTimestamp = store.lastTimestamp();
+    const qint64 hour = 3600 * 1000LL;
+    
+    timer.start();
+    QVector<SensorSample> lastHour = store.read(lastTimestamp - hour, lastTimestamp);
+    report("read last hour (all channels)", timer.nsecsElapsed() / 1e6, lastHour.size());
+    
+    timer.start();
+    QVector<SensorSample> midDay = store.read(BASE_TIMESTAMP + 120 * hour, BASE_TIMESTAMP + 144 * hour);
+    report("read one day mid-file", timer.nsecsElapsed() / 1e6, midDay.size());
+    
+    QVector<qint64> timestamps;
+    QVector<double> values;
+    timer.start();
+    store.readChannel(SensorChannel::Temperature, BASE_TIMESTAMP, lastTimestamp, timestamps, values);
+    report("read temperature column, all", timer.nsecsElapsed() / 1e6, values.size());
+    
+    timer.start();
+    SensorRangeSummary summary = store.summarize(SensorChannel::Temperature);
+    report("min/max temperature, all", timer.nsecsElapsed() / 1e6, summary.count);
+    
+    timer.start();
+    summary = store.summarize(SensorChannel::Temperature, BASE_TIMESTAMP + 30 * 60 * 1000LL,
+                              lastTimestamp - 30 * 60 * 1000LL);
+    report("min/max temperature, unaligned", timer.nsecsElapsed() / 1e6, summary.count);
+    store.close();
+    
+    std::printf("\n%-36s %12s %12s\n", "legacy JSON rewrite", "ms", "us/sample");
+    for (int count : LEGACY_SAMPLE_COUNTS) {
+        QFile::remove(legacyPath);
+        timer.start();
+        for (int i = 0; i < count; ++i) {
+            legacyAppend(legacyPath, makeSample(rng, i));
+        }
+        const double elapsedMs = timer.nsecsElapsed() / 1e6;
+        char name[64];
+        std::snprintf(name, sizeof(name), "append %d samples", count);
+        std::printf("%-36s %12.1f %12.1f\n", name, elapsedMs, elapsedMs * 1e3 / count);
+    }
+    
+    QFile::remove(path);
+    QFile::remove(legacyPath);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <cstdio>
+
+#include "FastClock.h"
+
+// Per-call cost of the timestamp paths used by Logger and MockI2C: the old
+// QDateTime formatting versus FastClock's cached-prefix formatting, plus the
+// raw integer clocks.
+
+static const int ITERATIONS = 1000000;
+
+template <typename Function>
+static void measure(const char* name, Function function)
+{
+    qint64 sink = 0;
+    for (int i = 0; i < ITERATIONS / 100; ++i) {
+        sink += function(i);
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        sink += function(i);
+    }
+    double nsPerCall = double(timer.nsecsElapsed()) / ITERATIONS;
+    std::printf("%-44s %10.1f\n", name, nsPerCall);
+    if (sink == 42) {
+        std::printf(" ");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const qint64 base = QDateTime::currentMSecsSinceEpoch();
+    
+    std::printf("%-44s %10s\n", "path", "ns/call");
+    
+    measure("QDateTime::currentDateTime().toString()", [](int) {
+        return QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz").size();
+    });
+    measure("FastClock::currentTimestamp()", [](int) {
+        return FastClock::currentTimestamp().size();
+    });
+    
+    // Formatting recorded timestamps, ~1 kHz like the logger's writer sees
+    measure("QDateTime::fromMSecsSinceEpoch().toString()", [base](int i) {
+        return QDateTime::fromMSecsSinceEpoch(base + i).toString("yyyy-MM-dd hh:mm:ss.zzz").size();
+    });
+    measure("FastClock::formatTimestamp()", [base](int i) {
+        return FastClock::formatTimestamp(base + i).size();
+    });
+    
+    measure("QDateTime::currentMSecsSinceEpoch()", [](int) {
+        return QDateTime::currentMSecsSinceEpoch();
+    });
+    measure("FastClock::wallMs()", [](int) {
+        return FastClock::wallMs();
+    });
+    measure("FastClock::now() (wall + monotonic)", [](int) {
+        FastClock::Now now = FastClock::now();
+        return now.wallMs + now.monotonicNs;
+    });
+    
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include <QCommandLineParser>
 #include <QCommandLineOption>
 #include <QDir>
+#include <QFileInfo>
 #include <QStandardPaths>
 #include <QMessageBox>
 #include <QStyleFactory>
@@ -42,6 +43,51 @@ int main(int argc, char *argv[])
                                      "level", "INFO");
     parser.addOption(logLevelOption);
     
+    QCommandLineOption moduleLogLevelOption(QStringList() << "log-module", 
+                                           "Override the log level for one module, e.g. MockI2C=WARNING", 
+                                           "module=level");
+    parser.addOption(moduleLogLevelOption);
+    
+    QCommandLineOption sensorRateOption(QStringList() << "sensor-rate", 
+                                       "Sample the I2C sensors on a dedicated thread at this rate (1-1000 Hz)", 
+                                       "hz");
+    parser.addOption(sensorRateOption);
+    
+    QCommandLineOption sensorModelOption(QStringList() << "sensor-model", 
+                                        "Sensor signal model: " + SensorSignalModel::names().join(", "), 
+                                        "model");
+    parser.addOption(sensorModelOption);
+    
+    QCommandLineOption sensorSeedOption(QStringList() << "sensor-seed", 
+                                       "Seed for the sensor signal model and noise, for reproducible runs", 
+                                       "seed", "1");
+    parser.addOption(sensorSeedOption);
+    
+    QCommandLineOption sensorIntervalsOption(QStringList() << "sensor-intervals", 
+                                            "Per-channel sampling intervals: temperature,humidity,pressure,light (0 disables a channel)", 
+                                            "ms,ms,ms,ms");
+    parser.addOption(sensorIntervalsOption);
+    
+    QCommandLineOption sensorHeartbeatOption(QStringList() << "sensor-heartbeat", 
+                                            "Publish sensor updates only when a reading changes by its displayed precision, or at least this often", 
+                                            "ms");
+    parser.addOption(sensorHeartbeatOption);
+    
+    QCommandLineOption recordTraceOption(QStringList() << "record-trace", 
+                                        "Record every published sensor sample to a trace file", 
+                                        "file");
+    parser.addOption(recordTraceOption);
+    
+    QCommandLineOption replayTraceOption(QStringList() << "replay-trace", 
+                                        "Replay a recorded sensor trace instead of live sensor data", 
+                                        "file");
+    parser.addOption(replayTraceOption);
+    
+    QCommandLineOption replaySpeedOption(QStringList() << "replay-speed", 
+                                        "Trace replay speed: 1 for real time, N for N times faster, 0 for as fast as possible", 
+                                        "factor", "1");
+    parser.addOption(replaySpeedOption);
+    
     QCommandLineOption configOption(QStringList() << "c" << "config", 
                                    "Configuration file path", "file");
     parser.addOption(configOption);
@@ -84,6 +130,36 @@ int main(int argc, char *argv[])
         logger.setLogLevel(LogLevel::INFO);
     }
     
+    const QStringList levelNames = {"DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL"};
+    for (const QString& override : parser.values(moduleLogLevelOption)) {
+        QString module = override.section('=', 0, 0);
+        int levelIndex = levelNames.indexOf(override.section('=', 1).toUpper());
+        if (module.isEmpty() || levelIndex < 0) {
+            qWarning() << "Ignoring invalid --log-module value:" << override;
+            continue;
+        }
+        logger.setModuleLogLevel(module, static_cast<LogLevel>(levelIndex));
+    }
+    
+    // Chatty simulators: BluetoothSim logs every signal-strength tick and
+    // USBMonitor every directory change
+    logger.setSampling("BluetoothSim", LogLevel::DEBUG, 10);
+    logger.setRateLimit("USBMonitor", LogLevel::DEBUG, 5.0, 20);
+    
+    // Coalesce UI log notifications so log storms do not flood the event loop
+    logger.setNotificationInterval(50);
+    
+    // Bound autodash.log on long drives: 10 MB segments, the newest 10 kept
+    // (gzip-compressed when zlib is available)
+    LogRotationPolicy rotation;
+    rotation.maxBytes = 10 * 1024 * 1024;
+    rotation.keepCount = 10;
+    logger.setRotationPolicy(rotation);
+    
+    // Keep the newest log lines in a mapped file so a crash loses nothing;
+    // lines left over from a crashed session are appended to the log here
+    logger.setBlackBoxFile(QFileInfo(logger.getLogFilePath()).absolutePath() + "/autodash.blackbox");
+    
     // Enable debug mode if requested
     if (parser.isSet(debugOption)) {
         logger.setConsoleOutput(true);
@@ -144,6 +220,48 @@ int main(int argc, char *argv[])
         LOG_ERROR("Main", "Failed to initialize Mock I2C");
     } else {
         LOG_INFO("Main", "Mock I2C initialized successfully");
+        if (parser.isSet(sensorSeedOption)) {
+            mockI2C.setSeed(parser.value(sensorSeedOption).toULongLong());
+        }
+        if (parser.isSet(sensorModelOption)) {
+            const QString model = parser.value(sensorModelOption);
+            std::unique_ptr<SensorSignalModel> signalModel =
+                SensorSignalModel::create(model, parser.value(sensorSeedOption).toULongLong());
+            if (signalModel) {
+                mockI2C.setSignalModel(std::move(signalModel));
+            } else {
+                LOG_WARNING("Main", "Unknown sensor model: " + model);
+            }
+        }
+        if (parser.isSet(sensorIntervalsOption)) {
+            const QStringList intervals = parser.value(sensorIntervalsOption).split(',');
+            if (intervals.size() == SensorSample::CHANNEL_COUNT) {
+                for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+                    mockI2C.setChannelInterval(static_cast<SensorChannel>(c), intervals[c].toInt());
+                }
+            } else {
+                LOG_WARNING("Main", "--sensor-intervals needs one interval per channel");
+            }
+        }
+        if (parser.isSet(sensorHeartbeatOption)) {
+            // Deadbands at the precision the UI shows: 0.1 C, 0.1 %, 0.1 hPa, 1 lux
+            static const double DISPLAY_DEADBANDS[SensorSample::CHANNEL_COUNT] = {0.1, 0.1, 0.1, 1.0};
+            SensorPublishPolicy policy;
+            policy.heartbeatMs = parser.value(sensorHeartbeatOption).toLongLong();
+            for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+                policy.deadband = DISPLAY_DEADBANDS[c];
+                mockI2C.setPublishPolicy(static_cast<SensorChannel>(c), policy);
+            }
+        }
+        if (parser.isSet(sensorRateOption)) {
+            mockI2C.startAcquisition(parser.value(sensorRateOption).toInt());
+        }
+    }
+    if (parser.isSet(recordTraceOption)) {
+        mockI2C.startRecording(parser.value(recordTraceOption));
+    }
+    if (parser.isSet(replayTraceOption)) {
+        mockI2C.startReplay(parser.value(replayTraceOption), parser.value(replaySpeedOption).toDouble());
     }
     
     // Initialize USB Monitor
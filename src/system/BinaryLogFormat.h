@@ -0,0 +1,90 @@
+#ifndef BINARYLOGFORMAT_H
+#define BINARYLOGFORMAT_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+// On-disk layout shared by BinaryLogSink and BinaryLogReader.
+//
+// A file is a sequence of tagged records. Every writer session starts with a
+// SESSION record, which resets the module/format tables and the timestamp
+// base, so sessions can simply be appended to an existing file.
+//
+//   SESSION  : tag, "ADLG", version u8, wall-clock base ms (i64 LE),
+//              monotonic base ns (i64 LE)
+//   MODULE   : tag, id varint, name string
+//   FORMAT   : tag, id varint, format string
+//   TEXT     : tag, ts delta, level u8, module id varint, payload string
+//   FORMATTED: tag, ts delta, level u8, module id varint, format id varint,
+//              argc u8, argc x (type u8, value)
+//
+// Strings are varint length + UTF-8. ts delta is the zigzag-encoded change in
+// monotonic ns from the previous entry of the session (async writers can
+// reorder entries slightly). Argument values are zigzag varints for signed
+// integers, plain varints for unsigned ones (version 3), 8-byte little-endian
+// IEEE doubles, strings, or a u8 for booleans (version 2). Strings are cut at MAX_STRING_BYTES, so a longer length is corruption.
+namespace BinaryLog {
+
+const char MAGIC[4] = {'A', 'D', 'L', 'G'};
+const quint8 VERSION = 3;
+const quint64 MAX_STRING_BYTES = 1024 * 1024;
+
+enum RecordTag : quint8 {
+    TAG_SESSION = 0xA5,
+    TAG_MODULE = 0x01,
+    TAG_FORMAT = 0x02,
+    TAG_TEXT = 0x10,
+    TAG_FORMATTED = 0x11
+};
+
+enum ArgumentType : quint8 {
+    ARG_INT = 0,
+    ARG_DOUBLE = 1,
+    ARG_STRING = 2,
+    ARG_BOOL = 3,
+    ARG_UINT = 4
+};
+
+inline quint64 zigzagEncode(qint64 value)
+{
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+inline qint64 zigzagDecode(quint64 value)
+{
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+inline void appendVarint(QByteArray& out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+inline void appendFixed64(QByteArray& out, quint64 value)
+{
+    for (int i = 0; i < 8; ++i) {
+        out.append(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+inline void appendString(QByteArray& out, const QByteArray& utf8)
+{
+    quint64 length = static_cast<quint64>(utf8.size());
+    if (length > MAX_STRING_BYTES) {
+        // Back off to a character boundary
+        length = MAX_STRING_BYTES;
+        while (length > 0 && (static_cast<quint8>(utf8.at(static_cast<int>(length))) & 0xC0) == 0x80) {
+            --length;
+        }
+    }
+    appendVarint(out, length);
+    out.append(utf8.constData(), static_cast<int>(length));
+}
+
+} // namespace BinaryLog
+
+#endif // BINARYLOGFORMAT_H
@@ -0,0 +1,301 @@
+#include "BinaryLogReader.h"
+#include "BinaryLogFormat.h"
+#include <cstring>
+
+using namespace BinaryLog;
+
+namespace {
+
+// Bounds-checked cursor; any read past the end marks it incomplete, a value
+// no writer produces marks it corrupt as well
+class Cursor
+{
+public:
+    Cursor(const QByteArray& data, int offset)
+        : m_data(data.constData())
+        , m_size(data.size())
+        , m_pos(offset)
+        , m_ok(true)
+        , m_corrupt(false)
+    {
+    }
+    
+    bool ok() const { return m_ok; }
+    bool corrupt() const { return m_corrupt; }
+    
+    void markCorrupt()
+    {
+        m_ok = false;
+        m_corrupt = true;
+    }
+    int pos() const { return m_pos; }
+    
+    quint8 byte()
+    {
+        if (m_pos >= m_size) {
+            m_ok = false;
+            return 0;
+        }
+        return static_cast<quint8>(m_data[m_pos++]);
+    }
+    
+    quint64 varint()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            quint8 b = byte();
+            if (!m_ok) {
+                return 0;
+            }
+            value |= static_cast<quint64>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        markCorrupt();
+        return 0;
+    }
+    
+    quint64 fixed64()
+    {
+        quint64 value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<quint64>(byte()) << (i * 8);
+        }
+        return value;
+    }
+    
+    QByteArray bytes(quint64 length)
+    {
+        if (!m_ok || length > static_cast<quint64>(m_size - m_pos)) {
+            m_ok = false;
+            return QByteArray();
+        }
+        QByteArray result(m_data + m_pos, static_cast<int>(length));
+        m_pos += static_cast<int>(length);
+        return result;
+    }
+    
+    QString string()
+    {
+        quint64 length = varint();
+        if (length > MAX_STRING_BYTES) {
+            markCorrupt();
+            return QString();
+        }
+        return QString::fromUtf8(bytes(length));
+    }
+
+private:
+    const char* m_data;
+    int m_size;
+    int m_pos;
+    bool m_ok;
+    bool m_corrupt;
+};
+
+} // namespace
+
+BinaryLogReader::BinaryLogReader()
+    : m_offset(0)
+    , m_consumed(0)
+    , m_wallBaseMs(0)
+    , m_monotonicBaseNs(0)
+    , m_lastMonotonicNs(0)
+    , m_inSession(false)
+{
+}
+
+bool BinaryLogReader::open(const QString& filePath)
+{
+    close();
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = QString("Cannot open %1: %2").arg(filePath, m_file.errorString());
+        return false;
+    }
+    return true;
+}
+
+void BinaryLogReader::close()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_buffer.clear();
+    m_offset = 0;
+    m_consumed = 0;
+    m_modules.clear();
+    m_formats.clear();
+    m_inSession = false;
+    m_error.clear();
+}
+
+bool BinaryLogReader::readNext(BinaryLogEntry& entry)
+{
+    if (!m_error.isEmpty()) {
+        return false;
+    }
+    
+    for (;;) {
+        ParseResult result = parseRecord(entry);
+        switch (result) {
+            case PARSE_ENTRY:
+                return true;
+            case PARSE_CONTROL:
+                continue;
+            case PARSE_INCOMPLETE:
+                if (!fillBuffer()) {
+                    return false;
+                }
+                continue;
+            case PARSE_ERROR:
+                return false;
+        }
+    }
+}
+
+bool BinaryLogReader::hasError() const
+{
+    return !m_error.isEmpty();
+}
+
+QString BinaryLogReader::errorString() const
+{
+    return m_error;
+}
+
+qint64 BinaryLogReader::position() const
+{
+    return m_consumed + m_offset;
+}
+
+bool BinaryLogReader::fillBuffer()
+{
+    // Drop the parsed prefix, keep any partial record
+    if (m_offset > 0) {
+        m_consumed += m_offset;
+        m_buffer.remove(0, m_offset);
+        m_offset = 0;
+    }
+    
+    QByteArray chunk = m_file.read(READ_CHUNK_SIZE);
+    if (chunk.isEmpty()) {
+        return false;
+    }
+    m_buffer.append(chunk);
+    return true;
+}
+
+BinaryLogReader::ParseResult BinaryLogReader::parseRecord(BinaryLogEntry& entry)
+{
+    Cursor cursor(m_buffer, m_offset);
+    
+    // Running out of data is normal at the end of a file being written; an
+    // impossible length or type is not, and waiting for more would never end
+    auto incomplete = [this, &cursor]() {
+        if (cursor.corrupt()) {
+            m_error = QString("Corrupt record at offset %1").arg(position());
+            return PARSE_ERROR;
+        }
+        return PARSE_INCOMPLETE;
+    };
+    
+    quint8 tag = cursor.byte();
+    if (!cursor.ok()) {
+        return incomplete();
+    }
+    
+    if (tag != TAG_SESSION && !m_inSession) {
+        m_error = QString("Missing session header at offset %1").arg(position());
+        return PARSE_ERROR;
+    }
+    
+    switch (tag) {
+        case TAG_SESSION: {
+            QByteArray magic = cursor.bytes(sizeof(MAGIC));
+            quint8 version = cursor.byte();
+            qint64 wallBase = static_cast<qint64>(cursor.fixed64());
+            qint64 monotonicBase = static_cast<qint64>(cursor.fixed64());
+            if (!cursor.ok()) {
+                return incomplete();
+            }
+            // Versions 2 and 3 only added ARG_BOOL and ARG_UINT, so older
+            // files read as they are
+            if (std::memcmp(magic.constData(), MAGIC, sizeof(MAGIC)) != 0 || version < 1 || version > VERSION) {
+                m_error = QString("Bad session header at offset %1").arg(position());
+                return PARSE_ERROR;
+            }
+            m_modules.clear();
+            m_formats.clear();
+            m_wallBaseMs = wallBase;
+            m_monotonicBaseNs = monotonicBase;
+            m_lastMonotonicNs = monotonicBase;
+            m_inSession = true;
+            m_offset = cursor.pos();
+            return PARSE_CONTROL;
+        }
+        case TAG_MODULE:
+        case TAG_FORMAT: {
+            quint32 id = static_cast<quint32>(cursor.varint());
+            QString text = cursor.string();
+            if (!cursor.ok()) {
+                return incomplete();
+            }
+            (tag == TAG_MODULE ? m_modules : m_formats).insert(id, text);
+            m_offset = cursor.pos();
+            return PARSE_CONTROL;
+        }
+        case TAG_TEXT:
+        case TAG_FORMATTED: {
+            qint64 delta = zigzagDecode(cursor.varint());
+            quint8 level = cursor.byte();
+            quint32 module = static_cast<quint32>(cursor.varint());
+            QString message;
+            if (tag == TAG_TEXT) {
+                message = cursor.string();
+            } else {
+                quint32 format = static_cast<quint32>(cursor.varint());
+                quint8 argumentCount = cursor.byte();
+                LogArguments arguments;
+                for (int i = 0; i < argumentCount && cursor.ok(); ++i) {
+                    quint8 type = cursor.byte();
+                    if (type == ARG_INT) {
+                        arguments.append(zigzagDecode(cursor.varint()));
+                    } else if (type == ARG_DOUBLE) {
+                        quint64 bits = cursor.fixed64();
+                        double value;
+                        std::memcpy(&value, &bits, sizeof(value));
+                        arguments.append(value);
+                    } else if (type == ARG_STRING) {
+                        arguments.append(cursor.string());
+                    } else if (type == ARG_UINT) {
+                        arguments.append(cursor.varint());
+                    } else if (type == ARG_BOOL) {
+                        arguments.append(cursor.byte() != 0);
+                    } else if (cursor.ok()) {
+                        cursor.markCorrupt();
+                    }
+                }
+                if (cursor.ok()) {
+                    message = formatLogMessage(m_formats.value(format), arguments);
+                }
+            }
+            if (!cursor.ok()) {
+                return incomplete();
+            }
+            
+            m_lastMonotonicNs += delta;
+            entry.monotonicNs = m_lastMonotonicNs;
+            entry.timestamp = m_wallBaseMs + (m_lastMonotonicNs - m_monotonicBaseNs) / 1000000;
+            entry.level = static_cast<LogLevel>(qMin<int>(level, static_cast<int>(LogLevel::CRITICAL)));
+            entry.module = m_modules.value(module);
+            entry.message = message;
+            m_offset = cursor.pos();
+            return PARSE_ENTRY;
+        }
+        default:
+            m_error = QString("Unknown record tag 0x%1 at offset %2").arg(tag, 2, 16, QChar('0')).arg(position());
+            return PARSE_ERROR;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef BINARYLOGREADER_H
+#define BINARYLOGREADER_H
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QByteArray>
+
+#include "LogRecord.h"
+
+// Decoded entry from a binary log file
+struct BinaryLogEntry {
+    qint64 timestamp;      // ms since epoch, reconstructed from the session base
+    qint64 monotonicNs;
+    LogLevel level;
+    QString module;
+    QString message;
+};
+
+// Streaming decoder for files written by BinaryLogSink. readNext() returns
+// false at the current end of data without losing a partially written
+// trailing record, so calling it again after the file grows implements tail.
+class BinaryLogReader
+{
+public:
+    BinaryLogReader();
+    
+    bool open(const QString& filePath);
+    void close();
+    
+    bool readNext(BinaryLogEntry& entry);
+    bool hasError() const;
+    QString errorString() const;
+    qint64 position() const;
+
+private:
+    enum ParseResult {
+        PARSE_ENTRY,
+        PARSE_CONTROL,      // Session/module/format definition, no entry
+        PARSE_INCOMPLETE,
+        PARSE_ERROR
+    };
+    
+    ParseResult parseRecord(BinaryLogEntry& entry);
+    bool fillBuffer();
+    
+    QFile m_file;
+    QByteArray m_buffer;
+    int m_offset;            // Parse position within m_buffer
+    qint64 m_consumed;       // File bytes before m_buffer
+    
+    QHash<quint32, QString> m_modules;
+    QHash<quint32, QString> m_formats;
+    qint64 m_wallBaseMs;
+    qint64 m_monotonicBaseNs;
+    qint64 m_lastMonotonicNs;
+    bool m_inSession;
+    QString m_error;
+    
+    static const int READ_CHUNK_SIZE = 256 * 1024;
+};
+
+#endif // BINARYLOGREADER_H
@@ -0,0 +1,186 @@
+#include "BinaryLogSink.h"
+#include "BinaryLogFormat.h"
+#include <QDateTime>
+#include <QDebug>
+#include <cstring>
+
+using namespace BinaryLog;
+
+BinaryLogSink::BinaryLogSink()
+    : m_sessionStarted(false)
+    , m_lastMonotonicNs(0)
+    , m_bytesWritten(0)
+{
+    m_buffer.reserve(FLUSH_THRESHOLD * 2);
+}
+
+BinaryLogSink::~BinaryLogSink()
+{
+    close();
+}
+
+bool BinaryLogSink::open(const QString& filePath)
+{
+    close();
+    
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Failed to open binary log file:" << filePath;
+        return false;
+    }
+    
+    m_modules.clear();
+    m_formats.clear();
+    m_sessionStarted = false;
+    m_bytesWritten = 0;
+    m_lastMonotonicNs = 0;
+    m_sinceFlush.start();
+    return true;
+}
+
+void BinaryLogSink::close()
+{
+    if (m_file.isOpen()) {
+        flush();
+        m_file.close();
+    }
+}
+
+bool BinaryLogSink::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+QString BinaryLogSink::filePath() const
+{
+    return m_file.fileName();
+}
+
+void BinaryLogSink::append(const LogRecord& record)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    
+    // A session record precedes the first entry so the reader can convert
+    // monotonic deltas back to wall-clock time
+    if (!m_sessionStarted) {
+        m_buffer.append(static_cast<char>(TAG_SESSION));
+        m_buffer.append(MAGIC, sizeof(MAGIC));
+        m_buffer.append(static_cast<char>(VERSION));
+        appendFixed64(m_buffer, static_cast<quint64>(record.timestamp));
+        appendFixed64(m_buffer, static_cast<quint64>(record.monotonicNs));
+        m_lastMonotonicNs = record.monotonicNs;
+        m_sessionStarted = true;
+    }
+    
+    quint32 module = moduleId(record.module);
+    quint32 format = record.format ? formatId(record.format) : 0;
+    
+    m_buffer.append(static_cast<char>(record.format ? TAG_FORMATTED : TAG_TEXT));
+    appendVarint(m_buffer, zigzagEncode(record.monotonicNs - m_lastMonotonicNs));
+    m_lastMonotonicNs = record.monotonicNs;
+    m_buffer.append(static_cast<char>(record.level));
+    appendVarint(m_buffer, module);
+    
+    if (record.format) {
+        appendVarint(m_buffer, format);
+        int argumentCount = qMin(record.arguments.size(), qsizetype(255));
+        m_buffer.append(static_cast<char>(argumentCount));
+        for (int i = 0; i < argumentCount; ++i) {
+            appendArgument(record.arguments[i]);
+        }
+    } else {
+        appendString(m_buffer, record.message.toUtf8());
+    }
+}
+
+void BinaryLogSink::flush()
+{
+    if (!m_file.isOpen() || m_buffer.isEmpty()) {
+        return;
+    }
+    
+    m_bytesWritten += m_file.write(m_buffer);
+    m_file.flush();
+    m_buffer.clear();
+    m_sinceFlush.restart();
+}
+
+void BinaryLogSink::flushIfDue()
+{
+    if (m_buffer.size() >= FLUSH_THRESHOLD || m_sinceFlush.elapsed() >= FLUSH_INTERVAL_MS) {
+        flush();
+    }
+}
+
+qint64 BinaryLogSink::bytesWritten() const
+{
+    return m_bytesWritten + m_buffer.size();
+}
+
+quint32 BinaryLogSink::moduleId(const QString& module)
+{
+    auto it = m_modules.constFind(module);
+    if (it != m_modules.constEnd()) {
+        return it.value();
+    }
+    
+    quint32 id = static_cast<quint32>(m_modules.size());
+    m_modules.insert(module, id);
+    m_buffer.append(static_cast<char>(TAG_MODULE));
+    appendVarint(m_buffer, id);
+    appendString(m_buffer, module.toUtf8());
+    return id;
+}
+
+quint32 BinaryLogSink::formatId(const char* format)
+{
+    // Keyed by pointer: formats are string literals, so each call site
+    // resolves to one id without hashing the text
+    auto it = m_formats.constFind(format);
+    if (it != m_formats.constEnd()) {
+        return it.value();
+    }
+    
+    quint32 id = static_cast<quint32>(m_formats.size());
+    m_formats.insert(format, id);
+    m_buffer.append(static_cast<char>(TAG_FORMAT));
+    appendVarint(m_buffer, id);
+    appendString(m_buffer, QByteArray(format));
+    return id;
+}
+
+void BinaryLogSink::appendArgument(const QVariant& argument)
+{
+    switch (argument.typeId()) {
+        case QMetaType::Int:
+        case QMetaType::LongLong:
+            m_buffer.append(static_cast<char>(ARG_INT));
+            appendVarint(m_buffer, zigzagEncode(argument.toLongLong()));
+            break;
+        case QMetaType::UInt:
+        case QMetaType::ULongLong:
+            // Not zigzag: values above INT64_MAX would come back negative
+            m_buffer.append(static_cast<char>(ARG_UINT));
+            appendVarint(m_buffer, argument.toULongLong());
+            break;
+        case QMetaType::Bool:
+            m_buffer.append(static_cast<char>(ARG_BOOL));
+            m_buffer.append(static_cast<char>(argument.toBool() ? 1 : 0));
+            break;
+        case QMetaType::Double:
+        case QMetaType::Float: {
+            double value = argument.toDouble();
+            quint64 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            m_buffer.append(static_cast<char>(ARG_DOUBLE));
+            appendFixed64(m_buffer, bits);
+            break;
+        }
+        default:
+            m_buffer.append(static_cast<char>(ARG_STRING));
+            appendString(m_buffer, argument.toString().toUtf8());
+            break;
+    }
+}
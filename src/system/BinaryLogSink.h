@@ -0,0 +1,55 @@
+#ifndef BINARYLOGSINK_H
+#define BINARYLOGSINK_H
+
+#include <QFile>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QByteArray>
+
+#include "LogRecord.h"
+
+// Compact binary log sink. Each entry is a monotonic timestamp delta, a level
+// byte, an interned module id and either the raw UTF-8 message or a format id
+// plus typed arguments. See BinaryLogFormat.h for the layout and the
+// autodash-logcat tool for decoding.
+//
+// Not thread-safe; the Logger calls it under its own mutex.
+class BinaryLogSink
+{
+public:
+    BinaryLogSink();
+    ~BinaryLogSink();
+    
+    bool open(const QString& filePath);
+    void close();
+    bool isOpen() const;
+    QString filePath() const;
+    
+    void append(const LogRecord& record);
+    void flush();
+    // Flush when the buffer is large or the last flush is older than
+    // FLUSH_INTERVAL_MS, trading a bounded loss window for fewer writes
+    void flushIfDue();
+    
+    qint64 bytesWritten() const;
+
+private:
+    quint32 moduleId(const QString& module);
+    quint32 formatId(const char* format);
+    void appendArgument(const QVariant& argument);
+    
+    QFile m_file;
+    QByteArray m_buffer;
+    QHash<QString, quint32> m_modules;
+    QHash<const char*, quint32> m_formats;
+    bool m_sessionStarted;
+    qint64 m_lastMonotonicNs;
+    qint64 m_bytesWritten;
+    QElapsedTimer m_sinceFlush;
+    
+    static const int FLUSH_THRESHOLD = 64 * 1024;
+    static const int FLUSH_INTERVAL_MS = 1000;
+};
+
+#endif // BINARYLOGSINK_H
@@ -0,0 +1,202 @@
+#include "BlackBoxLog.h"
+#include <QDebug>
+#include <atomic>
+#include <cstring>
+
+namespace {
+const char BLACK_BOX_MAGIC[8] = { 'A', 'D', 'B', 'L', 'K', 'B', 'O', 'X' };
+}
+
+BlackBoxLog::BlackBoxLog()
+    : m_map(nullptr)
+    , m_header(nullptr)
+    , m_data(nullptr)
+    , m_capacity(0)
+{
+}
+
+BlackBoxLog::~BlackBoxLog()
+{
+    close();
+}
+
+bool BlackBoxLog::open(const QString& filePath, qint64 capacityBytes, QByteArray* recovered)
+{
+    close();
+    
+    const qint64 capacity = qMax(capacityBytes, MIN_CAPACITY);
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Failed to open black box log:" << filePath;
+        return false;
+    }
+    
+    // Recover before resizing: a changed capacity discards the old layout
+    QByteArray pending;
+    bool reuse = false;
+    const qint64 existingSize = m_file.size();
+    if (existingSize > HEADER_SIZE) {
+        uchar* old = m_file.map(0, existingSize);
+        if (old) {
+            pending = readPending(old, existingSize);
+            reuse = existingSize == HEADER_SIZE + capacity
+                    && isValidHeader(reinterpret_cast<const Header*>(old), existingSize);
+            m_file.unmap(old);
+        }
+    }
+    if (recovered) {
+        *recovered = pending;
+    }
+    
+    if (!reuse && !m_file.resize(HEADER_SIZE + capacity)) {
+        qWarning() << "Failed to size black box log:" << filePath;
+        m_file.close();
+        return false;
+    }
+    
+    m_map = m_file.map(0, HEADER_SIZE + capacity);
+    if (!m_map) {
+        qWarning() << "Failed to map black box log:" << filePath;
+        m_file.close();
+        return false;
+    }
+    m_header = reinterpret_cast<Header*>(m_map);
+    m_data = m_map + HEADER_SIZE;
+    m_capacity = capacity;
+    
+    if (reuse) {
+        // The recovered bytes are now the caller's responsibility
+        m_header->synced = m_header->head;
+    } else {
+        memset(m_map, 0, HEADER_SIZE);
+        m_header->version = VERSION;
+        m_header->headerSize = HEADER_SIZE;
+        m_header->capacity = static_cast<quint64>(capacity);
+        m_header->head = 0;
+        m_header->synced = 0;
+        std::atomic_thread_fence(std::memory_order_release);
+        // Magic last, so a torn initialisation is not mistaken for a valid file
+        memcpy(m_header->magic, BLACK_BOX_MAGIC, sizeof(BLACK_BOX_MAGIC));
+    }
+    return true;
+}
+
+void BlackBoxLog::close()
+{
+    unmap();
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+bool BlackBoxLog::isOpen() const
+{
+    return m_map != nullptr;
+}
+
+QString BlackBoxLog::filePath() const
+{
+    return m_file.fileName();
+}
+
+qint64 BlackBoxLog::capacity() const
+{
+    return m_capacity;
+}
+
+void BlackBoxLog::append(const char* data, qint64 size)
+{
+    if (!m_map || size <= 0) {
+        return;
+    }
+    
+    // Only the newest `capacity` bytes of an oversized write can survive
+    const quint64 head = m_header->head;
+    const qint64 skip = qMax<qint64>(0, size - m_capacity);
+    const quint64 start = head + skip;
+    qint64 remaining = size - skip;
+    data += skip;
+    
+    qint64 offset = static_cast<qint64>(start % static_cast<quint64>(m_capacity));
+    while (remaining > 0) {
+        const qint64 chunk = qMin(remaining, m_capacity - offset);
+        memcpy(m_data + offset, data, static_cast<size_t>(chunk));
+        data += chunk;
+        remaining -= chunk;
+        offset = 0;
+    }
+    
+    // Publish the new head only after the bytes are in place
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->head = head + static_cast<quint64>(size);
+}
+
+void BlackBoxLog::append(const QByteArray& data)
+{
+    append(data.constData(), data.size());
+}
+
+void BlackBoxLog::markSynced()
+{
+    if (m_map) {
+        m_header->synced = m_header->head;
+    }
+}
+
+qint64 BlackBoxLog::unsyncedBytes() const
+{
+    return m_map ? static_cast<qint64>(m_header->head - m_header->synced) : 0;
+}
+
+bool BlackBoxLog::isValidHeader(const Header* header, qint64 fileSize)
+{
+    return memcmp(header->magic, BLACK_BOX_MAGIC, sizeof(BLACK_BOX_MAGIC)) == 0
+           && header->version == VERSION && header->headerSize == HEADER_SIZE
+           && static_cast<qint64>(header->capacity) == fileSize - HEADER_SIZE
+           && header->synced <= header->head;
+}
+
+QByteArray BlackBoxLog::readPending(const uchar* map, qint64 fileSize)
+{
+    const Header* header = reinterpret_cast<const Header*>(map);
+    if (!isValidHeader(header, fileSize)) {
+        return QByteArray();
+    }
+    
+    const quint64 capacity = header->capacity;
+    const quint64 head = header->head;
+    const quint64 oldest = head > capacity ? head - capacity : 0;
+    const quint64 start = qMax(header->synced, oldest);
+    if (start == head) {
+        return QByteArray();
+    }
+    
+    const uchar* data = map + HEADER_SIZE;
+    QByteArray pending;
+    pending.reserve(static_cast<int>(head - start));
+    quint64 position = start;
+    while (position < head) {
+        const quint64 offset = position % capacity;
+        const quint64 chunk = qMin(head - position, capacity - offset);
+        pending.append(reinterpret_cast<const char*>(data + offset), static_cast<int>(chunk));
+        position += chunk;
+    }
+    
+    // The ring overwrote part of the unsynced range: resume at a line boundary
+    if (start > header->synced) {
+        const int newline = pending.indexOf('\n');
+        pending = newline < 0 ? QByteArray() : pending.mid(newline + 1);
+    }
+    return pending;
+}
+
+void BlackBoxLog::unmap()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+    }
+    m_map = nullptr;
+    m_header = nullptr;
+    m_data = nullptr;
+    m_capacity = 0;
+}
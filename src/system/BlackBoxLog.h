@@ -0,0 +1,68 @@
+#ifndef BLACKBOXLOG_H
+#define BLACKBOXLOG_H
+
+#include <QFile>
+#include <QByteArray>
+#include <QString>
+
+// Crash-safe tail of the text log in a memory-mapped ring file.
+//
+// append() is a memcpy into a shared mapping followed by a header update, so
+// once it returns the bytes belong to the kernel's page cache and survive a
+// crash of the process (not a power loss). The header also records how far
+// the regular log file was known to be flushed; on the next open() anything
+// newer than that mark is returned for the caller to append to the regular
+// log, which lets the Logger stop flushing the text file on every batch.
+//
+// Not thread-safe; the Logger calls it under its own mutex.
+class BlackBoxLog
+{
+public:
+    static const qint64 MIN_CAPACITY = 64 * 1024;
+    
+    BlackBoxLog();
+    ~BlackBoxLog();
+    
+    // Maps the file, creating or resizing it as needed. Lines written by a
+    // previous session after its last markSynced() are stored in recovered,
+    // oldest first; if they wrapped the ring, the partial oldest line is
+    // dropped.
+    bool open(const QString& filePath, qint64 capacityBytes, QByteArray* recovered = nullptr);
+    void close();
+    bool isOpen() const;
+    QString filePath() const;
+    qint64 capacity() const;
+    
+    void append(const char* data, qint64 size);
+    void append(const QByteArray& data);
+    // Everything appended so far has reached the regular log file
+    void markSynced();
+    
+    // Bytes appended since the last markSynced()
+    qint64 unsyncedBytes() const;
+
+private:
+    struct Header {
+        char magic[8];
+        quint32 version;
+        quint32 headerSize;
+        quint64 capacity;
+        quint64 head;       // Total bytes ever appended; data ends at head % capacity
+        quint64 synced;     // head value at the last markSynced()
+    };
+    
+    static const int HEADER_SIZE = 4096;
+    static const quint32 VERSION = 1;
+    
+    static bool isValidHeader(const Header* header, qint64 fileSize);
+    static QByteArray readPending(const uchar* map, qint64 fileSize);
+    void unmap();
+    
+    QFile m_file;
+    uchar* m_map;
+    Header* m_header;
+    uchar* m_data;
+    qint64 m_capacity;
+};
+
+#endif // BLACKBOXLOG_H
@@ -0,0 +1,245 @@
+#include "DirectoryWalker.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <cctype>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <QDateTime>
+#include <QDirIterator>
+#endif
+
+#ifdef Q_OS_UNIX
+static qint64 modifiedMs(const struct stat& st)
+{
+#ifdef Q_OS_LINUX
+    return qint64(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+#else
+    return qint64(st.st_mtime) * 1000;
+#endif
+}
+#endif
+
+DirectoryWalker::DirectoryWalker(const QString& rootPath)
+    : m_rootPath(QDir(rootPath).absolutePath())
+    , m_maxDepth(UNLIMITED_DEPTH)
+    , m_cancelled(nullptr)
+    , m_rootDevice(0)
+{
+}
+
+void DirectoryWalker::setMaxDepth(int depth)
+{
+    m_maxDepth = depth;
+}
+
+void DirectoryWalker::setSuffixes(const QStringList& suffixes)
+{
+    m_suffixes.clear();
+    for (const QString& suffix : suffixes) {
+        m_suffixes.insert(suffix.toLower().toUtf8());
+    }
+}
+
+void DirectoryWalker::setCancelFlag(const std::atomic<bool>* cancelled)
+{
+    m_cancelled = cancelled;
+}
+
+void DirectoryWalker::setDirectoryCallback(const std::function<void()>& directoryRead)
+{
+    m_directoryRead = directoryRead;
+}
+
+bool DirectoryWalker::walk(const std::function<void(const DirectoryEntry&)>& visit)
+{
+    m_stats = DirectoryWalkStats();
+    m_pending.clear();
+    m_visited.clear();
+    m_visitedPaths.clear();
+    m_rootCanonicalPath = QFileInfo(m_rootPath).canonicalFilePath();
+    
+    m_pending.push_back({m_rootPath, 0});
+    while (!m_pending.empty()) {
+        if (isCancelled()) {
+            return false;
+        }
+        const PendingDirectory directory = m_pending.front();
+        m_pending.pop_front();
+        if (!readDirectory(directory, visit)) {
+            return false;
+        }
+        if (m_directoryRead) {
+            m_directoryRead();
+        }
+    }
+    return true;
+}
+
+DirectoryWalkStats DirectoryWalker::stats() const
+{
+    return m_stats;
+}
+
+#ifdef Q_OS_UNIX
+bool DirectoryWalker::readDirectory(const PendingDirectory& directory, const std::function<void(const DirectoryEntry&)>& visit)
+{
+    const QByteArray path = QFile::encodeName(directory.path);
+    const int fd = ::open(path.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        ++m_stats.unreadable;
+        return true;
+    }
+    
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        ++m_stats.unreadable;
+        return true;
+    }
+    if (directory.depth == 0) {
+        m_rootDevice = quint64(st.st_dev);
+    } else if (quint64(st.st_dev) != m_rootDevice) {
+        ::close(fd);
+        ++m_stats.skippedOutside;
+        return true;
+    }
+    if (!m_visited.insert({quint64(st.st_dev), quint64(st.st_ino)}).second) {
+        ::close(fd);
+        ++m_stats.skippedLoops;
+        return true;
+    }
+    DIR* dir = ::fdopendir(fd);
+    if (!dir) {
+        ::close(fd);
+        ++m_stats.unreadable;
+        return true;
+    }
+    ++m_stats.directories;
+    
+    bool completed = true;
+    while (const dirent* entry = ::readdir(dir)) {
+        if (isCancelled()) {
+            completed = false;
+            break;
+        }
+        const char* name = entry->d_name;
+        if (name[0] == '.') {
+            continue;
+        }
+        
+        // Symlinks and file systems without d_type need a stat to tell
+        unsigned char type = entry->d_type;
+        bool haveStat = false;
+        if (type == DT_LNK || type == DT_UNKNOWN) {
+            if (::fstatat(fd, name, &st, 0) != 0) {
+                continue;
+            }
+            // Directories are checked when read; a linked file here
+            if (!S_ISDIR(st.st_mode) && quint64(st.st_dev) != m_rootDevice) {
+                continue;
+            }
+            haveStat = true;
+            type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+        }
+        
+        if (type == DT_DIR) {
+            enqueue(directory.path + '/' + QFile::decodeName(name), directory.depth + 1);
+        } else if (type == DT_REG && matches(name)) {
+            if (!haveStat && ::fstatat(fd, name, &st, 0) != 0) {
+                continue;
+            }
+            ++m_stats.files;
+            visit({QFile::decodeName(path + '/' + name), qint64(st.st_size), modifiedMs(st), directory.depth});
+        }
+    }
+    ::closedir(dir);
+    return completed;
+}
+#else
+bool DirectoryWalker::readDirectory(const PendingDirectory& directory, const std::function<void(const DirectoryEntry&)>& visit)
+{
+    const QFileInfo directoryInfo(directory.path);
+    if (!directoryInfo.isReadable()) {
+        ++m_stats.unreadable;
+        return true;
+    }
+    const QString canonicalPath = directoryInfo.canonicalFilePath();
+    if (!isInsideRoot(canonicalPath)) {
+        ++m_stats.skippedOutside;
+        return true;
+    }
+    if (m_visitedPaths.contains(canonicalPath)) {
+        ++m_stats.skippedLoops;
+        return true;
+    }
+    m_visitedPaths.insert(canonicalPath);
+    ++m_stats.directories;
+    
+    QDirIterator it(directory.path, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        if (isCancelled()) {
+            return false;
+        }
+        it.next();
+        const QFileInfo fileInfo = it.fileInfo();
+        if (fileInfo.isDir()) {
+            enqueue(fileInfo.absoluteFilePath(), directory.depth + 1);
+        } else if (fileInfo.isFile() && matches(QFile::encodeName(fileInfo.fileName()).constData())
+                   && (!fileInfo.isSymLink() || isInsideRoot(fileInfo.canonicalFilePath()))) {
+            ++m_stats.files;
+            visit({fileInfo.absoluteFilePath(), fileInfo.size(),
+                   fileInfo.lastModified().toMSecsSinceEpoch(), directory.depth});
+        }
+    }
+    return true;
+}
+
+bool DirectoryWalker::isInsideRoot(const QString& canonicalPath) const
+{
+    return canonicalPath == m_rootCanonicalPath
+           || canonicalPath.startsWith(m_rootCanonicalPath + '/');
+}
+#endif
+
+void DirectoryWalker::enqueue(const QString& path, int depth)
+{
+    if (m_maxDepth != UNLIMITED_DEPTH && depth > m_maxDepth) {
+        ++m_stats.skippedDepth;
+        return;
+    }
+    m_pending.push_back({path, depth});
+}
+
+bool DirectoryWalker::matches(const char* name) const
+{
+    if (m_suffixes.isEmpty()) {
+        return true;
+    }
+    const char* dot = std::strrchr(name, '.');
+    if (!dot || dot == name) {
+        return false;
+    }
+    
+    // Extensions are short; lower-case them on the stack
+    char suffix[16];
+    const size_t length = std::strlen(dot + 1);
+    if (length == 0 || length >= sizeof(suffix)) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        suffix[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(dot[1 + i])));
+    }
+    return m_suffixes.contains(QByteArray::fromRawData(suffix, int(length)));
+}
+
+bool DirectoryWalker::isCancelled() const
+{
+    return m_cancelled && m_cancelled->load(std::memory_order_relaxed);
+}
@@ -0,0 +1,84 @@
+#ifndef DIRECTORYWALKER_H
+#define DIRECTORYWALKER_H
+
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <set>
+#include <utility>
+
+struct DirectoryEntry {
+    QString path;       // Absolute
+    qint64 size;
+    qint64 mtimeMs;     // ms since epoch
+    int depth;          // 0 for files directly in the root
+};
+
+struct DirectoryWalkStats {
+    int directories = 0;    // Directories read
+    int files = 0;          // Matching files visited
+    int skippedLoops = 0;   // Directories already reached through another path
+    int skippedDepth = 0;   // Directories below the depth limit
+    int skippedOutside = 0; // Links leading off the root's file system
+    int unreadable = 0;     // Directories that could not be opened
+};
+
+// Breadth-first walk over the regular files under a root directory.
+//
+// On Unix the directories are read with readdir() and the entry type it
+// returns, so only matching files and symlinks are stat'ed, relative to
+// the open directory; elsewhere QDirIterator stands in. Hidden entries are
+// skipped as QDir does by default. Symlinked directories are followed, but
+// each directory is read once, so links back to an ancestor cannot loop.
+// Nothing on another file system than the root is read (elsewhere: nothing
+// outside the root), so a device holding a link to / cannot pull the host's
+// files into the walk.
+class DirectoryWalker
+{
+public:
+    static const int UNLIMITED_DEPTH = -1;
+    
+    explicit DirectoryWalker(const QString& rootPath);
+    
+    // Deepest directory level read; 0 reads only the root
+    void setMaxDepth(int depth);
+    // Lower-case extensions without the dot; empty matches every file
+    void setSuffixes(const QStringList& suffixes);
+    // Checked between entries; a set flag ends the walk
+    void setCancelFlag(const std::atomic<bool>* cancelled);
+    // Called after each directory is read, matching files or not
+    void setDirectoryCallback(const std::function<void()>& directoryRead);
+    
+    // Calls visit for every matching file; false if cancelled
+    bool walk(const std::function<void(const DirectoryEntry&)>& visit);
+    DirectoryWalkStats stats() const;
+
+private:
+    struct PendingDirectory {
+        QString path;
+        int depth;
+    };
+    
+    bool readDirectory(const PendingDirectory& directory, const std::function<void(const DirectoryEntry&)>& visit);
+    void enqueue(const QString& path, int depth);
+    bool matches(const char* name) const;
+    bool isCancelled() const;
+    bool isInsideRoot(const QString& canonicalPath) const;
+    
+    QString m_rootPath;
+    int m_maxDepth;
+    QSet<QByteArray> m_suffixes;
+    const std::atomic<bool>* m_cancelled;
+    std::function<void()> m_directoryRead;
+    std::deque<PendingDirectory> m_pending;
+    std::set<std::pair<quint64, quint64>> m_visited;   // (device, inode)
+    QSet<QString> m_visitedPaths;                      // Canonical paths without readdir()
+    quint64 m_rootDevice;
+    QString m_rootCanonicalPath;                       // Without readdir()
+    DirectoryWalkStats m_stats;
+};
+
+#endif // DIRECTORYWALKER_H
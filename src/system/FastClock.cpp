@@ -0,0 +1,96 @@
+#include "FastClock.h"
+
+#include <QDateTime>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+namespace {
+
+struct ClockSync {
+    std::atomic<qint64> wallOffsetMs;   // wall ms = monotonic ms + offset
+    std::atomic<qint64> lastSyncNs;
+    
+    ClockSync()
+    {
+        qint64 monotonic = FastClock::monotonicNs();
+        wallOffsetMs.store(QDateTime::currentMSecsSinceEpoch() - monotonic / 1000000);
+        lastSyncNs.store(monotonic);
+    }
+};
+
+// Initialised on first use, so no caller ever sees an unsynchronised offset
+ClockSync& clockSync()
+{
+    static ClockSync sync;
+    return sync;
+}
+
+struct PrefixCache {
+    qint64 second = std::numeric_limits<qint64>::min();
+    QString prefix;     // "yyyy-MM-dd hh:mm:ss."
+};
+
+thread_local PrefixCache t_prefixCache;
+
+} // namespace
+
+FastClock::Now FastClock::now()
+{
+    Now result;
+    result.monotonicNs = monotonicNs();
+    
+    ClockSync& sync = clockSync();
+    qint64 lastSync = sync.lastSyncNs.load(std::memory_order_acquire);
+    if (result.monotonicNs - lastSync >= RESYNC_INTERVAL_NS
+        && sync.lastSyncNs.compare_exchange_strong(lastSync, result.monotonicNs)) {
+        // Only the winner re-reads the system clock
+        sync.wallOffsetMs.store(systemMs() - result.monotonicNs / 1000000, std::memory_order_release);
+    }
+    
+    result.wallMs = result.monotonicNs / 1000000 + sync.wallOffsetMs.load(std::memory_order_acquire);
+    return result;
+}
+
+qint64 FastClock::wallMs()
+{
+    return now().wallMs;
+}
+
+qint64 FastClock::monotonicNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QString FastClock::formatTimestamp(qint64 wallMs)
+{
+    const qint64 second = wallMs >= 0 ? wallMs / 1000 : (wallMs - 999) / 1000;
+    const int millisecond = static_cast<int>(wallMs - second * 1000);
+    
+    PrefixCache& cache = t_prefixCache;
+    if (cache.second != second) {
+        cache.second = second;
+        cache.prefix = QDateTime::fromMSecsSinceEpoch(second * 1000).toString("yyyy-MM-dd hh:mm:ss.");
+    }
+    
+    QString result(cache.prefix.size() + 3, Qt::Uninitialized);
+    QChar* out = result.data();
+    std::copy(cache.prefix.constData(), cache.prefix.constData() + cache.prefix.size(), out);
+    out += cache.prefix.size();
+    out[0] = QChar('0' + millisecond / 100);
+    out[1] = QChar('0' + millisecond / 10 % 10);
+    out[2] = QChar('0' + millisecond % 10);
+    return result;
+}
+
+QString FastClock::currentTimestamp()
+{
+    return formatTimestamp(wallMs());
+}
+
+qint64 FastClock::systemMs()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
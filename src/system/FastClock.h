@@ -0,0 +1,40 @@
+#ifndef FASTCLOCK_H
+#define FASTCLOCK_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Shared time source for Logger, MockI2C and anything else that stamps
+// records at high rates.
+//
+// now() reads the monotonic clock once and derives wall time from an offset
+// re-synchronised with the system clock every second, so a record gets a
+// matching wall/monotonic pair from a single clock read and wall time never
+// steps backwards between syncs.
+//
+// formatTimestamp() renders "yyyy-MM-dd hh:mm:ss.zzz" from a per-thread cache
+// of the local-time prefix for the current second; within that second only
+// the three millisecond digits are written. QDateTime is consulted once per
+// second per thread instead of once per call.
+class FastClock
+{
+public:
+    struct Now {
+        qint64 wallMs;        // ms since epoch
+        qint64 monotonicNs;   // steady clock
+    };
+    
+    static Now now();
+    static qint64 wallMs();
+    static qint64 monotonicNs();
+    
+    static QString formatTimestamp(qint64 wallMs);
+    static QString currentTimestamp();
+
+private:
+    static qint64 systemMs();
+    
+    static const qint64 RESYNC_INTERVAL_NS = 1000000000LL;
+};
+
+#endif // FASTCLOCK_H
@@ -0,0 +1,303 @@
+#include "I2CBus.h"
+#include <algorithm>
+#include <cstring>
+
+// Clock counts per transaction phase: 9 per byte (8 data bits + ACK), one
+// each for START, repeated START and STOP
+static const int CLOCKS_PER_BYTE = 9;
+static const int WRITE_OVERHEAD_CLOCKS = 1 + 2 * CLOCKS_PER_BYTE + 1;
+static const int READ_OVERHEAD_CLOCKS = 1 + 2 * CLOCKS_PER_BYTE + 1 + CLOCKS_PER_BYTE + 1;
+static const int ADDRESS_NACK_CLOCKS = 1 + CLOCKS_PER_BYTE + 1;
+static const int POINTER_NACK_CLOCKS = 1 + 2 * CLOCKS_PER_BYTE + 1;
+
+I2CDevice::I2CDevice(quint8 address, const QString& name, const QVector<I2CRegisterSpec>& registers)
+    : m_address(address)
+    , m_name(name)
+    , m_registers(registers)
+{
+    m_specIndex.fill(-1);
+    m_access.fill(0);
+    for (int i = 0; i < m_registers.size(); ++i) {
+        const I2CRegisterSpec& spec = m_registers[i];
+        quint8 access = 0;
+        if (spec.access != I2CAccess::WriteOnly) {
+            access |= READABLE;
+        }
+        if (spec.access != I2CAccess::ReadOnly) {
+            access |= WRITABLE;
+        }
+        for (int byte = 0; byte < spec.width && spec.address + byte <= 0xFF; ++byte) {
+            m_specIndex[spec.address + byte] = static_cast<qint16>(i);
+            m_access[spec.address + byte] = access;
+        }
+        m_byName.insert(QString::fromLatin1(spec.name), spec.address);
+    }
+    reset();
+}
+
+quint8 I2CDevice::address() const
+{
+    return m_address;
+}
+
+QString I2CDevice::name() const
+{
+    return m_name;
+}
+
+const QVector<I2CRegisterSpec>& I2CDevice::registers() const
+{
+    return m_registers;
+}
+
+bool I2CDevice::setValue(quint8 reg, quint32 value)
+{
+    const I2CRegisterSpec* registerSpec = spec(reg);
+    if (!registerSpec || registerSpec->address != reg) {
+        return false;
+    }
+    for (int byte = registerSpec->width - 1; byte >= 0; --byte) {
+        if (reg + byte <= 0xFF) {
+            m_bytes[reg + byte] = static_cast<quint8>(value & 0xFF);
+        }
+        value >>= 8;
+    }
+    return true;
+}
+
+bool I2CDevice::setValue(const QString& name, quint32 value)
+{
+    auto it = m_byName.constFind(name);
+    return it != m_byName.constEnd() && setValue(it.value(), value);
+}
+
+quint32 I2CDevice::value(quint8 reg) const
+{
+    const I2CRegisterSpec* registerSpec = spec(reg);
+    if (!registerSpec) {
+        return 0;
+    }
+    quint32 value = 0;
+    for (int byte = 0; byte < registerSpec->width && registerSpec->address + byte <= 0xFF; ++byte) {
+        value = (value << 8) | m_bytes[registerSpec->address + byte];
+    }
+    return value;
+}
+
+void I2CDevice::reset()
+{
+    m_bytes.fill(0xFF);
+    for (const I2CRegisterSpec& spec : m_registers) {
+        setValue(spec.address, spec.resetValue);
+    }
+}
+
+bool I2CDevice::read(quint8 reg, quint8* data, int length) const
+{
+    // A register pointer outside the map is NACKed; bytes past the end of a
+    // burst read whatever the chip drives, here 0xFF
+    if (m_specIndex[reg] < 0) {
+        return false;
+    }
+    for (int i = 0; i < length; ++i) {
+        const int address = reg + i;
+        data[i] = address <= 0xFF && (m_access[address] & READABLE) ? m_bytes[address] : 0xFF;
+    }
+    return true;
+}
+
+bool I2CDevice::write(quint8 reg, const quint8* data, int length)
+{
+    for (int i = 0; i < length; ++i) {
+        const int address = reg + i;
+        if (address > 0xFF || !(m_access[address] & WRITABLE)) {
+            return false;
+        }
+        m_bytes[address] = data[i];
+    }
+    return true;
+}
+
+const I2CRegisterSpec* I2CDevice::spec(quint8 reg) const
+{
+    const qint16 index = m_specIndex[reg];
+    return index < 0 ? nullptr : &m_registers[index];
+}
+
+I2CBus::I2CBus(I2CBusSpeed speed)
+    : m_speed(speed)
+    , m_timeNs(0)
+{
+}
+
+void I2CBus::setSpeed(I2CBusSpeed speed)
+{
+    m_speed = speed;
+}
+
+I2CBusSpeed I2CBus::speed() const
+{
+    return m_speed;
+}
+
+bool I2CBus::attach(std::unique_ptr<I2CDevice> device)
+{
+    if (!device || device->address() == 0 || device->address() > MAX_ADDRESS
+        || m_devices[device->address()]) {
+        return false;
+    }
+    m_devices[device->address()] = std::move(device);
+    return true;
+}
+
+void I2CBus::detach(quint8 address)
+{
+    if (address <= MAX_ADDRESS) {
+        m_devices[address].reset();
+    }
+}
+
+I2CDevice* I2CBus::device(quint8 address) const
+{
+    return address <= MAX_ADDRESS ? m_devices[address].get() : nullptr;
+}
+
+QVector<quint8> I2CBus::scan() const
+{
+    QVector<quint8> addresses;
+    for (int address = 1; address <= MAX_ADDRESS; ++address) {
+        if (m_devices[address]) {
+            addresses.append(static_cast<quint8>(address));
+        }
+    }
+    return addresses;
+}
+
+I2CStatus I2CBus::read(quint8 address, quint8 reg, quint8* data, int length)
+{
+    I2CDevice* target = device(address);
+    if (!target) {
+        account(clocksToNs(ADDRESS_NACK_CLOCKS), 0, I2CStatus::AddressNack);
+        return I2CStatus::AddressNack;
+    }
+    if (!target->read(reg, data, length)) {
+        account(clocksToNs(POINTER_NACK_CLOCKS), 0, I2CStatus::DataNack);
+        return I2CStatus::DataNack;
+    }
+    account(readDurationNs(length), length, I2CStatus::Ok);
+    return I2CStatus::Ok;
+}
+
+I2CStatus I2CBus::write(quint8 address, quint8 reg, const quint8* data, int length)
+{
+    I2CDevice* target = device(address);
+    if (!target) {
+        account(clocksToNs(ADDRESS_NACK_CLOCKS), 0, I2CStatus::AddressNack);
+        return I2CStatus::AddressNack;
+    }
+    const I2CStatus status = target->write(reg, data, length) ? I2CStatus::Ok : I2CStatus::DataNack;
+    account(writeDurationNs(length), length, status);
+    return status;
+}
+
+qint64 I2CBus::readDurationNs(int length) const
+{
+    return clocksToNs(READ_OVERHEAD_CLOCKS + qint64(CLOCKS_PER_BYTE) * length);
+}
+
+qint64 I2CBus::writeDurationNs(int length) const
+{
+    return clocksToNs(WRITE_OVERHEAD_CLOCKS + qint64(CLOCKS_PER_BYTE) * length);
+}
+
+qint64 I2CBus::busTimeNs() const
+{
+    return m_timeNs;
+}
+
+I2CBusStats I2CBus::stats() const
+{
+    return m_stats;
+}
+
+void I2CBus::resetStats()
+{
+    m_stats = I2CBusStats();
+}
+
+I2CScheduleReport I2CBus::simulateSchedule(const QVector<I2CPoll>& polls, qint64 durationNs)
+{
+    I2CScheduleReport report;
+    report.polls.resize(polls.size());
+    if (polls.isEmpty() || durationNs <= 0) {
+        return report;
+    }
+    
+    QVector<qint64> nextDue(polls.size(), 0);
+    QVector<double> latencySum(polls.size(), 0.0);
+    QVector<quint8> buffer;
+    const qint64 startTimeNs = m_timeNs;
+    const qint64 startBusyNs = m_stats.busyNs;
+    qint64 now = 0;
+    
+    for (;;) {
+        // Earliest due poll first; ties go to the poll listed first
+        int next = 0;
+        for (int i = 1; i < polls.size(); ++i) {
+            if (nextDue[i] < nextDue[next]) {
+                next = i;
+            }
+        }
+        
+        const I2CPoll& poll = polls[next];
+        const qint64 due = nextDue[next];
+        const qint64 start = qMax(now, due);
+        if (start >= durationNs) {
+            break;
+        }
+        
+        // The bus clock is idle until the transaction starts
+        m_timeNs = startTimeNs + start;
+        buffer.resize(qMax(poll.length, 1));
+        read(poll.address, poll.reg, buffer.data(), poll.length);
+        now = m_timeNs - startTimeNs;
+        
+        I2CPollResult& result = report.polls[next];
+        const qint64 latency = now - due;
+        ++result.completed;
+        latencySum[next] += latency;
+        result.maxLatencyNs = qMax(result.maxLatencyNs, latency);
+        if (latency > poll.periodNs) {
+            ++result.missed;
+            report.fits = false;
+        }
+        nextDue[next] = due + qMax<qint64>(poll.periodNs, 1);
+    }
+    
+    for (int i = 0; i < polls.size(); ++i) {
+        I2CPollResult& result = report.polls[i];
+        if (result.completed > 0) {
+            result.meanLatencyNs = latencySum[i] / result.completed;
+        }
+    }
+    report.utilization = double(m_stats.busyNs - startBusyNs) / durationNs;
+    m_timeNs = startTimeNs + qMax(now, durationNs);
+    return report;
+}
+
+qint64 I2CBus::clocksToNs(qint64 clocks) const
+{
+    return clocks * 1000000000LL / static_cast<qint64>(m_speed);
+}
+
+void I2CBus::account(qint64 durationNs, int length, I2CStatus status)
+{
+    m_timeNs += durationNs;
+    m_stats.busyNs += durationNs;
+    ++m_stats.transactions;
+    if (status == I2CStatus::Ok) {
+        m_stats.bytes += static_cast<quint64>(length);
+    } else {
+        ++m_stats.nacks;
+    }
+}
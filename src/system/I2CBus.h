@@ -0,0 +1,153 @@
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <array>
+#include <memory>
+
+enum class I2CAccess {
+    ReadOnly,
+    WriteOnly,
+    ReadWrite
+};
+
+// One entry of a device's register map. Registers wider than a byte occupy
+// consecutive addresses and are big-endian, as on most sensor chips.
+struct I2CRegisterSpec {
+    quint8 address;
+    const char* name;
+    int width;
+    I2CAccess access;
+    quint32 resetValue;
+};
+
+enum class I2CBusSpeed {
+    Standard = 100000,   // Hz
+    Fast = 400000,
+    FastPlus = 1000000
+};
+
+enum class I2CStatus {
+    Ok,
+    AddressNack,    // No device at the address
+    DataNack        // The device rejected a register (unmapped or wrong access)
+};
+
+// A simulated I2C slave: a 256-byte register file described by a
+// declarative register map, with an auto-incrementing register pointer for
+// burst transfers. Unmapped bytes read as 0xFF.
+class I2CDevice
+{
+public:
+    I2CDevice(quint8 address, const QString& name, const QVector<I2CRegisterSpec>& registers);
+    
+    quint8 address() const;
+    QString name() const;
+    const QVector<I2CRegisterSpec>& registers() const;
+    
+    // Device side: the simulated chip updating its own registers
+    bool setValue(quint8 reg, quint32 value);
+    bool setValue(const QString& name, quint32 value);
+    quint32 value(quint8 reg) const;
+    void reset();
+    
+    // Bus side; false when the device NACKs: a register pointer outside the
+    // map, or a write reaching a byte that is not writable
+    bool read(quint8 reg, quint8* data, int length) const;
+    bool write(quint8 reg, const quint8* data, int length);
+
+private:
+    static const quint8 READABLE = 0x01;
+    static const quint8 WRITABLE = 0x02;
+    
+    const I2CRegisterSpec* spec(quint8 reg) const;
+    
+    quint8 m_address;
+    QString m_name;
+    QVector<I2CRegisterSpec> m_registers;
+    QHash<QString, quint8> m_byName;
+    std::array<qint16, 256> m_specIndex;  // Register address -> m_registers index, -1 if unmapped
+    std::array<quint8, 256> m_access;
+    std::array<quint8, 256> m_bytes;
+};
+
+struct I2CBusStats {
+    quint64 transactions = 0;
+    quint64 bytes = 0;        // Payload bytes, excluding address and register bytes
+    quint64 nacks = 0;
+    qint64 busyNs = 0;        // Modelled time the bus was driven
+};
+
+// A periodic register read in a polling plan
+struct I2CPoll {
+    quint8 address;
+    quint8 reg;
+    int length;
+    qint64 periodNs;
+};
+
+struct I2CPollResult {
+    quint64 completed = 0;
+    quint64 missed = 0;         // Finished after the next poll was already due
+    qint64 maxLatencyNs = 0;    // Due time to completion
+    double meanLatencyNs = 0.0;
+};
+
+struct I2CScheduleReport {
+    double utilization = 0.0;   // Busy time / simulated time
+    bool fits = true;           // No poll missed a deadline
+    QVector<I2CPollResult> polls;
+};
+
+// Simulated I2C bus hosting up to 127 devices.
+//
+// Transactions run synchronously against the devices and advance a modelled
+// bus clock by their wire time: 9 clocks per byte (8 bits + ACK) plus
+// START/STOP, with a repeated START and second address byte for reads. So
+// timing depends only on the bus speed and transfer sizes, never on the host.
+// simulateSchedule() replays a polling plan against that model to check it
+// fits the bus bandwidth. Not thread-safe.
+class I2CBus
+{
+public:
+    explicit I2CBus(I2CBusSpeed speed = I2CBusSpeed::Fast);
+    
+    void setSpeed(I2CBusSpeed speed);
+    I2CBusSpeed speed() const;
+    
+    // Takes ownership; false if the address is invalid or taken
+    bool attach(std::unique_ptr<I2CDevice> device);
+    void detach(quint8 address);
+    I2CDevice* device(quint8 address) const;
+    QVector<quint8> scan() const;
+    
+    // Register-pointer write followed by a repeated-START burst read
+    I2CStatus read(quint8 address, quint8 reg, quint8* data, int length);
+    I2CStatus write(quint8 address, quint8 reg, const quint8* data, int length);
+    
+    // Modelled wire time in ns at the current speed
+    qint64 readDurationNs(int length) const;
+    qint64 writeDurationNs(int length) const;
+    
+    qint64 busTimeNs() const;
+    I2CBusStats stats() const;
+    void resetStats();
+    
+    // Earliest-due-first replay of the plan for durationNs of bus time
+    I2CScheduleReport simulateSchedule(const QVector<I2CPoll>& polls, qint64 durationNs);
+
+private:
+    static const int MAX_ADDRESS = 0x7F;
+    
+    qint64 clocksToNs(qint64 clocks) const;
+    void account(qint64 durationNs, int length, I2CStatus status);
+    
+    I2CBusSpeed m_speed;
+    std::array<std::unique_ptr<I2CDevice>, MAX_ADDRESS + 1> m_devices;
+    qint64 m_timeNs;
+    I2CBusStats m_stats;
+};
+
+#endif // I2CBUS_H
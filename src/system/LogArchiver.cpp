@@ -0,0 +1,260 @@
+#include "LogArchiver.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QDebug>
+
+#ifdef AUTODASH_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+const char* const COMPRESSED_SUFFIX = ".gz";
+const char* const PARTIAL_SUFFIX = ".tmp";
+const qint64 COMPRESS_CHUNK_SIZE = 64 * 1024;
+
+} // namespace
+
+LogArchiver::LogArchiver()
+    : m_busy(false)
+    , m_stopping(false)
+{
+}
+
+LogArchiver::~LogArchiver()
+{
+    if (!m_worker) {
+        return;
+    }
+    
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+    }
+    m_wakeup.wakeAll();
+    m_worker->wait();
+}
+
+void LogArchiver::schedule(const QString& activePath, int keepCount, bool compress)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending.insert(activePath, Job{keepCount, compress});
+    startWorker();
+    m_wakeup.wakeOne();
+}
+
+void LogArchiver::run(const std::function<void()>& task)
+{
+    QMutexLocker locker(&m_mutex);
+    m_tasks.append(task);
+    startWorker();
+    m_wakeup.wakeOne();
+}
+
+void LogArchiver::startWorker()
+{
+    if (!m_worker) {
+        m_worker.reset(QThread::create([this]() { workerLoop(); }));
+        m_worker->setObjectName("LogArchiver");
+        m_worker->start(QThread::LowestPriority);
+    }
+}
+
+void LogArchiver::waitForIdle()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_busy || !m_pending.isEmpty() || !m_tasks.isEmpty()) {
+        m_idle.wait(&m_mutex);
+    }
+}
+
+QString LogArchiver::segmentPath(const QString& activePath, qint64 timestamp)
+{
+    // Bump the timestamp on collision so names stay unique and ordered
+    for (;;) {
+        QString candidate = QString("%1.%2").arg(activePath,
+            QDateTime::fromMSecsSinceEpoch(timestamp).toString("yyyyMMdd-hhmmsszzz"));
+        if (!QFile::exists(candidate) && !QFile::exists(candidate + COMPRESSED_SUFFIX)) {
+            return candidate;
+        }
+        ++timestamp;
+    }
+}
+
+QStringList LogArchiver::rotatedSegments(const QString& activePath)
+{
+    QFileInfo active(activePath);
+    QDir dir = active.absoluteDir();
+    QStringList segments;
+    
+    static const QRegularExpression segmentSuffix("^\\.\\d{8}-\\d{9}(\\.gz)?$");
+    const QStringList names = dir.entryList(QStringList() << active.fileName() + ".*",
+                                            QDir::Files, QDir::Name);
+    for (const QString& name : names) {
+        if (segmentSuffix.match(name.mid(active.fileName().size())).hasMatch()) {
+            segments.append(dir.filePath(name));
+        }
+    }
+    return segments;
+}
+
+bool LogArchiver::compressionAvailable()
+{
+#ifdef AUTODASH_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool LogArchiver::compressFile(const QString& sourcePath, const QString& destinationPath)
+{
+#ifdef AUTODASH_HAVE_ZLIB
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    // Written under a temporary name so a crash never leaves a truncated .gz
+    const QString partialPath = destinationPath + PARTIAL_SUFFIX;
+    gzFile destination = gzopen(QFile::encodeName(partialPath).constData(), "wb6");
+    if (!destination) {
+        return false;
+    }
+    
+    bool ok = true;
+    while (ok && !source.atEnd()) {
+        QByteArray chunk = source.read(COMPRESS_CHUNK_SIZE);
+        if (chunk.isEmpty()) {
+            ok = false;
+        } else {
+            ok = gzwrite(destination, chunk.constData(), static_cast<unsigned>(chunk.size())) == static_cast<int>(chunk.size());
+        }
+    }
+    ok = (gzclose(destination) == Z_OK) && ok;
+    
+    if (!ok || !QFile::rename(partialPath, destinationPath)) {
+        QFile::remove(partialPath);
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(sourcePath);
+    Q_UNUSED(destinationPath);
+    return false;
+#endif
+}
+
+bool LogArchiver::readSegment(const QString& path, QByteArray& contents)
+{
+    contents.clear();
+    if (!path.endsWith(COMPRESSED_SUFFIX)) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        contents = file.readAll();
+        return true;
+    }
+
+#ifdef AUTODASH_HAVE_ZLIB
+    gzFile source = gzopen(QFile::encodeName(path).constData(), "rb");
+    if (!source) {
+        return false;
+    }
+    
+    QByteArray chunk(COMPRESS_CHUNK_SIZE, Qt::Uninitialized);
+    int read = 0;
+    while ((read = gzread(source, chunk.data(), static_cast<unsigned>(chunk.size()))) > 0) {
+        contents.append(chunk.constData(), read);
+    }
+    gzclose(source);
+    return read == 0;
+#else
+    return false;
+#endif
+}
+
+qint64 LogArchiver::segmentTimestamp(const QString& segmentPath)
+{
+    static const QRegularExpression stamp("\\.(\\d{8}-\\d{9})(\\.gz)?$");
+    QRegularExpressionMatch match = stamp.match(segmentPath);
+    if (!match.hasMatch()) {
+        return -1;
+    }
+    QDateTime rotated = QDateTime::fromString(match.captured(1), "yyyyMMdd-hhmmsszzz");
+    return rotated.isValid() ? rotated.toMSecsSinceEpoch() : -1;
+}
+
+void LogArchiver::workerLoop()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        while (m_pending.isEmpty() && m_tasks.isEmpty() && !m_stopping) {
+            m_wakeup.wait(&m_mutex);
+        }
+        if (m_pending.isEmpty() && m_tasks.isEmpty()) {
+            return; // Stopping with nothing left to do
+        }
+        
+        QVector<std::function<void()>> tasks;
+        tasks.swap(m_tasks);
+        m_busy = true;
+        locker.unlock();
+        
+        // Tasks may schedule housekeeping, so they run first
+        for (const auto& task : tasks) {
+            task();
+        }
+        
+        locker.relock();
+        QHash<QString, Job> jobs;
+        jobs.swap(m_pending);
+        locker.unlock();
+        
+        for (auto it = jobs.constBegin(); it != jobs.constEnd(); ++it) {
+            runJob(it.key(), it.value());
+        }
+        
+        locker.relock();
+        m_busy = false;
+        if (m_pending.isEmpty() && m_tasks.isEmpty()) {
+            m_idle.wakeAll();
+        }
+    }
+}
+
+void LogArchiver::runJob(const QString& activePath, const Job& job)
+{
+    // Leftovers from an interrupted compression
+    QFileInfo active(activePath);
+    const QStringList partials = active.absoluteDir().entryList(
+        QStringList() << active.fileName() + ".*" + PARTIAL_SUFFIX, QDir::Files);
+    for (const QString& name : partials) {
+        active.absoluteDir().remove(name);
+    }
+    
+    if (job.compress && compressionAvailable()) {
+        for (const QString& segment : rotatedSegments(activePath)) {
+            if (segment.endsWith(COMPRESSED_SUFFIX)) {
+                continue;
+            }
+            if (compressFile(segment, segment + COMPRESSED_SUFFIX)) {
+                QFile::remove(segment);
+            } else {
+                qWarning() << "Failed to compress log segment:" << segment;
+            }
+        }
+    }
+    
+    if (job.keepCount > 0) {
+        QStringList segments = rotatedSegments(activePath);
+        for (int i = 0; i < segments.size() - job.keepCount; ++i) {
+            QFile::remove(segments[i]);
+        }
+    }
+}
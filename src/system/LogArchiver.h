@@ -0,0 +1,77 @@
+#ifndef LOGARCHIVER_H
+#define LOGARCHIVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <functional>
+#include <memory>
+
+struct LogRotationPolicy {
+    qint64 maxBytes = 0;        // Rotate once the active file reaches this size; 0 disables
+    qint64 intervalMs = 0;      // Rotate this long after the file was opened; 0 disables
+    int keepCount = 5;          // Rotated segments to keep; 0 keeps all
+    bool compress = true;       // gzip rotated segments (needs zlib at build time)
+};
+
+// Background housekeeping for rotated log segments. The Logger hands the
+// rotation itself to run() and calls schedule(); renaming, compression and
+// retention run on a worker thread so the log path never waits on them.
+//
+// Each pass compresses every uncompressed segment of the log (which also
+// picks up segments left behind by an earlier crash), then deletes the
+// oldest segments beyond keepCount. Segment names embed a fixed-width
+// timestamp, so name order is age order.
+class LogArchiver
+{
+public:
+    LogArchiver();
+    ~LogArchiver();
+    
+    LogArchiver(const LogArchiver&) = delete;
+    LogArchiver& operator=(const LogArchiver&) = delete;
+    
+    void schedule(const QString& activePath, int keepCount, bool compress);
+    // Runs task on the worker thread, ahead of any scheduled housekeeping
+    void run(const std::function<void()>& task);
+    // Waits for tasks as well as housekeeping
+    void waitForIdle();
+    
+    // Unused "<activePath>.<yyyyMMdd-hhmmsszzz>" name for a new segment
+    static QString segmentPath(const QString& activePath, qint64 timestamp);
+    // Rotated segments of activePath, oldest first
+    static QStringList rotatedSegments(const QString& activePath);
+    static bool compressionAvailable();
+    static bool compressFile(const QString& sourcePath, const QString& destinationPath);
+    // Reads a segment, decompressing .gz files when zlib is available
+    static bool readSegment(const QString& path, QByteArray& contents);
+    // Rotation time encoded in a segment name, or -1
+    static qint64 segmentTimestamp(const QString& segmentPath);
+
+private:
+    struct Job {
+        int keepCount;
+        bool compress;
+    };
+    
+    void workerLoop();
+    void runJob(const QString& activePath, const Job& job);
+    
+    void startWorker();
+    
+    QHash<QString, Job> m_pending;   // Keyed by active log path; repeated requests coalesce
+    QVector<std::function<void()>> m_tasks;
+    std::unique_ptr<QThread> m_worker;
+    QMutex m_mutex;
+    QWaitCondition m_wakeup;
+    QWaitCondition m_idle;
+    bool m_busy;
+    bool m_stopping;
+};
+
+#endif // LOGARCHIVER_H
@@ -0,0 +1,204 @@
+#include "LogRateLimiter.h"
+
+#include <cstring>
+
+LogRateLimiter::LogRateLimiter()
+    : m_ruleCount(0)
+    , m_totalSuppressed(0)
+{
+}
+
+bool LogRateLimiter::allow(LogLevel level, const char* module, qint64 nowNs)
+{
+    if (m_ruleCount.load(std::memory_order_relaxed) == 0) {
+        return true;
+    }
+    Slot* slot = lookup(module, static_cast<int>(std::strlen(module)), static_cast<int>(level));
+    return !slot || admit(*slot, nowNs);
+}
+
+bool LogRateLimiter::allow(LogLevel level, const QString& module, qint64 nowNs)
+{
+    if (m_ruleCount.load(std::memory_order_relaxed) == 0) {
+        return true;
+    }
+    Slot* slot = lookup(reinterpret_cast<const char16_t*>(module.utf16()), module.size(), static_cast<int>(level));
+    return !slot || admit(*slot, nowNs);
+}
+
+bool LogRateLimiter::setRateLimit(const QString& module, LogLevel level, double perSecond, int burst)
+{
+    QMutexLocker locker(&m_writeMutex);
+    Slot* slot = findOrInsert(module, static_cast<int>(level));
+    if (!slot) {
+        return false;
+    }
+    
+    qint64 interval = perSecond > 0 ? static_cast<qint64>(1e9 / perSecond) : 0;
+    slot->intervalNs.store(qMax<qint64>(interval, perSecond > 0 ? 1 : 0), std::memory_order_relaxed);
+    slot->toleranceNs.store(interval * qMax(0, burst - 1), std::memory_order_relaxed);
+    slot->arrivalNs.store(0, std::memory_order_relaxed);
+    updateRuleCount();
+    return true;
+}
+
+bool LogRateLimiter::setSampling(const QString& module, LogLevel level, int everyN)
+{
+    QMutexLocker locker(&m_writeMutex);
+    Slot* slot = findOrInsert(module, static_cast<int>(level));
+    if (!slot) {
+        return false;
+    }
+    slot->sampleEvery.store(everyN, std::memory_order_relaxed);
+    slot->seen.store(0, std::memory_order_relaxed);
+    updateRuleCount();
+    return true;
+}
+
+void LogRateLimiter::clearRules()
+{
+    QMutexLocker locker(&m_writeMutex);
+    for (Slot& slot : m_slots) {
+        slot.intervalNs.store(0, std::memory_order_relaxed);
+        slot.sampleEvery.store(0, std::memory_order_relaxed);
+    }
+    updateRuleCount();
+}
+
+void LogRateLimiter::updateRuleCount()
+{
+    // Slots stay allocated once used; only those still limiting count, so
+    // clearing every rule brings back the fast path
+    int active = 0;
+    for (const Slot& slot : m_slots) {
+        if (slot.hash.load(std::memory_order_relaxed) != 0
+            && (slot.intervalNs.load(std::memory_order_relaxed) > 0
+                || slot.sampleEvery.load(std::memory_order_relaxed) > 1)) {
+            ++active;
+        }
+    }
+    m_ruleCount.store(active, std::memory_order_release);
+}
+
+QVector<QPair<QString, quint64>> LogRateLimiter::takeSuppressed()
+{
+    // Not gated on hasRules(): counts from rules cleared since the last
+    // call are still reported
+    QVector<QPair<QString, quint64>> result;
+    for (Slot& slot : m_slots) {
+        if (slot.hash.load(std::memory_order_acquire) == 0) {
+            continue;
+        }
+        quint64 count = slot.suppressed.exchange(0, std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        
+        // Levels of the same module are reported together
+        bool merged = false;
+        for (auto& entry : result) {
+            if (entry.first == slot.module) {
+                entry.second += count;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            result.append(qMakePair(slot.module, count));
+        }
+    }
+    return result;
+}
+
+quint64 LogRateLimiter::totalSuppressed() const
+{
+    return m_totalSuppressed.load(std::memory_order_relaxed);
+}
+
+template <typename Char>
+quint32 LogRateLimiter::hashName(const Char* name, int length, int level)
+{
+    // FNV-1a over code units, so ASCII hashes the same as char or char16_t
+    quint32 hash = 2166136261u ^ static_cast<quint32>(level);
+    for (int i = 0; i < length; ++i) {
+        hash ^= static_cast<quint32>(name[i]);
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+template <typename Char>
+LogRateLimiter::Slot* LogRateLimiter::lookup(const Char* name, int length, int level)
+{
+    const quint32 hash = hashName(name, length, level);
+    for (int probe = 0; probe < MAX_RULES; ++probe) {
+        Slot& slot = m_slots[(hash + probe) % MAX_RULES];
+        quint32 slotHash = slot.hash.load(std::memory_order_acquire);
+        if (slotHash == 0) {
+            return nullptr;
+        }
+        if (slotHash != hash || slot.level != level || slot.module.size() != length) {
+            continue;
+        }
+        
+        const QChar* stored = slot.module.constData();
+        bool equal = true;
+        for (int i = 0; i < length && equal; ++i) {
+            equal = stored[i].unicode() == static_cast<char16_t>(name[i]);
+        }
+        if (equal) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+LogRateLimiter::Slot* LogRateLimiter::findOrInsert(const QString& module, int level)
+{
+    const quint32 hash = hashName(reinterpret_cast<const char16_t*>(module.utf16()), module.size(), level);
+    for (int probe = 0; probe < MAX_RULES; ++probe) {
+        Slot& slot = m_slots[(hash + probe) % MAX_RULES];
+        quint32 slotHash = slot.hash.load(std::memory_order_relaxed);
+        if (slotHash == 0) {
+            slot.module = module;
+            slot.level = level;
+            slot.hash.store(hash, std::memory_order_release);
+            return &slot;
+        }
+        if (slotHash == hash && slot.level == level && slot.module == module) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+bool LogRateLimiter::admit(Slot& slot, qint64 nowNs)
+{
+    const int sampleEvery = slot.sampleEvery.load(std::memory_order_relaxed);
+    if (sampleEvery > 1 && slot.seen.fetch_add(1, std::memory_order_relaxed) % sampleEvery != 0) {
+        slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+        m_totalSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    const qint64 interval = slot.intervalNs.load(std::memory_order_relaxed);
+    if (interval <= 0) {
+        return true;
+    }
+    
+    // GCRA: admit if the theoretical arrival time is within the burst
+    // tolerance of now, then push it one interval further
+    const qint64 tolerance = slot.toleranceNs.load(std::memory_order_relaxed);
+    qint64 arrival = slot.arrivalNs.load(std::memory_order_relaxed);
+    for (;;) {
+        if (arrival - tolerance > nowNs) {
+            slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+            m_totalSuppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        qint64 next = qMax(arrival, nowNs) + interval;
+        if (slot.arrivalNs.compare_exchange_weak(arrival, next, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
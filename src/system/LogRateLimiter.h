@@ -0,0 +1,72 @@
+#ifndef LOGRATELIMITER_H
+#define LOGRATELIMITER_H
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QPair>
+#include <atomic>
+
+#include "LogRecord.h"
+
+// Per-module, per-level admission control: a token bucket and/or 1-in-N
+// sampling for each (module, level) rule. Rejected messages are counted so
+// the Logger can report them as summary lines.
+//
+// Same table layout as ModuleLogLevels: fixed open addressing, names written
+// before the slot hash is published, slots never freed. The bucket is kept
+// as a single "theoretical arrival time" (GCRA), so admission is one CAS
+// and the whole check is lock-free. Module names are expected to be ASCII,
+// which lets const char* and QString callers hash identically.
+class LogRateLimiter
+{
+public:
+    LogRateLimiter();
+    
+    bool hasRules() const { return m_ruleCount.load(std::memory_order_relaxed) > 0; }
+    
+    // Fast exit when no rules exist
+    bool allow(LogLevel level, const char* module, qint64 nowNs);
+    bool allow(LogLevel level, const QString& module, qint64 nowNs);
+    
+    // perSecond <= 0 removes the bucket; burst is the number of messages
+    // admitted back to back. Returns false when the table is full.
+    bool setRateLimit(const QString& module, LogLevel level, double perSecond, int burst);
+    // everyN <= 1 disables sampling
+    bool setSampling(const QString& module, LogLevel level, int everyN);
+    void clearRules();
+    
+    // Suppressed counts per module since the last call, reset on read
+    QVector<QPair<QString, quint64>> takeSuppressed();
+    quint64 totalSuppressed() const;
+    
+    static const int MAX_RULES = 128;
+
+private:
+    struct Slot {
+        std::atomic<quint32> hash{0};           // 0 marks an empty slot
+        QString module;                         // Immutable once hash is published
+        int level = 0;
+        std::atomic<qint64> intervalNs{0};      // 0 = no bucket
+        std::atomic<qint64> toleranceNs{0};
+        std::atomic<qint64> arrivalNs{0};       // GCRA theoretical arrival time
+        std::atomic<int> sampleEvery{0};        // <= 1 = no sampling
+        std::atomic<quint64> seen{0};
+        std::atomic<quint64> suppressed{0};
+    };
+    
+    template <typename Char>
+    static quint32 hashName(const Char* name, int length, int level);
+    template <typename Char>
+    Slot* lookup(const Char* name, int length, int level);
+    Slot* findOrInsert(const QString& module, int level);
+    void updateRuleCount();
+    bool admit(Slot& slot, qint64 nowNs);
+    
+    Slot m_slots[MAX_RULES];
+    std::atomic<int> m_ruleCount;          // Slots with a bucket or sampling set
+    std::atomic<quint64> m_totalSuppressed;
+    QMutex m_writeMutex;
+};
+
+#endif // LOGRATELIMITER_H
@@ -0,0 +1,66 @@
+#include "LogRecord.h"
+
+namespace {
+
+QString renderArgument(const QVariant& argument)
+{
+    switch (argument.typeId()) {
+        case QMetaType::Double:
+        case QMetaType::Float:
+            return QString::number(argument.toDouble(), 'g', 8);
+        case QMetaType::Int:
+        case QMetaType::LongLong:
+            return QString::number(argument.toLongLong());
+        case QMetaType::UInt:
+        case QMetaType::ULongLong:
+            return QString::number(argument.toULongLong());
+        default:
+            return argument.toString();
+    }
+}
+
+} // namespace
+
+QString LogRecord::renderMessage() const
+{
+    if (!format) {
+        return message;
+    }
+    return formatLogMessage(QString::fromUtf8(format), arguments);
+}
+
+QString formatLogMessage(const QString& format, const LogArguments& arguments)
+{
+    // One pass over the format: repeated QString::arg() calls would also
+    // substitute placeholders that an earlier string argument brought in
+    QString result;
+    result.reserve(format.size() + 16 * arguments.size());
+    const int length = format.size();
+    int i = 0;
+    while (i < length) {
+        const QChar c = format.at(i);
+        if (c != QLatin1Char('%') || i + 1 >= length || !format.at(i + 1).isDigit()) {
+            result += c;
+            ++i;
+            continue;
+        }
+        
+        // %1..%99; a second digit only counts when that argument exists
+        int index = format.at(i + 1).digitValue();
+        int end = i + 2;
+        if (end < length && format.at(end).isDigit()) {
+            const int twoDigits = index * 10 + format.at(end).digitValue();
+            if (twoDigits <= arguments.size()) {
+                index = twoDigits;
+                ++end;
+            }
+        }
+        if (index >= 1 && index <= arguments.size()) {
+            result += renderArgument(arguments[index - 1]);
+        } else {
+            result += format.mid(i, end - i);
+        }
+        i = end;
+    }
+    return result;
+}
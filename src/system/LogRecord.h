@@ -0,0 +1,47 @@
+#ifndef LOGRECORD_H
+#define LOGRECORD_H
+
+#include <QString>
+#include <QVarLengthArray>
+#include <QVariant>
+#include <QVector>
+#include <QMetaType>
+#include <QtGlobal>
+
+enum class LogLevel {
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR,
+    CRITICAL
+};
+
+// Arguments of a deferred-format record. Up to four are stored inline, so
+// the _FMT macros do not allocate for the usual handful of numbers.
+typedef QVarLengthArray<QVariant, 4> LogArguments;
+
+// Compact log entry as captured on the caller's thread. Formatting into the
+// "[timestamp] [LEVEL] [module] message" text form is deferred to the sinks.
+//
+// A record carries either a ready-made message or a static format string
+// ("%1".."%n" placeholders) plus arguments; the latter lets the binary sink
+// store a format id and raw values instead of rendered text.
+struct LogRecord {
+    qint64 timestamp = 0;          // ms since epoch
+    qint64 monotonicNs = 0;        // steady clock, for ordering and binary logs
+    LogLevel level = LogLevel::INFO;
+    QString module;
+    QString message;
+    const char* format = nullptr;  // Must point to a string literal
+    LogArguments arguments;
+    
+    QString renderMessage() const;
+};
+
+Q_DECLARE_METATYPE(LogRecord)
+
+// Substitutes %N in format with argument N in a single pass, so text inside
+// an argument is never substituted again
+QString formatLogMessage(const QString& format, const LogArguments& arguments);
+
+#endif // LOGRECORD_H
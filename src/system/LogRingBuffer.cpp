@@ -0,0 +1,96 @@
+#include "LogRingBuffer.h"
+
+LogRingBuffer::LogRingBuffer(int maxEntries, qint64 maxBytes)
+    : m_slots(qMax(1, maxEntries))
+    , m_head(0)
+    , m_count(0)
+    , m_bytes(0)
+    , m_maxBytes(maxBytes)
+{
+}
+
+void LogRingBuffer::append(const QString& entry)
+{
+    const qint64 bytes = entryBytes(entry);
+    
+    // A single entry larger than the byte budget is still kept on its own
+    while (m_count > 0 && (m_count == m_slots.size() || m_bytes + bytes > m_maxBytes)) {
+        evictOldest();
+    }
+    
+    int tail = (m_head + m_count) % m_slots.size();
+    m_slots[tail] = entry;
+    m_bytes += bytes;
+    ++m_count;
+}
+
+void LogRingBuffer::clear()
+{
+    for (int i = 0; i < m_count; ++i) {
+        m_slots[(m_head + i) % m_slots.size()].clear();
+    }
+    m_head = 0;
+    m_count = 0;
+    m_bytes = 0;
+}
+
+int LogRingBuffer::size() const
+{
+    return m_count;
+}
+
+qint64 LogRingBuffer::byteSize() const
+{
+    return m_bytes;
+}
+
+int LogRingBuffer::maxEntries() const
+{
+    return m_slots.size();
+}
+
+qint64 LogRingBuffer::maxBytes() const
+{
+    return m_maxBytes;
+}
+
+QStringList LogRingBuffer::snapshot(int maxEntries) const
+{
+    int count = (maxEntries < 0) ? m_count : qMin(maxEntries, m_count);
+    int first = m_count - count;
+    
+    QStringList entries;
+    entries.reserve(count);
+    for (int i = first; i < m_count; ++i) {
+        entries.append(m_slots[(m_head + i) % m_slots.size()]);
+    }
+    return entries;
+}
+
+QString LogRingBuffer::joined() const
+{
+    qint64 length = 0;
+    forEach([&length](const QString& entry) { length += entry.size() + 1; });
+    
+    QString result;
+    result.reserve(length);
+    forEach([&result](const QString& entry) {
+        result += entry;
+        result += QChar('\n');
+    });
+    return result;
+}
+
+void LogRingBuffer::evictOldest()
+{
+    QString& oldest = m_slots[m_head];
+    m_bytes -= entryBytes(oldest);
+    oldest.clear();
+    m_head = (m_head + 1) % m_slots.size();
+    --m_count;
+}
+
+qint64 LogRingBuffer::entryBytes(const QString& entry)
+{
+    return entry.size() * static_cast<qint64>(sizeof(QChar));
+}
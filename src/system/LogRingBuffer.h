@@ -0,0 +1,50 @@
+#ifndef LOGRINGBUFFER_H
+#define LOGRINGBUFFER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Fixed-capacity ring of formatted log lines, bounded by both entry count and
+// total payload bytes. Slots are allocated once; append() evicts from the
+// oldest end in O(1) per evicted entry. Not thread-safe: the Logger guards it
+// with its own mutex.
+class LogRingBuffer
+{
+public:
+    LogRingBuffer(int maxEntries, qint64 maxBytes);
+    
+    void append(const QString& entry);
+    void clear();
+    
+    int size() const;
+    qint64 byteSize() const;
+    int maxEntries() const;
+    qint64 maxBytes() const;
+    
+    // Oldest first. maxEntries < 0 returns everything, otherwise the newest N.
+    // Entries are implicitly shared, so this copies pointers, not text.
+    QStringList snapshot(int maxEntries = -1) const;
+    QString joined() const;
+    
+    // Visit entries oldest first without materialising a list
+    template <typename Visitor>
+    void forEach(Visitor visitor) const
+    {
+        for (int i = 0; i < m_count; ++i) {
+            visitor(m_slots[(m_head + i) % m_slots.size()]);
+        }
+    }
+
+private:
+    void evictOldest();
+    static qint64 entryBytes(const QString& entry);
+    
+    QVector<QString> m_slots;
+    int m_head;     // Index of the oldest entry
+    int m_count;
+    qint64 m_bytes;
+    qint64 m_maxBytes;
+};
+
+#endif // LOGRINGBUFFER_H
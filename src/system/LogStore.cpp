@@ -0,0 +1,544 @@
+#include "LogStore.h"
+#include "LogArchiver.h"
+#include "BinaryLogReader.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+
+static_assert(LogStore::CHUNK_SIZE == 64 * 64, "LogSelection::WORDS_PER_CHUNK assumes 4096-entry chunks");
+
+namespace {
+
+const char* const OVERFLOW_MODULE = "(other)";
+
+// Parses exactly `count` ASCII digits, or returns -1
+int parseDigits(const char* text, int count)
+{
+    int value = 0;
+    for (int i = 0; i < count; ++i) {
+        unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+        if (digit > 9) {
+            return -1;
+        }
+        value = value * 10 + static_cast<int>(digit);
+    }
+    return value;
+}
+
+int parseLevel(const char* text, int length)
+{
+    static const char* const names[] = {"DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL"};
+    for (int i = 0; i < 5; ++i) {
+        if (static_cast<int>(std::strlen(names[i])) == length && std::memcmp(names[i], text, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char* findChar(const char* begin, const char* end, char c)
+{
+    const void* found = std::memchr(begin, c, end - begin);
+    return found ? static_cast<const char*>(found) : nullptr;
+}
+
+} // namespace
+
+quint8 LogFilter::levelsAtLeast(LogLevel level)
+{
+    return static_cast<quint8>(0x1F & ~((1u << static_cast<int>(level)) - 1));
+}
+
+int LogSelection::count() const
+{
+    return m_count;
+}
+
+bool LogSelection::isEmpty() const
+{
+    return m_count == 0;
+}
+
+quint64 LogSelection::entryAt(int row) const
+{
+    // Last chunk whose firstRow <= row
+    auto it = std::upper_bound(m_chunks.constBegin(), m_chunks.constEnd(), row,
+                               [](int value, const ChunkMatches& chunk) { return value < chunk.firstRow; });
+    const ChunkMatches& chunk = *(it - 1);
+    
+    int remaining = row - chunk.firstRow;
+    for (int word = 0; word < WORDS_PER_CHUNK; ++word) {
+        quint64 bits = chunk.bits[word];
+        int population = qPopulationCount(bits);
+        if (remaining >= population) {
+            remaining -= population;
+            continue;
+        }
+        // Drop the lowest set bits until the wanted one is lowest
+        for (int i = 0; i < remaining; ++i) {
+            bits &= bits - 1;
+        }
+        return chunk.chunkId * LogStore::CHUNK_SIZE + word * 64 + qCountTrailingZeroBits(bits);
+    }
+    return chunk.chunkId * LogStore::CHUNK_SIZE; // Not reached for valid rows
+}
+
+LogStore::LogStore(qint64 maxEntries)
+    : m_nextChunkId(0)
+    , m_maxEntries(maxEntries)
+    , m_size(0)
+    , m_ordered(true)
+{
+}
+
+void LogStore::append(qint64 timestamp, LogLevel level, const QString& module, const QString& message)
+{
+    const QByteArray text = message.toUtf8();
+    appendUtf8(timestamp, level, moduleId(module), text.constData(), text.size());
+}
+
+void LogStore::appendUtf8(qint64 timestamp, LogLevel level, quint8 moduleId, const char* message, int length)
+{
+    if (m_chunks.empty() || m_chunks.back().timestamps.size() == CHUNK_SIZE) {
+        if (m_maxEntries > 0 && m_size + CHUNK_SIZE > m_maxEntries && !m_chunks.empty()) {
+            m_size -= m_chunks.front().timestamps.size();
+            m_chunks.pop_front();
+        }
+        
+        Chunk chunk;
+        chunk.id = m_nextChunkId++;
+        chunk.minTimestamp = timestamp;
+        chunk.maxTimestamp = timestamp;
+        chunk.levelMask = 0;
+        std::fill(chunk.moduleMask, chunk.moduleMask + MODULE_WORDS, 0);
+        chunk.timestamps.reserve(CHUNK_SIZE);
+        chunk.levels.reserve(CHUNK_SIZE);
+        chunk.moduleIds.reserve(CHUNK_SIZE);
+        chunk.textEnds.reserve(CHUNK_SIZE);
+        m_chunks.push_back(std::move(chunk));
+    }
+    
+    Chunk& chunk = m_chunks.back();
+    if (m_ordered && m_chunks.size() > 1 && timestamp < m_chunks[m_chunks.size() - 2].maxTimestamp) {
+        m_ordered = false;
+    }
+    chunk.minTimestamp = qMin(chunk.minTimestamp, timestamp);
+    chunk.maxTimestamp = qMax(chunk.maxTimestamp, timestamp);
+    chunk.levelMask |= static_cast<quint8>(1u << static_cast<int>(level));
+    chunk.moduleMask[moduleId / 64] |= quint64(1) << (moduleId % 64);
+    
+    chunk.timestamps.append(timestamp);
+    chunk.levels.append(static_cast<quint8>(level));
+    chunk.moduleIds.append(moduleId);
+    chunk.text.append(message, length);
+    chunk.textEnds.append(static_cast<quint32>(chunk.text.size()));
+    ++m_size;
+}
+
+void LogStore::clear()
+{
+    m_chunks.clear();
+    m_size = 0;
+    m_ordered = true;
+}
+
+qint64 LogStore::size() const
+{
+    return m_size;
+}
+
+quint64 LogStore::firstEntryId() const
+{
+    return m_chunks.empty() ? m_nextChunkId * CHUNK_SIZE : m_chunks.front().id * CHUNK_SIZE;
+}
+
+quint64 LogStore::endEntryId() const
+{
+    if (m_chunks.empty()) {
+        return m_nextChunkId * CHUNK_SIZE;
+    }
+    const Chunk& last = m_chunks.back();
+    return last.id * CHUNK_SIZE + last.timestamps.size();
+}
+
+bool LogStore::contains(quint64 id) const
+{
+    return id >= firstEntryId() && id < endEntryId();
+}
+
+LogStoreEntry LogStore::entry(quint64 id) const
+{
+    LogStoreEntry result;
+    const Chunk* chunk = chunkFor(id);
+    if (!chunk) {
+        return result;
+    }
+    
+    int index = static_cast<int>(id % CHUNK_SIZE);
+    result.timestamp = chunk->timestamps[index];
+    result.level = static_cast<LogLevel>(chunk->levels[index]);
+    result.module = m_moduleNames[chunk->moduleIds[index]];
+    result.message = messageAt(*chunk, index);
+    return result;
+}
+
+QStringList LogStore::modules() const
+{
+    return m_moduleNames;
+}
+
+LogSelection LogStore::query(const LogFilter& filter) const
+{
+    LogSelection selection;
+    selection.m_scannedEnd = firstEntryId();
+    extend(selection, filter);
+    return selection;
+}
+
+void LogStore::extend(LogSelection& selection, const LogFilter& filter) const
+{
+    const quint64 end = endEntryId();
+    if (selection.m_scannedEnd >= end || m_chunks.empty()) {
+        selection.m_scannedEnd = qMax(selection.m_scannedEnd, end);
+        return;
+    }
+    
+    const CompiledFilter compiled = compile(filter);
+    if (compiled.matchesNothing) {
+        selection.m_scannedEnd = end;
+        return;
+    }
+    
+    // Sparse time index: with ordered chunks, skip straight to the first
+    // chunk that can contain `since`
+    const quint64 firstChunkId = m_chunks.front().id;
+    size_t chunkIndex = static_cast<size_t>(qMax(selection.m_scannedEnd, firstEntryId()) / CHUNK_SIZE - firstChunkId);
+    if (m_ordered && filter.since != std::numeric_limits<qint64>::min()) {
+        auto first = std::partition_point(m_chunks.begin() + chunkIndex, m_chunks.end(),
+                                          [&filter](const Chunk& chunk) { return chunk.maxTimestamp < filter.since; });
+        chunkIndex = static_cast<size_t>(first - m_chunks.begin());
+    }
+    
+    for (; chunkIndex < m_chunks.size(); ++chunkIndex) {
+        const Chunk& chunk = m_chunks[chunkIndex];
+        if (m_ordered && chunk.minTimestamp > filter.until) {
+            break;
+        }
+        if (!chunkMayMatch(chunk, filter, compiled)) {
+            continue;
+        }
+        
+        const quint64 chunkStart = chunk.id * CHUNK_SIZE;
+        const int begin = selection.m_scannedEnd > chunkStart ? static_cast<int>(selection.m_scannedEnd - chunkStart) : 0;
+        const int size = chunk.timestamps.size();
+        if (begin >= size) {
+            continue;
+        }
+        
+        // Continue the selection's last chunk if new entries landed in it
+        bool reuse = !selection.m_chunks.isEmpty() && selection.m_chunks.last().chunkId == chunk.id;
+        if (!reuse) {
+            LogSelection::ChunkMatches matches;
+            matches.chunkId = chunk.id;
+            matches.firstRow = selection.m_count;
+            matches.count = 0;
+            std::fill(matches.bits, matches.bits + LogSelection::WORDS_PER_CHUNK, 0);
+            selection.m_chunks.append(matches);
+        }
+        
+        LogSelection::ChunkMatches& matches = selection.m_chunks.last();
+        const int count = scanChunk(chunk, begin, size, filter, compiled, matches.bits);
+        selection.m_count += count - matches.count;
+        matches.count = count;
+        if (count == 0) {
+            selection.m_chunks.removeLast();
+        }
+    }
+    
+    selection.m_scannedEnd = end;
+}
+
+bool LogStore::isValid(const LogSelection& selection) const
+{
+    return selection.m_chunks.isEmpty() || (!m_chunks.empty() && selection.m_chunks.first().chunkId >= m_chunks.front().id);
+}
+
+int LogStore::importTextLog(const QString& filePath, const std::atomic<bool>* cancel)
+{
+    QByteArray contents;
+    if (!LogArchiver::readSegment(filePath, contents)) {
+        qWarning() << "Failed to read log file:" << filePath;
+        return 0;
+    }
+    
+    QByteArray lastModule;
+    quint8 lastModuleId = 0;
+    int imported = 0;
+    const char* position = contents.constData();
+    const char* end = position + contents.size();
+    while (position < end && !(cancel && cancel->load(std::memory_order_relaxed))) {
+        const char* lineEnd = findChar(position, end, '\n');
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        int length = static_cast<int>(lineEnd - position);
+        if (length > 0 && position[length - 1] == '\r') {
+            --length;
+        }
+        if (importTextLine(position, length, lastModule, lastModuleId)) {
+            ++imported;
+        }
+        position = lineEnd + 1;
+    }
+    return imported;
+}
+
+int LogStore::importBinaryLog(const QString& filePath)
+{
+    BinaryLogReader reader;
+    if (!reader.open(filePath)) {
+        qWarning() << "Failed to open binary log:" << filePath;
+        return 0;
+    }
+    
+    BinaryLogEntry entry;
+    int imported = 0;
+    while (reader.readNext(entry)) {
+        append(entry.timestamp, entry.level, entry.module, entry.message);
+        ++imported;
+    }
+    if (reader.hasError()) {
+        qWarning() << "Binary log decode error in" << filePath << ":" << reader.errorString();
+    }
+    return imported;
+}
+
+int LogStore::importLogFiles(const QString& activePath, qint64 since, const std::atomic<bool>* cancel)
+{
+    int imported = 0;
+    for (const QString& segment : LogArchiver::rotatedSegments(activePath)) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            return imported;
+        }
+        // The name records when the segment was closed, i.e. its newest entry
+        qint64 rotatedAt = LogArchiver::segmentTimestamp(segment);
+        if (rotatedAt >= 0 && rotatedAt < since) {
+            continue;
+        }
+        imported += importTextLog(segment, cancel);
+    }
+    return imported + importTextLog(activePath, cancel);
+}
+
+bool LogStore::parseTimestamp(const char* text, int length, qint64& timestamp)
+{
+    // yyyy-MM-dd hh:mm:ss.zzz
+    if (length != 23 || text[4] != '-' || text[7] != '-' || text[10] != ' '
+        || text[13] != ':' || text[16] != ':' || text[19] != '.') {
+        return false;
+    }
+    
+    int year = parseDigits(text, 4);
+    int month = parseDigits(text + 5, 2);
+    int day = parseDigits(text + 8, 2);
+    int hour = parseDigits(text + 11, 2);
+    int minute = parseDigits(text + 14, 2);
+    int second = parseDigits(text + 17, 2);
+    int millisecond = parseDigits(text + 20, 3);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31 || hour < 0 || hour > 23
+        || minute < 0 || minute > 59 || second < 0 || second > 59 || millisecond < 0) {
+        return false;
+    }
+    
+    qint64 base = hourBase(year, month, day, hour);
+    if (base == std::numeric_limits<qint64>::min()) {
+        return false;
+    }
+    timestamp = base + minute * 60000LL + second * 1000LL + millisecond;
+    return true;
+}
+
+bool LogStore::importTextLine(const char* line, int length, QByteArray& lastModule, quint8& lastModuleId)
+{
+    // [yyyy-MM-dd hh:mm:ss.zzz] [LEVEL] [module] message
+    const char* end = line + length;
+    if (length < 32 || line[0] != '[' || line[24] != ']' || line[25] != ' ' || line[26] != '[') {
+        return false;
+    }
+    
+    qint64 timestamp;
+    if (!parseTimestamp(line + 1, 23, timestamp)) {
+        return false;
+    }
+    
+    const char* levelBegin = line + 27;
+    const char* levelEnd = findChar(levelBegin, end, ']');
+    if (!levelEnd || end - levelEnd < 3 || levelEnd[1] != ' ' || levelEnd[2] != '[') {
+        return false;
+    }
+    int level = parseLevel(levelBegin, static_cast<int>(levelEnd - levelBegin));
+    if (level < 0) {
+        return false;
+    }
+    
+    const char* moduleBegin = levelEnd + 3;
+    const char* moduleEnd = findChar(moduleBegin, end, ']');
+    if (!moduleEnd) {
+        return false;
+    }
+    const int moduleLength = static_cast<int>(moduleEnd - moduleBegin);
+    if (lastModule.size() != moduleLength || std::memcmp(lastModule.constData(), moduleBegin, moduleLength) != 0) {
+        lastModule = QByteArray(moduleBegin, moduleLength);
+        lastModuleId = moduleId(QString::fromUtf8(lastModule));
+    }
+    
+    const char* message = qMin(moduleEnd + 2, end);
+    appendUtf8(timestamp, static_cast<LogLevel>(level), lastModuleId, message, static_cast<int>(end - message));
+    return true;
+}
+
+quint8 LogStore::moduleId(const QString& module)
+{
+    auto it = m_moduleIds.constFind(module);
+    if (it != m_moduleIds.constEnd()) {
+        return it.value();
+    }
+    
+    // The last id is shared by every module beyond the table size
+    quint8 id;
+    if (m_moduleNames.size() < MAX_MODULES - 1) {
+        id = static_cast<quint8>(m_moduleNames.size());
+        m_moduleNames.append(module);
+    } else {
+        id = MAX_MODULES - 1;
+        if (m_moduleNames.size() < MAX_MODULES) {
+            m_moduleNames.append(OVERFLOW_MODULE);
+        }
+    }
+    m_moduleIds.insert(module, id);
+    return id;
+}
+
+LogStore::CompiledFilter LogStore::compile(const LogFilter& filter) const
+{
+    CompiledFilter compiled;
+    compiled.levelMask = filter.levelMask & 0x1F;
+    for (int i = 0; i < 8; ++i) {
+        compiled.acceptLevel[i] = (compiled.levelMask >> i) & 1;
+    }
+    compiled.matchesNothing = compiled.levelMask == 0 || filter.since > filter.until;
+    
+    const bool allModules = filter.modules.isEmpty();
+    std::fill(compiled.acceptModule, compiled.acceptModule + MAX_MODULES, allModules);
+    std::fill(compiled.moduleMask, compiled.moduleMask + MODULE_WORDS, allModules ? ~quint64(0) : 0);
+    if (!allModules) {
+        bool anyKnown = false;
+        for (const QString& module : filter.modules) {
+            auto it = m_moduleIds.constFind(module);
+            if (it == m_moduleIds.constEnd()) {
+                continue;
+            }
+            quint8 id = it.value();
+            compiled.acceptModule[id] = true;
+            compiled.moduleMask[id / 64] |= quint64(1) << (id % 64);
+            anyKnown = true;
+        }
+        compiled.matchesNothing = compiled.matchesNothing || !anyKnown;
+    }
+    return compiled;
+}
+
+bool LogStore::chunkMayMatch(const Chunk& chunk, const LogFilter& filter, const CompiledFilter& compiled) const
+{
+    if (chunk.maxTimestamp < filter.since || chunk.minTimestamp > filter.until) {
+        return false;
+    }
+    if ((chunk.levelMask & compiled.levelMask) == 0) {
+        return false;
+    }
+    for (int word = 0; word < MODULE_WORDS; ++word) {
+        if (chunk.moduleMask[word] & compiled.moduleMask[word]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int LogStore::scanChunk(const Chunk& chunk, int begin, int end, const LogFilter& filter,
+                        const CompiledFilter& compiled, quint64* bits) const
+{
+    const quint8* levels = chunk.levels.constData();
+    const quint8* modules = chunk.moduleIds.constData();
+    const qint64* timestamps = chunk.timestamps.constData();
+    
+    // Branch-free: every row costs two table lookups and an OR into the bitmap
+    if (chunk.minTimestamp >= filter.since && chunk.maxTimestamp <= filter.until) {
+        for (int i = begin; i < end; ++i) {
+            quint64 match = compiled.acceptLevel[levels[i]] & compiled.acceptModule[modules[i]];
+            bits[i >> 6] |= match << (i & 63);
+        }
+    } else {
+        for (int i = begin; i < end; ++i) {
+            quint64 match = compiled.acceptLevel[levels[i]] & compiled.acceptModule[modules[i]]
+                          & (timestamps[i] >= filter.since) & (timestamps[i] <= filter.until);
+            bits[i >> 6] |= match << (i & 63);
+        }
+    }
+    
+    // Text matching needs the decoded message, so it only runs on survivors
+    if (!filter.text.isEmpty()) {
+        for (int word = begin >> 6; word <= (end - 1) >> 6; ++word) {
+            quint64 remaining = bits[word];
+            while (remaining) {
+                int bit = qCountTrailingZeroBits(remaining);
+                remaining &= remaining - 1;
+                int index = word * 64 + bit;
+                if (index >= begin && !messageAt(chunk, index).contains(filter.text, Qt::CaseInsensitive)) {
+                    bits[word] &= ~(quint64(1) << bit);
+                }
+            }
+        }
+    }
+    
+    int count = 0;
+    for (int word = 0; word < LogSelection::WORDS_PER_CHUNK; ++word) {
+        count += qPopulationCount(bits[word]);
+    }
+    return count;
+}
+
+const LogStore::Chunk* LogStore::chunkFor(quint64 id) const
+{
+    if (!contains(id)) {
+        return nullptr;
+    }
+    return &m_chunks[static_cast<size_t>(id / CHUNK_SIZE - m_chunks.front().id)];
+}
+
+QString LogStore::messageAt(const Chunk& chunk, int index) const
+{
+    const quint32 begin = index > 0 ? chunk.textEnds[index - 1] : 0;
+    return QString::fromUtf8(chunk.text.constData() + begin, static_cast<int>(chunk.textEnds[index] - begin));
+}
+
+qint64 LogStore::hourBase(int year, int month, int day, int hour)
+{
+    // Converting local time through QDateTime is slow, so it happens once per
+    // local hour and entries add their minutes and seconds to it. That is
+    // exact unless the UTC offset changes within the hour, as with Lord Howe
+    // Island's 30 minute DST shift; entries in such an hour can be off by the
+    // shift, an accepted approximation for a log viewer
+    const qint64 key = ((static_cast<qint64>(year) * 13 + month) * 32 + day) * 24 + hour;
+    auto it = m_hourBases.constFind(key);
+    if (it != m_hourBases.constEnd()) {
+        return it.value();
+    }
+    
+    QDateTime start(QDate(year, month, day), QTime(hour, 0));
+    qint64 base = start.isValid() ? start.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    m_hourBases.insert(key, base);
+    return base;
+}
@@ -0,0 +1,158 @@
+#ifndef LOGSTORE_H
+#define LOGSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <deque>
+#include <limits>
+
+#include "LogRecord.h"
+
+// Filter for LogStore::query(). Unset fields match everything.
+struct LogFilter {
+    qint64 since = std::numeric_limits<qint64>::min();  // ms since epoch, inclusive
+    qint64 until = std::numeric_limits<qint64>::max();  // ms since epoch, inclusive
+    quint8 levelMask = 0x1F;    // Bit n set = LogLevel n accepted
+    QStringList modules;        // Empty = all modules
+    QString text;               // Case-insensitive substring of the message
+    
+    static quint8 levelsAtLeast(LogLevel level);
+};
+
+struct LogStoreEntry {
+    qint64 timestamp = 0;
+    LogLevel level = LogLevel::INFO;
+    QString module;
+    QString message;
+};
+
+// Result of a query: a per-chunk match bitmap plus running row counts, so
+// mapping a view row to an entry is a binary search and a popcount scan
+// rather than a list of 10M indices.
+class LogSelection
+{
+public:
+    int count() const;
+    bool isEmpty() const;
+    
+    // Store entry id for a row in [0, count())
+    quint64 entryAt(int row) const;
+
+private:
+    friend class LogStore;
+    
+    static const int WORDS_PER_CHUNK = 4096 / 64;
+    
+    struct ChunkMatches {
+        quint64 chunkId;
+        int firstRow;
+        int count;
+        quint64 bits[WORDS_PER_CHUNK];
+    };
+    
+    QVector<ChunkMatches> m_chunks;
+    quint64 m_scannedEnd = 0;   // Entries below this id have been evaluated
+    int m_count = 0;
+};
+
+// In-memory columnar log index for the Log Viewer.
+//
+// Entries are appended into fixed-size chunks holding separate timestamp,
+// level and module-id columns plus the message text as one UTF-8 blob. Each
+// chunk also keeps its time range (the sparse time index), a level mask and a
+// module bitmap, so a query skips every chunk that cannot match and scans the
+// survivors with a branch-free loop over two byte columns. Message text is
+// decoded only for rows that are displayed or text-filtered.
+//
+// Entry ids are stable and increase with append order; evicting the oldest
+// chunk (when maxEntries is set) invalidates only the ids it held. Not
+// thread-safe.
+class LogStore
+{
+public:
+    static const int CHUNK_SIZE = 4096;
+    static const int MAX_MODULES = 256;
+    
+    explicit LogStore(qint64 maxEntries = 0);
+    
+    void append(qint64 timestamp, LogLevel level, const QString& module, const QString& message);
+    void clear();
+    
+    qint64 size() const;
+    quint64 firstEntryId() const;
+    quint64 endEntryId() const;
+    bool contains(quint64 id) const;
+    LogStoreEntry entry(quint64 id) const;
+    QStringList modules() const;
+    
+    LogSelection query(const LogFilter& filter) const;
+    // Evaluates entries appended since the selection was built
+    void extend(LogSelection& selection, const LogFilter& filter) const;
+    // False when the selection refers to evicted chunks
+    bool isValid(const LogSelection& selection) const;
+    
+    // Text logs ("[timestamp] [LEVEL] [module] message"), optionally gzip'd.
+    // Text imports stop early once *cancel becomes true.
+    int importTextLog(const QString& filePath, const std::atomic<bool>* cancel = nullptr);
+    int importBinaryLog(const QString& filePath);
+    // Rotated segments oldest first, then the active file. Segments rotated
+    // before `since` only hold older entries and are not read at all.
+    int importLogFiles(const QString& activePath, qint64 since = std::numeric_limits<qint64>::min(),
+                       const std::atomic<bool>* cancel = nullptr);
+    
+    // "yyyy-MM-dd hh:mm:ss.zzz" in local time; returns false if malformed
+    bool parseTimestamp(const char* text, int length, qint64& timestamp);
+
+private:
+    static const int MODULE_WORDS = MAX_MODULES / 64;
+    
+    struct Chunk {
+        quint64 id;
+        qint64 minTimestamp;
+        qint64 maxTimestamp;
+        quint8 levelMask;
+        quint64 moduleMask[MODULE_WORDS];
+        QVector<qint64> timestamps;
+        QVector<quint8> levels;
+        QVector<quint8> moduleIds;
+        QByteArray text;
+        QVector<quint32> textEnds;
+    };
+    
+    struct CompiledFilter {
+        bool acceptLevel[8];
+        bool acceptModule[MAX_MODULES];
+        quint64 moduleMask[MODULE_WORDS];
+        quint8 levelMask;
+        bool matchesNothing;
+    };
+    
+    void appendUtf8(qint64 timestamp, LogLevel level, quint8 moduleId, const char* message, int length);
+    bool importTextLine(const char* line, int length, QByteArray& lastModule, quint8& lastModuleId);
+    quint8 moduleId(const QString& module);
+    CompiledFilter compile(const LogFilter& filter) const;
+    bool chunkMayMatch(const Chunk& chunk, const LogFilter& filter, const CompiledFilter& compiled) const;
+    int scanChunk(const Chunk& chunk, int begin, int end, const LogFilter& filter,
+                  const CompiledFilter& compiled, quint64* bits) const;
+    const Chunk* chunkFor(quint64 id) const;
+    QString messageAt(const Chunk& chunk, int index) const;
+    qint64 hourBase(int year, int month, int day, int hour);
+    
+    std::deque<Chunk> m_chunks;
+    quint64 m_nextChunkId;
+    qint64 m_maxEntries;
+    qint64 m_size;
+    bool m_ordered;     // Chunk time ranges do not overlap, so they can be binary searched
+    
+    QStringList m_moduleNames;
+    QHash<QString, quint8> m_moduleIds;
+    
+    // Local-time offset cache for text import, keyed by date and hour
+    QHash<qint64, qint64> m_hourBases;
+};
+
+#endif // LOGSTORE_H
@@ -1,12 +1,35 @@
 #include "Logger.h"
+#include "FastClock.h"
 #include <QDir>
 #include <QStandardPaths>
 #include <QCoreApplication>
+#include <QMetaMethod>
 
 Logger::Logger() 
-    : m_consoleOutput(true)
-    , m_currentLevel(LogLevel::DEBUG)
+    : m_nextRotationMs(0)
+    , m_rotationPending(false)
+    , m_rotationRetryMs(0)
+    , m_textLogEnabled(true)
+    , m_consoleOutput(true)
+    , m_logBuffer(MAX_BUFFER_SIZE, MAX_BUFFER_BYTES)
+    , m_queue(ASYNC_QUEUE_CAPACITY)
+    , m_asyncMode(false)
+    , m_writerRunning(false)
+    , m_writerSleeping(false)
+    , m_overflowPolicy(LogOverflowPolicy::BLOCK)
+    , m_enqueuedCount(0)
+    , m_processedCount(0)
+    , m_droppedCount(0)
+    , m_reportedDropCount(0)
+    , m_notifyTimer(nullptr)
+    , m_notifyIntervalMs(0)
+    , m_notifyScheduled(false)
+    , m_droppedNotifications(0)
+    , m_summaryTimer(nullptr)
+    , m_textFlushTimer(nullptr)
 {
+    qRegisterMetaType<QVector<LogRecord>>();
+    
     // Create log directory if it doesn't exist
     QString logDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/logs";
     QDir().mkpath(logDir);
@@ -15,13 +38,23 @@ Logger::Logger()
     QString logFile = logDir + "/autodash.log";
     setLogFile(logFile);
     
-    LOG_INFO("Logger", "AutoDash OS Logger initialized");
+    // Not LOG_INFO: getInstance() is still constructing this object
+    info("Logger", "AutoDash OS Logger initialized");
 }
 
 Logger::~Logger()
 {
     if (m_logFile && m_logFile->isOpen()) {
-        LOG_INFO("Logger", "Shutting down logger");
+        reportSuppressedMessages();
+        info("Logger", "Shutting down logger");
+    }
+    stopWriter();
+    // A rotation in flight still needs m_mutex
+    m_archiver.waitForIdle();
+    
+    QMutexLocker locker(&m_mutex);
+    flushTextLocked();
+    if (m_logFile && m_logFile->isOpen()) {
         m_logFile->close();
     }
 }
@@ -34,35 +67,71 @@ Logger& Logger::getInstance()
 
 void Logger::log(LogLevel level, const QString& module, const QString& message)
 {
-    if (level < m_currentLevel) {
-        return;
+    if (shouldLog(level, module)) {
+        logAdmitted(level, module, message);
     }
-    
-    QMutexLocker locker(&m_mutex);
-    
-    QString timestamp = getCurrentTimestamp();
-    QString levelStr = levelToString(level);
-    QString logEntry = QString("[%1] [%2] [%3] %4")
-                      .arg(timestamp, levelStr, module, message);
-    
-    // Add to buffer
-    m_logBuffer += logEntry + "\n";
-    if (m_logBuffer.split('\n').size() > MAX_BUFFER_SIZE) {
-        QStringList lines = m_logBuffer.split('\n');
-        lines.removeFirst();
-        m_logBuffer = lines.join('\n');
+}
+
+void Logger::log(LogRecord& record)
+{
+    if (shouldLog(record.level, record.module)) {
+        dispatch(record);
     }
-    
-    // Write to file
-    writeToFile(logEntry);
-    
-    // Write to console if enabled
-    if (m_consoleOutput) {
-        writeToConsole(logEntry);
+}
+
+void Logger::logFormat(LogLevel level, const QString& module, const char* format, const LogArguments& arguments)
+{
+    if (shouldLog(level, module)) {
+        logFormatAdmitted(level, module, format, arguments);
     }
+}
+
+void Logger::logAdmitted(LogLevel level, const QString& module, const QString& message)
+{
+    LogRecord record;
+    record.level = level;
+    record.module = module;
+    record.message = message;
+    dispatch(record);
+}
+
+void Logger::logFormatAdmitted(LogLevel level, const QString& module, const char* format, const LogArguments& arguments)
+{
+    LogRecord record;
+    record.level = level;
+    record.module = module;
+    record.format = format;
+    record.arguments = arguments;
+    dispatch(record);
+}
+
+bool Logger::shouldLog(LogLevel level, const char* module)
+{
+    if (!m_levels.isEnabled(level, module)) {
+        return false;
+    }
+    return !m_rateLimiter.hasRules() || m_rateLimiter.allow(level, module, FastClock::monotonicNs());
+}
+
+bool Logger::shouldLog(LogLevel level, const QString& module)
+{
+    if (!m_levels.isEnabled(level, module)) {
+        return false;
+    }
+    return !m_rateLimiter.hasRules() || m_rateLimiter.allow(level, module, FastClock::monotonicNs());
+}
+
+void Logger::dispatch(LogRecord& record)
+{
+    const FastClock::Now now = FastClock::now();
+    record.timestamp = now.wallMs;
+    record.monotonicNs = now.monotonicNs;
     
-    // Emit signal for UI updates
-    emit logMessageAdded(timestamp, levelStr, module, message);
+    if (m_asyncMode.load(std::memory_order_acquire)) {
+        enqueue(record);
+    } else {
+        writeRecords(&record, 1);
+    }
 }
 
 void Logger::debug(const QString& module, const QString& message)
@@ -91,39 +160,398 @@ void Logger::critical(const QString& module, const QString& message)
 }
 
 void Logger::setLogFile(const QString& filePath)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        if (m_logFile && m_logFile->isOpen()) {
+            flushTextLocked();
+            m_logFile->close();
+        }
+        
+        if (!openLogFile(filePath)) {
+            return;
+        }
+    }
+    info("Logger", QString("Log file set to: %1").arg(filePath));
+}
+
+QString Logger::getLogFilePath() const
 {
     QMutexLocker locker(&m_mutex);
+    return m_logFile ? m_logFile->fileName() : QString();
+}
+
+void Logger::setRotationPolicy(const LogRotationPolicy& policy)
+{
+    QString activePath;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_rotationPolicy = policy;
+        m_nextRotationMs = QDateTime::currentMSecsSinceEpoch() + policy.intervalMs;
+        m_rotationRetryMs = 0;
+        if (m_logFile) {
+            activePath = m_logFile->fileName();
+        }
+    }
     
+    // Apply retention to whatever earlier runs left behind
+    if (!activePath.isEmpty()) {
+        m_archiver.schedule(activePath, policy.keepCount, policy.compress);
+    }
+    info("Logger", QString("Log rotation: max %1 bytes, interval %2 ms, keep %3")
+         .arg(policy.maxBytes).arg(policy.intervalMs).arg(policy.keepCount));
+}
+
+LogRotationPolicy Logger::getRotationPolicy() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_rotationPolicy;
+}
+
+void Logger::rotateLogFile()
+{
+    QMutexLocker locker(&m_mutex);
     if (m_logFile && m_logFile->isOpen()) {
-        m_logFile->close();
+        rotateLocked(QDateTime::currentMSecsSinceEpoch());
+    }
+}
+
+void Logger::waitForArchiver()
+{
+    m_archiver.waitForIdle();
+}
+
+void Logger::setTextLogEnabled(bool enabled)
+{
+    m_textLogEnabled = enabled;
+    info("Logger", QString("Text log %1").arg(enabled ? "enabled" : "disabled"));
+}
+
+bool Logger::setBinaryLogFile(const QString& filePath)
+{
+    bool opened = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (filePath.isEmpty()) {
+            m_binarySink.close();
+        } else {
+            opened = m_binarySink.open(filePath);
+        }
     }
     
-    m_logFile = std::make_unique<QFile>(filePath);
-    if (!m_logFile->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-        qWarning() << "Failed to open log file:" << filePath;
-        return;
+    if (filePath.isEmpty()) {
+        info("Logger", "Binary log disabled");
+    } else if (opened) {
+        info("Logger", QString("Binary log file set to: %1").arg(filePath));
+    } else {
+        error("Logger", QString("Failed to open binary log file: %1").arg(filePath));
+    }
+    return opened;
+}
+
+bool Logger::setBlackBoxFile(const QString& filePath, qint64 capacityBytes)
+{
+    bool opened = false;
+    QByteArray recovered;
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        // Whatever the current black box covers goes to the text file first
+        flushTextLocked();
+        m_blackBox.close();
+        
+        if (!filePath.isEmpty()) {
+            opened = m_blackBox.open(filePath, capacityBytes, &recovered);
+            if (!recovered.isEmpty() && m_logFile && m_logFile->isOpen()) {
+                if (!recovered.endsWith('\n')) {
+                    recovered.append('\n');
+                }
+                m_logFile->write(recovered);
+                m_logFile->flush();
+            }
+        }
     }
     
-    m_logStream.setDevice(m_logFile.get());
-    LOG_INFO("Logger", QString("Log file set to: %1").arg(filePath));
+    if (!recovered.isEmpty()) {
+        warning("Logger", QString("Recovered %1 bytes of unflushed log lines from black box %2")
+                          .arg(recovered.size()).arg(filePath));
+    }
+    if (opened) {
+        QMetaObject::invokeMethod(this, "startTextFlushTimer", Qt::QueuedConnection);
+    }
+    if (filePath.isEmpty()) {
+        info("Logger", "Black box log disabled");
+    } else if (opened) {
+        info("Logger", QString("Black box log file set to: %1 (%2 KB)")
+                       .arg(filePath).arg(m_blackBox.capacity() / 1024));
+    } else {
+        error("Logger", QString("Failed to open black box log file: %1").arg(filePath));
+    }
+    return opened;
+}
+
+QString Logger::getBlackBoxFilePath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_blackBox.isOpen() ? m_blackBox.filePath() : QString();
 }
 
 void Logger::setConsoleOutput(bool enabled)
 {
     m_consoleOutput = enabled;
-    LOG_INFO("Logger", QString("Console output %1").arg(enabled ? "enabled" : "disabled"));
+    info("Logger", QString("Console output %1").arg(enabled ? "enabled" : "disabled"));
 }
 
 void Logger::setLogLevel(LogLevel level)
 {
-    m_currentLevel = level;
-    LOG_INFO("Logger", QString("Log level set to: %1").arg(levelToString(level)));
+    m_levels.setGlobalLevel(level);
+    info("Logger", QString("Log level set to: %1").arg(levelToString(level)));
+}
+
+LogLevel Logger::getLogLevel() const
+{
+    return m_levels.globalLevel();
+}
+
+bool Logger::setModuleLogLevel(const QString& module, LogLevel level)
+{
+    if (!m_levels.setModuleLevel(module, level)) {
+        warning("Logger", QString("Too many module log levels, ignoring %1").arg(module));
+        return false;
+    }
+    info("Logger", QString("Log level for %1 set to: %2").arg(module, levelToString(level)));
+    return true;
+}
+
+void Logger::clearModuleLogLevel(const QString& module)
+{
+    m_levels.clearModuleLevel(module);
+    info("Logger", QString("Log level for %1 reset to global").arg(module));
+}
+
+bool Logger::setRateLimit(const QString& module, LogLevel level, double perSecond, int burst)
+{
+    if (!m_rateLimiter.setRateLimit(module, level, perSecond, burst)) {
+        warning("Logger", QString("Too many rate limit rules, ignoring %1").arg(module));
+        return false;
+    }
+    QMetaObject::invokeMethod(this, "startSummaryTimer", Qt::QueuedConnection);
+    info("Logger", QString("Rate limit for %1 %2: %3/s, burst %4")
+         .arg(module, levelToString(level)).arg(perSecond).arg(burst));
+    return true;
+}
+
+bool Logger::setSampling(const QString& module, LogLevel level, int everyN)
+{
+    if (!m_rateLimiter.setSampling(module, level, everyN)) {
+        warning("Logger", QString("Too many rate limit rules, ignoring %1").arg(module));
+        return false;
+    }
+    QMetaObject::invokeMethod(this, "startSummaryTimer", Qt::QueuedConnection);
+    info("Logger", QString("Sampling for %1 %2: 1 in %3").arg(module, levelToString(level)).arg(everyN));
+    return true;
+}
+
+void Logger::clearRateLimits()
+{
+    m_rateLimiter.clearRules();
+}
+
+quint64 Logger::getSuppressedMessageCount() const
+{
+    return m_rateLimiter.totalSuppressed();
+}
+
+void Logger::startSummaryTimer()
+{
+    if (!m_summaryTimer) {
+        m_summaryTimer = new QTimer(this);
+        connect(m_summaryTimer, &QTimer::timeout, this, &Logger::reportSuppressedMessages);
+    }
+    if (!m_summaryTimer->isActive()) {
+        m_summaryTimer->start(SUPPRESSION_SUMMARY_INTERVAL_MS);
+    }
+}
+
+void Logger::reportSuppressedMessages()
+{
+    // On a timer rather than on the next admitted message, so a module that
+    // goes quiet still reports its last count
+    for (const auto& suppressed : m_rateLimiter.takeSuppressed()) {
+        logAdmitted(LogLevel::INFO, "Logger", QString("Suppressed %1 messages from %2")
+                    .arg(suppressed.second).arg(suppressed.first));
+    }
+    
+    // After clearRateLimits() this tick flushed the remainder
+    if (m_summaryTimer && !m_rateLimiter.hasRules()) {
+        m_summaryTimer->stop();
+    }
+}
+
+void Logger::startTextFlushTimer()
+{
+    if (!m_textFlushTimer) {
+        m_textFlushTimer = new QTimer(this);
+        connect(m_textFlushTimer, &QTimer::timeout, this, &Logger::flushPendingText);
+    }
+    // Restarted even when active: a black box opened afresh starts its
+    // interval now
+    m_textFlushTimer->start(TEXT_FLUSH_INTERVAL_MS);
+}
+
+void Logger::flushPendingText()
+{
+    // Writes only flush what is due when they happen, so a logger that goes
+    // quiet needs this to get its last lines into the text file
+    QMutexLocker locker(&m_mutex);
+    if (!m_blackBox.isOpen()) {
+        m_textFlushTimer->stop();
+        return;
+    }
+    if (!m_pendingText.isEmpty()) {
+        flushTextLocked();
+    }
+}
+
+bool Logger::isEnabled(LogLevel level, const char* module) const
+{
+    return m_levels.isEnabled(level, module);
+}
+
+bool Logger::isEnabled(LogLevel level, const QString& module) const
+{
+    return m_levels.isEnabled(level, module);
+}
+
+void Logger::setAsyncMode(bool enabled)
+{
+    if (enabled == m_asyncMode.load()) {
+        return;
+    }
+    
+    if (enabled) {
+        startWriter();
+        m_asyncMode.store(true, std::memory_order_release);
+    } else {
+        m_asyncMode.store(false, std::memory_order_release);
+        stopWriter();
+    }
+    info("Logger", QString("Async mode %1").arg(enabled ? "enabled" : "disabled"));
+}
+
+bool Logger::isAsyncMode() const
+{
+    return m_asyncMode.load(std::memory_order_acquire);
+}
+
+void Logger::setOverflowPolicy(LogOverflowPolicy policy)
+{
+    m_overflowPolicy.store(policy, std::memory_order_relaxed);
+}
+
+LogOverflowPolicy Logger::getOverflowPolicy() const
+{
+    return m_overflowPolicy.load(std::memory_order_relaxed);
+}
+
+quint64 Logger::getDroppedMessageCount() const
+{
+    return m_droppedCount.load(std::memory_order_relaxed);
+}
+
+void Logger::flush()
+{
+    if (m_asyncMode.load(std::memory_order_acquire)) {
+        // Wait until everything enqueued before this call has been written
+        const quint64 target = m_enqueuedCount.load(std::memory_order_acquire);
+        while (m_processedCount.load(std::memory_order_acquire) < target
+               && m_writerRunning.load(std::memory_order_acquire)) {
+            m_writerWakeup.wakeOne();
+            QThread::usleep(100);
+        }
+    }
+    
+    QMutexLocker locker(&m_mutex);
+    flushTextLocked();
+    m_binarySink.flush();
+}
+
+void Logger::setNotificationInterval(int milliseconds)
+{
+    m_notifyIntervalMs.store(qMax(0, milliseconds));
+    if (milliseconds <= 0) {
+        // Hand over anything still pending before switching back
+        QMetaObject::invokeMethod(this, "deliverNotifications", Qt::QueuedConnection);
+    }
+    info("Logger", QString("Notification interval set to %1 ms").arg(milliseconds));
+}
+
+int Logger::getNotificationInterval() const
+{
+    return m_notifyIntervalMs.load();
+}
+
+quint64 Logger::getDroppedNotificationCount() const
+{
+    return m_droppedNotifications.load();
+}
+
+void Logger::queueNotifications(QVector<LogRecord>& records)
+{
+    {
+        QMutexLocker locker(&m_notifyMutex);
+        int room = MAX_PENDING_NOTIFICATIONS - m_pendingNotifications.size();
+        if (records.size() > room) {
+            // The UI is not keeping up; keep what is already queued
+            m_droppedNotifications.fetch_add(records.size() - qMax(0, room), std::memory_order_relaxed);
+            records.resize(qMax(0, room));
+        }
+        m_pendingNotifications += records;
+    }
+    
+    // One queued call per interval, not per entry
+    if (!m_notifyScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(this, "startNotificationTimer", Qt::QueuedConnection);
+    }
+}
+
+void Logger::startNotificationTimer()
+{
+    if (!m_notifyTimer) {
+        m_notifyTimer = new QTimer(this);
+        m_notifyTimer->setSingleShot(true);
+        connect(m_notifyTimer, &QTimer::timeout, this, &Logger::deliverNotifications);
+    }
+    if (!m_notifyTimer->isActive()) {
+        m_notifyTimer->start(qMax(1, m_notifyIntervalMs.load()));
+    }
+}
+
+void Logger::deliverNotifications()
+{
+    QVector<LogRecord> records;
+    {
+        QMutexLocker locker(&m_notifyMutex);
+        records.swap(m_pendingNotifications);
+        m_notifyScheduled.store(false);
+    }
+    
+    if (!records.isEmpty()) {
+        emit logMessagesAdded(records);
+    }
 }
 
 QString Logger::getLogBuffer() const
 {
     QMutexLocker locker(&m_mutex);
-    return m_logBuffer;
+    return m_logBuffer.joined();
+}
+
+QStringList Logger::getLogEntries(int maxEntries) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_logBuffer.snapshot(maxEntries);
 }
 
 void Logger::clearLogBuffer()
@@ -146,18 +574,317 @@ QString Logger::levelToString(LogLevel level) const
 
 QString Logger::getCurrentTimestamp() const
 {
-    return QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
+    return FastClock::currentTimestamp();
+}
+
+QString Logger::formatTimestamp(qint64 timestamp) const
+{
+    return FastClock::formatTimestamp(timestamp);
 }
 
-void Logger::writeToFile(const QString& logEntry)
+void Logger::writeRecords(const LogRecord* records, int count)
+{
+    // Text is only rendered for a consumer that needs it: the text log and
+    // its in-memory buffer, the console, or a notification subscriber. A
+    // binary-only logger never formats a message.
+    const bool textLog = m_textLogEnabled.load(std::memory_order_relaxed);
+    const bool console = m_consoleOutput.load(std::memory_order_relaxed);
+    const bool batched = m_notifyIntervalMs.load(std::memory_order_relaxed) > 0;
+    const bool perEntry = !batched && isSignalConnected(QMetaMethod::fromSignal(&Logger::logMessageAdded));
+    const bool perBatch = batched || isSignalConnected(QMetaMethod::fromSignal(&Logger::logMessagesAdded));
+    const bool render = textLog || console || perEntry || perBatch;
+    
+    QStringList timestamps;
+    QStringList messages;
+    QStringList logEntries;
+    if (render) {
+        timestamps.reserve(count);
+        messages.reserve(count);
+        logEntries.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            const LogRecord& record = records[i];
+            QString timestamp = formatTimestamp(record.timestamp);
+            QString message = record.renderMessage();
+            logEntries.append(QString("[%1] [%2] [%3] %4")
+                              .arg(timestamp, levelToString(record.level), record.module, message));
+            timestamps.append(timestamp);
+            messages.append(message);
+        }
+    }
+    
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        if (m_binarySink.isOpen()) {
+            for (int i = 0; i < count; ++i) {
+                m_binarySink.append(records[i]);
+            }
+            m_binarySink.flushIfDue();
+        }
+        
+        // One write and one flush for the whole batch
+        if (textLog) {
+            for (const QString& logEntry : logEntries) {
+                m_logBuffer.append(logEntry);
+            }
+            writeToFile(logEntries);
+            checkRotation(records[count - 1].timestamp);
+        }
+    }
+    
+    // Console output and UI notification happen outside the lock
+    if (console) {
+        for (const QString& logEntry : logEntries) {
+            writeToConsole(logEntry);
+        }
+    }
+    
+    if (perEntry) {
+        for (int i = 0; i < count; ++i) {
+            emit logMessageAdded(timestamps[i], levelToString(records[i].level),
+                                 records[i].module, messages[i]);
+        }
+    }
+    
+    if (perBatch) {
+        QVector<LogRecord> rendered;
+        rendered.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            LogRecord record;
+            record.timestamp = records[i].timestamp;
+            record.monotonicNs = records[i].monotonicNs;
+            record.level = records[i].level;
+            record.module = records[i].module;
+            record.message = messages[i];
+            rendered.append(record);
+        }
+        
+        if (batched) {
+            queueNotifications(rendered);
+        } else {
+            emit logMessagesAdded(rendered);
+        }
+    }
+}
+
+void Logger::writeToFile(const QStringList& logEntries)
+{
+    if (!m_logFile || !m_logFile->isOpen()) {
+        return;
+    }
+    
+    if (m_blackBox.isOpen()) {
+        // The mapped copy is what survives a crash, so the file write can wait
+        const int start = m_pendingText.size();
+        for (const QString& logEntry : logEntries) {
+            m_pendingText += logEntry.toUtf8();
+            m_pendingText += '\n';
+        }
+        m_blackBox.append(m_pendingText.constData() + start, m_pendingText.size() - start);
+        
+        if (m_pendingText.size() >= TEXT_FLUSH_THRESHOLD
+            || m_sinceTextFlush.elapsed() >= TEXT_FLUSH_INTERVAL_MS) {
+            flushTextLocked();
+        }
+        return;
+    }
+    
+    for (const QString& logEntry : logEntries) {
+        m_logStream << logEntry << '\n';
+    }
+    m_logStream.flush();
+}
+
+void Logger::flushTextLocked()
 {
     if (m_logFile && m_logFile->isOpen()) {
-        m_logStream << logEntry << Qt::endl;
         m_logStream.flush();
+        if (!m_pendingText.isEmpty()) {
+            m_logFile->write(m_pendingText);
+            m_logFile->flush();
+        }
     }
+    m_pendingText.clear();
+    m_blackBox.markSynced();
+    m_sinceTextFlush.restart();
 }
 
 void Logger::writeToConsole(const QString& logEntry)
 {
     qDebug().noquote() << logEntry;
-} 
\ No newline at end of file
+}
+
+bool Logger::openLogFile(const QString& filePath)
+{
+    m_logFile = std::make_unique<QFile>(filePath);
+    if (!m_logFile->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "Failed to open log file:" << filePath;
+        return false;
+    }
+    
+    m_logStream.setDevice(m_logFile.get());
+    m_nextRotationMs = QDateTime::currentMSecsSinceEpoch() + m_rotationPolicy.intervalMs;
+    return true;
+}
+
+void Logger::checkRotation(qint64 now)
+{
+    if (!m_logFile || !m_logFile->isOpen()) {
+        return;
+    }
+    
+    bool sizeDue = m_rotationPolicy.maxBytes > 0
+                   && m_logFile->pos() + m_pendingText.size() >= m_rotationPolicy.maxBytes;
+    bool timeDue = m_rotationPolicy.intervalMs > 0 && now >= m_nextRotationMs;
+    if ((sizeDue || timeDue) && !m_rotationPending && now >= m_rotationRetryMs) {
+        // This is the caller's thread in sync mode, so the rotation goes to
+        // the archiver thread; lines keep going to the current file
+        m_rotationPending = true;
+        const QString activePath = m_logFile->fileName();
+        m_archiver.run([this, activePath, now]() { rotateInBackground(activePath, now); });
+    }
+}
+
+void Logger::rotateInBackground(const QString& activePath, qint64 now)
+{
+    QMutexLocker locker(&m_mutex);
+    m_rotationPending = false;
+    if (!m_logFile || !m_logFile->isOpen() || m_logFile->fileName() != activePath) {
+        return; // setLogFile() switched files meanwhile
+    }
+    rotateLocked(now);
+}
+
+void Logger::rotateLocked(qint64 now)
+{
+    // Only a close, a rename and an open happen here; compression and
+    // retention are handed to the archiver thread
+    const QString activePath = m_logFile->fileName();
+    flushTextLocked();
+    // Closed first: Windows cannot rename a file that is still open
+    m_logFile->close();
+    
+    const QString segment = LogArchiver::segmentPath(activePath, now);
+    const bool renamed = QFile::rename(activePath, segment);
+    // Reopened whatever happened, so the live log stays at activePath
+    const bool opened = openLogFile(activePath);
+    if (!renamed || !opened) {
+        qWarning() << "Failed to rotate log file:" << activePath;
+        // Retried later instead of on every write
+        m_rotationRetryMs = now + ROTATION_RETRY_MS;
+        m_nextRotationMs = qMax(m_nextRotationMs, m_rotationRetryMs);
+    }
+    if (renamed) {
+        m_archiver.schedule(activePath, m_rotationPolicy.keepCount, m_rotationPolicy.compress);
+    }
+}
+
+void Logger::enqueue(LogRecord& record)
+{
+    while (!m_queue.tryPush(record)) {
+        switch (m_overflowPolicy.load(std::memory_order_relaxed)) {
+            case LogOverflowPolicy::BLOCK:
+                m_writerWakeup.wakeOne();
+                QThread::yieldCurrentThread();
+                break;
+            case LogOverflowPolicy::DROP_OLDEST: {
+                LogRecord evicted;
+                if (m_queue.tryPop(evicted)) {
+                    m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+                    m_processedCount.fetch_add(1, std::memory_order_release);
+                }
+                break;
+            }
+            case LogOverflowPolicy::DROP_NEWEST:
+                m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
+        }
+    }
+    
+    m_enqueuedCount.fetch_add(1, std::memory_order_release);
+    if (m_writerSleeping.load()) {
+        m_writerWakeup.wakeOne();
+    }
+}
+
+void Logger::startWriter()
+{
+    m_writerRunning.store(true);
+    m_writerThread.reset(QThread::create([this]() { writerLoop(); }));
+    m_writerThread->setObjectName("LoggerWriter");
+    m_writerThread->start(QThread::LowPriority);
+}
+
+void Logger::stopWriter()
+{
+    if (!m_writerThread) {
+        return;
+    }
+    
+    m_writerRunning.store(false);
+    m_writerWakeup.wakeOne();
+    m_writerThread->wait();
+    m_writerThread.reset();
+    
+    // Records pushed by producers that raced with the switch back to sync mode
+    LogRecord record;
+    while (m_queue.tryPop(record)) {
+        writeRecords(&record, 1);
+        m_processedCount.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void Logger::writerLoop()
+{
+    QVector<LogRecord> batch;
+    batch.reserve(WRITER_BATCH_SIZE);
+    
+    for (;;) {
+        LogRecord record;
+        while (batch.size() < WRITER_BATCH_SIZE && m_queue.tryPop(record)) {
+            batch.append(std::move(record));
+        }
+        
+        if (!batch.isEmpty()) {
+            writeRecords(batch.constData(), batch.size());
+            m_processedCount.fetch_add(batch.size(), std::memory_order_release);
+            batch.clear();
+            reportDroppedMessages();
+            continue;
+        }
+        
+        // Queue drained; exit only once a stop was requested
+        if (!m_writerRunning.load()) {
+            break;
+        }
+        
+        // Producers only signal when they see m_writerSleeping set. A wakeup
+        // that races with this check is covered by the wait timeout.
+        QMutexLocker locker(&m_writerMutex);
+        m_writerSleeping.store(true);
+        if (m_queue.isEmpty() && m_writerRunning.load()) {
+            m_writerWakeup.wait(&m_writerMutex, WRITER_IDLE_WAIT_MS);
+        }
+        m_writerSleeping.store(false);
+    }
+    
+    reportDroppedMessages();
+}
+
+void Logger::reportDroppedMessages()
+{
+    quint64 dropped = m_droppedCount.load(std::memory_order_relaxed);
+    if (dropped == m_reportedDropCount) {
+        return;
+    }
+    
+    LogRecord record;
+    const FastClock::Now now = FastClock::now();
+    record.timestamp = now.wallMs;
+    record.monotonicNs = now.monotonicNs;
+    record.level = LogLevel::WARNING;
+    record.module = "Logger";
+    record.message = QString("Async queue overflow: dropped %1 messages").arg(dropped - m_reportedDropCount);
+    m_reportedDropCount = dropped;
+    writeRecords(&record, 1);
+}
\ No newline at end of file
@@ -3,19 +3,34 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QFile>
 #include <QTextStream>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <atomic>
 #include <memory>
 
-enum class LogLevel {
-    DEBUG,
-    INFO,
-    WARNING,
-    ERROR,
-    CRITICAL
+#include "LogRecord.h"
+#include "LockFreeQueue.h"
+#include "LogRingBuffer.h"
+#include "BinaryLogSink.h"
+#include "ModuleLogLevels.h"
+#include "LogArchiver.h"
+#include "LogRateLimiter.h"
+#include "BlackBoxLog.h"
+
+// What log() does when the async queue is full
+enum class LogOverflowPolicy {
+    BLOCK,        // Wait for the writer thread to free a slot
+    DROP_OLDEST,  // Evict the oldest queued record to make room
+    DROP_NEWEST   // Discard the new record and count it
 };
 
 class Logger : public QObject
@@ -26,22 +41,108 @@ public:
     static Logger& getInstance();
     
     void log(LogLevel level, const QString& module, const QString& message);
+    void log(LogRecord& record);
     void debug(const QString& module, const QString& message);
     void info(const QString& module, const QString& message);
     void warning(const QString& module, const QString& message);
     void error(const QString& module, const QString& message);
     void critical(const QString& module, const QString& message);
     
+    // Deferred formatting: format must be a string literal with %1..%n
+    // placeholders. The text is rendered by the sinks, and the binary sink
+    // stores the format id and raw arguments instead.
+    void logFormat(LogLevel level, const QString& module, const char* format, const LogArguments& arguments);
+    
     void setLogFile(const QString& filePath);
+    QString getLogFilePath() const;
+    
+    // Rotated segments are renamed in place. When a policy limit is reached,
+    // the close, rename and reopen run on a background thread under the
+    // logger lock, then compression and retention run there unlocked, so
+    // log() never does the work itself; rotateLogFile() rotates immediately
+    // on the calling thread. A failed rotation keeps logging to the same
+    // path and is retried after ROTATION_RETRY_MS.
+    void setRotationPolicy(const LogRotationPolicy& policy);
+    LogRotationPolicy getRotationPolicy() const;
+    void rotateLogFile();
+    void waitForArchiver();
+    
+    // The in-memory buffer (getLogBuffer) follows the text log. With both the
+    // text log and console output off and nothing connected to the
+    // notification signals, records reach only the binary sink and are never
+    // rendered as text.
+    void setTextLogEnabled(bool enabled);
+    bool setBinaryLogFile(const QString& filePath);
+    
+    // Black box mode: text lines are also copied into a memory-mapped ring
+    // holding the newest capacityBytes, and the text file is flushed at most
+    // every second instead of per batch. Lines a crashed session never
+    // flushed are appended to the current log file when the black box is
+    // reopened. An empty path turns the mode off.
+    bool setBlackBoxFile(const QString& filePath, qint64 capacityBytes = DEFAULT_BLACK_BOX_BYTES);
+    QString getBlackBoxFilePath() const;
+    static const qint64 DEFAULT_BLACK_BOX_BYTES = 4 * 1024 * 1024;
+    
     void setConsoleOutput(bool enabled);
     void setLogLevel(LogLevel level);
+    LogLevel getLogLevel() const;
+    
+    // Per-module thresholds override the global level for that module
+    bool setModuleLogLevel(const QString& module, LogLevel level);
+    void clearModuleLogLevel(const QString& module);
+    
+    // Lock-free; true if the level is enabled for the module
+    bool isEnabled(LogLevel level, const char* module) const;
+    bool isEnabled(LogLevel level, const QString& module) const;
+    
+    // Rate limiting per (module, level): token bucket and/or 1-in-N sampling.
+    // Suppressed messages are summarised every 10 s, from a timer on the
+    // Logger's thread, as "Suppressed N messages from <module>".
+    bool setRateLimit(const QString& module, LogLevel level, double perSecond, int burst);
+    bool setSampling(const QString& module, LogLevel level, int everyN);
+    void clearRateLimits();
+    quint64 getSuppressedMessageCount() const;
+    
+    // Level check plus rate limiter admission, lock-free. The LOG_* macros
+    // call this before building the message and then the *Admitted
+    // variants, which skip the checks; admission consumes a token.
+    bool shouldLog(LogLevel level, const char* module);
+    bool shouldLog(LogLevel level, const QString& module);
+    void logAdmitted(LogLevel level, const QString& module, const QString& message);
+    void logFormatAdmitted(LogLevel level, const QString& module, const char* format, const LogArguments& arguments);
+    
+    // Async mode: log() only enqueues, a writer thread formats and writes
+    void setAsyncMode(bool enabled);
+    bool isAsyncMode() const;
+    void setOverflowPolicy(LogOverflowPolicy policy);
+    LogOverflowPolicy getOverflowPolicy() const;
+    quint64 getDroppedMessageCount() const;
+    void flush();
+    
+    // 0 (default): logMessageAdded per entry, logMessagesAdded per write.
+    // N > 0: only logMessagesAdded, coalesced on the Logger's thread at most
+    // every N ms, so log storms cost the UI one event per interval.
+    void setNotificationInterval(int milliseconds);
+    int getNotificationInterval() const;
+    quint64 getDroppedNotificationCount() const;
     
     QString getLogBuffer() const;
+    QStringList getLogEntries(int maxEntries = -1) const;
     void clearLogBuffer();
 
 signals:
     void logMessageAdded(const QString& timestamp, const QString& level, 
                         const QString& module, const QString& message);
+    // Records carry rendered messages (format is always null)
+    void logMessagesAdded(const QVector<LogRecord>& records);
+
+private slots:
+    void startNotificationTimer();
+    void deliverNotifications();
+    void startSummaryTimer();
+    void reportSuppressedMessages();
+    void startTextFlushTimer();
+    void flushPendingText();
 
 private:
     Logger();
@@ -51,23 +152,116 @@ private:
     
     QString levelToString(LogLevel level) const;
     QString getCurrentTimestamp() const;
-    void writeToFile(const QString& logEntry);
+    QString formatTimestamp(qint64 timestamp) const;
+    void dispatch(LogRecord& record);
+    void writeRecords(const LogRecord* records, int count);
+    void writeToFile(const QStringList& logEntries);
+    void flushTextLocked();
     void writeToConsole(const QString& logEntry);
+    bool openLogFile(const QString& filePath);
+    void checkRotation(qint64 now);
+    void rotateInBackground(const QString& activePath, qint64 now);
+    void rotateLocked(qint64 now);
+    
+    // Async backend
+    void enqueue(LogRecord& record);
+    void startWriter();
+    void stopWriter();
+    void writerLoop();
+    void reportDroppedMessages();
+    void queueNotifications(QVector<LogRecord>& records);
     
     std::unique_ptr<QFile> m_logFile;
     QTextStream m_logStream;
-    QMutex m_mutex;
-    bool m_consoleOutput;
-    LogLevel m_currentLevel;
-    QString m_logBuffer;
+    LogRotationPolicy m_rotationPolicy;
+    qint64 m_nextRotationMs;
+    bool m_rotationPending;
+    qint64 m_rotationRetryMs;       // After a failed rotation, none before this
+    static const int ROTATION_RETRY_MS = 60 * 1000;
+    LogArchiver m_archiver;
+    BinaryLogSink m_binarySink;
+    BlackBoxLog m_blackBox;
+    QByteArray m_pendingText;       // Black box mode: text not yet written to m_logFile
+    QElapsedTimer m_sinceTextFlush;
+    static const int TEXT_FLUSH_THRESHOLD = 64 * 1024;
+    static const int TEXT_FLUSH_INTERVAL_MS = 1000;
+    mutable QMutex m_mutex;
+    std::atomic<bool> m_textLogEnabled;
+    std::atomic<bool> m_consoleOutput;
+    ModuleLogLevels m_levels;
+    LogRateLimiter m_rateLimiter;
+    LogRingBuffer m_logBuffer;
     static const int MAX_BUFFER_SIZE = 1000;
+    static const qint64 MAX_BUFFER_BYTES = 1024 * 1024;
+    
+    LockFreeQueue<LogRecord> m_queue;
+    std::unique_ptr<QThread> m_writerThread;
+    QMutex m_writerMutex;
+    QWaitCondition m_writerWakeup;
+    std::atomic<bool> m_asyncMode;
+    std::atomic<bool> m_writerRunning;
+    std::atomic<bool> m_writerSleeping;
+    std::atomic<LogOverflowPolicy> m_overflowPolicy;
+    std::atomic<quint64> m_enqueuedCount;
+    std::atomic<quint64> m_processedCount;
+    std::atomic<quint64> m_droppedCount;
+    quint64 m_reportedDropCount;
+    static const int ASYNC_QUEUE_CAPACITY = 8192;
+    static const int WRITER_BATCH_SIZE = 256;
+    static const int WRITER_IDLE_WAIT_MS = 10;
+    
+    // Batched UI notification
+    QMutex m_notifyMutex;
+    QVector<LogRecord> m_pendingNotifications;
+    QTimer* m_notifyTimer;
+    std::atomic<int> m_notifyIntervalMs;
+    std::atomic<bool> m_notifyScheduled;
+    std::atomic<quint64> m_droppedNotifications;
+    static const int MAX_PENDING_NOTIFICATIONS = 10000;
+    
+    QTimer* m_summaryTimer;
+    static const int SUPPRESSION_SUMMARY_INTERVAL_MS = 10000;
+    
+    QTimer* m_textFlushTimer;
 };
 
+// Levels below AUTODASH_MIN_LOG_LEVEL (0 = DEBUG .. 4 = CRITICAL) are compiled
+// out: the condition is a constant, so the call and its arguments vanish.
+#ifndef AUTODASH_MIN_LOG_LEVEL
+#define AUTODASH_MIN_LOG_LEVEL 0
+#endif
+
+#define AUTODASH_LOG_COMPILED(level) (static_cast<int>(level) >= AUTODASH_MIN_LOG_LEVEL)
+
+// The message expression is only evaluated when the level is enabled for
+// the module and the rate limiter admits it, so QString(...).arg(...) costs
+// nothing when filtered out.
+#define AUTODASH_LOG(level, module, message) \
+    do { \
+        if (AUTODASH_LOG_COMPILED(level) && Logger::getInstance().shouldLog(level, module)) { \
+            Logger::getInstance().logAdmitted(level, module, message); \
+        } \
+    } while (0)
+
+#define AUTODASH_LOG_FMT(level, module, format, ...) \
+    do { \
+        if (AUTODASH_LOG_COMPILED(level) && Logger::getInstance().shouldLog(level, module)) { \
+            Logger::getInstance().logFormatAdmitted(level, module, format, {__VA_ARGS__}); \
+        } \
+    } while (0)
+
 // Convenience macros for easier logging
-#define LOG_DEBUG(module, message) Logger::getInstance().debug(module, message)
-#define LOG_INFO(module, message) Logger::getInstance().info(module, message)
-#define LOG_WARNING(module, message) Logger::getInstance().warning(module, message)
-#define LOG_ERROR(module, message) Logger::getInstance().error(module, message)
-#define LOG_CRITICAL(module, message) Logger::getInstance().critical(module, message)
+#define LOG_DEBUG(module, message) AUTODASH_LOG(LogLevel::DEBUG, module, message)
+#define LOG_INFO(module, message) AUTODASH_LOG(LogLevel::INFO, module, message)
+#define LOG_WARNING(module, message) AUTODASH_LOG(LogLevel::WARNING, module, message)
+#define LOG_ERROR(module, message) AUTODASH_LOG(LogLevel::ERROR, module, message)
+#define LOG_CRITICAL(module, message) AUTODASH_LOG(LogLevel::CRITICAL, module, message)
+
+// Deferred-formatting variants, e.g. LOG_DEBUG_FMT("MockI2C", "T=%1", temperature)
+#define LOG_DEBUG_FMT(module, format, ...) AUTODASH_LOG_FMT(LogLevel::DEBUG, module, format, __VA_ARGS__)
+#define LOG_INFO_FMT(module, format, ...) AUTODASH_LOG_FMT(LogLevel::INFO, module, format, __VA_ARGS__)
+#define LOG_WARNING_FMT(module, format, ...) AUTODASH_LOG_FMT(LogLevel::WARNING, module, format, __VA_ARGS__)
+#define LOG_ERROR_FMT(module, format, ...) AUTODASH_LOG_FMT(LogLevel::ERROR, module, format, __VA_ARGS__)
+#define LOG_CRITICAL_FMT(module, format, ...) AUTODASH_LOG_FMT(LogLevel::CRITICAL, module, format, __VA_ARGS__)
 
 #endif // LOGGER_H 
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+#include <QtEndian>
+#include <cstring>
+
+MappedFile::MappedFile(const QString& filePath)
+    : m_file(filePath)
+    , m_size(0)
+    , m_window(nullptr)
+    , m_windowOffset(0)
+    , m_windowSize(0)
+{
+    if (m_file.open(QIODevice::ReadOnly)) {
+        m_size = m_file.size();
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_window) {
+        m_file.unmap(m_window);
+    }
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+qint64 MappedFile::size() const
+{
+    return m_size;
+}
+
+const uchar* MappedFile::map(qint64 offset, qint64 length)
+{
+    if (offset < 0 || length <= 0 || offset > m_size - length) {
+        return nullptr;
+    }
+    if (m_window && offset >= m_windowOffset && offset + length <= m_windowOffset + m_windowSize) {
+        return m_window + (offset - m_windowOffset);
+    }
+    
+    if (m_window) {
+        m_file.unmap(m_window);
+    }
+    m_windowOffset = offset;
+    m_windowSize = qMin(qMax(length, qint64(WINDOW_SIZE)), m_size - offset);
+    m_window = m_file.map(m_windowOffset, m_windowSize);
+    return m_window;
+}
+
+bool findMp4Atom(MappedFile& file, qint64 begin, qint64 end, const char* type, qint64& bodyBegin, qint64& bodyEnd)
+{
+    qint64 pos = begin;
+    while (pos <= end - 8) {
+        const uchar* header = file.map(pos, qMin<qint64>(16, end - pos));
+        if (!header) {
+            return false;
+        }
+        qint64 size = qFromBigEndian<quint32>(header);
+        qint64 headerLength = 8;
+        if (size == 1) {
+            if (end - pos < 16) {
+                return false;
+            }
+            size = qint64(qFromBigEndian<quint64>(header + 8));
+            headerLength = 16;
+        } else if (size == 0) {
+            size = end - pos;
+        }
+        if (size < headerLength || size > end - pos) {
+            return false;
+        }
+        if (std::memcmp(header + 4, type, 4) == 0) {
+            bodyBegin = pos + headerLength;
+            bodyEnd = pos + size;
+            return true;
+        }
+        pos += size;
+    }
+    return false;
+}
@@ -0,0 +1,39 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <QFile>
+#include <QString>
+
+// Read-only window onto part of a file through QFile::map().
+//
+// Header parsers ask for the bytes at an offset; the window is only moved
+// when they fall outside it, and it covers at least WINDOW_SIZE bytes, so a
+// walk over small headers costs one mapping per region rather than a read
+// per header. Only the pages actually touched are read from the device.
+class MappedFile
+{
+public:
+    static const qint64 WINDOW_SIZE = 64 * 1024;
+    
+    explicit MappedFile(const QString& filePath);
+    ~MappedFile();
+    
+    bool isOpen() const;
+    qint64 size() const;
+    // length bytes at offset, valid until the next call; nullptr if the
+    // range is empty, past the end of the file or cannot be mapped
+    const uchar* map(qint64 offset, qint64 length);
+
+private:
+    QFile m_file;
+    qint64 m_size;
+    uchar* m_window;
+    qint64 m_windowOffset;
+    qint64 m_windowSize;
+};
+
+// Finds the first atom of type among the MP4 (ISO base media) atoms in
+// [begin, end), reading only their headers; its body is [bodyBegin, bodyEnd)
+bool findMp4Atom(MappedFile& file, qint64 begin, qint64 end, const char* type, qint64& bodyBegin, qint64& bodyEnd);
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,324 @@
+#include "MediaDurationReader.h"
+#include "MappedFile.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+// Layer II at 384 kbit/s and 32 kHz, padded
+const qint64 MAX_FRAME_BYTES = 1729;
+const int MAX_WAV_CHUNKS = 16;
+
+struct MpegFrame {
+    int version;            // Header bits: 3 MPEG-1, 2 MPEG-2, 0 MPEG-2.5
+    int layer;
+    bool mono;
+    int bitrate;            // bit/s
+    int sampleRate;
+    int samplesPerFrame;
+    int length;             // Bytes, header included
+};
+
+bool parseMpegHeader(const uchar* bytes, MpegFrame& frame)
+{
+    static const int BITRATES[5][15] = {   // kbit/s
+        {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},   // MPEG-1 layer I
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},      // MPEG-1 layer II
+        {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},       // MPEG-1 layer III
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},      // MPEG-2/2.5 layer I
+        {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},           // MPEG-2/2.5 layers II, III
+    };
+    static const int SAMPLE_RATES[3] = {44100, 48000, 32000};   // MPEG-1; halved for 2, quartered for 2.5
+    
+    const quint32 header = qFromBigEndian<quint32>(bytes);
+    const int version = (header >> 19) & 3;
+    const int layerBits = (header >> 17) & 3;
+    const int bitrateIndex = (header >> 12) & 15;
+    const int rateIndex = (header >> 10) & 3;
+    if ((header & 0xffe00000) != 0xffe00000 || version == 1 || layerBits == 0
+        || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) {
+        return false;
+    }
+    
+    const bool mpeg1 = version == 3;
+    frame.version = version;
+    frame.layer = 4 - layerBits;
+    frame.mono = ((header >> 6) & 3) == 3;
+    frame.bitrate = BITRATES[mpeg1 ? frame.layer - 1 : (frame.layer == 1 ? 3 : 4)][bitrateIndex] * 1000;
+    frame.sampleRate = SAMPLE_RATES[rateIndex] >> (mpeg1 ? 0 : version == 2 ? 1 : 2);
+    const int padding = (header >> 9) & 1;
+    if (frame.layer == 1) {
+        frame.samplesPerFrame = 384;
+        frame.length = (12 * frame.bitrate / frame.sampleRate + padding) * 4;
+    } else {
+        frame.samplesPerFrame = frame.layer == 3 && !mpeg1 ? 576 : 1152;
+        frame.length = frame.samplesPerFrame / 8 * frame.bitrate / frame.sampleRate + padding;
+    }
+    return true;
+}
+
+bool sameStream(const MpegFrame& a, const MpegFrame& b)
+{
+    return a.version == b.version && a.layer == b.layer && a.sampleRate == b.sampleRate && a.mono == b.mono;
+}
+
+// First frame header within SYNC_SEARCH_BYTES of from that the next frame's
+// header confirms, or that ends the audio
+bool findFirstFrame(MappedFile& file, qint64 from, qint64 end, qint64& offset, MpegFrame& frame)
+{
+    const qint64 length = qMin<qint64>(MediaDurationReader::SYNC_SEARCH_BYTES + MAX_FRAME_BYTES + 4, end - from);
+    const uchar* data = file.map(from, length);
+    if (!data) {
+        return false;
+    }
+    const qint64 searched = qMin<qint64>(MediaDurationReader::SYNC_SEARCH_BYTES, length - 4);
+    for (qint64 i = 0; i <= searched; ++i) {
+        if (data[i] != 0xff || !parseMpegHeader(data + i, frame)) {
+            continue;
+        }
+        const qint64 next = i + frame.length;
+        MpegFrame nextFrame;
+        if ((next + 4 <= length && parseMpegHeader(data + next, nextFrame) && sameStream(frame, nextFrame))
+            || from + next == end) {
+            offset = from + i;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct FrameSample {
+    int frames = 0;
+    qint64 bytes = 0;
+    bool constantBitrate = true;
+};
+
+// Walks the frames in the SAMPLE_WINDOW_BYTES at from, starting at the
+// first header that belongs to the stream and leads to another. The frame
+// the window starts in is never counted; being more likely to be a long
+// one, it would skew the mean frame length.
+void sampleFrames(MappedFile& file, qint64 from, qint64 end, const MpegFrame& reference, FrameSample& sample)
+{
+    const qint64 length = qMin<qint64>(MediaDurationReader::SAMPLE_WINDOW_BYTES, end - from);
+    const uchar* data = file.map(from, length);
+    if (!data) {
+        return;
+    }
+    MpegFrame frame;
+    for (qint64 i = 0; i + 4 <= length; ++i) {
+        FrameSample walk;
+        qint64 pos = i;
+        while (pos + 4 <= length && data[pos] == 0xff && parseMpegHeader(data + pos, frame)
+               && sameStream(frame, reference)) {
+            ++walk.frames;
+            walk.bytes += frame.length;
+            walk.constantBitrate = walk.constantBitrate && frame.bitrate == reference.bitrate;
+            pos += frame.length;
+        }
+        // A lone header is only trusted when its frame runs past the window
+        if (walk.frames >= 2 || (walk.frames == 1 && pos + 4 > length)) {
+            sample.frames += walk.frames;
+            sample.bytes += walk.bytes;
+            sample.constantBitrate = sample.constantBitrate && walk.constantBitrate;
+            return;
+        }
+    }
+}
+
+bool isEncoderTag(const uchar* bytes)
+{
+    return std::memcmp(bytes, "LAME", 4) == 0 || std::memcmp(bytes, "Lavc", 4) == 0
+        || std::memcmp(bytes, "Lavf", 4) == 0;
+}
+
+qint64 readMpeg(MappedFile& file, qint64 audioStart)
+{
+    qint64 audioEnd = file.size();
+    const uchar* trailer = file.map(audioEnd - 128, 3);
+    if (trailer && std::memcmp(trailer, "TAG", 3) == 0) {
+        audioEnd -= 128;
+    }
+    qint64 offset;
+    MpegFrame first;
+    if (!findFirstFrame(file, audioStart, audioEnd, offset, first)) {
+        return -1;
+    }
+    
+    // VBR encoders put a Xing/Info or VBRI header in the first frame
+    const qint64 length = qMin<qint64>(first.length, audioEnd - offset);
+    if (const uchar* data = file.map(offset, length)) {
+        const qint64 xing = 4 + (first.version == 3 ? (first.mono ? 17 : 32) : (first.mono ? 9 : 17));
+        if (xing + 12 <= length && (std::memcmp(data + xing, "Xing", 4) == 0 || std::memcmp(data + xing, "Info", 4) == 0)) {
+            const quint32 flags = qFromBigEndian<quint32>(data + xing + 4);
+            const qint64 frames = (flags & 1) ? qint64(qFromBigEndian<quint32>(data + xing + 8)) : 0;
+            if (frames > 0) {
+                qint64 samples = frames * first.samplesPerFrame;
+                const qint64 lame = xing + 12 + ((flags & 2) ? 4 : 0) + ((flags & 4) ? 100 : 0) + ((flags & 8) ? 4 : 0);
+                if (lame + 24 <= length && isEncoderTag(data + lame)) {
+                    // Encoder delay and end padding, 12 bits each
+                    const uchar* gap = data + lame + 21;
+                    const int delay = (gap[0] << 4) | (gap[1] >> 4);
+                    const int padding = ((gap[1] & 0x0f) << 8) | gap[2];
+                    if (delay + padding < samples) {
+                        samples -= delay + padding;
+                    }
+                }
+                return samples * 1000 / first.sampleRate;
+            }
+        }
+        const qint64 vbri = 4 + 32;
+        if (vbri + 18 <= length && std::memcmp(data + vbri, "VBRI", 4) == 0) {
+            const qint64 frames = qFromBigEndian<quint32>(data + vbri + 14);
+            if (frames > 0) {
+                return frames * first.samplesPerFrame * 1000 / first.sampleRate;
+            }
+        }
+    }
+    
+    // No VBR header: sample frame headers at the start and through the audio
+    const qint64 audioBytes = audioEnd - offset;
+    FrameSample sample;
+    sampleFrames(file, offset, audioEnd, first, sample);
+    for (int point = 1; point <= MediaDurationReader::SAMPLE_POINTS; ++point) {
+        sampleFrames(file, offset + audioBytes * point / (MediaDurationReader::SAMPLE_POINTS + 1), audioEnd, first, sample);
+    }
+    if (sample.frames == 0) {
+        return -1;
+    }
+    if (sample.constantBitrate) {
+        return audioBytes * 8000 / first.bitrate;
+    }
+    const double frames = double(audioBytes) * sample.frames / sample.bytes;
+    return qint64(frames * first.samplesPerFrame * 1000 / first.sampleRate);
+}
+
+qint64 readFlac(MappedFile& file)
+{
+    // STREAMINFO is always the first metadata block
+    const uchar* header = file.map(0, 4 + 4 + 34);
+    if (!header || (header[4] & 0x7f) != 0) {
+        return -1;
+    }
+    const uchar* info = header + 8;
+    const quint32 sampleRate = (quint32(info[10]) << 12) | (quint32(info[11]) << 4) | (info[12] >> 4);
+    const quint64 samples = (quint64(info[13] & 0x0f) << 32) | qFromBigEndian<quint32>(info + 14);
+    if (sampleRate == 0 || samples == 0) {
+        return -1;   // Sample count unknown to the encoder
+    }
+    return qint64(samples * 1000 / sampleRate);
+}
+
+qint64 readWav(MappedFile& file)
+{
+    quint16 formatTag = 0;
+    quint32 sampleRate = 0;
+    quint32 byteRate = 0;
+    qint64 factSamples = -1;
+    qint64 dataBytes = -1;
+    qint64 pos = 12;
+    for (int chunk = 0; chunk < MAX_WAV_CHUNKS && (byteRate == 0 || dataBytes < 0); ++chunk) {
+        const uchar* header = file.map(pos, 8);
+        if (!header) {
+            break;
+        }
+        const qint64 size = qFromLittleEndian<quint32>(header + 4);
+        const qint64 body = pos + 8;
+        if (std::memcmp(header, "fmt ", 4) == 0 && size >= 16) {
+            const uchar* format = file.map(body, 16);
+            if (!format) {
+                break;
+            }
+            formatTag = qFromLittleEndian<quint16>(format);
+            sampleRate = qFromLittleEndian<quint32>(format + 4);
+            byteRate = qFromLittleEndian<quint32>(format + 8);
+        } else if (std::memcmp(header, "fact", 4) == 0 && size >= 4) {
+            if (const uchar* fact = file.map(body, 4)) {
+                factSamples = qFromLittleEndian<quint32>(fact);
+            }
+        } else if (std::memcmp(header, "data", 4) == 0) {
+            // Streaming writers leave the size at 0 or 0xffffffff
+            dataBytes = size == 0 ? file.size() - body : qMin(size, file.size() - body);
+        }
+        pos = body + size + (size & 1);
+    }
+    if (dataBytes < 0 || byteRate == 0) {
+        return -1;
+    }
+    
+    // PCM, float and extensible data are timed by size, other codecs by samples
+    const bool compressed = formatTag != 1 && formatTag != 3 && formatTag != 0xfffe;
+    if (compressed && factSamples >= 0 && sampleRate > 0) {
+        return factSamples * 1000 / sampleRate;
+    }
+    return dataBytes * 1000 / byteRate;
+}
+
+qint64 readMp4(MappedFile& file)
+{
+    qint64 moovBegin, moovEnd, mvhdBegin, mvhdEnd;
+    if (!findMp4Atom(file, 0, file.size(), "moov", moovBegin, moovEnd)
+        || !findMp4Atom(file, moovBegin, moovEnd, "mvhd", mvhdBegin, mvhdEnd)) {
+        return -1;
+    }
+    // Version and flags, creation and modification times, time scale, duration
+    const qint64 length = mvhdEnd - mvhdBegin;
+    const uchar* mvhd = file.map(mvhdBegin, qMin<qint64>(32, length));
+    if (!mvhd || length < 20) {
+        return -1;
+    }
+    quint32 timeScale;
+    quint64 duration;
+    if (mvhd[0] == 1) {
+        if (length < 32) {
+            return -1;
+        }
+        timeScale = qFromBigEndian<quint32>(mvhd + 20);
+        duration = qFromBigEndian<quint64>(mvhd + 24);
+    } else {
+        timeScale = qFromBigEndian<quint32>(mvhd + 12);
+        duration = qFromBigEndian<quint32>(mvhd + 16);
+        if (duration == 0xffffffff) {
+            return -1;
+        }
+    }
+    if (timeScale == 0 || duration == 0 || duration == ~quint64(0)) {
+        return -1;
+    }
+    return qint64(duration * 1000 / timeScale);
+}
+
+} // namespace
+
+qint64 MediaDurationReader::read(const QString& filePath)
+{
+    MappedFile file(filePath);
+    return read(file);
+}
+
+qint64 MediaDurationReader::read(MappedFile& file)
+{
+    const uchar* magic = file.map(0, 12);
+    if (!magic) {
+        return -1;
+    }
+    
+    if (std::memcmp(magic, "ID3", 3) == 0) {
+        // The audio follows the tag and its optional footer
+        const qint64 tagSize = (qint64(magic[6] & 0x7f) << 21) | (qint64(magic[7] & 0x7f) << 14)
+                             | (qint64(magic[8] & 0x7f) << 7) | qint64(magic[9] & 0x7f);
+        return readMpeg(file, 10 + tagSize + ((magic[5] & 0x10) ? 10 : 0));
+    }
+    if (std::memcmp(magic, "fLaC", 4) == 0) {
+        return readFlac(file);
+    }
+    if (std::memcmp(magic, "RIFF", 4) == 0 && std::memcmp(magic + 8, "WAVE", 4) == 0) {
+        return readWav(file);
+    }
+    if (std::memcmp(magic + 4, "ftyp", 4) == 0) {
+        return readMp4(file);
+    }
+    if (std::memcmp(magic, "OggS", 4) == 0) {
+        return -1;
+    }
+    return readMpeg(file, 0);
+}
@@ -0,0 +1,35 @@
+#ifndef MEDIADURATIONREADER_H
+#define MEDIADURATIONREADER_H
+
+#include <QString>
+
+class MappedFile;
+
+// Playing time of audio files from their headers, without decoding.
+//
+//   MP3       : Xing/Info frame count, less the LAME encoder delay and
+//               padding, or the VBRI frame count
+//   FLAC      : STREAMINFO sample count
+//   WAV       : data chunk size over the fmt byte rate, or the fact
+//               sample count for compressed formats
+//   M4A / MP4 : moov/mvhd duration over its time scale
+//
+// MP3 files without a VBR header are timed from a sample of frame headers:
+// the first frames and short walks at SAMPLE_POINTS places through the
+// audio. A constant bitrate gives the exact time, otherwise the mean frame
+// size is used, which is an estimate. Headers cost a few hundred bytes of
+// reads; the sampled walk at most SYNC_SEARCH_BYTES and a window per point.
+class MediaDurationReader
+{
+public:
+    // How far past the tags the first MPEG frame is looked for
+    static const int SYNC_SEARCH_BYTES = 4096;
+    static const int SAMPLE_POINTS = 4;
+    static const int SAMPLE_WINDOW_BYTES = 2048;
+    
+    // Milliseconds; -1 if the format is not recognised or carries no length
+    static qint64 read(const QString& filePath);
+    static qint64 read(MappedFile& file);
+};
+
+#endif // MEDIADURATIONREADER_H
@@ -0,0 +1,320 @@
+#include "MediaLibraryIndex.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QVector>
+#include <QtEndian>
+#include <QDebug>
+
+// Field order within an entry's string indices
+enum EntryField {
+    FIELD_DIRECTORY,
+    FIELD_FILE_NAME,
+    FIELD_TITLE,
+    FIELD_ARTIST,
+    FIELD_ALBUM,
+    FIELD_DURATION,
+    FIELD_FILE_TYPE
+};
+
+// The first strings of every table
+enum SectionString {
+    STRING_VOLUME_ID,
+    STRING_DEVICE_NAME,
+    STRING_FILE_SYSTEM,
+    FIXED_STRING_COUNT
+};
+
+static QString mountRoot(const QString& mountPoint)
+{
+    return QDir(mountPoint).absolutePath();
+}
+
+MediaLibraryIndex::MediaLibraryIndex()
+{
+}
+
+bool MediaLibraryIndex::load(const QString& filePath)
+{
+    m_filePath = filePath;
+    m_sections.clear();
+    
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+    if (data.size() < FILE_HEADER_SIZE
+        || qFromLittleEndian<quint32>(bytes) != MAGIC
+        || qFromLittleEndian<quint16>(bytes + 4) != VERSION) {
+        qWarning() << "MediaLibraryIndex: not a media index:" << filePath;
+        return false;
+    }
+    
+    const quint32 volumeCount = qFromLittleEndian<quint32>(bytes + 8);
+    qint64 offset = FILE_HEADER_SIZE;
+    for (quint32 v = 0; v < volumeCount; ++v) {
+        if (data.size() - offset < SECTION_HEADER_SIZE) {
+            qWarning() << "MediaLibraryIndex: truncated index:" << filePath;
+            break;
+        }
+        const quint32 sectionBytes = qFromLittleEndian<quint32>(bytes + offset);
+        if (sectionBytes < quint32(SECTION_HEADER_SIZE) || sectionBytes > quint64(data.size() - offset)) {
+            qWarning() << "MediaLibraryIndex: truncated index:" << filePath;
+            break;
+        }
+        
+        const QByteArray section = data.mid(offset, sectionBytes);
+        offset += sectionBytes;
+        if (!validateSection(section)) {
+            qWarning() << "MediaLibraryIndex: dropping a corrupt volume from" << filePath;
+            continue;
+        }
+        m_sections.insert(sectionVolumeId(section), section);
+    }
+    return true;
+}
+
+bool MediaLibraryIndex::save()
+{
+    if (m_filePath.isEmpty()) {
+        return false;
+    }
+    
+    uchar header[FILE_HEADER_SIZE] = {};
+    qToLittleEndian<quint32>(MAGIC, header);
+    qToLittleEndian<quint16>(VERSION, header + 4);
+    qToLittleEndian<quint32>(quint32(m_sections.size()), header + 8);
+    
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "MediaLibraryIndex: cannot write" << m_filePath;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(header), FILE_HEADER_SIZE);
+    for (const QByteArray& section : m_sections) {
+        file.write(section);
+    }
+    return file.commit();
+}
+
+QString MediaLibraryIndex::filePath() const
+{
+    return m_filePath;
+}
+
+bool MediaLibraryIndex::contains(const QString& volumeId) const
+{
+    return m_sections.contains(volumeId);
+}
+
+QStringList MediaLibraryIndex::volumes() const
+{
+    return m_sections.keys();
+}
+
+int MediaLibraryIndex::fileCount(const QString& volumeId) const
+{
+    auto it = m_sections.constFind(volumeId);
+    if (it == m_sections.constEnd()) {
+        return 0;
+    }
+    return int(qFromLittleEndian<quint32>(it->constData() + 12));
+}
+
+QList<MediaFile> MediaLibraryIndex::files(const QString& volumeId, const QString& mountPoint) const
+{
+    QList<MediaFile> files;
+    auto it = m_sections.constFind(volumeId);
+    if (it == m_sections.constEnd()) {
+        return files;
+    }
+    
+    const uchar* bytes = reinterpret_cast<const uchar*>(it->constData());
+    const quint32 stringCount = qFromLittleEndian<quint32>(bytes + 4);
+    const quint32 stringBytes = qFromLittleEndian<quint32>(bytes + 8);
+    const quint32 entryCount = qFromLittleEndian<quint32>(bytes + 12);
+    const uchar* offsets = bytes + SECTION_HEADER_SIZE;
+    const char* stringData = reinterpret_cast<const char*>(offsets + 4 * (stringCount + 1));
+    const uchar* entries = reinterpret_cast<const uchar*>(stringData) + stringBytes;
+    
+    // Equal tags share one QString
+    QVector<QString> strings(stringCount);
+    for (quint32 i = 0; i < stringCount; ++i) {
+        const quint32 begin = qFromLittleEndian<quint32>(offsets + 4 * i);
+        const quint32 end = qFromLittleEndian<quint32>(offsets + 4 * (i + 1));
+        strings[i] = QString::fromUtf8(stringData + begin, int(end - begin));
+    }
+    
+    // Path prefixes per directory, built on first use
+    const QString root = mountRoot(mountPoint) + '/';
+    QVector<QString> prefixes(stringCount);
+    QVector<bool> hasPrefix(stringCount, false);
+    
+    files.reserve(entryCount);
+    for (quint32 e = 0; e < entryCount; ++e) {
+        const uchar* entry = entries + qint64(e) * ENTRY_SIZE;
+        quint32 fields[FIELD_COUNT];
+        for (int f = 0; f < FIELD_COUNT; ++f) {
+            fields[f] = qFromLittleEndian<quint32>(entry + 4 * f);
+        }
+        
+        const quint32 directory = fields[FIELD_DIRECTORY];
+        if (!hasPrefix[directory]) {
+            prefixes[directory] = strings[directory].isEmpty() ? root : root + strings[directory] + '/';
+            hasPrefix[directory] = true;
+        }
+        
+        MediaFile file;
+        file.fileName = strings[fields[FIELD_FILE_NAME]];
+        file.filePath = prefixes[directory] + file.fileName;
+        file.title = strings[fields[FIELD_TITLE]];
+        file.artist = strings[fields[FIELD_ARTIST]];
+        file.album = strings[fields[FIELD_ALBUM]];
+        file.duration = strings[fields[FIELD_DURATION]];
+        file.fileType = strings[fields[FIELD_FILE_TYPE]];
+        file.fileSize = qFromLittleEndian<qint64>(entry + 32);
+        file.lastModified = QDateTime::fromMSecsSinceEpoch(qFromLittleEndian<qint64>(entry + 40));
+        files.append(file);
+    }
+    return files;
+}
+
+void MediaLibraryIndex::store(const USBDevice& device, const QString& volumeId)
+{
+    QHash<QString, quint32> stringIds;
+    QByteArray stringData;
+    QVector<quint32> offsets;
+    auto intern = [&](const QString& value) -> quint32 {
+        auto it = stringIds.constFind(value);
+        if (it != stringIds.constEnd()) {
+            return *it;
+        }
+        const quint32 id = quint32(offsets.size());
+        offsets.append(quint32(stringData.size()));
+        stringData.append(value.toUtf8());
+        stringIds.insert(value, id);
+        return id;
+    };
+    // Fixed slots, even if a name repeats
+    for (const QString& value : {volumeId, device.deviceName, device.fileSystem}) {
+        offsets.append(quint32(stringData.size()));
+        stringData.append(value.toUtf8());
+    }
+    
+    const QString root = mountRoot(device.mountPoint) + '/';
+    QByteArray entries;
+    entries.reserve(device.mediaFiles.size() * ENTRY_SIZE);
+    quint32 entryCount = 0;
+    for (const MediaFile& file : device.mediaFiles) {
+        if (!file.filePath.startsWith(root) || !file.filePath.endsWith(file.fileName)) {
+            continue;
+        }
+        const int directoryLength = file.filePath.size() - root.size() - file.fileName.size() - 1;
+        const QString directory = directoryLength > 0 ? file.filePath.mid(root.size(), directoryLength) : QString();
+        
+        uchar entry[ENTRY_SIZE] = {};
+        const quint32 fields[FIELD_COUNT] = {
+            intern(directory), intern(file.fileName), intern(file.title), intern(file.artist),
+            intern(file.album), intern(file.duration), intern(file.fileType)
+        };
+        for (int f = 0; f < FIELD_COUNT; ++f) {
+            qToLittleEndian<quint32>(fields[f], entry + 4 * f);
+        }
+        qToLittleEndian<qint64>(file.fileSize, entry + 32);
+        qToLittleEndian<qint64>(file.lastModified.toMSecsSinceEpoch(), entry + 40);
+        entries.append(reinterpret_cast<const char*>(entry), ENTRY_SIZE);
+        ++entryCount;
+    }
+    offsets.append(quint32(stringData.size()));
+    
+    const quint32 stringCount = quint32(offsets.size() - 1);
+    QByteArray section(SECTION_HEADER_SIZE + 4 * offsets.size(), '\0');
+    uchar* header = reinterpret_cast<uchar*>(section.data());
+    qToLittleEndian<quint32>(quint32(section.size() + stringData.size() + entries.size()), header);
+    qToLittleEndian<quint32>(stringCount, header + 4);
+    qToLittleEndian<quint32>(quint32(stringData.size()), header + 8);
+    qToLittleEndian<quint32>(entryCount, header + 12);
+    qToLittleEndian<qint64>(device.totalSpace, header + 16);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 24);
+    qToLittleEndian<quint32>(offsets.constData(), offsets.size(), header + SECTION_HEADER_SIZE);
+    section.append(stringData);
+    section.append(entries);
+    m_sections.insert(volumeId, section);
+    
+    // Forget the volumes not seen for the longest, never the one just stored
+    while (m_sections.size() > MAX_VOLUMES) {
+        QString oldestId;
+        qint64 oldestSeen = 0;
+        for (auto it = m_sections.constBegin(); it != m_sections.constEnd(); ++it) {
+            if (it.key() != volumeId && (oldestId.isEmpty() || sectionLastSeen(it.value()) < oldestSeen)) {
+                oldestId = it.key();
+                oldestSeen = sectionLastSeen(it.value());
+            }
+        }
+        m_sections.remove(oldestId);
+    }
+}
+
+void MediaLibraryIndex::remove(const QString& volumeId)
+{
+    m_sections.remove(volumeId);
+}
+
+void MediaLibraryIndex::clear()
+{
+    m_sections.clear();
+}
+
+QString MediaLibraryIndex::sectionVolumeId(const QByteArray& section)
+{
+    const uchar* bytes = reinterpret_cast<const uchar*>(section.constData());
+    const quint32 stringCount = qFromLittleEndian<quint32>(bytes + 4);
+    const uchar* offsets = bytes + SECTION_HEADER_SIZE;
+    const char* stringData = reinterpret_cast<const char*>(offsets + 4 * (stringCount + 1));
+    return QString::fromUtf8(stringData, int(qFromLittleEndian<quint32>(offsets + 4)));
+}
+
+qint64 MediaLibraryIndex::sectionLastSeen(const QByteArray& section)
+{
+    return qFromLittleEndian<qint64>(section.constData() + 24);
+}
+
+bool MediaLibraryIndex::validateSection(const QByteArray& section)
+{
+    const uchar* bytes = reinterpret_cast<const uchar*>(section.constData());
+    const quint64 stringCount = qFromLittleEndian<quint32>(bytes + 4);
+    const quint64 stringBytes = qFromLittleEndian<quint32>(bytes + 8);
+    const quint64 entryCount = qFromLittleEndian<quint32>(bytes + 12);
+    if (stringCount < FIXED_STRING_COUNT
+        || quint64(section.size()) != SECTION_HEADER_SIZE + 4 * (stringCount + 1) + stringBytes + entryCount * ENTRY_SIZE) {
+        return false;
+    }
+    
+    // Offsets must be ordered and inside the string data
+    const uchar* offsets = bytes + SECTION_HEADER_SIZE;
+    quint32 previous = 0;
+    for (quint64 i = 0; i <= stringCount; ++i) {
+        const quint32 offset = qFromLittleEndian<quint32>(offsets + 4 * i);
+        if (offset < previous || offset > stringBytes || (i == 0 && offset != 0)) {
+            return false;
+        }
+        previous = offset;
+    }
+    if (previous != stringBytes) {
+        return false;
+    }
+    
+    const uchar* entries = offsets + 4 * (stringCount + 1) + stringBytes;
+    for (quint64 e = 0; e < entryCount; ++e) {
+        for (int f = 0; f < FIELD_COUNT; ++f) {
+            if (qFromLittleEndian<quint32>(entries + e * ENTRY_SIZE + 4 * f) >= stringCount) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
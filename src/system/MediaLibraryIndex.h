@@ -0,0 +1,70 @@
+#ifndef MEDIALIBRARYINDEX_H
+#define MEDIALIBRARYINDEX_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include "USBMonitor.h"
+
+// Saved media libraries of the USB volumes seen so far, keyed by volume
+// identity, so a known stick's library is available as soon as it is
+// mounted, wherever it is mounted.
+//
+//   file   : "AMLI", version u16, reserved u16, volume count u32
+//   volume : section bytes u32, string count u32, string bytes u32,
+//            entry count u32, total space i64, last seen ms i64,
+//            string offsets u32[string count + 1], UTF-8 string data,
+//            entries[entry count]
+//   entry  : directory, file name, title, artist, album, duration, file type
+//            (u32 string indices), reserved u32, size i64, mtime ms i64
+//
+// Little-endian. Each volume has its own string table, with every distinct
+// string stored once: the volume id, device name and file system first,
+// then directories relative to the mount point, names and tags. Loading
+// reads the file in one go and only splits it into volume sections; a
+// volume's strings and entries are decoded when its library is asked for.
+// Sections that fail validation are dropped. Volumes not seen for the
+// longest are forgotten beyond MAX_VOLUMES. Not thread-safe.
+class MediaLibraryIndex
+{
+public:
+    static const int MAX_VOLUMES = 32;
+    
+    MediaLibraryIndex();
+    
+    // Replaces the libraries in memory with the file's; false if it is
+    // missing or not an index, leaving the index empty
+    bool load(const QString& filePath);
+    // Writes every library to the file last loaded, atomically
+    bool save();
+    QString filePath() const;
+    
+    bool contains(const QString& volumeId) const;
+    QStringList volumes() const;
+    int fileCount(const QString& volumeId) const;
+    // The volume's files with paths under mountPoint; empty if unknown
+    QList<MediaFile> files(const QString& volumeId, const QString& mountPoint) const;
+    // Replaces the volume's library; files outside mountPoint are skipped
+    void store(const USBDevice& device, const QString& volumeId);
+    void remove(const QString& volumeId);
+    void clear();
+
+private:
+    static const quint32 MAGIC = 0x494C4D41;   // "AMLI"
+    static const quint16 VERSION = 1;
+    static const int FILE_HEADER_SIZE = 12;
+    static const int SECTION_HEADER_SIZE = 32;
+    static const int ENTRY_SIZE = 48;
+    static const int FIELD_COUNT = 7;
+    
+    static QString sectionVolumeId(const QByteArray& section);
+    static qint64 sectionLastSeen(const QByteArray& section);
+    static bool validateSection(const QByteArray& section);
+    
+    QString m_filePath;
+    QMap<QString, QByteArray> m_sections;   // Encoded volume sections by volume id
+};
+
+#endif // MEDIALIBRARYINDEX_H
@@ -0,0 +1,278 @@
+#include "MediaScanner.h"
+#include "DirectoryWalker.h"
+#include "MappedFile.h"
+#include "MediaDurationReader.h"
+#include "MediaTagReader.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMetaObject>
+
+MediaScanner::MediaScanner(QObject* parent)
+    : QObject(parent)
+    , m_maxDepth(DEFAULT_MAX_DEPTH)
+{
+    m_pool.setMaxThreadCount(MAX_THREADS);
+}
+
+MediaScanner::~MediaScanner()
+{
+    for (DeviceState& state : m_devices) {
+        if (state.job) {
+            state.job->cancelled = true;
+        }
+    }
+    m_pool.waitForDone();
+}
+
+void MediaScanner::setSupportedFormats(const QStringList& formats)
+{
+    m_supportedFormats = formats;
+}
+
+QStringList MediaScanner::supportedFormats() const
+{
+    return m_supportedFormats;
+}
+
+void MediaScanner::setMaxDepth(int depth)
+{
+    m_maxDepth = qMax(0, depth);
+}
+
+int MediaScanner::maxDepth() const
+{
+    return m_maxDepth;
+}
+
+void MediaScanner::prime(const QString& deviceId, const QList<MediaFile>& files)
+{
+    DeviceState& state = m_devices[deviceId];
+    if (state.job) {
+        return;
+    }
+    
+    state.cache.clear();
+    state.cache.reserve(files.size());
+    for (const MediaFile& file : files) {
+        state.cache.insert(file.filePath, {file.fileSize, file.lastModified.toMSecsSinceEpoch(), state.generation});
+    }
+}
+
+bool MediaScanner::isKnown(const QString& deviceId) const
+{
+    return m_devices.contains(deviceId);
+}
+
+void MediaScanner::scan(const QString& deviceId, const QString& rootPath)
+{
+    DeviceState& state = m_devices[deviceId];
+    if (state.job) {
+        state.pendingRoot = rootPath;
+        return;
+    }
+    
+    auto job = std::make_shared<Job>();
+    job->deviceId = deviceId;
+    job->rootPath = rootPath;
+    job->suffixes = m_supportedFormats;
+    job->maxDepth = m_maxDepth;
+    job->cache = std::move(state.cache);
+    job->generation = ++state.generation;
+    state.job = job;
+    
+    m_pool.start([this, job]() { run(job); });
+}
+
+void MediaScanner::cancel(const QString& deviceId)
+{
+    auto it = m_devices.find(deviceId);
+    if (it == m_devices.end()) {
+        return;
+    }
+    if (it->job) {
+        it->job->cancelled = true;
+    }
+    m_devices.erase(it);
+}
+
+bool MediaScanner::isScanning(const QString& deviceId) const
+{
+    auto it = m_devices.constFind(deviceId);
+    return it != m_devices.constEnd() && it->job;
+}
+
+void MediaScanner::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+MediaFile MediaScanner::describe(const QFileInfo& fileInfo)
+{
+    return describe(fileInfo.absoluteFilePath(), fileInfo.size(), fileInfo.lastModified());
+}
+
+MediaFile MediaScanner::describe(const QString& filePath, qint64 size, const QDateTime& lastModified)
+{
+    // Nothing is stat'ed; only the tag and stream headers are read
+    const QFileInfo fileInfo(filePath);
+    MediaFile mediaFile;
+    mediaFile.fileName = fileInfo.fileName();
+    mediaFile.filePath = filePath;
+    mediaFile.fileSize = size;
+    mediaFile.fileType = fileInfo.suffix().toLower();
+    mediaFile.lastModified = lastModified;
+    mediaFile.title = fileInfo.baseName();
+    mediaFile.artist = "Unknown Artist";
+    mediaFile.album = "Unknown Album";
+    
+    // "Artist - Title" file names
+    const int separator = mediaFile.title.indexOf(" - ");
+    if (separator >= 0) {
+        mediaFile.artist = mediaFile.title.left(separator).trimmed();
+        mediaFile.title = mediaFile.title.mid(separator + 3).section(" - ", 0, 0).trimmed();
+    }
+    
+    // Tags win over the file name, field by field
+    MappedFile file(filePath);
+    const MediaTags tags = MediaTagReader::read(file);
+    if (!tags.title.isEmpty()) {
+        mediaFile.title = tags.title;
+    }
+    if (!tags.artist.isEmpty() || !tags.albumArtist.isEmpty()) {
+        mediaFile.artist = tags.artist.isEmpty() ? tags.albumArtist : tags.artist;
+    }
+    if (!tags.album.isEmpty()) {
+        mediaFile.album = tags.album;
+    }
+    mediaFile.duration = formatDuration(MediaDurationReader::read(file));
+    return mediaFile;
+}
+
+void MediaScanner::run(const std::shared_ptr<Job>& job)
+{
+    QElapsedTimer timer;
+    timer.start();
+    qint64 lastProgressMs = 0;
+    MediaScanStats stats;
+    QList<MediaFile> batch;
+    int batchSize = FIRST_BATCH_SIZE;
+    
+    DirectoryWalker walker(job->rootPath);
+    auto reportProgress = [&]() {
+        const qint64 elapsedMs = timer.elapsed();
+        if (elapsedMs - lastProgressMs < PROGRESS_INTERVAL_MS) {
+            return;
+        }
+        lastProgressMs = elapsedMs;
+        stats.directories = walker.stats().directories;
+        stats.elapsedMs = elapsedMs;
+        stats.filesPerSecond = stats.files * 1000.0 / elapsedMs;
+        QMetaObject::invokeMethod(this, [this, job, stats]() { deliverProgress(job, stats); }, Qt::QueuedConnection);
+    };
+    walker.setMaxDepth(job->maxDepth);
+    walker.setSuffixes(job->suffixes);
+    walker.setCancelFlag(&job->cancelled);
+    // Per directory, so a large tree with few media files still reports;
+    // per 256 files as well for a directory holding thousands of them
+    walker.setDirectoryCallback(reportProgress);
+    const bool walked = walker.walk([&](const DirectoryEntry& entry) {
+        if ((++stats.files & 255) == 0) {
+            reportProgress();
+        }
+        
+        auto cached = job->cache.find(entry.path);
+        if (cached != job->cache.end()) {
+            cached->generation = job->generation;
+            if (cached->size == entry.size && cached->mtimeMs == entry.mtimeMs) {
+                return;
+            }
+            cached->size = entry.size;
+            cached->mtimeMs = entry.mtimeMs;
+            ++stats.changed;
+        } else {
+            job->cache.insert(entry.path, {entry.size, entry.mtimeMs, job->generation});
+            ++stats.added;
+        }
+        
+        batch.append(describe(entry.path, entry.size, QDateTime::fromMSecsSinceEpoch(entry.mtimeMs)));
+        if (batch.size() >= batchSize) {
+            QMetaObject::invokeMethod(this, [this, job, batch]() { deliverBatch(job, batch); }, Qt::QueuedConnection);
+            batch.clear();
+            batchSize = qMin(batchSize * 2, MAX_BATCH_SIZE);
+        }
+    });
+    if (!walked) {
+        return;
+    }
+    if (!batch.isEmpty()) {
+        QMetaObject::invokeMethod(this, [this, job, batch]() { deliverBatch(job, batch); }, Qt::QueuedConnection);
+    }
+    
+    // Entries this scan did not see are gone, unless a directory could not
+    // be read; a device pulled mid-scan must not empty its library
+    const DirectoryWalkStats walkStats = walker.stats();
+    stats.directories = walkStats.directories;
+    stats.complete = walkStats.unreadable == 0;
+    QStringList removedPaths;
+    for (auto cached = job->cache.begin(); cached != job->cache.end();) {
+        if (cached->generation == job->generation) {
+            ++cached;
+        } else if (stats.complete) {
+            removedPaths << cached.key();
+            cached = job->cache.erase(cached);
+        } else {
+            // Unconfirmed; the next complete scan decides
+            cached->generation = job->generation;
+            ++cached;
+        }
+    }
+    stats.removed = removedPaths.size();
+    stats.elapsedMs = timer.elapsed();
+    stats.filesPerSecond = stats.files * 1000.0 / qMax<qint64>(1, stats.elapsedMs);
+    
+    QMetaObject::invokeMethod(this, [this, job, removedPaths, stats]() { finish(job, removedPaths, stats); },
+                              Qt::QueuedConnection);
+}
+
+void MediaScanner::deliverProgress(const std::shared_ptr<Job>& job, const MediaScanStats& stats)
+{
+    auto it = m_devices.constFind(job->deviceId);
+    if (it == m_devices.constEnd() || it->job != job) {
+        return;
+    }
+    emit scanProgress(job->deviceId, stats);
+}
+
+void MediaScanner::deliverBatch(const std::shared_ptr<Job>& job, const QList<MediaFile>& files)
+{
+    auto it = m_devices.constFind(job->deviceId);
+    if (it == m_devices.constEnd() || it->job != job) {
+        return;
+    }
+    emit filesFound(job->deviceId, files);
+}
+
+void MediaScanner::finish(const std::shared_ptr<Job>& job, const QStringList& removedPaths, const MediaScanStats& stats)
+{
+    auto it = m_devices.find(job->deviceId);
+    if (it == m_devices.end() || it->job != job) {
+        return;
+    }
+    
+    it->cache = std::move(job->cache);
+    it->job.reset();
+    const QString pendingRoot = it->pendingRoot;
+    it->pendingRoot.clear();
+    
+    emit scanFinished(job->deviceId, removedPaths, stats);
+    if (!pendingRoot.isEmpty() && m_devices.contains(job->deviceId)) {
+        scan(job->deviceId, pendingRoot);
+    }
+}
+
+QString MediaScanner::formatDuration(qint64 durationMs)
+{
+    const qint64 seconds = qMax<qint64>(0, durationMs) / 1000;
+    return QString("%1:%2").arg(seconds / 60, 2, 10, QChar('0'))
+                           .arg(seconds % 60, 2, 10, QChar('0'));
+}
@@ -0,0 +1,121 @@
+#ifndef MEDIASCANNER_H
+#define MEDIASCANNER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+#include "USBMonitor.h"
+
+struct MediaScanStats {
+    int directories = 0;
+    int files = 0;          // Media files on the device after the scan
+    int added = 0;
+    int changed = 0;        // Size or modification time differs from the last scan
+    int removed = 0;
+    qint64 elapsedMs = 0;
+    double filesPerSecond = 0.0;
+    bool complete = true;   // Every directory was read; removals are only reported then
+};
+
+// Incremental media scans of mounted devices on a thread pool.
+//
+// The device is walked breadth-first down to a depth limit (DirectoryWalker).
+// Each device keeps a (path, size, mtime) cache of the files its last scan
+// found; a rescan only stats the files and builds MediaFile entries for
+// new or changed ones, so an unchanged device costs one pass over its
+// directory entries. New and changed files are streamed back in batches that
+// start small and double, so the first results show quickly while a large
+// cold scan only costs a few list updates. One scan runs per device; a scan
+// requested while one is running starts when it finishes. Signals are
+// emitted on the scanner's thread, never for a cancelled scan.
+class MediaScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int MAX_THREADS = 2;
+    static const int FIRST_BATCH_SIZE = 64;
+    static const int MAX_BATCH_SIZE = 8192;
+    static const int DEFAULT_MAX_DEPTH = 8;
+    static const int PROGRESS_INTERVAL_MS = 250;
+    
+    explicit MediaScanner(QObject* parent = nullptr);
+    ~MediaScanner();
+    
+    // Lower-case extensions; takes effect from the next scan
+    void setSupportedFormats(const QStringList& formats);
+    QStringList supportedFormats() const;
+    // Deepest directory level scanned; 0 scans only the mount point
+    void setMaxDepth(int depth);
+    int maxDepth() const;
+    
+    // Files already known for a device, e.g. from a saved library; the next
+    // scan reports only the differences. Ignored while a scan is running.
+    void prime(const QString& deviceId, const QList<MediaFile>& files);
+    bool isKnown(const QString& deviceId) const;
+    
+    void scan(const QString& deviceId, const QString& rootPath);
+    // Stops a running scan, between two directory entries, and forgets the
+    // device's cache
+    void cancel(const QString& deviceId);
+    bool isScanning(const QString& deviceId) const;
+    // Blocks until no scan is running; queued results still need the event loop
+    void waitForDone();
+    
+    // Metadata for one file from its tags (MediaTagReader), falling back to
+    // "Artist - Title" file names, and its duration from the stream headers
+    // (MediaDurationReader); "00:00" when unknown
+    static MediaFile describe(const QFileInfo& fileInfo);
+    static MediaFile describe(const QString& filePath, qint64 size, const QDateTime& lastModified);
+
+signals:
+    // Running totals every PROGRESS_INTERVAL_MS of a scan
+    void scanProgress(const QString& deviceId, const MediaScanStats& stats);
+    void filesFound(const QString& deviceId, const QList<MediaFile>& files);
+    void scanFinished(const QString& deviceId, const QStringList& removedPaths, const MediaScanStats& stats);
+
+private:
+    struct FileStamp {
+        qint64 size;
+        qint64 mtimeMs;
+        quint32 generation;   // Last scan that saw the file
+    };
+    
+    // Shared with the worker; the cache belongs to the worker while it runs
+    struct Job {
+        QString deviceId;
+        QString rootPath;
+        QStringList suffixes;
+        int maxDepth = 0;
+        QHash<QString, FileStamp> cache;
+        quint32 generation = 0;
+        std::atomic<bool> cancelled{false};
+    };
+    
+    struct DeviceState {
+        QHash<QString, FileStamp> cache;
+        quint32 generation = 0;
+        std::shared_ptr<Job> job;
+        QString pendingRoot;   // Rescan requested while the job ran
+    };
+    
+    void run(const std::shared_ptr<Job>& job);
+    void deliverProgress(const std::shared_ptr<Job>& job, const MediaScanStats& stats);
+    void deliverBatch(const std::shared_ptr<Job>& job, const QList<MediaFile>& files);
+    void finish(const std::shared_ptr<Job>& job, const QStringList& removedPaths, const MediaScanStats& stats);
+    // "mm:ss"
+    static QString formatDuration(qint64 durationMs);
+    
+    QThreadPool m_pool;
+    QHash<QString, DeviceState> m_devices;
+    QStringList m_supportedFormats;
+    int m_maxDepth;
+};
+
+#endif // MEDIASCANNER_H
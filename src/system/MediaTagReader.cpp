@@ -0,0 +1,430 @@
+#include "MediaTagReader.h"
+#include "MappedFile.h"
+#include <QByteArray>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+quint32 syncSafe(const uchar* bytes)
+{
+    return (quint32(bytes[0] & 0x7f) << 21) | (quint32(bytes[1] & 0x7f) << 14)
+         | (quint32(bytes[2] & 0x7f) << 7) | quint32(bytes[3] & 0x7f);
+}
+
+quint32 bigEndian24(const uchar* bytes)
+{
+    return (quint32(bytes[0]) << 16) | (quint32(bytes[1]) << 8) | quint32(bytes[2]);
+}
+
+void setIfEmpty(QString& field, const QString& value)
+{
+    if (field.isEmpty()) {
+        field = value;
+    }
+}
+
+// Drops the 0x00 stuffed after every 0xFF
+QByteArray removeUnsynchronisation(const uchar* data, qint64 length)
+{
+    QByteArray result;
+    result.reserve(int(length));
+    for (qint64 i = 0; i < length; ++i) {
+        result.append(char(data[i]));
+        if (data[i] == 0xff && i + 1 < length && data[i + 1] == 0x00) {
+            ++i;
+        }
+    }
+    return result;
+}
+
+QString decodeUtf16(const uchar* data, qint64 length, bool bigEndian)
+{
+    QString text;
+    text.reserve(int(length / 2));
+    for (qint64 i = 0; i + 1 < length; i += 2) {
+        const char16_t unit = bigEndian ? char16_t((data[i] << 8) | data[i + 1])
+                                        : char16_t((data[i + 1] << 8) | data[i]);
+        if (unit == 0) {
+            break;
+        }
+        text.append(QChar(unit));
+    }
+    return text;
+}
+
+// Text frame body: encoding byte, then the first of possibly several
+// null-separated values
+QString decodeId3Text(const uchar* data, qint64 length)
+{
+    if (length < 2) {
+        return QString();
+    }
+    const uchar encoding = data[0];
+    ++data;
+    --length;
+    
+    if (encoding == 1 || encoding == 2) {
+        bool bigEndian = encoding == 2;
+        if (encoding == 1 && length >= 2 && ((data[0] == 0xff && data[1] == 0xfe) || (data[0] == 0xfe && data[1] == 0xff))) {
+            bigEndian = data[0] == 0xfe;
+            data += 2;
+            length -= 2;
+        }
+        return decodeUtf16(data, length, bigEndian).trimmed();
+    }
+    
+    const void* terminator = std::memchr(data, 0, size_t(length));
+    const int size = terminator ? int(static_cast<const uchar*>(terminator) - data) : int(length);
+    const char* text = reinterpret_cast<const char*>(data);
+    return (encoding == 3 ? QString::fromUtf8(text, size) : QString::fromLatin1(text, size)).trimmed();
+}
+
+QString* id3Field(const uchar* id, int idLength, MediaTags& tags)
+{
+    static const char* const V22_IDS[] = {"TT2", "TP1", "TAL", "TP2"};
+    static const char* const V23_IDS[] = {"TIT2", "TPE1", "TALB", "TPE2"};
+    QString* const fields[] = {&tags.title, &tags.artist, &tags.album, &tags.albumArtist};
+    
+    const char* const* ids = idLength == 3 ? V22_IDS : V23_IDS;
+    for (int i = 0; i < 4; ++i) {
+        if (std::memcmp(id, ids[i], size_t(idLength)) == 0) {
+            return fields[i];
+        }
+    }
+    return nullptr;
+}
+
+bool readId3v2(MappedFile& file, MediaTags& tags)
+{
+    const uchar* header = file.map(0, 10);
+    if (!header || std::memcmp(header, "ID3", 3) != 0) {
+        return false;
+    }
+    const int major = header[3];
+    const uchar flags = header[5];
+    if (major < 2 || major > 4 || ((header[6] | header[7] | header[8] | header[9]) & 0x80)) {
+        return false;
+    }
+    // ID3v2.2 defines the extended header bit as compression, which no reader supports
+    if (major == 2 && (flags & 0x40)) {
+        return false;
+    }
+    qint64 tagSize = qMin<qint64>(syncSafe(header + 6), file.size() - 10);
+    if (tagSize <= 0) {
+        return true;
+    }
+    
+    const uchar* tag = file.map(10, tagSize);
+    if (!tag) {
+        return false;
+    }
+    // Whole-tag unsynchronisation before ID3v2.4 is rare; undo it on a copy
+    QByteArray unsynchronised;
+    if ((flags & 0x80) && major < 4) {
+        unsynchronised = removeUnsynchronisation(tag, tagSize);
+        tag = reinterpret_cast<const uchar*>(unsynchronised.constData());
+        tagSize = unsynchronised.size();
+    }
+    
+    qint64 pos = 0;
+    if ((flags & 0x40) && tagSize >= 4) {
+        pos = major == 3 ? 4 + qint64(qFromBigEndian<quint32>(tag)) : qint64(syncSafe(tag));
+    }
+    
+    const int idLength = major == 2 ? 3 : 4;
+    const int headerLength = major == 2 ? 6 : 10;
+    while (pos + headerLength <= tagSize) {
+        const uchar* frame = tag + pos;
+        if (frame[0] == 0) {
+            break;   // Padding
+        }
+        const qint64 frameSize = major == 2 ? bigEndian24(frame + 3)
+                               : major == 3 ? qFromBigEndian<quint32>(frame + 4)
+                               : syncSafe(frame + 4);
+        pos += headerLength;
+        if (frameSize > tagSize - pos) {
+            break;
+        }
+        const uchar* body = tag + pos;
+        qint64 bodySize = frameSize;
+        pos += frameSize;
+        
+        QString* field = id3Field(frame, idLength, tags);
+        if (!field || !field->isEmpty()) {
+            continue;
+        }
+        
+        QByteArray frameData;
+        if (major == 3) {
+            const uchar format = frame[9];
+            if (format & 0xc0) {
+                continue;   // Compressed or encrypted
+            }
+            if (format & 0x20) {
+                ++body;     // Group id
+                --bodySize;
+            }
+        } else if (major == 4) {
+            const uchar format = frame[9];
+            if (format & 0x0c) {
+                continue;   // Compressed or encrypted
+            }
+            const int skipped = ((format & 0x40) ? 1 : 0) + ((format & 0x01) ? 4 : 0);
+            body += skipped;
+            bodySize -= skipped;
+            if (bodySize > 0 && ((format & 0x02) || (flags & 0x80))) {
+                frameData = removeUnsynchronisation(body, bodySize);
+                body = reinterpret_cast<const uchar*>(frameData.constData());
+                bodySize = frameData.size();
+            }
+        }
+        if (bodySize > 0) {
+            *field = decodeId3Text(body, bodySize);
+        }
+    }
+    return true;
+}
+
+void readId3v1(MappedFile& file, MediaTags& tags)
+{
+    const uchar* tag = file.map(file.size() - 128, 128);
+    if (!tag || std::memcmp(tag, "TAG", 3) != 0) {
+        return;
+    }
+    auto text = [tag](int offset) {
+        const char* field = reinterpret_cast<const char*>(tag + offset);
+        return QString::fromLatin1(field, int(qstrnlen(field, 30))).trimmed();
+    };
+    setIfEmpty(tags.title, text(3));
+    setIfEmpty(tags.artist, text(33));
+    setIfEmpty(tags.album, text(63));
+}
+
+// Vendor string, then "KEY=value" UTF-8 comments with case-insensitive keys.
+// Truncated data yields the comments read so far.
+void readVorbisComment(const uchar* data, qint64 length, MediaTags& tags)
+{
+    if (length < 4) {
+        return;
+    }
+    qint64 pos = 4 + qint64(qFromLittleEndian<quint32>(data));
+    if (pos > length - 4) {
+        return;
+    }
+    const quint32 count = qFromLittleEndian<quint32>(data + pos);
+    pos += 4;
+    
+    struct Key {
+        const char* name;
+        QString* field;
+    };
+    const Key keys[] = {{"TITLE", &tags.title}, {"ARTIST", &tags.artist},
+                        {"ALBUM", &tags.album}, {"ALBUMARTIST", &tags.albumArtist}};
+    for (quint32 i = 0; i < count && pos <= length - 4; ++i) {
+        const qint64 commentLength = qFromLittleEndian<quint32>(data + pos);
+        pos += 4;
+        if (commentLength > length - pos) {
+            return;
+        }
+        const char* comment = reinterpret_cast<const char*>(data + pos);
+        pos += commentLength;
+        
+        const void* separator = std::memchr(comment, '=', size_t(commentLength));
+        if (!separator) {
+            continue;
+        }
+        const int keyLength = int(static_cast<const char*>(separator) - comment);
+        for (const Key& key : keys) {
+            if (keyLength == int(std::strlen(key.name)) && qstrnicmp(comment, key.name, uint(keyLength)) == 0) {
+                setIfEmpty(*key.field, QString::fromUtf8(comment + keyLength + 1,
+                                                         int(commentLength) - keyLength - 1).trimmed());
+                break;
+            }
+        }
+    }
+}
+
+void readFlac(MappedFile& file, MediaTags& tags)
+{
+    qint64 pos = 4;
+    while (const uchar* block = file.map(pos, 4)) {
+        const bool last = block[0] & 0x80;
+        const int type = block[0] & 0x7f;
+        const qint64 length = bigEndian24(block + 1);
+        pos += 4;
+        if (type == 4) {
+            if (const uchar* comment = file.map(pos, length)) {
+                readVorbisComment(comment, length, tags);
+            }
+            return;
+        }
+        if (last || type == 127) {
+            return;
+        }
+        pos += length;
+    }
+}
+
+// Reassembles the first two packets of the first logical stream from its
+// page segments; the identification header and the comments. Pages of other
+// streams multiplexed into the file are skipped by serial number.
+void readOgg(MappedFile& file, MediaTags& tags)
+{
+    QByteArray packets[2];
+    int packet = 0;
+    qint64 pos = 0;
+    quint32 serial = 0;
+    for (int page = 0; page < MediaTagReader::MAX_OGG_PAGES && packet < 2; ++page) {
+        const uchar* header = file.map(pos, 27);
+        if (!header || std::memcmp(header, "OggS", 4) != 0) {
+            break;
+        }
+        // Beginning-of-stream pages come first, so the first page is the
+        // first stream's
+        const quint32 pageSerial = qFromLittleEndian<quint32>(header + 14);
+        if (page == 0) {
+            serial = pageSerial;
+        }
+        const int segmentCount = header[26];
+        uchar lacing[255];
+        const uchar* table = file.map(pos + 27, segmentCount);
+        if (segmentCount > 0 && !table) {
+            break;
+        }
+        qint64 bodyLength = 0;
+        for (int i = 0; i < segmentCount; ++i) {
+            lacing[i] = table[i];
+            bodyLength += lacing[i];
+        }
+        const qint64 bodyPos = pos + 27 + segmentCount;
+        if (pageSerial != serial) {
+            pos = bodyPos + bodyLength;
+            continue;
+        }
+        const uchar* body = bodyLength > 0 ? file.map(bodyPos, bodyLength) : nullptr;
+        if (bodyLength > 0 && !body) {
+            break;
+        }
+        
+        qint64 offset = 0;
+        for (int i = 0; i < segmentCount && packet < 2; ++i) {
+            QByteArray& data = packets[packet];
+            const int room = MediaTagReader::MAX_OGG_PACKET_BYTES - data.size();
+            data.append(reinterpret_cast<const char*>(body + offset), qMin<int>(lacing[i], qMax(0, room)));
+            offset += lacing[i];
+            if (lacing[i] < 255) {
+                ++packet;
+            }
+        }
+        pos = bodyPos + bodyLength;
+    }
+    if (packet < 1) {
+        return;
+    }
+    
+    const QByteArray& identification = packets[0];
+    const QByteArray& comments = packets[1];
+    const uchar* data = reinterpret_cast<const uchar*>(comments.constData());
+    if (identification.startsWith("\x01vorbis") && comments.startsWith("\x03vorbis")) {
+        readVorbisComment(data + 7, comments.size() - 7, tags);
+    } else if (identification.startsWith("OpusHead") && comments.startsWith("OpusTags")) {
+        readVorbisComment(data + 8, comments.size() - 8, tags);
+    } else if (identification.startsWith("\x7f" "FLAC") && comments.size() > 4 && (data[0] & 0x7f) == 4) {
+        readVorbisComment(data + 4, comments.size() - 4, tags);
+    }
+}
+
+void readMp4(MappedFile& file, MediaTags& tags)
+{
+    qint64 moovBegin, moovEnd, udtaBegin, udtaEnd, metaBegin, metaEnd, ilstBegin, ilstEnd;
+    if (!findMp4Atom(file, 0, file.size(), "moov", moovBegin, moovEnd)) {
+        return;
+    }
+    // iTunes puts meta in udta; some writers put it directly in moov
+    if (!(findMp4Atom(file, moovBegin, moovEnd, "udta", udtaBegin, udtaEnd)
+          && findMp4Atom(file, udtaBegin, udtaEnd, "meta", metaBegin, metaEnd))
+        && !findMp4Atom(file, moovBegin, moovEnd, "meta", metaBegin, metaEnd)) {
+        return;
+    }
+    // meta is a full box (version and flags) in ISO files, a plain one in QuickTime
+    const uchar* meta = file.map(metaBegin, qMin<qint64>(12, metaEnd - metaBegin));
+    if (meta && metaEnd - metaBegin >= 12 && std::memcmp(meta + 8, "hdlr", 4) == 0) {
+        metaBegin += 4;
+    }
+    if (!findMp4Atom(file, metaBegin, metaEnd, "ilst", ilstBegin, ilstEnd)) {
+        return;
+    }
+    
+    const qint64 length = ilstEnd - ilstBegin;
+    const uchar* ilst = file.map(ilstBegin, length);
+    if (!ilst) {
+        return;
+    }
+    struct Item {
+        const char* type;
+        QString* field;
+    };
+    const Item items[] = {{"\xa9nam", &tags.title}, {"\xa9" "ART", &tags.artist},
+                          {"\xa9" "alb", &tags.album}, {"aART", &tags.albumArtist}};
+    qint64 pos = 0;
+    while (pos <= length - 8) {
+        const qint64 size = qFromBigEndian<quint32>(ilst + pos);
+        if (size < 8 || size > length - pos) {
+            return;
+        }
+        const uchar* item = ilst + pos;
+        pos += size;
+        
+        // The item's first child: data size, "data", type, locale, value
+        if (size < 24 || std::memcmp(item + 12, "data", 4) != 0) {
+            continue;
+        }
+        const qint64 dataSize = qMin<qint64>(qFromBigEndian<quint32>(item + 8), size - 8);
+        const quint32 valueType = qFromBigEndian<quint32>(item + 16) & 0xffffff;
+        if (dataSize < 16 || (valueType != 1 && valueType != 2)) {
+            continue;
+        }
+        const uchar* value = item + 24;
+        const qint64 valueLength = dataSize - 16;
+        for (const Item& known : items) {
+            if (std::memcmp(item + 4, known.type, 4) == 0) {
+                setIfEmpty(*known.field, valueType == 1
+                    ? QString::fromUtf8(reinterpret_cast<const char*>(value), int(valueLength)).trimmed()
+                    : decodeUtf16(value, valueLength, true).trimmed());
+                break;
+            }
+        }
+    }
+}
+
+} // namespace
+
+MediaTags MediaTagReader::read(const QString& filePath)
+{
+    MappedFile file(filePath);
+    return read(file);
+}
+
+MediaTags MediaTagReader::read(MappedFile& file)
+{
+    MediaTags tags;
+    const uchar* magic = file.map(0, 12);
+    if (!magic) {
+        return tags;
+    }
+    
+    if (std::memcmp(magic, "ID3", 3) == 0) {
+        readId3v2(file, tags);
+        readId3v1(file, tags);
+    } else if (std::memcmp(magic, "fLaC", 4) == 0) {
+        readFlac(file, tags);
+    } else if (std::memcmp(magic, "OggS", 4) == 0) {
+        readOgg(file, tags);
+    } else if (std::memcmp(magic + 4, "ftyp", 4) == 0) {
+        readMp4(file, tags);
+    } else {
+        readId3v1(file, tags);
+    }
+    return tags;
+}
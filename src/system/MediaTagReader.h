@@ -0,0 +1,41 @@
+#ifndef MEDIATAGREADER_H
+#define MEDIATAGREADER_H
+
+#include <QString>
+
+class MappedFile;
+
+struct MediaTags {
+    QString title;
+    QString artist;
+    QString album;
+    QString albumArtist;
+    
+    bool isEmpty() const { return title.isEmpty() && artist.isEmpty() && album.isEmpty() && albumArtist.isEmpty(); }
+};
+
+// Title, artist and album from the tags embedded in audio files.
+//
+//   MP3       : ID3v2.2/2.3/2.4 at the start, ID3v1 in the last 128 bytes
+//   FLAC      : VORBIS_COMMENT metadata block
+//   Ogg       : Vorbis, Opus and Ogg FLAC comment packets
+//   M4A / MP4 : moov/udta/meta/ilst items
+//
+// The format is told from the file's first bytes, not its name. Only the
+// tag regions are mapped (MappedFile) and only the frames and atoms that
+// carry these fields are decoded; cover art and audio are skipped by their
+// sizes, never read. Fields the file does not carry are left empty.
+class MediaTagReader
+{
+public:
+    // Stops collecting an Ogg comment packet beyond this; the fields come
+    // before any embedded picture
+    static const int MAX_OGG_PACKET_BYTES = 64 * 1024;
+    static const int MAX_OGG_PAGES = 16;
+    
+    static MediaTags read(const QString& filePath);
+    // Through a file already open, e.g. shared with MediaDurationReader
+    static MediaTags read(MappedFile& file);
+};
+
+#endif // MEDIATAGREADER_H
@@ -1,11 +1,19 @@
 #include "MockI2C.h"
 #include "Logger.h"
+#include "FastClock.h"
 #include <QStandardPaths>
 #include <QJsonArray>
 #include <QDateTime>
+#include <QFileInfo>
+#include <chrono>
 #include <cmath>
+#include <limits>
+#include <numeric>
+#include <thread>
 
 const QString MockI2C::CONFIG_FILE = "config/i2c_calibration.json";
+const QString MockI2C::SENSOR_LOG_FILE = "config/sensor_data.series";
+const QString MockI2C::LEGACY_SENSOR_LOG_FILE = "config/sensor_data.json";
 
 MockI2C::MockI2C()
     : m_randomGenerator(std::random_device{}())
@@ -13,6 +21,7 @@ MockI2C::MockI2C()
     , m_humidityDist(40.0, 60.0)
     , m_pressureDist(1013.0, 1013.5)
     , m_lightDist(100.0, 1000.0)
+    , m_deviceAddress(0)
     , m_isConnected(false)
     , m_simulateConnectionError(false)
     , m_simulateSensorFailure(false)
@@ -26,10 +35,30 @@ MockI2C::MockI2C()
     , m_humidityMin(40.0), m_humidityMax(60.0)
     , m_pressureMin(1013.0), m_pressureMax(1013.5)
     , m_lightMin(100.0), m_lightMax(1000.0)
-{
+    , m_acquisitionRing(ACQUISITION_RING_CAPACITY)
+    , m_acquisitionRunning(false)
+    , m_acquisitionRateHz(0)
+    , m_acquiredSamples(0)
+    , m_missedDeadlines(0)
+    , m_droppedSamples(0)
+    , m_jitterSumNs(0)
+    , m_maxJitterNs(0)
+{
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        m_scheduler.setInterval(static_cast<SensorChannel>(c), DEFAULT_UPDATE_INTERVAL_MS);
+    }
+    
     m_updateTimer = std::make_unique<QTimer>(this);
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setTimerType(Qt::PreciseTimer);
     connect(m_updateTimer.get(), &QTimer::timeout, this, &MockI2C::updateSensorData);
     
+    m_deliveryTimer = std::make_unique<QTimer>(this);
+    connect(m_deliveryTimer.get(), &QTimer::timeout, this, &MockI2C::deliverAcquiredSamples);
+    
+    m_replayTimer = std::make_unique<QTimer>(this);
+    connect(m_replayTimer.get(), &QTimer::timeout, this, &MockI2C::replayDueSamples);
+    
     // Load calibration data
     loadCalibrationData();
     
@@ -38,6 +67,8 @@ MockI2C::MockI2C()
 
 MockI2C::~MockI2C()
 {
+    stopAcquisition();
+    stopRecording();
     if (m_dataLoggingEnabled) {
         saveCalibrationData();
     }
@@ -58,11 +89,21 @@ bool MockI2C::begin(uint8_t address)
         return false;
     }
     
+    if (m_deviceAddress != address) {
+        m_bus.detach(m_deviceAddress);
+        if (!m_bus.attach(std::make_unique<I2CDevice>(address, "MockI2C sensor", sensorRegisterMap()))) {
+            LOG_ERROR("MockI2C", QString("Invalid I2C address 0x%1").arg(address, 0, 16));
+            m_deviceAddress = 0;
+            return false;
+        }
+        m_deviceAddress = address;
+    }
+    
     m_isConnected = true;
     LOG_INFO("MockI2C", QString("Connected to I2C device at address 0x%1").arg(address, 0, 16));
     
     // Start periodic updates
-    m_updateTimer->start(5000); // Update every 5 seconds
+    startScheduledUpdates();
     
     return true;
 }
@@ -73,29 +114,18 @@ bool MockI2C::isConnected() const
 }
 
 uint8_t MockI2C::readRegister(uint8_t reg)
+{
+    uint8_t value = 0;
+    return readRegisters(reg, &value, 1) ? value : 0;
+}
+
+bool MockI2C::readRegisters(uint8_t reg, uint8_t* data, int length)
 {
     if (!isConnected()) {
         LOG_ERROR("MockI2C", "Cannot read register - device not connected");
-        return 0;
-    }
-    
-    // Simulate different register values based on sensor data
-    switch (reg) {
-        case 0x00: // Temperature register
-            return static_cast<uint8_t>(m_currentData.temperature * 2);
-        case 0x01: // Humidity register
-            return static_cast<uint8_t>(m_currentData.humidity * 2.55);
-        case 0x02: // Pressure register (high byte)
-            return static_cast<uint8_t>((static_cast<int>(m_currentData.pressure) >> 8) & 0xFF);
-        case 0x03: // Pressure register (low byte)
-            return static_cast<uint8_t>(static_cast<int>(m_currentData.pressure) & 0xFF);
-        case 0x04: // Light register (high byte)
-            return static_cast<uint8_t>((static_cast<int>(m_currentData.lightLevel) >> 8) & 0xFF);
-        case 0x05: // Light register (low byte)
-            return static_cast<uint8_t>(static_cast<int>(m_currentData.lightLevel) & 0xFF);
-        default:
-            return 0;
+        return false;
     }
+    return m_bus.read(m_deviceAddress, reg, data, length) == I2CStatus::Ok;
 }
 
 bool MockI2C::writeRegister(uint8_t reg, uint8_t value)
@@ -106,7 +136,26 @@ bool MockI2C::writeRegister(uint8_t reg, uint8_t value)
     }
     
     LOG_DEBUG("MockI2C", QString("Writing 0x%1 to register 0x%2").arg(value, 0, 16).arg(reg, 0, 16));
-    return true;
+    return m_bus.write(m_deviceAddress, reg, &value, 1) == I2CStatus::Ok;
+}
+
+I2CBus& MockI2C::bus()
+{
+    return m_bus;
+}
+
+QVector<I2CRegisterSpec> MockI2C::sensorRegisterMap()
+{
+    // Scaled readings as the old fixed register switch produced them
+    return {
+        {0x00, "TEMPERATURE", 1, I2CAccess::ReadOnly, 0},   // Celsius * 2
+        {0x01, "HUMIDITY", 1, I2CAccess::ReadOnly, 0},      // Percent * 2.55
+        {0x02, "PRESSURE", 2, I2CAccess::ReadOnly, 0},      // hPa
+        {0x04, "LIGHT", 2, I2CAccess::ReadOnly, 0},         // lux
+        {0x0F, "WHO_AM_I", 1, I2CAccess::ReadOnly, 0xA5},
+        {0x10, "CONFIG", 1, I2CAccess::ReadWrite, 0x00},
+        {0x11, "THRESHOLD", 2, I2CAccess::ReadWrite, 0x0000}
+    };
 }
 
 SensorData MockI2C::getCurrentData() const
@@ -134,44 +183,292 @@ double MockI2C::getLightLevel() const
     return m_currentData.lightLevel;
 }
 
+const SensorHistory& MockI2C::history() const
+{
+    return m_history;
+}
+
+void MockI2C::setPublishPolicy(SensorChannel channel, const SensorPublishPolicy& policy)
+{
+    m_publishFilter.setPolicy(channel, policy);
+}
+
+void MockI2C::setPublishPolicy(const SensorPublishPolicy& policy)
+{
+    m_publishFilter.setPolicy(policy);
+}
+
+SensorPublishStats MockI2C::getPublishStats() const
+{
+    return m_publishFilter.stats();
+}
+
+bool MockI2C::startAcquisition(int rateHz, int deliveryHz)
+{
+    if (!isConnected()) {
+        LOG_ERROR("MockI2C", "Cannot start acquisition - device not connected");
+        return false;
+    }
+    if (rateHz <= 0 || rateHz > MAX_ACQUISITION_RATE_HZ) {
+        LOG_ERROR("MockI2C", QString("Acquisition rate %1 Hz out of range (1-%2 Hz)")
+                  .arg(rateHz).arg(MAX_ACQUISITION_RATE_HZ));
+        return false;
+    }
+    
+    stopReplay();
+    stopAcquisition();
+    stopScheduledUpdates();
+    
+    m_acquiredSamples.store(0);
+    m_missedDeadlines.store(0);
+    m_droppedSamples.store(0);
+    m_jitterSumNs.store(0);
+    m_maxJitterNs.store(0);
+    m_acquisitionRateHz = rateHz;
+    m_acquisitionFilter.reset();
+    m_sinceStatsLog.start();
+    
+    m_acquisitionRunning.store(true);
+    m_acquisitionThread.reset(QThread::create([this, rateHz]() { acquisitionLoop(rateHz); }));
+    m_acquisitionThread->setObjectName("MockI2CAcquisition");
+    m_acquisitionThread->start(QThread::TimeCriticalPriority);
+    
+    const int delivery = qBound(1, deliveryHz, rateHz);
+    m_deliveryTimer->start(1000 / delivery);
+    LOG_INFO("MockI2C", QString("Acquisition started at %1 Hz, UI updates at %2 Hz").arg(rateHz).arg(delivery));
+    return true;
+}
+
+void MockI2C::stopAcquisition()
+{
+    if (!m_acquisitionThread) {
+        return;
+    }
+    
+    m_acquisitionRunning.store(false);
+    m_acquisitionThread->wait();
+    m_acquisitionThread.reset();
+    m_deliveryTimer->stop();
+    
+    // Hand over whatever is still in the ring
+    deliverAcquiredSamples();
+    logAcquisitionStats();
+    m_acquisitionRateHz = 0;
+    
+    if (m_isConnected) {
+        startScheduledUpdates();
+    }
+    LOG_INFO("MockI2C", "Acquisition stopped");
+}
+
+bool MockI2C::isAcquiring() const
+{
+    return m_acquisitionThread != nullptr;
+}
+
+AcquisitionStats MockI2C::getAcquisitionStats() const
+{
+    AcquisitionStats stats;
+    stats.rateHz = m_acquisitionRateHz;
+    stats.samples = m_acquiredSamples.load(std::memory_order_relaxed);
+    stats.missedDeadlines = m_missedDeadlines.load(std::memory_order_relaxed);
+    stats.droppedSamples = m_droppedSamples.load(std::memory_order_relaxed);
+    if (stats.samples > 0) {
+        stats.meanJitterUs = m_jitterSumNs.load(std::memory_order_relaxed) / 1000.0 / stats.samples;
+    }
+    stats.maxJitterUs = m_maxJitterNs.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+void MockI2C::setAcquisitionFilter(const SensorFilter& filter)
+{
+    m_acquisitionFilter = filter;
+    m_acquisitionFilter.reset();
+}
+
+bool MockI2C::startRecording(const QString& tracePath)
+{
+    stopRecording();
+    QFile::remove(tracePath);
+    if (!m_traceRecorder.open(tracePath)) {
+        LOG_ERROR("MockI2C", "Failed to open sensor trace: " + tracePath);
+        return false;
+    }
+    LOG_INFO("MockI2C", "Recording sensor trace to " + tracePath);
+    return true;
+}
+
+void MockI2C::stopRecording()
+{
+    if (!m_traceRecorder.isOpen()) {
+        return;
+    }
+    m_traceRecorder.flush();
+    LOG_INFO("MockI2C", QString("Sensor trace recorded: %1 samples").arg(m_traceRecorder.size()));
+    m_traceRecorder.close();
+}
+
+bool MockI2C::isRecording() const
+{
+    return m_traceRecorder.isOpen();
+}
+
+bool MockI2C::startReplay(const QString& tracePath, double speed)
+{
+    stopReplay();
+    if (!m_tracePlayer.open(tracePath) || m_tracePlayer.size() == 0) {
+        m_tracePlayer.close();
+        LOG_ERROR("MockI2C", "Cannot replay sensor trace: " + tracePath);
+        return false;
+    }
+    
+    stopAcquisition();
+    stopScheduledUpdates();
+    m_tracePlayer.setSpeed(speed);
+    m_publishFilter.reset();
+    m_replayTimer->start(m_tracePlayer.speed() > 0.0 ? REPLAY_TICK_MS : 0);
+    LOG_INFO("MockI2C", QString("Replaying %1 samples from %2 at %3")
+             .arg(m_tracePlayer.size()).arg(tracePath)
+             .arg(speed > 0.0 ? QString("%1x").arg(speed) : QString("full speed")));
+    return true;
+}
+
+void MockI2C::stopReplay()
+{
+    if (!m_tracePlayer.isOpen()) {
+        return;
+    }
+    m_replayTimer->stop();
+    m_tracePlayer.close();
+    if (m_isConnected) {
+        startScheduledUpdates();
+    }
+    LOG_INFO("MockI2C", "Replay stopped");
+}
+
+bool MockI2C::isReplaying() const
+{
+    return m_tracePlayer.isOpen();
+}
+
+void MockI2C::setReplaySpeed(double speed)
+{
+    if (!isReplaying()) {
+        return;
+    }
+    m_tracePlayer.setSpeed(speed);
+    m_replayTimer->setInterval(m_tracePlayer.speed() > 0.0 ? REPLAY_TICK_MS : 0);
+}
+
+bool MockI2C::seekReplay(qint64 timestamp)
+{
+    return isReplaying() && m_tracePlayer.seek(timestamp);
+}
+
+qint64 MockI2C::replayPosition() const
+{
+    return isReplaying() ? m_tracePlayer.position() : 0;
+}
+
 void MockI2C::setUpdateInterval(int milliseconds)
 {
-    if (m_updateTimer->isActive()) {
-        m_updateTimer->stop();
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        m_scheduler.setInterval(static_cast<SensorChannel>(c), milliseconds);
+    }
+    // Takes effect when acquisition or replay stops
+    if (!isAcquiring() && !isReplaying()) {
+        startScheduledUpdates();
     }
-    m_updateTimer->start(milliseconds);
     LOG_INFO("MockI2C", QString("Update interval set to %1 ms").arg(milliseconds));
 }
 
+void MockI2C::setChannelInterval(SensorChannel channel, int milliseconds)
+{
+    m_scheduler.setInterval(channel, milliseconds);
+    // Stopped during acquisition and replay, which restart it when they end
+    if (m_scheduler.isActive()) {
+        armUpdateTimer();
+    }
+    LOG_INFO("MockI2C", QString("Channel %1 sampling interval set to %2 ms")
+             .arg(static_cast<int>(channel)).arg(milliseconds));
+}
+
+int MockI2C::channelInterval(SensorChannel channel) const
+{
+    return static_cast<int>(m_scheduler.interval(channel));
+}
+
+void MockI2C::setSignalModel(std::unique_ptr<SensorSignalModel> model)
+{
+    const QString name = model ? QString("%1 (seed %2)").arg(model->name()).arg(model->seed()) : QString("uniform");
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_signalModel = std::move(model);
+        if (m_signalModel) {
+            // The dashboard shows the vehicle's day, not UTC's
+            m_signalModel->setLocalTime(true);
+            m_signalModel->setHvac(m_hvacState);
+        }
+    }
+    LOG_INFO("MockI2C", "Signal model set to " + name);
+}
+
+void MockI2C::setSeed(quint64 seed)
+{
+    QMutexLocker locker(&m_configMutex);
+    m_randomGenerator.seed(static_cast<std::mt19937::result_type>(seed));
+}
+
+void MockI2C::setHvacState(const HvacState& state)
+{
+    QMutexLocker locker(&m_configMutex);
+    m_hvacState = state;
+    if (m_signalModel) {
+        m_signalModel->setHvac(state);
+    }
+}
+
 void MockI2C::setTemperatureRange(double min, double max)
 {
-    m_tempMin = min;
-    m_tempMax = max;
-    m_tempDist = std::uniform_real_distribution<double>(min, max);
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_tempMin = min;
+        m_tempMax = max;
+        m_tempDist = std::uniform_real_distribution<double>(min, max);
+    }
     LOG_INFO("MockI2C", QString("Temperature range set to %1-%2°C").arg(min).arg(max));
 }
 
 void MockI2C::setHumidityRange(double min, double max)
 {
-    m_humidityMin = min;
-    m_humidityMax = max;
-    m_humidityDist = std::uniform_real_distribution<double>(min, max);
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_humidityMin = min;
+        m_humidityMax = max;
+        m_humidityDist = std::uniform_real_distribution<double>(min, max);
+    }
     LOG_INFO("MockI2C", QString("Humidity range set to %1-%2%%").arg(min).arg(max));
 }
 
 void MockI2C::setPressureRange(double min, double max)
 {
-    m_pressureMin = min;
-    m_pressureMax = max;
-    m_pressureDist = std::uniform_real_distribution<double>(min, max);
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_pressureMin = min;
+        m_pressureMax = max;
+        m_pressureDist = std::uniform_real_distribution<double>(min, max);
+    }
     LOG_INFO("MockI2C", QString("Pressure range set to %1-%2 hPa").arg(min).arg(max));
 }
 
 void MockI2C::setLightRange(double min, double max)
 {
-    m_lightMin = min;
-    m_lightMax = max;
-    m_lightDist = std::uniform_real_distribution<double>(min, max);
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_lightMin = min;
+        m_lightMax = max;
+        m_lightDist = std::uniform_real_distribution<double>(min, max);
+    }
     LOG_INFO("MockI2C", QString("Light range set to %1-%2 lux").arg(min).arg(max));
 }
 
@@ -209,38 +506,66 @@ void MockI2C::simulateDataCorruption(bool enable)
 
 void MockI2C::calibrateTemperature(double offset)
 {
-    m_tempOffset = offset;
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_tempOffset = offset;
+    }
     LOG_INFO("MockI2C", QString("Temperature calibration offset set to %1°C").arg(offset));
     emit calibrationChanged();
 }
 
 void MockI2C::calibrateHumidity(double offset)
 {
-    m_humidityOffset = offset;
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_humidityOffset = offset;
+    }
     LOG_INFO("MockI2C", QString("Humidity calibration offset set to %1%%").arg(offset));
     emit calibrationChanged();
 }
 
 void MockI2C::calibratePressure(double offset)
 {
-    m_pressureOffset = offset;
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_pressureOffset = offset;
+    }
     LOG_INFO("MockI2C", QString("Pressure calibration offset set to %1 hPa").arg(offset));
     emit calibrationChanged();
 }
 
 void MockI2C::calibrateLight(double offset)
 {
-    m_lightOffset = offset;
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_lightOffset = offset;
+    }
     LOG_INFO("MockI2C", QString("Light calibration offset set to %1 lux").arg(offset));
     emit calibrationChanged();
 }
 
 void MockI2C::enableDataLogging(bool enable)
 {
+    if (enable && !m_sensorLog.isOpen()) {
+        QDir().mkpath(QFileInfo(SENSOR_LOG_FILE).absolutePath());
+        if (!m_sensorLog.open(SENSOR_LOG_FILE)) {
+            LOG_ERROR("MockI2C", QString("Failed to open sensor log %1").arg(SENSOR_LOG_FILE));
+            return;
+        }
+        migrateLegacyLog();
+    } else if (!enable) {
+        m_sensorLog.close();
+    }
+    
     m_dataLoggingEnabled = enable;
     LOG_INFO("MockI2C", QString("Data logging %1").arg(enable ? "enabled" : "disabled"));
 }
 
+const SensorSeriesStore& MockI2C::sensorLog() const
+{
+    return m_sensorLog;
+}
+
 void MockI2C::saveCalibrationData()
 {
     QJsonObject config;
@@ -266,6 +591,7 @@ void MockI2C::loadCalibrationData()
 {
     QFile file(CONFIG_FILE);
     if (file.open(QIODevice::ReadOnly)) {
+        QMutexLocker locker(&m_configMutex);
         QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
         QJsonObject config = doc.object();
         
@@ -287,87 +613,332 @@ void MockI2C::loadCalibrationData()
 
 void MockI2C::updateSensorData()
 {
+    const quint32 due = m_scheduler.takeDue(FastClock::monotonicNs() / 1000000);
+    armUpdateTimer();
+    if (due == 0) {
+        return;
+    }
+    
     if (m_simulateSensorFailure) {
-        m_currentData.isValid = false;
-        LOG_ERROR("MockI2C", "Sensor failure detected - invalid data");
-        emit sensorError("Sensor failure - invalid readings");
+        reportSensorFailure();
         return;
     }
     
-    generateRandomData();
-    applyCalibration();
+    // Channels not due keep their last reading
+    SensorSample sample = readSensors(FastClock::wallMs());
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        if (!(due & (1u << c)) && m_currentData.isValid) {
+            sample.values[c] = m_latestSample.values[c];
+        }
+    }
+    // The sensor log keeps whole rows, so it holds the repeats too
+    if (m_dataLoggingEnabled) {
+        logData(sample);
+    }
+    publish(sample, m_currentData.isValid ? due : SensorScheduler::ALL_CHANNELS);
+}
+
+void MockI2C::replayDueSamples()
+{
+    m_replayBatch.clear();
+    m_tracePlayer.takeDue(FastClock::monotonicNs(), m_replayBatch, REPLAY_BATCH_SAMPLES);
+    for (const SensorSample& sample : m_replayBatch) {
+        publish(sample);
+    }
     
-    m_currentData.timestamp = getCurrentTimestamp();
-    m_currentData.isValid = true;
+    if (m_tracePlayer.atEnd()) {
+        LOG_INFO("MockI2C", "Sensor trace replay finished");
+        stopReplay();
+        emit replayFinished();
+    }
+}
+
+void MockI2C::deliverAcquiredSamples()
+{
+    if (m_simulateSensorFailure) {
+        SensorSample discarded;
+        while (m_acquisitionRing.tryPop(discarded)) {
+        }
+        // Report the failure once, not at the delivery rate
+        if (m_currentData.isValid) {
+            reportSensorFailure();
+        }
+        return;
+    }
     
-    if (m_dataLoggingEnabled) {
-        logData();
+    SensorSample sample;
+    m_deliveryBlock.clear();
+    while (m_acquisitionRing.tryPop(sample)) {
+        m_deliveryBlock.append(sample);
     }
     
-    LOG_DEBUG("MockI2C", QString("Sensor data updated: T=%1°C, H=%2%%, P=%3 hPa, L=%4 lux")
-              .arg(m_currentData.temperature, 0, 'f', 1)
-              .arg(m_currentData.humidity, 0, 'f', 1)
-              .arg(m_currentData.pressure, 0, 'f', 1)
-              .arg(m_currentData.lightLevel, 0, 'f', 0));
+    const int count = m_deliveryBlock.size();
+    if (count > 0) {
+        SensorCalibration batchCalibration;
+        {
+            QMutexLocker locker(&m_configMutex);
+            batchCalibration = calibration();
+        }
+        SensorBatch::calibrate(m_deliveryBlock, batchCalibration);
+        m_acquisitionFilter.process(m_deliveryBlock);
+        
+        if (m_dataLoggingEnabled) {
+            for (int i = 0; i < count; ++i) {
+                logData(m_deliveryBlock.sample(i));
+            }
+        }
+        
+        // Boxcar decimation: the UI gets the mean of the window, stamped
+        // with the newest sample
+        SensorSample mean;
+        for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+            const std::vector<double>& column = m_deliveryBlock.values[c];
+            mean.values[c] = std::accumulate(column.begin(), column.end(), 0.0) / count;
+        }
+        mean.timestamp = m_deliveryBlock.timestamps.last();
+        publish(mean);
+    }
     
-    emit dataUpdated(m_currentData);
+    if (m_sinceStatsLog.isValid() && m_sinceStatsLog.elapsed() >= STATS_LOG_INTERVAL_MS) {
+        logAcquisitionStats();
+        m_sinceStatsLog.restart();
+    }
 }
 
-void MockI2C::generateRandomData()
+void MockI2C::acquisitionLoop(int rateHz)
 {
-    m_currentData.temperature = m_tempDist(m_randomGenerator);
-    m_currentData.humidity = m_humidityDist(m_randomGenerator);
-    m_currentData.pressure = m_pressureDist(m_randomGenerator);
-    m_currentData.lightLevel = m_lightDist(m_randomGenerator);
+    using Clock = std::chrono::steady_clock;
+    const std::chrono::nanoseconds period(1000000000LL / rateHz);
     
-    if (m_simulateDataCorruption) {
-        // Add some noise to simulate data corruption
-        m_currentData.temperature += (m_randomGenerator() % 100 - 50) * 0.1;
-        m_currentData.humidity += (m_randomGenerator() % 100 - 50) * 0.1;
+    // Absolute deadlines, so sleep overshoot does not accumulate as drift
+    Clock::time_point deadline = Clock::now() + period;
+    while (m_acquisitionRunning.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_until(deadline);
+        
+        if (!m_simulateSensorFailure.load(std::memory_order_relaxed)) {
+            const qint64 lateNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - deadline).count();
+            const quint64 jitterNs = static_cast<quint64>(qMax<qint64>(0, lateNs));
+            m_jitterSumNs.fetch_add(jitterNs, std::memory_order_relaxed);
+            if (jitterNs > m_maxJitterNs.load(std::memory_order_relaxed)) {
+                m_maxJitterNs.store(jitterNs, std::memory_order_relaxed);
+            }
+            
+            // Calibrated in bulk on delivery
+            const SensorSample sample = readRawSensors(FastClock::wallMs());
+            if (!m_acquisitionRing.tryPush(sample)) {
+                m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_acquiredSamples.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        // A full period or more behind: skip the lost slots instead of
+        // bursting to catch up
+        deadline += period;
+        const Clock::time_point now = Clock::now();
+        if (now >= deadline) {
+            const qint64 behind = (now - deadline) / period + 1;
+            m_missedDeadlines.fetch_add(static_cast<quint64>(behind), std::memory_order_relaxed);
+            deadline += period * behind;
+        }
     }
 }
 
-void MockI2C::applyCalibration()
+void MockI2C::logAcquisitionStats()
+{
+    const AcquisitionStats stats = getAcquisitionStats();
+    LOG_INFO_FMT("MockI2C", "Acquisition at %1 Hz: %2 samples, %3 missed deadlines, %4 dropped, jitter mean %5 us, max %6 us",
+                 stats.rateHz, stats.samples, stats.missedDeadlines, stats.droppedSamples,
+                 std::round(stats.meanJitterUs), std::round(stats.maxJitterUs));
+}
+
+SensorSample MockI2C::readSensors(qint64 timestamp)
 {
-    m_currentData.temperature += m_tempOffset;
-    m_currentData.humidity += m_humidityOffset;
-    m_currentData.pressure += m_pressureOffset;
-    m_currentData.lightLevel += m_lightOffset;
+    SensorSample sample;
+    sample.timestamp = timestamp;
     
-    // Clamp values to reasonable ranges
-    m_currentData.temperature = std::clamp(m_currentData.temperature, -40.0, 80.0);
-    m_currentData.humidity = std::clamp(m_currentData.humidity, 0.0, 100.0);
-    m_currentData.pressure = std::clamp(m_currentData.pressure, 800.0, 1200.0);
-    m_currentData.lightLevel = std::clamp(m_currentData.lightLevel, 0.0, 10000.0);
+    QMutexLocker locker(&m_configMutex);
+    generateRandomData(sample);
+    applyCalibration(sample);
+    return sample;
 }
 
-void MockI2C::logData()
+SensorSample MockI2C::readRawSensors(qint64 timestamp)
 {
-    QJsonObject dataPoint;
-    dataPoint["timestamp"] = m_currentData.timestamp;
-    dataPoint["temperature"] = m_currentData.temperature;
-    dataPoint["humidity"] = m_currentData.humidity;
-    dataPoint["pressure"] = m_currentData.pressure;
-    dataPoint["light_level"] = m_currentData.lightLevel;
+    SensorSample sample;
+    sample.timestamp = timestamp;
     
-    // Append to log file
-    QFile logFile("config/sensor_data.json");
-    QJsonArray dataArray;
+    QMutexLocker locker(&m_configMutex);
+    generateRandomData(sample);
+    return sample;
+}
+
+void MockI2C::generateRandomData(SensorSample& sample)
+{
+    if (m_signalModel) {
+        m_signalModel->generate(sample);
+    } else {
+        sample.setValue(SensorChannel::Temperature, m_tempDist(m_randomGenerator));
+        sample.setValue(SensorChannel::Humidity, m_humidityDist(m_randomGenerator));
+        sample.setValue(SensorChannel::Pressure, m_pressureDist(m_randomGenerator));
+        sample.setValue(SensorChannel::Light, m_lightDist(m_randomGenerator));
+    }
     
-    if (logFile.exists() && logFile.open(QIODevice::ReadOnly)) {
-        QJsonDocument doc = QJsonDocument::fromJson(logFile.readAll());
-        dataArray = doc.array();
-        logFile.close();
+    if (m_simulateDataCorruption) {
+        // Add some noise to simulate data corruption
+        sample.setValue(SensorChannel::Temperature, sample.value(SensorChannel::Temperature)
+                        + (m_randomGenerator() % 100 - 50) * 0.1);
+        sample.setValue(SensorChannel::Humidity, sample.value(SensorChannel::Humidity)
+                        + (m_randomGenerator() % 100 - 50) * 0.1);
+    }
+}
+
+void MockI2C::applyCalibration(SensorSample& sample)
+{
+    SensorBatch::calibrate(sample, calibration());
+}
+
+SensorCalibration MockI2C::calibration() const
+{
+    // Clamp ranges are SensorCalibration's defaults
+    SensorCalibration calibration;
+    calibration.offsets[static_cast<int>(SensorChannel::Temperature)] = m_tempOffset;
+    calibration.offsets[static_cast<int>(SensorChannel::Humidity)] = m_humidityOffset;
+    calibration.offsets[static_cast<int>(SensorChannel::Pressure)] = m_pressureOffset;
+    calibration.offsets[static_cast<int>(SensorChannel::Light)] = m_lightOffset;
+    return calibration;
+}
+
+void MockI2C::startScheduledUpdates()
+{
+    m_scheduler.start(FastClock::monotonicNs() / 1000000);
+    armUpdateTimer();
+}
+
+void MockI2C::stopScheduledUpdates()
+{
+    // The scheduler too, or an interval change would re-arm the timer
+    m_scheduler.stop();
+    m_updateTimer->stop();
+}
+
+void MockI2C::armUpdateTimer()
+{
+    const qint64 deadline = m_scheduler.nextDeadline();
+    if (deadline == std::numeric_limits<qint64>::max()) {
+        m_updateTimer->stop();
+        return;
+    }
+    const qint64 delay = deadline - FastClock::monotonicNs() / 1000000;
+    m_updateTimer->start(static_cast<int>(qBound<qint64>(0, delay, std::numeric_limits<int>::max())));
+}
+
+void MockI2C::publish(const SensorSample& sample, quint32 freshChannels)
+{
+    m_currentData.temperature = sample.value(SensorChannel::Temperature);
+    m_currentData.humidity = sample.value(SensorChannel::Humidity);
+    m_currentData.pressure = sample.value(SensorChannel::Pressure);
+    m_currentData.lightLevel = sample.value(SensorChannel::Light);
+    m_currentData.timestamp = FastClock::formatTimestamp(sample.timestamp);
+    m_currentData.isValid = true;
+    qint64* const updated[SensorSample::CHANNEL_COUNT] = {
+        &m_currentData.temperatureUpdatedMs, &m_currentData.humidityUpdatedMs,
+        &m_currentData.pressureUpdatedMs, &m_currentData.lightLevelUpdatedMs
+    };
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        if (freshChannels & (1u << c)) {
+            *updated[c] = sample.timestamp;
+        }
+    }
+    m_latestSample = sample;
+    updateRegisters();
+    checkForAnomalies(sample, freshChannels);
+    m_history.add(sample, freshChannels);
+    // Traces store whole samples, repeats included; a replay publishes each
+    // as fresh
+    if (m_traceRecorder.isOpen()) {
+        m_traceRecorder.append(sample);
+        m_traceRecorder.flushIfDue();
+    }
+    if (!m_publishFilter.accept(sample)) {
+        return;
     }
     
-    dataArray.append(dataPoint);
+    // Rounded to the precision of the former text. Deferred rendering uses
+    // 'g', so whole values lose their trailing zero: 23.0 prints as 23
+    LOG_DEBUG_FMT("MockI2C", "Sensor data updated: T=%1°C, H=%2%%, P=%3 hPa, L=%4 lux",
+                  std::round(m_currentData.temperature * 10.0) / 10.0,
+                  std::round(m_currentData.humidity * 10.0) / 10.0,
+                  std::round(m_currentData.pressure * 10.0) / 10.0,
+                  std::round(m_currentData.lightLevel));
     
-    if (logFile.open(QIODevice::WriteOnly)) {
-        logFile.write(QJsonDocument(dataArray).toJson());
+    emit dataUpdated(m_currentData);
+}
+
+void MockI2C::updateRegisters()
+{
+    I2CDevice* sensor = m_bus.device(m_deviceAddress);
+    if (!sensor) {
+        return;
     }
+    sensor->setValue(0x00, static_cast<uint8_t>(m_currentData.temperature * 2));
+    sensor->setValue(0x01, static_cast<uint8_t>(m_currentData.humidity * 2.55));
+    sensor->setValue(0x02, static_cast<quint16>(static_cast<int>(m_currentData.pressure)));
+    sensor->setValue(0x04, static_cast<quint16>(static_cast<int>(m_currentData.lightLevel)));
+}
+
+void MockI2C::reportSensorFailure()
+{
+    m_currentData.isValid = false;
+    // The first valid reading after the failure always goes out
+    m_publishFilter.reset();
+    LOG_ERROR("MockI2C", "Sensor failure detected - invalid data");
+    emit sensorError("Sensor failure - invalid readings");
 }
 
-QString MockI2C::getCurrentTimestamp() const
+void MockI2C::checkForAnomalies(const SensorSample& sample, quint32 freshChannels)
 {
-    return QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-} 
\ No newline at end of file
+    static const char* const CHANNEL_NAMES[SensorSample::CHANNEL_COUNT] = {
+        "Temperature", "Humidity", "Pressure", "Light level"
+    };
+    
+    const int window = m_history.windowCount() - 1;
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        const SensorChannel channel = static_cast<SensorChannel>(c);
+        // A repeated reading was checked when it was new
+        if (!(freshChannels & (1u << c))
+            || m_history.stats(channel, window).count < MIN_ANOMALY_SAMPLES) {
+            continue;
+        }
+        const double z = m_history.zScore(channel, sample.values[c], window);
+        if (std::abs(z) >= ANOMALY_Z_SCORE) {
+            LOG_WARNING_FMT("MockI2C", "%1 reading %2 is %3 standard deviations from the 10 minute mean",
+                            CHANNEL_NAMES[c], sample.values[c], std::round(z * 10.0) / 10.0);
+        }
+    }
+}
+
+void MockI2C::logData(const SensorSample& sample)
+{
+    m_sensorLog.append(sample);
+    m_sensorLog.flushIfDue();
+}
+
+void MockI2C::migrateLegacyLog()
+{
+    if (!QFile::exists(LEGACY_SENSOR_LOG_FILE)) {
+        return;
+    }
+    
+    const int imported = m_sensorLog.importJson(LEGACY_SENSOR_LOG_FILE);
+    if (imported < 0) {
+        LOG_WARNING("MockI2C", QString("Could not migrate %1").arg(LEGACY_SENSOR_LOG_FILE));
+        return;
+    }
+    
+    // Keep the original around, but never import it twice
+    const QString migratedPath = LEGACY_SENSOR_LOG_FILE + ".migrated";
+    QFile::remove(migratedPath);
+    QFile::rename(LEGACY_SENSOR_LOG_FILE, migratedPath);
+    LOG_INFO("MockI2C", QString("Migrated %1 samples from %2 to %3")
+             .arg(imported).arg(LEGACY_SENSOR_LOG_FILE, SENSOR_LOG_FILE));
+}
@@ -8,8 +8,22 @@
 #include <QJsonDocument>
 #include <QFile>
 #include <QDir>
+#include <QMutex>
+#include <QThread>
+#include <QElapsedTimer>
 #include <random>
 #include <memory>
+#include <atomic>
+
+#include "SensorSeriesStore.h"
+#include "SensorHistory.h"
+#include "SensorBatch.h"
+#include "SensorTracePlayer.h"
+#include "SensorSignalModel.h"
+#include "SensorPublishFilter.h"
+#include "SensorScheduler.h"
+#include "SpscRing.h"
+#include "I2CBus.h"
 
 struct SensorData {
     double temperature;    // Celsius
@@ -18,6 +32,34 @@ struct SensorData {
     double lightLevel;     // lux
     bool isValid;
     QString timestamp;
+    
+    // When each reading was last sampled, ms since epoch. Channels on slower
+    // schedules (MockI2C::setChannelInterval()) carry older readings.
+    qint64 temperatureUpdatedMs = 0;
+    qint64 humidityUpdatedMs = 0;
+    qint64 pressureUpdatedMs = 0;
+    qint64 lightLevelUpdatedMs = 0;
+    
+    qint64 updatedMs(SensorChannel channel) const
+    {
+        switch (channel) {
+            case SensorChannel::Temperature: return temperatureUpdatedMs;
+            case SensorChannel::Humidity: return humidityUpdatedMs;
+            case SensorChannel::Pressure: return pressureUpdatedMs;
+            case SensorChannel::Light: return lightLevelUpdatedMs;
+        }
+        return 0;
+    }
+};
+
+// Acquisition thread health since startAcquisition()
+struct AcquisitionStats {
+    int rateHz = 0;
+    quint64 samples = 0;
+    quint64 missedDeadlines = 0;  // Sample slots skipped because the thread woke a full period late
+    quint64 droppedSamples = 0;   // Ring full: the UI side fell behind
+    double meanJitterUs = 0.0;    // Wake-up lateness against the schedule
+    double maxJitterUs = 0.0;
 };
 
 class MockI2C : public QObject
@@ -27,11 +69,15 @@ class MockI2C : public QObject
 public:
     static MockI2C& getInstance();
     
-    // I2C-like interface
+    // I2C-like interface. The sensor is a device on a simulated bus (see
+    // sensorRegisterMap()); other devices can be attached through bus().
     bool begin(uint8_t address = 0x48);
     bool isConnected() const;
     uint8_t readRegister(uint8_t reg);
+    bool readRegisters(uint8_t reg, uint8_t* data, int length);
     bool writeRegister(uint8_t reg, uint8_t value);
+    I2CBus& bus();
+    static QVector<I2CRegisterSpec> sensorRegisterMap();
     
     // Sensor data access
     SensorData getCurrentData() const;
@@ -39,9 +85,65 @@ public:
     double getHumidity() const;
     double getPressure() const;
     double getLightLevel() const;
+    // Every sample read, with rolling 1 min and 10 min statistics
+    const SensorHistory& history() const;
+    
+    // Publishing: dataUpdated (and its debug log) only fires for samples
+    // that pass the per-channel policies; see SensorPublishFilter. Held-back
+    // samples still update getCurrentData(), the registers, the history and
+    // the logs. The default policy publishes every sample.
+    void setPublishPolicy(SensorChannel channel, const SensorPublishPolicy& policy);
+    void setPublishPolicy(const SensorPublishPolicy& policy);
+    SensorPublishStats getPublishStats() const;
+    
+    // High-rate acquisition: sampling runs on its own thread on a fixed
+    // schedule and hands samples to the GUI thread through a lock-free ring.
+    // Up to deliveryHz times a second, the mean of the samples since the
+    // last delivery is published; every sample reaches the data log.
+    // Replaces the update timer until stopAcquisition().
+    // Acquired samples are calibrated and filtered a delivery at a time
+    // through the SensorBatch vector kernels.
+    bool startAcquisition(int rateHz, int deliveryHz = 10);
+    void stopAcquisition();
+    bool isAcquiring() const;
+    AcquisitionStats getAcquisitionStats() const;
+    // Smoothing for acquired samples, pass-through by default
+    void setAcquisitionFilter(const SensorFilter& filter);
     
-    // Configuration
+    // Trace recording: every sample read, published or held back by the
+    // publish policy, is written to tracePath (replacing an existing file)
+    // until stopped
+    bool startRecording(const QString& tracePath);
+    void stopRecording();
+    bool isRecording() const;
+    
+    // Trace replay: publishes a recorded trace through dataUpdated instead
+    // of the generators, at speed times real time or as fast as possible
+    // (SensorTracePlayer::AS_FAST_AS_POSSIBLE). Stops acquisition and the
+    // update timer; live updates resume after stopReplay() or the end of
+    // the trace.
+    bool startReplay(const QString& tracePath, double speed = 1.0);
+    void stopReplay();
+    bool isReplaying() const;
+    void setReplaySpeed(double speed);
+    bool seekReplay(qint64 timestamp);
+    qint64 replayPosition() const;
+    
+    // Configuration. Each channel is sampled on its own interval, all from
+    // one timer (see SensorScheduler); channels due together are read in one
+    // pass and published as one sample, the others keeping their last
+    // reading. setUpdateInterval() sets every channel's interval.
     void setUpdateInterval(int milliseconds);
+    // 0 stops sampling the channel
+    void setChannelInterval(SensorChannel channel, int milliseconds);
+    int channelInterval(SensorChannel channel) const;
+    // Replaces the independent uniform draws below with a signal model;
+    // nullptr restores them. setSeed() makes the uniform draws and data
+    // corruption noise reproducible.
+    void setSignalModel(std::unique_ptr<SensorSignalModel> model);
+    void setSeed(quint64 seed);
+    // Forwarded to the signal model (see CabinThermalModel)
+    void setHvacState(const HvacState& state);
     void setTemperatureRange(double min, double max);
     void setHumidityRange(double min, double max);
     void setPressureRange(double min, double max);
@@ -58,8 +160,10 @@ public:
     void calibratePressure(double offset);
     void calibrateLight(double offset);
     
-    // Data logging
+    // Data logging: samples are appended to config/sensor_data.series; an
+    // old config/sensor_data.json log is imported on first use
     void enableDataLogging(bool enable);
+    const SensorSeriesStore& sensorLog() const;
     void saveCalibrationData();
     void loadCalibrationData();
 
@@ -68,6 +172,7 @@ signals:
     void connectionError(const QString& error);
     void sensorError(const QString& error);
     void calibrationChanged();
+    void replayFinished();
 
 private:
     MockI2C();
@@ -76,24 +181,50 @@ private:
     MockI2C& operator=(const MockI2C&) = delete;
     
     void updateSensorData();
-    void generateRandomData();
-    void applyCalibration();
-    void logData();
-    QString getCurrentTimestamp() const;
+    void deliverAcquiredSamples();
+    void acquisitionLoop(int rateHz);
+    void logAcquisitionStats();
+    void replayDueSamples();
+    // Thread-safe: the configuration is read under m_configMutex
+    SensorSample readSensors(qint64 timestamp);
+    SensorSample readRawSensors(qint64 timestamp);
+    void generateRandomData(SensorSample& sample);
+    void applyCalibration(SensorSample& sample);
+    // Caller holds m_configMutex
+    SensorCalibration calibration() const;
+    void startScheduledUpdates();
+    void stopScheduledUpdates();
+    void armUpdateTimer();
+    // freshChannels: SensorScheduler bits of the channels sampled for sample
+    void publish(const SensorSample& sample, quint32 freshChannels = SensorScheduler::ALL_CHANNELS);
+    void updateRegisters();
+    void reportSensorFailure();
+    void checkForAnomalies(const SensorSample& sample, quint32 freshChannels);
+    void logData(const SensorSample& sample);
+    void migrateLegacyLog();
     
-    std::unique_ptr<QTimer> m_updateTimer;
+    std::unique_ptr<QTimer> m_updateTimer;    // Single-shot, armed for the scheduler's next deadline
+    SensorScheduler m_scheduler;
+    SensorSample m_latestSample;    // Every channel's last reading
     std::mt19937 m_randomGenerator;
     std::uniform_real_distribution<double> m_tempDist;
     std::uniform_real_distribution<double> m_humidityDist;
     std::uniform_real_distribution<double> m_pressureDist;
     std::uniform_real_distribution<double> m_lightDist;
+    std::unique_ptr<SensorSignalModel> m_signalModel;
+    HvacState m_hvacState;
     
     SensorData m_currentData;
+    SensorHistory m_history;
+    SensorPublishFilter m_publishFilter;
+    I2CBus m_bus;
+    uint8_t m_deviceAddress;
     bool m_isConnected;
-    bool m_simulateConnectionError;
-    bool m_simulateSensorFailure;
-    bool m_simulateDataCorruption;
+    std::atomic<bool> m_simulateConnectionError;
+    std::atomic<bool> m_simulateSensorFailure;
+    std::atomic<bool> m_simulateDataCorruption;
     bool m_dataLoggingEnabled;
+    SensorSeriesStore m_sensorLog;
     
     // Calibration offsets
     double m_tempOffset;
@@ -107,7 +238,45 @@ private:
     double m_pressureMin, m_pressureMax;
     double m_lightMin, m_lightMax;
     
+    // Guards the generators, ranges and offsets shared with the acquisition thread
+    mutable QMutex m_configMutex;
+    
+    // High-rate acquisition
+    std::unique_ptr<QThread> m_acquisitionThread;
+    std::unique_ptr<QTimer> m_deliveryTimer;
+    SpscRing<SensorSample> m_acquisitionRing;
+    SensorBlock m_deliveryBlock;
+    SensorFilter m_acquisitionFilter;
+    std::atomic<bool> m_acquisitionRunning;
+    int m_acquisitionRateHz;
+    std::atomic<quint64> m_acquiredSamples;
+    std::atomic<quint64> m_missedDeadlines;
+    std::atomic<quint64> m_droppedSamples;
+    std::atomic<quint64> m_jitterSumNs;
+    std::atomic<quint64> m_maxJitterNs;
+    QElapsedTimer m_sinceStatsLog;
+    static const int DEFAULT_UPDATE_INTERVAL_MS = 5000;
+    static const int MAX_ACQUISITION_RATE_HZ = 1000;
+    static const int ACQUISITION_RING_CAPACITY = 4096;
+    static const int STATS_LOG_INTERVAL_MS = 10000;
+    
+    // Trace record and replay
+    SensorSeriesStore m_traceRecorder;
+    SensorTracePlayer m_tracePlayer;
+    std::unique_ptr<QTimer> m_replayTimer;
+    QVector<SensorSample> m_replayBatch;
+    static const int REPLAY_TICK_MS = 5;
+    // Per timer tick, so the event loop keeps running at any speed
+    static const int REPLAY_BATCH_SAMPLES = 1000;
+    
+    // A published value this many standard deviations from the 10 minute
+    // mean is logged as an anomaly, once the window has enough samples
+    static constexpr double ANOMALY_Z_SCORE = 6.0;
+    static const int MIN_ANOMALY_SAMPLES = 30;
+    
     static const QString CONFIG_FILE;
+    static const QString SENSOR_LOG_FILE;
+    static const QString LEGACY_SENSOR_LOG_FILE;
 };
 
 #endif // MOCKI2C_H 
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "ModuleLogLevels.h"
+
+#include <cstring>
+
+ModuleLogLevels::ModuleLogLevels()
+    : m_globalLevel(static_cast<int>(LogLevel::DEBUG))
+    , m_minLevel(static_cast<int>(LogLevel::DEBUG))
+    , m_maxLevel(static_cast<int>(LogLevel::DEBUG))
+{
+}
+
+bool ModuleLogLevels::isEnabled(LogLevel level, const char* module) const
+{
+    const int value = static_cast<int>(level);
+    if (value < m_minLevel.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (value >= m_maxLevel.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    return value >= lookup(module, static_cast<int>(std::strlen(module)));
+}
+
+bool ModuleLogLevels::isEnabled(LogLevel level, const QString& module) const
+{
+    const int value = static_cast<int>(level);
+    if (value < m_minLevel.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (value >= m_maxLevel.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    const QByteArray name = module.toUtf8();
+    return value >= lookup(name.constData(), name.size());
+}
+
+void ModuleLogLevels::setGlobalLevel(LogLevel level)
+{
+    QMutexLocker locker(&m_writeMutex);
+    m_globalLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    updateBounds();
+}
+
+LogLevel ModuleLogLevels::globalLevel() const
+{
+    return static_cast<LogLevel>(m_globalLevel.load(std::memory_order_relaxed));
+}
+
+bool ModuleLogLevels::setModuleLevel(const QString& module, LogLevel level)
+{
+    QMutexLocker locker(&m_writeMutex);
+    Slot* slot = findOrInsert(module.toUtf8());
+    if (!slot) {
+        return false;
+    }
+    slot->level.store(static_cast<int>(level), std::memory_order_relaxed);
+    updateBounds();
+    return true;
+}
+
+void ModuleLogLevels::clearModuleLevel(const QString& module)
+{
+    QMutexLocker locker(&m_writeMutex);
+    const QByteArray name = module.toUtf8();
+    const quint32 hash = hashName(name.constData(), name.size());
+    for (int probe = 0; probe < MAX_MODULES; ++probe) {
+        Slot& slot = m_slots[(hash + probe) % MAX_MODULES];
+        quint32 slotHash = slot.hash.load(std::memory_order_relaxed);
+        if (slotHash == 0) {
+            return;
+        }
+        if (slotHash == hash && slot.name == name) {
+            slot.level.store(INHERIT, std::memory_order_relaxed);
+            updateBounds();
+            return;
+        }
+    }
+}
+
+void ModuleLogLevels::clearModuleLevels()
+{
+    QMutexLocker locker(&m_writeMutex);
+    for (Slot& slot : m_slots) {
+        slot.level.store(INHERIT, std::memory_order_relaxed);
+    }
+    updateBounds();
+}
+
+LogLevel ModuleLogLevels::effectiveLevel(const QString& module) const
+{
+    const QByteArray name = module.toUtf8();
+    return static_cast<LogLevel>(lookup(name.constData(), name.size()));
+}
+
+quint32 ModuleLogLevels::hashName(const char* name, int length)
+{
+    // FNV-1a; never returns 0 so 0 can mark empty slots
+    quint32 hash = 2166136261u;
+    for (int i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+int ModuleLogLevels::lookup(const char* name, int length) const
+{
+    const quint32 hash = hashName(name, length);
+    for (int probe = 0; probe < MAX_MODULES; ++probe) {
+        const Slot& slot = m_slots[(hash + probe) % MAX_MODULES];
+        quint32 slotHash = slot.hash.load(std::memory_order_acquire);
+        if (slotHash == 0) {
+            break;
+        }
+        if (slotHash == hash && slot.name.size() == length
+            && std::memcmp(slot.name.constData(), name, length) == 0) {
+            int level = slot.level.load(std::memory_order_relaxed);
+            if (level != INHERIT) {
+                return level;
+            }
+            break;
+        }
+    }
+    return m_globalLevel.load(std::memory_order_relaxed);
+}
+
+ModuleLogLevels::Slot* ModuleLogLevels::findOrInsert(const QByteArray& name)
+{
+    const quint32 hash = hashName(name.constData(), name.size());
+    for (int probe = 0; probe < MAX_MODULES; ++probe) {
+        Slot& slot = m_slots[(hash + probe) % MAX_MODULES];
+        quint32 slotHash = slot.hash.load(std::memory_order_relaxed);
+        if (slotHash == 0) {
+            slot.name = name;
+            slot.hash.store(hash, std::memory_order_release);
+            return &slot;
+        }
+        if (slotHash == hash && slot.name == name) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+void ModuleLogLevels::updateBounds()
+{
+    int minLevel = m_globalLevel.load(std::memory_order_relaxed);
+    int maxLevel = minLevel;
+    for (const Slot& slot : m_slots) {
+        int level = slot.level.load(std::memory_order_relaxed);
+        if (level != INHERIT) {
+            minLevel = qMin(minLevel, level);
+            maxLevel = qMax(maxLevel, level);
+        }
+    }
+    m_minLevel.store(minLevel, std::memory_order_relaxed);
+    m_maxLevel.store(maxLevel, std::memory_order_relaxed);
+}
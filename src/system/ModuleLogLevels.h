@@ -0,0 +1,59 @@
+#ifndef MODULELOGLEVELS_H
+#define MODULELOGLEVELS_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+#include "LogRecord.h"
+
+// Global log threshold plus optional per-module overrides, readable without
+// a lock. Modules live in a fixed open-addressed table: a slot's name is
+// written once before its hash is published, and slots are never freed
+// (clearing an override just resets its level to "inherit"). Writers
+// serialise on a mutex.
+//
+// The lowest and highest effective thresholds are cached so most checks
+// resolve with two relaxed loads and never hash the module name.
+class ModuleLogLevels
+{
+public:
+    ModuleLogLevels();
+    
+    bool isEnabled(LogLevel level, const char* module) const;
+    bool isEnabled(LogLevel level, const QString& module) const;
+    
+    void setGlobalLevel(LogLevel level);
+    LogLevel globalLevel() const;
+    
+    // Returns false when the table is full
+    bool setModuleLevel(const QString& module, LogLevel level);
+    void clearModuleLevel(const QString& module);
+    void clearModuleLevels();
+    LogLevel effectiveLevel(const QString& module) const;
+    
+    static const int MAX_MODULES = 64;
+
+private:
+    struct Slot {
+        std::atomic<quint32> hash{0};   // 0 marks an empty slot
+        std::atomic<int> level{INHERIT};
+        QByteArray name;                // Immutable once hash is published
+    };
+    
+    static const int INHERIT = -1;
+    
+    static quint32 hashName(const char* name, int length);
+    int lookup(const char* name, int length) const;
+    Slot* findOrInsert(const QByteArray& name);
+    void updateBounds();
+    
+    Slot m_slots[MAX_MODULES];
+    std::atomic<int> m_globalLevel;
+    std::atomic<int> m_minLevel;    // Below this nothing is enabled
+    std::atomic<int> m_maxLevel;    // At or above this everything is enabled
+    QMutex m_writeMutex;
+};
+
+#endif // MODULELOGLEVELS_H
@@ -0,0 +1,301 @@
+#include "SensorBatch.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SENSORBATCH_X86 1
+#include <immintrin.h>
+#endif
+
+void SensorBlock::clear()
+{
+    timestamps.clear();
+    for (std::vector<double>& column : values) {
+        column.clear();
+    }
+}
+
+void SensorBlock::append(const SensorSample& sample)
+{
+    timestamps.append(sample.timestamp);
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        values[c].push_back(sample.values[c]);
+    }
+}
+
+SensorSample SensorBlock::sample(int index) const
+{
+    SensorSample sample;
+    sample.timestamp = timestamps[index];
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        sample.values[c] = values[c][index];
+    }
+    return sample;
+}
+
+static void calibrateScalar(double* values, int count, double offset, double min, double max)
+{
+    for (int i = 0; i < count; ++i) {
+        values[i] = std::clamp(values[i] + offset, min, max);
+    }
+}
+
+static void firScalar(const double* in, double* out, int count, const double* coefficients, int taps)
+{
+    for (int i = 0; i < count; ++i) {
+        double sum = 0.0;
+        for (int k = 0; k < taps; ++k) {
+            sum += coefficients[k] * in[i + taps - 1 - k];
+        }
+        out[i] = sum;
+    }
+}
+
+#ifdef SENSORBATCH_X86
+// max(min, x) then min(max, x) with the bound as the first operand: the
+// instructions return the second operand when either is NaN, so NaN passes
+// through exactly as in std::clamp
+
+__attribute__((target("sse2")))
+static void calibrateSse2(double* values, int count, double offset, double min, double max)
+{
+    const __m128d offsets = _mm_set1_pd(offset);
+    const __m128d lower = _mm_set1_pd(min);
+    const __m128d upper = _mm_set1_pd(max);
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d v = _mm_add_pd(_mm_loadu_pd(values + i), offsets);
+        v = _mm_min_pd(upper, _mm_max_pd(lower, v));
+        _mm_storeu_pd(values + i, v);
+    }
+    calibrateScalar(values + i, count - i, offset, min, max);
+}
+
+__attribute__((target("avx")))
+static void calibrateAvx(double* values, int count, double offset, double min, double max)
+{
+    const __m256d offsets = _mm256_set1_pd(offset);
+    const __m256d lower = _mm256_set1_pd(min);
+    const __m256d upper = _mm256_set1_pd(max);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_add_pd(_mm256_loadu_pd(values + i), offsets);
+        v = _mm256_min_pd(upper, _mm256_max_pd(lower, v));
+        _mm256_storeu_pd(values + i, v);
+    }
+    calibrateScalar(values + i, count - i, offset, min, max);
+}
+
+// Vectorized across outputs: each instruction advances 2 or 4 consecutive
+// outputs by one tap, so the sums keep the scalar order
+
+__attribute__((target("sse2")))
+static void firSse2(const double* in, double* out, int count, const double* coefficients, int taps)
+{
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d sum = _mm_setzero_pd();
+        for (int k = 0; k < taps; ++k) {
+            const __m128d x = _mm_loadu_pd(in + i + taps - 1 - k);
+            sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set1_pd(coefficients[k]), x));
+        }
+        _mm_storeu_pd(out + i, sum);
+    }
+    firScalar(in + i, out + i, count - i, coefficients, taps);
+}
+
+__attribute__((target("avx")))
+static void firAvx(const double* in, double* out, int count, const double* coefficients, int taps)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d sum = _mm256_setzero_pd();
+        for (int k = 0; k < taps; ++k) {
+            const __m256d x = _mm256_loadu_pd(in + i + taps - 1 - k);
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_set1_pd(coefficients[k]), x));
+        }
+        _mm256_storeu_pd(out + i, sum);
+    }
+    firScalar(in + i, out + i, count - i, coefficients, taps);
+}
+#endif
+
+static std::atomic<SimdLevel> s_simdLevel(SensorBatch::detectedSimdLevel());
+
+SimdLevel SensorBatch::detectedSimdLevel()
+{
+#ifdef SENSORBATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return SimdLevel::AVX;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::SSE2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel SensorBatch::simdLevel()
+{
+    return s_simdLevel.load(std::memory_order_relaxed);
+}
+
+void SensorBatch::setSimdLevel(SimdLevel level)
+{
+    s_simdLevel.store(std::min(level, detectedSimdLevel()), std::memory_order_relaxed);
+}
+
+const char* SensorBatch::simdLevelName(SimdLevel level)
+{
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE2: return "SSE2";
+        case SimdLevel::AVX: return "AVX";
+    }
+    return "unknown";
+}
+
+void SensorBatch::calibrate(SensorBlock& block, const SensorCalibration& calibration)
+{
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        calibrate(block.values[c].data(), block.size(), calibration.offsets[c],
+                  calibration.min[c], calibration.max[c]);
+    }
+}
+
+void SensorBatch::calibrate(SensorSample& sample, const SensorCalibration& calibration)
+{
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        sample.values[c] = std::clamp(sample.values[c] + calibration.offsets[c],
+                                      calibration.min[c], calibration.max[c]);
+    }
+}
+
+void SensorBatch::calibrate(double* values, int count, double offset, double min, double max)
+{
+    switch (simdLevel()) {
+#ifdef SENSORBATCH_X86
+        case SimdLevel::AVX:
+            calibrateAvx(values, count, offset, min, max);
+            return;
+        case SimdLevel::SSE2:
+            calibrateSse2(values, count, offset, min, max);
+            return;
+#endif
+        default:
+            calibrateScalar(values, count, offset, min, max);
+    }
+}
+
+void SensorBatch::fir(const double* in, double* out, int count, const double* coefficients, int taps)
+{
+    switch (simdLevel()) {
+#ifdef SENSORBATCH_X86
+        case SimdLevel::AVX:
+            firAvx(in, out, count, coefficients, taps);
+            return;
+        case SimdLevel::SSE2:
+            firSse2(in, out, count, coefficients, taps);
+            return;
+#endif
+        default:
+            firScalar(in, out, count, coefficients, taps);
+    }
+}
+
+SensorFilter::SensorFilter()
+    : m_type(Type::None)
+    , m_alpha(1.0)
+    , m_primed(false)
+{
+}
+
+SensorFilter SensorFilter::fir(const QVector<double>& coefficients)
+{
+    SensorFilter filter;
+    if (!coefficients.isEmpty()) {
+        filter.m_type = Type::Fir;
+        filter.m_coefficients.assign(coefficients.begin(), coefficients.end());
+    }
+    return filter;
+}
+
+SensorFilter SensorFilter::movingAverage(int taps)
+{
+    return taps > 1 ? fir(QVector<double>(taps, 1.0 / taps)) : SensorFilter();
+}
+
+SensorFilter SensorFilter::exponential(double alpha)
+{
+    SensorFilter filter;
+    if (alpha > 0.0 && alpha < 1.0) {
+        filter.m_type = Type::Exponential;
+        filter.m_alpha = alpha;
+    }
+    return filter;
+}
+
+SensorFilter::Type SensorFilter::type() const
+{
+    return m_type;
+}
+
+int SensorFilter::taps() const
+{
+    return static_cast<int>(m_coefficients.size());
+}
+
+void SensorFilter::reset()
+{
+    m_primed = false;
+    for (std::vector<double>& history : m_history) {
+        history.clear();
+    }
+}
+
+void SensorFilter::process(SensorBlock& block)
+{
+    const int count = block.size();
+    if (m_type == Type::None || count == 0) {
+        return;
+    }
+    
+    if (!m_primed) {
+        const int historySize = m_type == Type::Fir ? taps() - 1 : 1;
+        for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+            m_history[c].assign(historySize, block.values[c][0]);
+        }
+        m_primed = true;
+    }
+    
+    if (m_type == Type::Fir) {
+        const int historySize = taps() - 1;
+        m_scratch.resize(historySize + count);
+        for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+            double* column = block.values[c].data();
+            std::copy(m_history[c].begin(), m_history[c].end(), m_scratch.begin());
+            std::copy(column, column + count, m_scratch.begin() + historySize);
+            SensorBatch::fir(m_scratch.data(), column, count, m_coefficients.data(), taps());
+            std::copy(m_scratch.end() - historySize, m_scratch.end(), m_history[c].begin());
+        }
+        return;
+    }
+    
+    // One recurrence per channel, run side by side so they overlap
+    double state[SensorSample::CHANNEL_COUNT];
+    double* columns[SensorSample::CHANNEL_COUNT];
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        state[c] = m_history[c][0];
+        columns[c] = block.values[c].data();
+    }
+    for (int i = 0; i < count; ++i) {
+        for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+            state[c] += m_alpha * (columns[c][i] - state[c]);
+            columns[c][i] = state[c];
+        }
+    }
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        m_history[c][0] = state[c];
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef SENSORBATCH_H
+#define SENSORBATCH_H
+
+#include <QVector>
+#include <vector>
+
+#include "SensorSeriesStore.h"
+
+// Structure-of-arrays block of samples: the timestamps and each channel are
+// contiguous columns, so a batch operation streams through one channel at a
+// time with full-width vector loads.
+struct SensorBlock {
+    QVector<qint64> timestamps;
+    std::vector<double> values[SensorSample::CHANNEL_COUNT];
+    
+    int size() const { return timestamps.size(); }
+    void clear();
+    void append(const SensorSample& sample);
+    SensorSample sample(int index) const;
+    double* channel(SensorChannel channel) { return values[static_cast<int>(channel)].data(); }
+};
+
+// Per-channel offsets and the range the calibrated value is clamped to
+struct SensorCalibration {
+    double offsets[SensorSample::CHANNEL_COUNT] = {0.0, 0.0, 0.0, 0.0};
+    double min[SensorSample::CHANNEL_COUNT] = {-40.0, 0.0, 800.0, 0.0};
+    double max[SensorSample::CHANNEL_COUNT] = {80.0, 100.0, 1200.0, 10000.0};
+};
+
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX
+};
+
+// Batch calibration over SensorBlocks.
+//
+// Kernels exist for SSE2 (2 doubles per instruction), AVX (4 doubles) and
+// plain scalar code; the widest one the CPU supports is picked at startup.
+// Only double-precision add/mul/min/max are used, so AVX2 adds nothing over
+// AVX here. Calibration gives identical results at every level, and a NaN
+// input stays NaN as with std::clamp; FIR sums are taken in the same order
+// at every level and differ at most by rounding where the compiler fuses a
+// multiply-add.
+class SensorBatch
+{
+public:
+    static SimdLevel detectedSimdLevel();
+    static SimdLevel simdLevel();
+    // Capped at detectedSimdLevel(); for tests and benchmarks
+    static void setSimdLevel(SimdLevel level);
+    static const char* simdLevelName(SimdLevel level);
+    
+    static void calibrate(SensorBlock& block, const SensorCalibration& calibration);
+    static void calibrate(SensorSample& sample, const SensorCalibration& calibration);
+    // One column: values[i] = clamp(values[i] + offset, min, max)
+    static void calibrate(double* values, int count, double offset, double min, double max);
+    
+    // out[i] = sum over k of coefficients[k] * in[i + taps - 1 - k]; in holds
+    // count + taps - 1 values, the first taps - 1 being history
+    static void fir(const double* in, double* out, int count, const double* coefficients, int taps);
+};
+
+// Smoothing filter over a stream of SensorBlocks, applied to every channel.
+//
+// FIR filters run through SensorBatch's vector kernels, several outputs per
+// instruction. The exponential (single-pole IIR) filter is a recurrence, so
+// its outputs cannot be computed side by side; it runs the four channels
+// interleaved instead. State carries over between process() calls, so the
+// output does not depend on how the stream is cut into blocks. The history
+// is seeded with the first sample, so the output starts at the signal level
+// instead of ramping up from zero.
+class SensorFilter
+{
+public:
+    enum class Type {
+        None,
+        Fir,
+        Exponential
+    };
+    
+    SensorFilter();   // Pass-through
+    static SensorFilter fir(const QVector<double>& coefficients);
+    static SensorFilter movingAverage(int taps);
+    // y += alpha * (x - y); alpha outside (0, 1) gives a pass-through
+    static SensorFilter exponential(double alpha);
+    
+    Type type() const;
+    int taps() const;
+    void reset();
+    void process(SensorBlock& block);
+
+private:
+    Type m_type;
+    std::vector<double> m_coefficients;
+    double m_alpha;
+    bool m_primed;
+    // FIR: the last taps - 1 inputs per channel, oldest first; exponential:
+    // the last output per channel
+    std::vector<double> m_history[SensorSample::CHANNEL_COUNT];
+    std::vector<double> m_scratch;
+};
+
+#endif // SENSORBATCH_H
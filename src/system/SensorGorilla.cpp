@@ -0,0 +1,402 @@
+#include "SensorGorilla.h"
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+// Delta-of-delta buckets: control bits, then the value offset into [0, 2^bits)
+struct DeltaBucket {
+    quint64 control;
+    int controlBits;
+    int valueBits;
+    qint64 min;
+    qint64 max;
+};
+
+const DeltaBucket DELTA_BUCKETS[] = {
+    {0x2, 2, 7, -63, 64},
+    {0x6, 3, 9, -255, 256},
+    {0xE, 4, 12, -2047, 2048},
+};
+const quint64 DELTA_ESCAPE = 0xF;   // Then the full 64-bit delta of delta
+
+quint64 toBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Timestamp arithmetic wraps instead of overflowing, so any sequence of
+// qint64 values round-trips
+qint64 wrappingSub(qint64 a, qint64 b)
+{
+    return static_cast<qint64>(static_cast<quint64>(a) - static_cast<quint64>(b));
+}
+
+qint64 wrappingAdd(qint64 a, qint64 b)
+{
+    return static_cast<qint64>(static_cast<quint64>(a) + static_cast<quint64>(b));
+}
+}
+
+GorillaBitWriter::GorillaBitWriter()
+    : m_word(0)
+    , m_used(0)
+{
+}
+
+void GorillaBitWriter::write(quint64 bits, int count)
+{
+    if (count < 64) {
+        bits &= (quint64(1) << count) - 1;
+    }
+    const int free = 64 - m_used;
+    if (count < free) {
+        m_word |= bits << (free - count);
+        m_used += count;
+        return;
+    }
+    
+    // Fill the word, then carry the rest over
+    const int rest = count - free;
+    m_word |= bits >> rest;
+    flushWord();
+    if (rest > 0) {
+        m_word = bits << (64 - rest);
+        m_used = rest;
+    }
+}
+
+qint64 GorillaBitWriter::bitCount() const
+{
+    return qint64(m_bytes.size()) * 8 + m_used;
+}
+
+QByteArray GorillaBitWriter::finish()
+{
+    char word[8];
+    qToBigEndian(m_word, word);
+    m_bytes.append(word, (m_used + 7) / 8);
+    
+    QByteArray bytes;
+    bytes.swap(m_bytes);
+    m_word = 0;
+    m_used = 0;
+    return bytes;
+}
+
+void GorillaBitWriter::flushWord()
+{
+    char word[8];
+    qToBigEndian(m_word, word);
+    m_bytes.append(word, 8);
+    m_word = 0;
+    m_used = 0;
+}
+
+GorillaBitReader::GorillaBitReader()
+    : GorillaBitReader(nullptr, 0)
+{
+}
+
+GorillaBitReader::GorillaBitReader(const char* data, int size)
+    : m_data(reinterpret_cast<const uchar*>(data))
+    , m_size(size)
+    , m_position(0)
+    , m_window(0)
+    , m_bits(0)
+    , m_overrun(false)
+{
+}
+
+quint64 GorillaBitReader::read(int count)
+{
+    // A refill guarantees 57 bits, so wide reads come in two halves
+    if (count > 56) {
+        const quint64 high = read(count - 32);
+        return (high << 32) | read(32);
+    }
+    
+    if (m_bits < count) {
+        refill();
+        if (m_bits < count) {
+            m_overrun = true;
+            m_bits = count;
+        }
+    }
+    const quint64 bits = m_window >> (64 - count);
+    m_window <<= count;
+    m_bits -= count;
+    return bits;
+}
+
+bool GorillaBitReader::overrun() const
+{
+    return m_overrun;
+}
+
+void GorillaBitReader::refill()
+{
+    while (m_bits <= 56 && m_position < m_size) {
+        m_window |= quint64(m_data[m_position++]) << (56 - m_bits);
+        m_bits += 8;
+    }
+}
+
+GorillaTimestampEncoder::GorillaTimestampEncoder()
+    : m_count(0)
+    , m_previous(0)
+    , m_previousDelta(0)
+{
+}
+
+void GorillaTimestampEncoder::append(qint64 timestamp)
+{
+    if (m_count++ == 0) {
+        m_writer.write(static_cast<quint64>(timestamp), 64);
+        m_previous = timestamp;
+        m_previousDelta = 0;
+        return;
+    }
+    
+    const qint64 delta = wrappingSub(timestamp, m_previous);
+    const qint64 deltaOfDelta = wrappingSub(delta, m_previousDelta);
+    m_previous = timestamp;
+    m_previousDelta = delta;
+    
+    if (deltaOfDelta == 0) {
+        m_writer.write(0, 1);
+        return;
+    }
+    for (const DeltaBucket& bucket : DELTA_BUCKETS) {
+        if (deltaOfDelta >= bucket.min && deltaOfDelta <= bucket.max) {
+            m_writer.write(bucket.control, bucket.controlBits);
+            m_writer.write(static_cast<quint64>(deltaOfDelta - bucket.min), bucket.valueBits);
+            return;
+        }
+    }
+    m_writer.write(DELTA_ESCAPE, 4);
+    m_writer.write(static_cast<quint64>(deltaOfDelta), 64);
+}
+
+int GorillaTimestampEncoder::count() const
+{
+    return m_count;
+}
+
+QByteArray GorillaTimestampEncoder::finish()
+{
+    m_count = 0;
+    return m_writer.finish();
+}
+
+GorillaTimestampDecoder::GorillaTimestampDecoder()
+    : GorillaTimestampDecoder(nullptr, 0, 0)
+{
+}
+
+GorillaTimestampDecoder::GorillaTimestampDecoder(const char* data, int size, int count)
+    : m_reader(data, size)
+    , m_remaining(count)
+    , m_started(false)
+    , m_previous(0)
+    , m_previousDelta(0)
+{
+}
+
+bool GorillaTimestampDecoder::next(qint64& timestamp)
+{
+    if (m_remaining <= 0) {
+        return false;
+    }
+    
+    if (!m_started) {
+        m_started = true;
+        m_previous = static_cast<qint64>(m_reader.read(64));
+    } else {
+        qint64 deltaOfDelta = 0;
+        if (m_reader.read(1) != 0) {
+            // Count the further 1 bits of the control code
+            int ones = 1;
+            while (ones < 4 && m_reader.read(1) != 0) {
+                ++ones;
+            }
+            if (ones == 4) {
+                deltaOfDelta = static_cast<qint64>(m_reader.read(64));
+            } else {
+                const DeltaBucket& bucket = DELTA_BUCKETS[ones - 1];
+                deltaOfDelta = static_cast<qint64>(m_reader.read(bucket.valueBits)) + bucket.min;
+            }
+        }
+        m_previousDelta = wrappingAdd(m_previousDelta, deltaOfDelta);
+        m_previous = wrappingAdd(m_previous, m_previousDelta);
+    }
+    
+    if (m_reader.overrun()) {
+        m_remaining = 0;
+        return false;
+    }
+    --m_remaining;
+    timestamp = m_previous;
+    return true;
+}
+
+GorillaValueEncoder::GorillaValueEncoder()
+    : m_count(0)
+    , m_previous(0)
+    , m_leading(-1)
+    , m_trailing(0)
+{
+}
+
+void GorillaValueEncoder::append(double value)
+{
+    const quint64 bits = toBits(value);
+    if (m_count++ == 0) {
+        m_writer.write(bits, 64);
+        m_previous = bits;
+        m_leading = -1;
+        return;
+    }
+    
+    const quint64 xored = bits ^ m_previous;
+    m_previous = bits;
+    if (xored == 0) {
+        m_writer.write(0, 1);
+        return;
+    }
+    
+    const int leading = static_cast<int>(qCountLeadingZeroBits(xored));
+    const int trailing = static_cast<int>(qCountTrailingZeroBits(xored));
+    if (m_leading >= 0 && leading >= m_leading && trailing >= m_trailing) {
+        m_writer.write(0x2, 2);
+        m_writer.write(xored >> m_trailing, 64 - m_leading - m_trailing);
+        return;
+    }
+    
+    // New window: 6 bits of leading zeros, 6 bits of length - 1
+    const int meaningful = 64 - leading - trailing;
+    m_writer.write(0x3, 2);
+    m_writer.write(static_cast<quint64>(leading), 6);
+    m_writer.write(static_cast<quint64>(meaningful - 1), 6);
+    m_writer.write(xored >> trailing, meaningful);
+    m_leading = leading;
+    m_trailing = trailing;
+}
+
+int GorillaValueEncoder::count() const
+{
+    return m_count;
+}
+
+QByteArray GorillaValueEncoder::finish()
+{
+    m_count = 0;
+    m_leading = -1;
+    return m_writer.finish();
+}
+
+GorillaValueDecoder::GorillaValueDecoder()
+    : GorillaValueDecoder(nullptr, 0, 0)
+{
+}
+
+GorillaValueDecoder::GorillaValueDecoder(const char* data, int size, int count)
+    : m_reader(data, size)
+    , m_remaining(count)
+    , m_started(false)
+    , m_previous(0)
+    , m_leading(0)
+    , m_trailing(0)
+{
+}
+
+bool GorillaValueDecoder::next(double& value)
+{
+    if (m_remaining <= 0) {
+        return false;
+    }
+    
+    if (!m_started) {
+        m_started = true;
+        m_previous = m_reader.read(64);
+    } else if (m_reader.read(1) != 0) {
+        if (m_reader.read(1) != 0) {
+            m_leading = static_cast<int>(m_reader.read(6));
+            const int meaningful = static_cast<int>(m_reader.read(6)) + 1;
+            m_trailing = 64 - m_leading - meaningful;
+            if (m_trailing < 0) {
+                // Corrupt window; no encoder writes this
+                m_remaining = 0;
+                return false;
+            }
+        }
+        m_previous ^= m_reader.read(64 - m_leading - m_trailing) << m_trailing;
+    }
+    
+    if (m_reader.overrun()) {
+        m_remaining = 0;
+        return false;
+    }
+    --m_remaining;
+    value = fromBits(m_previous);
+    return true;
+}
+
+void SensorGorillaEncoder::append(const SensorSample& sample)
+{
+    m_timestamps.append(sample.timestamp);
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        m_values[c].append(sample.values[c]);
+    }
+}
+
+int SensorGorillaEncoder::count() const
+{
+    return m_timestamps.count();
+}
+
+QVector<QByteArray> SensorGorillaEncoder::finish()
+{
+    QVector<QByteArray> columns;
+    columns.reserve(COLUMN_COUNT);
+    columns.append(m_timestamps.finish());
+    for (GorillaValueEncoder& values : m_values) {
+        columns.append(values.finish());
+    }
+    return columns;
+}
+
+SensorGorillaDecoder::SensorGorillaDecoder(const QVector<QByteArray>& columns, int count)
+    : m_columns(columns)
+{
+    if (m_columns.size() != SensorGorillaEncoder::COLUMN_COUNT) {
+        return;
+    }
+    m_timestamps = GorillaTimestampDecoder(m_columns[0].constData(), m_columns[0].size(), count);
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        const QByteArray& column = m_columns[1 + c];
+        m_values[c] = GorillaValueDecoder(column.constData(), column.size(), count);
+    }
+}
+
+bool SensorGorillaDecoder::next(SensorSample& sample)
+{
+    if (!m_timestamps.next(sample.timestamp)) {
+        return false;
+    }
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        if (!m_values[c].next(sample.values[c])) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,160 @@
+#ifndef SENSORGORILLA_H
+#define SENSORGORILLA_H
+
+#include <QByteArray>
+#include <QVector>
+
+#include "SensorSeriesStore.h"
+
+// Gorilla-style compression for sensor columns (Pelkonen et al., "Gorilla: A
+// Fast, Scalable, In-Memory Time Series Database", VLDB 2015).
+//
+// Timestamps are stored as the delta of their deltas, so a steady sample
+// rate costs one bit per sample. Values are XORed with their predecessor and
+// only the bits between the leading and trailing zeros are kept, reusing the
+// previous window when it fits, so repeated and slowly changing readings
+// cost a few bits. Both are lossless for any input: timestamps may go
+// backwards and values keep their exact bit patterns, NaN included.
+//
+// Streams carry no length; the decoder is told how many values to expect.
+
+// Bits are written most significant first
+class GorillaBitWriter
+{
+public:
+    GorillaBitWriter();
+    
+    // Writes the low count bits of bits, 1 <= count <= 64
+    void write(quint64 bits, int count);
+    qint64 bitCount() const;
+    // Returns the stream padded to a whole byte and resets the writer
+    QByteArray finish();
+
+private:
+    void flushWord();
+    
+    QByteArray m_bytes;
+    quint64 m_word;     // Pending bits, left-aligned
+    int m_used;
+};
+
+class GorillaBitReader
+{
+public:
+    GorillaBitReader();
+    GorillaBitReader(const char* data, int size);
+    
+    // 1 <= count <= 64; reading past the end yields zeros and sets overrun()
+    quint64 read(int count);
+    bool overrun() const;
+
+private:
+    void refill();
+    
+    const uchar* m_data;
+    int m_size;
+    int m_position;
+    quint64 m_window;   // Buffered bits, left-aligned
+    int m_bits;
+    bool m_overrun;
+};
+
+class GorillaTimestampEncoder
+{
+public:
+    GorillaTimestampEncoder();
+    
+    void append(qint64 timestamp);
+    int count() const;
+    QByteArray finish();
+
+private:
+    GorillaBitWriter m_writer;
+    int m_count;
+    qint64 m_previous;
+    qint64 m_previousDelta;
+};
+
+class GorillaTimestampDecoder
+{
+public:
+    GorillaTimestampDecoder();
+    GorillaTimestampDecoder(const char* data, int size, int count);
+    
+    // False once count timestamps were read or the stream is truncated
+    bool next(qint64& timestamp);
+
+private:
+    GorillaBitReader m_reader;
+    int m_remaining;
+    bool m_started;
+    qint64 m_previous;
+    qint64 m_previousDelta;
+};
+
+class GorillaValueEncoder
+{
+public:
+    GorillaValueEncoder();
+    
+    void append(double value);
+    int count() const;
+    QByteArray finish();
+
+private:
+    GorillaBitWriter m_writer;
+    int m_count;
+    quint64 m_previous;
+    int m_leading;      // Window of the last explicitly written XOR
+    int m_trailing;
+};
+
+class GorillaValueDecoder
+{
+public:
+    GorillaValueDecoder();
+    GorillaValueDecoder(const char* data, int size, int count);
+    
+    bool next(double& value);
+
+private:
+    GorillaBitReader m_reader;
+    int m_remaining;
+    bool m_started;
+    quint64 m_previous;
+    int m_leading;
+    int m_trailing;
+};
+
+// Whole samples as one timestamp column and one value column per channel,
+// the layout SensorSeriesStore keeps sealed chunks in
+class SensorGorillaEncoder
+{
+public:
+    static const int COLUMN_COUNT = 1 + SensorSample::CHANNEL_COUNT;
+    
+    void append(const SensorSample& sample);
+    int count() const;
+    // Column 0 holds the timestamps, column 1 + c channel c; resets the encoder
+    QVector<QByteArray> finish();
+
+private:
+    GorillaTimestampEncoder m_timestamps;
+    GorillaValueEncoder m_values[SensorSample::CHANNEL_COUNT];
+};
+
+// Decodes one sample at a time; the columns are shared, not copied
+class SensorGorillaDecoder
+{
+public:
+    SensorGorillaDecoder(const QVector<QByteArray>& columns, int count);
+    
+    bool next(SensorSample& sample);
+
+private:
+    QVector<QByteArray> m_columns;
+    GorillaTimestampDecoder m_timestamps;
+    GorillaValueDecoder m_values[SensorSample::CHANNEL_COUNT];
+};
+
+#endif // SENSORGORILLA_H
@@ -0,0 +1,288 @@
+#include "SensorHistory.h"
+#include <algorithm>
+#include <cmath>
+
+// The clamp ranges of SensorCalibration
+static const double HISTOGRAM_LOW[SensorSample::CHANNEL_COUNT] = {-40.0, 0.0, 800.0, 0.0};
+static const double HISTOGRAM_HIGH[SensorSample::CHANNEL_COUNT] = {80.0, 100.0, 1200.0, 10000.0};
+
+SensorHistory::SensorHistory(int capacity, const QVector<qint64>& windowsMs)
+    : m_ring(static_cast<size_t>(qMax(capacity, 1)))
+    , m_fresh(m_ring.size())
+    , m_begin(0)
+    , m_end(0)
+    , m_windows(static_cast<size_t>(windowsMs.size()))
+{
+    for (int i = 0; i < windowsMs.size(); ++i) {
+        m_windows[i].spanMs = windowsMs[i];
+    }
+}
+
+void SensorHistory::add(const SensorSample& sample, quint32 freshChannels)
+{
+    // A full ring drops its oldest sample from every window still holding it
+    if (m_end - m_begin == m_ring.size()) {
+        for (Window& window : m_windows) {
+            if (window.begin == m_begin) {
+                evictOldest(window);
+            }
+        }
+        ++m_begin;
+    }
+    
+    const quint64 sequence = m_end++;
+    m_ring[sequence % m_ring.size()] = sample;
+    m_fresh[sequence % m_ring.size()] = freshChannels;
+    
+    for (Window& window : m_windows) {
+        insert(window, sequence);
+        const qint64 oldest = sample.timestamp - window.spanMs;
+        while (window.begin < sequence && sampleAt(window.begin).timestamp <= oldest) {
+            evictOldest(window);
+        }
+    }
+}
+
+void SensorHistory::clear()
+{
+    m_begin = m_end = 0;
+    for (Window& window : m_windows) {
+        const qint64 spanMs = window.spanMs;
+        window = Window();
+        window.spanMs = spanMs;
+    }
+}
+
+int SensorHistory::size() const
+{
+    return static_cast<int>(m_end - m_begin);
+}
+
+int SensorHistory::capacity() const
+{
+    return static_cast<int>(m_ring.size());
+}
+
+bool SensorHistory::isEmpty() const
+{
+    return m_end == m_begin;
+}
+
+const SensorSample& SensorHistory::at(int index) const
+{
+    return sampleAt(m_begin + static_cast<quint64>(index));
+}
+
+const SensorSample& SensorHistory::latest() const
+{
+    return sampleAt(m_end - 1);
+}
+
+QVector<SensorSample> SensorHistory::recent(int count) const
+{
+    count = qBound(0, count, size());
+    QVector<SensorSample> samples;
+    samples.reserve(count);
+    for (quint64 sequence = m_end - count; sequence < m_end; ++sequence) {
+        samples.append(sampleAt(sequence));
+    }
+    return samples;
+}
+
+int SensorHistory::windowCount() const
+{
+    return static_cast<int>(m_windows.size());
+}
+
+qint64 SensorHistory::windowSpanMs(int window) const
+{
+    return m_windows[window].spanMs;
+}
+
+SensorWindowStats SensorHistory::stats(SensorChannel channel, int window) const
+{
+    const Window& target = m_windows[window];
+    const ChannelWindow& state = target.channels[static_cast<int>(channel)];
+    SensorWindowStats stats;
+    stats.count = static_cast<qint64>(state.count);
+    if (stats.count == 0) {
+        return stats;
+    }
+    
+    const double n = static_cast<double>(stats.count);
+    stats.mean = state.offset + state.sum / n;
+    if (stats.count > 1) {
+        const double variance = (state.sumSquares - state.sum * state.sum / n) / (n - 1.0);
+        stats.stddev = std::sqrt(qMax(variance, 0.0));
+    }
+    stats.min = sampleAt(state.minQueue.front()).values[static_cast<int>(channel)];
+    stats.max = sampleAt(state.maxQueue.front()).values[static_cast<int>(channel)];
+    return stats;
+}
+
+double SensorHistory::percentile(SensorChannel channel, double q, int window) const
+{
+    const int c = static_cast<int>(channel);
+    const ChannelWindow& state = m_windows[window].channels[c];
+    const quint64 count = state.count;
+    if (count == 0) {
+        return 0.0;
+    }
+    
+    const double min = sampleAt(state.minQueue.front()).values[c];
+    const double max = sampleAt(state.maxQueue.front()).values[c];
+    if (q <= 0.0) {
+        return min;
+    }
+    if (q >= 1.0) {
+        return max;
+    }
+    
+    const double rank = q * static_cast<double>(count - 1);
+    const double width = (HISTOGRAM_HIGH[c] - HISTOGRAM_LOW[c]) / HISTOGRAM_BINS;
+    
+    // Spread each bin's samples evenly across it and take the rank-th
+    double value = HISTOGRAM_HIGH[c];
+    quint64 below = 0;
+    for (int bin = 0; bin < HISTOGRAM_BINS; ++bin) {
+        const quint32 inBin = state.bins[bin];
+        if (inBin > 0 && rank < static_cast<double>(below + inBin)) {
+            const double fraction = (rank - static_cast<double>(below) + 0.5) / inBin;
+            value = HISTOGRAM_LOW[c] + (bin + fraction) * width;
+            break;
+        }
+        below += inBin;
+    }
+    return qBound(min, value, max);
+}
+
+double SensorHistory::zScore(SensorChannel channel, double value, int window) const
+{
+    const SensorWindowStats windowStats = stats(channel, window);
+    if (windowStats.count < 2 || windowStats.stddev <= 0.0) {
+        return 0.0;
+    }
+    return (value - windowStats.mean) / windowStats.stddev;
+}
+
+void SensorHistory::histogramRange(SensorChannel channel, double& low, double& high)
+{
+    low = HISTOGRAM_LOW[static_cast<int>(channel)];
+    high = HISTOGRAM_HIGH[static_cast<int>(channel)];
+}
+
+const SensorSample& SensorHistory::sampleAt(quint64 sequence) const
+{
+    return m_ring[sequence % m_ring.size()];
+}
+
+bool SensorHistory::isFresh(quint64 sequence, int channel) const
+{
+    return (m_fresh[sequence % m_ring.size()] & (1u << channel)) != 0;
+}
+
+void SensorHistory::insert(Window& window, quint64 sequence)
+{
+    const SensorSample& sample = sampleAt(sequence);
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        if (!isFresh(sequence, c)) {
+            continue;
+        }
+        ChannelWindow& state = window.channels[c];
+        const double value = sample.values[c];
+        if (state.count++ == 0) {
+            state.offset = value;
+            state.sum = 0.0;
+            state.sumSquares = 0.0;
+        }
+        const double delta = value - state.offset;
+        state.sum += delta;
+        state.sumSquares += delta * delta;
+        
+        while (!state.minQueue.empty() && sampleAt(state.minQueue.back()).values[c] >= value) {
+            state.minQueue.pop_back();
+        }
+        state.minQueue.push_back(sequence);
+        while (!state.maxQueue.empty() && sampleAt(state.maxQueue.back()).values[c] <= value) {
+            state.maxQueue.pop_back();
+        }
+        state.maxQueue.push_back(sequence);
+        
+        ++state.bins[binIndex(c, value)];
+    }
+}
+
+void SensorHistory::evictOldest(Window& window)
+{
+    const quint64 sequence = window.begin++;
+    const SensorSample& sample = sampleAt(sequence);
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        if (!isFresh(sequence, c)) {
+            continue;
+        }
+        ChannelWindow& state = window.channels[c];
+        --state.count;
+        const double delta = sample.values[c] - state.offset;
+        state.sum -= delta;
+        state.sumSquares -= delta * delta;
+        if (state.minQueue.front() == sequence) {
+            state.minQueue.pop_front();
+        }
+        if (state.maxQueue.front() == sequence) {
+            state.maxQueue.pop_front();
+        }
+        --state.bins[binIndex(c, sample.values[c])];
+    }
+    
+    // Subtracting from running sums accumulates rounding error; recompute
+    // them once per window length of evictions, which keeps add() O(1)
+    // amortized
+    const quint64 count = m_end - window.begin;
+    if (++window.evictions >= qMax<quint64>(count, MIN_REBASE_EVICTIONS)) {
+        rebase(window);
+    }
+}
+
+void SensorHistory::rebase(Window& window)
+{
+    window.evictions = 0;
+    if (window.begin == m_end) {
+        return;
+    }
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        ChannelWindow& state = window.channels[c];
+        if (state.count == 0) {
+            continue;
+        }
+        // Offset by the oldest fresh reading still inside
+        bool first = true;
+        state.sum = 0.0;
+        state.sumSquares = 0.0;
+        for (quint64 sequence = window.begin; sequence < m_end; ++sequence) {
+            if (!isFresh(sequence, c)) {
+                continue;
+            }
+            if (first) {
+                state.offset = sampleAt(sequence).values[c];
+                first = false;
+            }
+            const double delta = sampleAt(sequence).values[c] - state.offset;
+            state.sum += delta;
+            state.sumSquares += delta * delta;
+        }
+    }
+}
+
+int SensorHistory::binIndex(int channel, double value)
+{
+    const double low = HISTOGRAM_LOW[channel];
+    const double high = HISTOGRAM_HIGH[channel];
+    // Written so NaN falls into the first bin
+    if (!(value > low)) {
+        return 0;
+    }
+    if (!(value < high)) {
+        return HISTOGRAM_BINS - 1;
+    }
+    return qMin(static_cast<int>((value - low) / (high - low) * HISTOGRAM_BINS), HISTOGRAM_BINS - 1);
+}
@@ -0,0 +1,109 @@
+#ifndef SENSORHISTORY_H
+#define SENSORHISTORY_H
+
+#include <QVector>
+#include <array>
+#include <deque>
+#include <vector>
+
+#include "SensorSeriesStore.h"
+
+// Statistics of one channel over a window; count == 0 means no samples
+struct SensorWindowStats {
+    qint64 count = 0;
+    double mean = 0.0;
+    double stddev = 0.0;    // Sample standard deviation
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// Rolling in-memory sensor history with sliding-window statistics.
+//
+// Samples live in one fixed-capacity ring shared by every channel and
+// window. Each window (by default the last minute and the last ten minutes,
+// measured back from the newest sample) keeps per channel:
+//   - running sums for mean and variance, taken around an offset so they do
+//     not lose precision, and recomputed once per window length of evictions
+//   - monotonic queues of ring positions for min and max
+//   - a fixed-range histogram of HISTOGRAM_BINS bins for percentiles
+// add() moves each window forward by the samples that left it, so updates
+// and stats() are amortized O(1) and percentile() costs HISTOGRAM_BINS steps
+// whatever the window length; nothing rescans the raw samples.
+//
+// Windows are anchored at the newest sample's timestamp, not the wall clock,
+// so replayed history gives the same answers. add() takes a mask of the
+// channels that carry a new reading; the others keep the sample in the ring
+// but stay out of that channel's statistics, so a slow channel repeated
+// between its readings does not look steadier than it is. Not thread-safe.
+class SensorHistory
+{
+public:
+    static const int DEFAULT_CAPACITY = 8192;
+    static const int HISTOGRAM_BINS = 512;
+    static const quint32 ALL_CHANNELS = (1u << SensorSample::CHANNEL_COUNT) - 1;
+    
+    explicit SensorHistory(int capacity = DEFAULT_CAPACITY,
+                           const QVector<qint64>& windowsMs = {60 * 1000, 10 * 60 * 1000});
+    
+    // Bit c of freshChannels set when channel c is a new reading
+    void add(const SensorSample& sample, quint32 freshChannels = ALL_CHANNELS);
+    void clear();
+    
+    int size() const;
+    int capacity() const;
+    bool isEmpty() const;
+    // Oldest first
+    const SensorSample& at(int index) const;
+    const SensorSample& latest() const;
+    QVector<SensorSample> recent(int count) const;
+    
+    int windowCount() const;
+    qint64 windowSpanMs(int window) const;
+    
+    // Over the channel's fresh readings only
+    SensorWindowStats stats(SensorChannel channel, int window = 0) const;
+    // q in [0, 1]. Approximate to one bin width of the channel's histogram
+    // range, and always within the window's min and max.
+    double percentile(SensorChannel channel, double q, int window = 0) const;
+    // Distance of value from the window mean in standard deviations; 0 with
+    // fewer than two samples or no spread
+    double zScore(SensorChannel channel, double value, int window = 0) const;
+    
+    // Histogram range per channel; values outside land in the end bins
+    static void histogramRange(SensorChannel channel, double& low, double& high);
+
+private:
+    struct ChannelWindow {
+        quint64 count = 0;          // Fresh readings inside the window
+        double offset = 0.0;
+        double sum = 0.0;           // Of (value - offset)
+        double sumSquares = 0.0;
+        std::deque<quint64> minQueue;   // Sequence numbers, values increasing
+        std::deque<quint64> maxQueue;   // Sequence numbers, values decreasing
+        std::array<quint32, HISTOGRAM_BINS> bins = {};
+    };
+    
+    struct Window {
+        qint64 spanMs = 0;
+        quint64 begin = 0;          // Sequence number of the oldest sample inside
+        quint64 evictions = 0;      // Since the sums were last recomputed
+        ChannelWindow channels[SensorSample::CHANNEL_COUNT];
+    };
+    
+    static const int MIN_REBASE_EVICTIONS = 1024;
+    
+    const SensorSample& sampleAt(quint64 sequence) const;
+    bool isFresh(quint64 sequence, int channel) const;
+    void insert(Window& window, quint64 sequence);
+    void evictOldest(Window& window);
+    void rebase(Window& window);
+    static int binIndex(int channel, double value);
+    
+    std::vector<SensorSample> m_ring;
+    std::vector<quint32> m_fresh;   // Fresh channel mask per ring slot
+    quint64 m_begin;    // Sequence numbers: ring slot = sequence % capacity
+    quint64 m_end;
+    std::vector<Window> m_windows;
+};
+
+#endif // SENSORHISTORY_H
@@ -0,0 +1,79 @@
+#include "SensorPublishFilter.h"
+#include <cmath>
+
+SensorPublishFilter::SensorPublishFilter()
+    : m_hasPublished(false)
+{
+}
+
+void SensorPublishFilter::setPolicy(SensorChannel channel, const SensorPublishPolicy& policy)
+{
+    m_policies[static_cast<int>(channel)] = policy;
+}
+
+void SensorPublishFilter::setPolicy(const SensorPublishPolicy& policy)
+{
+    for (SensorPublishPolicy& channelPolicy : m_policies) {
+        channelPolicy = policy;
+    }
+}
+
+SensorPublishPolicy SensorPublishFilter::policy(SensorChannel channel) const
+{
+    return m_policies[static_cast<int>(channel)];
+}
+
+bool SensorPublishFilter::accept(const SensorSample& sample)
+{
+    bool publish = !m_hasPublished;
+    bool rateLimited = false;
+    const qint64 sinceMs = sample.timestamp - m_lastPublished.timestamp;
+    const bool backwards = sinceMs < 0;
+    
+    for (int c = 0; c < CHANNEL_COUNT && !publish; ++c) {
+        const SensorPublishPolicy& policy = m_policies[c];
+        if (policy.heartbeatMs > 0 && (backwards || sinceMs >= policy.heartbeatMs)) {
+            publish = true;
+            continue;
+        }
+        
+        // A reading turning NaN, or back, is always a change
+        const double value = sample.values[c];
+        const double last = m_lastPublished.values[c];
+        const bool moved = std::isnan(value) != std::isnan(last)
+            || std::abs(value - last) >= policy.deadband;
+        if (!moved) {
+            continue;
+        }
+        if (backwards || sinceMs >= policy.minIntervalMs) {
+            publish = true;
+        } else {
+            rateLimited = true;
+        }
+    }
+    
+    if (!publish) {
+        ++m_stats.suppressed;
+        ++(rateLimited ? m_stats.suppressedByInterval : m_stats.suppressedByDeadband);
+        return false;
+    }
+    ++m_stats.published;
+    m_lastPublished = sample;
+    m_hasPublished = true;
+    return true;
+}
+
+void SensorPublishFilter::reset()
+{
+    m_hasPublished = false;
+}
+
+SensorPublishStats SensorPublishFilter::stats() const
+{
+    return m_stats;
+}
+
+void SensorPublishFilter::resetStats()
+{
+    m_stats = SensorPublishStats();
+}
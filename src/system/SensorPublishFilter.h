@@ -0,0 +1,54 @@
+#ifndef SENSORPUBLISHFILTER_H
+#define SENSORPUBLISHFILTER_H
+
+#include "SensorSeriesStore.h"
+
+// When a channel's new reading is worth waking subscribers for. The
+// defaults publish every sample.
+struct SensorPublishPolicy {
+    double deadband = 0.0;      // Publish once the value moved by at least this since the last publish
+    qint64 minIntervalMs = 0;   // A change publishes no sooner than this after the last publish
+    qint64 heartbeatMs = 0;     // Publish at least this often regardless; 0 never forces a publish
+};
+
+struct SensorPublishStats {
+    quint64 published = 0;
+    quint64 suppressed = 0;             // All samples held back
+    quint64 suppressedByDeadband = 0;   // No channel moved past its deadband
+    quint64 suppressedByInterval = 0;   // A channel moved, but too soon after the last publish
+};
+
+// Decides which samples are published, by per-channel policy.
+//
+// Subscribers get whole samples, so one channel passing its policy publishes
+// every channel, and deadbands compare against the values last published,
+// not the last sample seen: a slow drift publishes once it adds up to the
+// deadband. Sample timestamps drive the intervals; one that goes backwards
+// (a replay seek) counts as an expired interval. Not thread-safe.
+class SensorPublishFilter
+{
+public:
+    SensorPublishFilter();
+    
+    void setPolicy(SensorChannel channel, const SensorPublishPolicy& policy);
+    void setPolicy(const SensorPublishPolicy& policy);
+    SensorPublishPolicy policy(SensorChannel channel) const;
+    
+    // True if sample should be published; counts it either way
+    bool accept(const SensorSample& sample);
+    // The next sample is published unconditionally, e.g. after a gap
+    void reset();
+    
+    SensorPublishStats stats() const;
+    void resetStats();
+
+private:
+    static const int CHANNEL_COUNT = SensorSample::CHANNEL_COUNT;
+    
+    SensorPublishPolicy m_policies[CHANNEL_COUNT];
+    SensorSample m_lastPublished;
+    bool m_hasPublished;
+    SensorPublishStats m_stats;
+};
+
+#endif // SENSORPUBLISHFILTER_H
@@ -0,0 +1,114 @@
+#include "SensorScheduler.h"
+#include <algorithm>
+
+SensorScheduler::SensorScheduler()
+    : m_now(0)
+    , m_active(false)
+    , m_missed(0)
+{
+    std::fill(m_intervals, m_intervals + CHANNEL_COUNT, 0);
+    std::fill(m_lastSampled, m_lastSampled + CHANNEL_COUNT, 0);
+    m_heap.reserve(CHANNEL_COUNT);
+}
+
+void SensorScheduler::setInterval(SensorChannel channel, qint64 intervalMs)
+{
+    const int c = static_cast<int>(channel);
+    m_intervals[c] = qMax<qint64>(0, intervalMs);
+    if (!m_active) {
+        return;
+    }
+    
+    unschedule(c);
+    if (m_intervals[c] > 0) {
+        schedule(c, qMax(m_now, m_lastSampled[c] + m_intervals[c]));
+    }
+}
+
+qint64 SensorScheduler::interval(SensorChannel channel) const
+{
+    return m_intervals[static_cast<int>(channel)];
+}
+
+void SensorScheduler::start(qint64 nowMs)
+{
+    m_heap.clear();
+    m_now = nowMs;
+    m_active = true;
+    m_missed = 0;
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        m_lastSampled[c] = nowMs;
+        if (m_intervals[c] > 0) {
+            schedule(c, nowMs);
+        }
+    }
+}
+
+void SensorScheduler::stop()
+{
+    m_heap.clear();
+    m_active = false;
+}
+
+bool SensorScheduler::isActive() const
+{
+    return m_active;
+}
+
+qint64 SensorScheduler::nextDeadline() const
+{
+    return m_heap.empty() ? std::numeric_limits<qint64>::max() : m_heap.front().deadline;
+}
+
+quint32 SensorScheduler::takeDue(qint64 nowMs)
+{
+    m_now = nowMs;
+    quint32 due = 0;
+    while (!m_heap.empty() && m_heap.front().deadline <= nowMs) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), later);
+        const Entry entry = m_heap.back();
+        m_heap.pop_back();
+        
+        const int c = entry.channel;
+        const qint64 interval = m_intervals[c];
+        due |= 1u << c;
+        m_lastSampled[c] = nowMs;
+        
+        // Stay on the original grid, skipping slots already in the past
+        qint64 next = entry.deadline + interval;
+        if (next <= nowMs) {
+            const qint64 behind = (nowMs - next) / interval + 1;
+            m_missed += static_cast<quint64>(behind);
+            next += behind * interval;
+        }
+        schedule(c, next);
+    }
+    return due;
+}
+
+quint64 SensorScheduler::missedDeadlines() const
+{
+    return m_missed;
+}
+
+bool SensorScheduler::later(const Entry& a, const Entry& b)
+{
+    // Ties go to the lower channel, so the heap order is deterministic
+    return a.deadline != b.deadline ? a.deadline > b.deadline : a.channel > b.channel;
+}
+
+void SensorScheduler::schedule(int channel, qint64 deadline)
+{
+    m_heap.push_back({deadline, channel});
+    std::push_heap(m_heap.begin(), m_heap.end(), later);
+}
+
+void SensorScheduler::unschedule(int channel)
+{
+    auto it = std::find_if(m_heap.begin(), m_heap.end(),
+                           [channel](const Entry& entry) { return entry.channel == channel; });
+    if (it != m_heap.end()) {
+        m_heap.erase(it);
+        std::make_heap(m_heap.begin(), m_heap.end(), later);
+    }
+}
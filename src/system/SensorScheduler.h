@@ -0,0 +1,60 @@
+#ifndef SENSORSCHEDULER_H
+#define SENSORSCHEDULER_H
+
+#include <limits>
+#include <vector>
+
+#include "SensorSeriesStore.h"
+
+// Per-channel sampling deadlines on one clock.
+//
+// Each channel has its own interval; the pending deadlines sit in a min-heap,
+// so one timer armed for nextDeadline() serves every channel. Channels with
+// the same interval fall due together and are read in one pass. A deadline
+// that was missed by whole intervals is moved past now instead of firing
+// once per missed interval. Times are in ms on any monotonic clock.
+// Not thread-safe.
+class SensorScheduler
+{
+public:
+    static const quint32 ALL_CHANNELS = (1u << SensorSample::CHANNEL_COUNT) - 1;
+    
+    SensorScheduler();
+    
+    // intervalMs <= 0 stops sampling the channel. While active, a changed
+    // interval counts from the channel's last sample.
+    void setInterval(SensorChannel channel, qint64 intervalMs);
+    qint64 interval(SensorChannel channel) const;
+    
+    // Every channel with an interval falls due at nowMs
+    void start(qint64 nowMs);
+    void stop();
+    bool isActive() const;
+    
+    // Earliest pending deadline; max() when nothing is scheduled
+    qint64 nextDeadline() const;
+    // Bit c is set for each channel c due at nowMs; those are rescheduled
+    quint32 takeDue(qint64 nowMs);
+    // Intervals skipped because a deadline was served late by a full interval or more
+    quint64 missedDeadlines() const;
+
+private:
+    static const int CHANNEL_COUNT = SensorSample::CHANNEL_COUNT;
+    
+    struct Entry {
+        qint64 deadline;
+        int channel;
+    };
+    static bool later(const Entry& a, const Entry& b);
+    void schedule(int channel, qint64 deadline);
+    void unschedule(int channel);
+    
+    std::vector<Entry> m_heap;
+    qint64 m_intervals[CHANNEL_COUNT];
+    qint64 m_lastSampled[CHANNEL_COUNT];
+    qint64 m_now;
+    bool m_active;
+    quint64 m_missed;
+};
+
+#endif // SENSORSCHEDULER_H
@@ -0,0 +1,795 @@
+#include "SensorSeriesStore.h"
+#include "SensorGorilla.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const char SERIES_MAGIC[4] = {'A', 'D', 'T', 'S'};
+const quint32 CHUNK_MAGIC = 0x4B4E4843; // "CHNK", raw columns
+const quint32 SEALED_MAGIC = 0x5A4E4843; // "CHNZ", compressed columns
+
+void putDouble(char* out, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian(bits, out);
+}
+
+double getDouble(const char* in)
+{
+    const quint64 bits = qFromLittleEndian<quint64>(in);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+}
+
+SensorSeriesStore::SensorSeriesStore()
+    : m_readOnly(false)
+    , m_ordered(true)
+    , m_size(0)
+    , m_sealedEnd(0)
+    , m_tailFlushed(0)
+{
+}
+
+SensorSeriesStore::~SensorSeriesStore()
+{
+    close();
+}
+
+bool SensorSeriesStore::open(const QString& filePath, OpenMode mode)
+{
+    close();
+    
+    m_readOnly = mode == ReadOnly;
+    
+    // Earlier builds upgraded version 1 files in place and kept this copy
+    // until they finished; one left behind means the rewrite was cut short
+    const QString backupPath = filePath + ".v1";
+    if (!m_readOnly && QFile::exists(backupPath)) {
+        QFile::remove(filePath);
+        QFile::rename(backupPath, filePath);
+    }
+    
+    m_file.setFileName(filePath);
+    if (!m_file.open(m_readOnly ? QIODevice::ReadOnly : QIODevice::ReadWrite)) {
+        qWarning() << "Failed to open sensor series file:" << filePath;
+        return false;
+    }
+    
+    if (!loadChunks()) {
+        qWarning() << "Not a sensor series file:" << filePath;
+        m_file.close();
+        return false;
+    }
+    m_sinceFlush.start();
+    return true;
+}
+
+void SensorSeriesStore::close()
+{
+    if (m_file.isOpen()) {
+        flush();
+        m_file.close();
+    }
+    m_chunks.clear();
+    m_ordered = true;
+    m_size = 0;
+    m_sealedEnd = 0;
+    m_tailTimestamps.clear();
+    for (QVector<double>& column : m_tailValues) {
+        column.clear();
+    }
+    m_tailFlushed = 0;
+}
+
+bool SensorSeriesStore::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+QString SensorSeriesStore::filePath() const
+{
+    return m_file.fileName();
+}
+
+void SensorSeriesStore::append(const SensorSample& sample)
+{
+    if (!m_file.isOpen() || m_readOnly) {
+        return;
+    }
+    
+    // A tail left full by a failed seal is retried; samples are dropped
+    // while the file cannot be written
+    if (hasTail() && m_chunks.last().count == CHUNK_SAMPLES && !sealTail()) {
+        return;
+    }
+    if (!hasTail()) {
+        startChunk();
+    }
+    
+    Chunk& chunk = m_chunks.last();
+    if (chunk.count == 0) {
+        chunk.minTimestamp = chunk.maxTimestamp = sample.timestamp;
+        for (int c = 0; c < CHANNEL_COUNT; ++c) {
+            chunk.minValue[c] = chunk.maxValue[c] = sample.values[c];
+        }
+    } else {
+        chunk.minTimestamp = qMin(chunk.minTimestamp, sample.timestamp);
+        chunk.maxTimestamp = qMax(chunk.maxTimestamp, sample.timestamp);
+        for (int c = 0; c < CHANNEL_COUNT; ++c) {
+            chunk.minValue[c] = qMin(chunk.minValue[c], sample.values[c]);
+            chunk.maxValue[c] = qMax(chunk.maxValue[c], sample.values[c]);
+        }
+    }
+    if (m_chunks.size() > 1 && sample.timestamp < m_chunks[m_chunks.size() - 2].maxTimestamp) {
+        m_ordered = false;
+    }
+    
+    m_tailTimestamps.append(sample.timestamp);
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        m_tailValues[c].append(sample.values[c]);
+    }
+    ++chunk.count;
+    ++m_size;
+    
+    // A full chunk is sealed right away; it is never written again
+    if (chunk.count == CHUNK_SAMPLES) {
+        sealTail();
+    }
+}
+
+void SensorSeriesStore::flush()
+{
+    if (!m_file.isOpen() || m_readOnly || !hasTail()) {
+        return;
+    }
+    
+    const Chunk& chunk = m_chunks.last();
+    const int begin = m_tailFlushed;
+    const int count = chunk.count - begin;
+    if (count <= 0) {
+        return;
+    }
+    
+    // Columns first, header last: the stored count never covers unwritten data
+    QByteArray buffer(count * 8, Qt::Uninitialized);
+    for (int column = 0; column <= CHANNEL_COUNT; ++column) {
+        const void* source = column == 0
+            ? static_cast<const void*>(m_tailTimestamps.constData() + begin)
+            : static_cast<const void*>(m_tailValues[column - 1].constData() + begin);
+        qToLittleEndian<quint64>(source, count, buffer.data());
+        if (!m_file.seek(columnOffset(chunk, column, begin)) || m_file.write(buffer) != buffer.size()) {
+            qWarning() << "Failed to write sensor series file:" << m_file.fileName();
+            return;
+        }
+    }
+    writeChunkHeader(chunk);
+    m_file.flush();
+    
+    m_tailFlushed = chunk.count;
+    m_sinceFlush.restart();
+}
+
+void SensorSeriesStore::flushIfDue()
+{
+    if (m_sinceFlush.elapsed() >= FLUSH_INTERVAL_MS) {
+        flush();
+    }
+}
+
+qint64 SensorSeriesStore::size() const
+{
+    return m_size;
+}
+
+int SensorSeriesStore::chunkCount() const
+{
+    return m_chunks.size();
+}
+
+qint64 SensorSeriesStore::firstTimestamp() const
+{
+    if (m_chunks.isEmpty()) {
+        return 0;
+    }
+    if (m_ordered) {
+        return m_chunks.first().minTimestamp;
+    }
+    qint64 first = m_chunks.first().minTimestamp;
+    for (const Chunk& chunk : m_chunks) {
+        first = qMin(first, chunk.minTimestamp);
+    }
+    return first;
+}
+
+qint64 SensorSeriesStore::lastTimestamp() const
+{
+    if (m_chunks.isEmpty()) {
+        return 0;
+    }
+    if (m_ordered) {
+        return m_chunks.last().maxTimestamp;
+    }
+    qint64 last = m_chunks.first().maxTimestamp;
+    for (const Chunk& chunk : m_chunks) {
+        last = qMax(last, chunk.maxTimestamp);
+    }
+    return last;
+}
+
+QVector<SensorSample> SensorSeriesStore::read(qint64 since, qint64 until) const
+{
+    QVector<SensorSample> samples;
+    QVector<qint64> timestamps;
+    QVector<double> values[CHANNEL_COUNT];
+    
+    for (int i = firstCandidate(since); i < m_chunks.size(); ++i) {
+        const Chunk& chunk = m_chunks[i];
+        if (m_ordered && chunk.minTimestamp > until) {
+            break;
+        }
+        
+        int begin = 0;
+        int end = 0;
+        if (!matchRange(i, since, until, timestamps, begin, end)) {
+            continue;
+        }
+        for (int c = 0; c < CHANNEL_COUNT; ++c) {
+            values[c].resize(end - begin);
+            readColumn(chunk, 1 + c, begin, end, values[c].data());
+        }
+        
+        for (int index = begin; index < end; ++index) {
+            const qint64 timestamp = timestamps[index];
+            if (timestamp < since || timestamp > until) {
+                continue;
+            }
+            SensorSample sample;
+            sample.timestamp = timestamp;
+            for (int c = 0; c < CHANNEL_COUNT; ++c) {
+                sample.values[c] = values[c][index - begin];
+            }
+            samples.append(sample);
+        }
+    }
+    return samples;
+}
+
+void SensorSeriesStore::readChannel(SensorChannel channel, qint64 since, qint64 until,
+                                    QVector<qint64>& timestamps, QVector<double>& values) const
+{
+    timestamps.clear();
+    values.clear();
+    
+    const int column = 1 + static_cast<int>(channel);
+    QVector<qint64> chunkTimestamps;
+    QVector<double> chunkValues;
+    for (int i = firstCandidate(since); i < m_chunks.size(); ++i) {
+        const Chunk& chunk = m_chunks[i];
+        if (m_ordered && chunk.minTimestamp > until) {
+            break;
+        }
+        
+        int begin = 0;
+        int end = 0;
+        if (!matchRange(i, since, until, chunkTimestamps, begin, end)) {
+            continue;
+        }
+        chunkValues.resize(end - begin);
+        readColumn(chunk, column, begin, end, chunkValues.data());
+        
+        for (int index = begin; index < end; ++index) {
+            const qint64 timestamp = chunkTimestamps[index];
+            if (timestamp >= since && timestamp <= until) {
+                timestamps.append(timestamp);
+                values.append(chunkValues[index - begin]);
+            }
+        }
+    }
+}
+
+SensorRangeSummary SensorSeriesStore::summarize(SensorChannel channel, qint64 since, qint64 until) const
+{
+    SensorRangeSummary summary;
+    const int c = static_cast<int>(channel);
+    QVector<qint64> timestamps;
+    QVector<double> values;
+    
+    auto accumulate = [&summary](double min, double max, qint64 count) {
+        if (summary.count == 0) {
+            summary.min = min;
+            summary.max = max;
+        } else {
+            summary.min = qMin(summary.min, min);
+            summary.max = qMax(summary.max, max);
+        }
+        summary.count += count;
+    };
+    
+    for (int i = firstCandidate(since); i < m_chunks.size(); ++i) {
+        const Chunk& chunk = m_chunks[i];
+        if (m_ordered && chunk.minTimestamp > until) {
+            break;
+        }
+        
+        // Fully covered chunks are answered by their header
+        if (chunk.count > 0 && chunk.minTimestamp >= since && chunk.maxTimestamp <= until) {
+            accumulate(chunk.minValue[c], chunk.maxValue[c], chunk.count);
+            continue;
+        }
+        
+        int begin = 0;
+        int end = 0;
+        if (!matchRange(i, since, until, timestamps, begin, end)) {
+            continue;
+        }
+        values.resize(end - begin);
+        readColumn(chunk, 1 + c, begin, end, values.data());
+        for (int index = begin; index < end; ++index) {
+            if (timestamps[index] >= since && timestamps[index] <= until) {
+                const double value = values[index - begin];
+                accumulate(value, value, 1);
+            }
+        }
+    }
+    return summary;
+}
+
+QVector<SensorSample> SensorSeriesStore::readChunk(int index) const
+{
+    QVector<SensorSample> samples;
+    if (index < 0 || index >= m_chunks.size()) {
+        return samples;
+    }
+    
+    const Chunk& chunk = m_chunks[index];
+    QVector<qint64> timestamps(chunk.count);
+    readColumn(chunk, 0, 0, chunk.count, timestamps.data());
+    samples.resize(chunk.count);
+    for (int i = 0; i < chunk.count; ++i) {
+        samples[i].timestamp = timestamps[i];
+    }
+    QVector<double> values(chunk.count);
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        readColumn(chunk, 1 + c, 0, chunk.count, values.data());
+        for (int i = 0; i < chunk.count; ++i) {
+            samples[i].values[c] = values[i];
+        }
+    }
+    return samples;
+}
+
+int SensorSeriesStore::findChunk(qint64 timestamp) const
+{
+    return firstCandidate(timestamp);
+}
+
+int SensorSeriesStore::importJson(const QString& jsonPath)
+{
+    if (!m_file.isOpen()) {
+        return -1;
+    }
+    
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isArray()) {
+        return -1;
+    }
+    
+    int imported = 0;
+    const QJsonArray points = doc.array();
+    for (const QJsonValue& value : points) {
+        const QJsonObject point = value.toObject();
+        const QDateTime time = QDateTime::fromString(point["timestamp"].toString(), "yyyy-MM-dd hh:mm:ss.zzz");
+        if (!time.isValid()) {
+            continue;
+        }
+        
+        SensorSample sample;
+        sample.timestamp = time.toMSecsSinceEpoch();
+        sample.setValue(SensorChannel::Temperature, point["temperature"].toDouble());
+        sample.setValue(SensorChannel::Humidity, point["humidity"].toDouble());
+        sample.setValue(SensorChannel::Pressure, point["pressure"].toDouble());
+        sample.setValue(SensorChannel::Light, point["light_level"].toDouble());
+        append(sample);
+        ++imported;
+    }
+    flush();
+    return imported;
+}
+
+qint64 SensorSeriesStore::columnOffset(const Chunk& chunk, int column, int index)
+{
+    if (chunk.sealed) {
+        qint64 offset = chunk.offset + CHUNK_HEADER_SIZE;
+        for (int c = 0; c < column; ++c) {
+            offset += chunk.columnBytes[c];
+        }
+        return offset;
+    }
+    return chunk.offset + CHUNK_HEADER_SIZE + (qint64(column) * CHUNK_SAMPLES + index) * 8;
+}
+
+qint64 SensorSeriesStore::payloadBytes(const Chunk& chunk)
+{
+    if (!chunk.sealed) {
+        return CHUNK_BYTES - CHUNK_HEADER_SIZE;
+    }
+    qint64 bytes = 0;
+    for (quint32 columnBytes : chunk.columnBytes) {
+        bytes += columnBytes;
+    }
+    return bytes;
+}
+
+bool SensorSeriesStore::loadChunks()
+{
+    m_sealedEnd = FILE_HEADER_SIZE + CHUNK_BYTES;
+    const qint64 fileSize = m_file.size();
+    if (fileSize == 0) {
+        return !m_readOnly && writeFileHeader();
+    }
+    
+    char header[FILE_HEADER_SIZE];
+    if (m_file.read(header, FILE_HEADER_SIZE) != FILE_HEADER_SIZE
+        || std::memcmp(header, SERIES_MAGIC, sizeof(SERIES_MAGIC)) != 0
+        || qFromLittleEndian<quint32>(header + 8) != quint32(CHUNK_SAMPLES)
+        || qFromLittleEndian<quint32>(header + 12) != quint32(CHANNEL_COUNT)) {
+        return false;
+    }
+    const quint32 version = qFromLittleEndian<quint32>(header + 4);
+    if (version == 1) {
+        loadVersion1();
+        return m_readOnly || upgradeVersion1();
+    }
+    if (version != VERSION) {
+        return false;
+    }
+    
+    // Stop at the first sealed chunk whose header or payload is missing or
+    // partial: it was never committed and will be overwritten
+    Chunk chunk;
+    while (readChunkHeader(m_sealedEnd, chunk) && chunk.sealed && chunk.count > 0) {
+        const qint64 end = m_sealedEnd + CHUNK_HEADER_SIZE + payloadBytes(chunk);
+        if (end > fileSize) {
+            break;
+        }
+        if (!m_chunks.isEmpty() && chunk.minTimestamp < m_chunks.last().maxTimestamp) {
+            m_ordered = false;
+        }
+        m_chunks.append(chunk);
+        m_size += chunk.count;
+        m_sealedEnd = end;
+    }
+    if (fileSize > m_sealedEnd && !m_readOnly) {
+        m_file.resize(m_sealedEnd);
+    }
+    
+    // A tail written before the last seal is already in that sealed chunk
+    Chunk tail;
+    if (!readChunkHeader(FILE_HEADER_SIZE, tail) || tail.sealed || tail.count == 0
+        || tail.sealedBefore < m_chunks.size()) {
+        return true;
+    }
+    if (!m_chunks.isEmpty() && tail.minTimestamp < m_chunks.last().maxTimestamp) {
+        m_ordered = false;
+    }
+    m_chunks.append(tail);
+    m_size += tail.count;
+    
+    // The tail's columns stay in memory; read everything before installing
+    // it, as readColumn() serves the tail from memory once they are in place
+    QVector<qint64> timestamps(tail.count);
+    QVector<double> values[CHANNEL_COUNT];
+    readColumn(tail, 0, 0, tail.count, timestamps.data());
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        values[c].resize(tail.count);
+        readColumn(tail, 1 + c, 0, tail.count, values[c].data());
+    }
+    
+    m_tailTimestamps = timestamps;
+    m_tailTimestamps.reserve(CHUNK_SAMPLES);
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        m_tailValues[c] = values[c];
+        m_tailValues[c].reserve(CHUNK_SAMPLES);
+    }
+    m_tailFlushed = tail.count;
+    return true;
+}
+
+void SensorSeriesStore::loadVersion1()
+{
+    // Version 1 stored every chunk raw, back to back after the file header.
+    // readColumn() reads such chunks from the file like an unflushed tail.
+    Chunk chunk;
+    for (qint64 offset = FILE_HEADER_SIZE; readChunkHeader(offset, chunk); offset += CHUNK_BYTES) {
+        if (chunk.sealed || chunk.count == 0) {
+            break;
+        }
+        if (!m_chunks.isEmpty() && chunk.minTimestamp < m_chunks.last().maxTimestamp) {
+            m_ordered = false;
+        }
+        m_chunks.append(chunk);
+        m_size += chunk.count;
+        if (chunk.count < CHUNK_SAMPLES) {
+            break;
+        }
+    }
+}
+
+bool SensorSeriesStore::upgradeVersion1()
+{
+    const QVector<SensorSample> samples = read();
+    const QString path = m_file.fileName();
+    m_file.close();
+    m_chunks.clear();
+    m_ordered = true;
+    m_size = 0;
+    
+    // The new file is built aside, checked, and swapped in whole, so a crash
+    // or a failed write leaves the version 1 file as it was
+    const QString upgradePath = path + ".v2.tmp";
+    QFile::remove(upgradePath);
+    bool written = false;
+    {
+        SensorSeriesStore upgraded;
+        if (upgraded.open(upgradePath)) {
+            for (const SensorSample& sample : samples) {
+                upgraded.append(sample);
+            }
+            upgraded.close();
+            written = upgraded.open(upgradePath, ReadOnly) && upgraded.size() == samples.size();
+        }
+    }
+    QFile source(upgradePath);
+    QSaveFile target(path);
+    const bool replaced = written && source.open(QIODevice::ReadOnly) && target.open(QIODevice::WriteOnly)
+                          && target.write(source.readAll()) == source.size() && target.commit();
+    source.close();
+    QFile::remove(upgradePath);
+    if (!replaced) {
+        qWarning() << "Failed to upgrade sensor series file:" << path;
+        return false;
+    }
+    
+    qInfo() << "Upgraded sensor series file to version" << VERSION << ":" << samples.size() << "samples";
+    return m_file.open(QIODevice::ReadWrite) && loadChunks();
+}
+
+bool SensorSeriesStore::writeFileHeader()
+{
+    char header[FILE_HEADER_SIZE] = {};
+    std::memcpy(header, SERIES_MAGIC, sizeof(SERIES_MAGIC));
+    qToLittleEndian<quint32>(VERSION, header + 4);
+    qToLittleEndian<quint32>(CHUNK_SAMPLES, header + 8);
+    qToLittleEndian<quint32>(CHANNEL_COUNT, header + 12);
+    return m_file.seek(0) && m_file.write(header, FILE_HEADER_SIZE) == FILE_HEADER_SIZE;
+}
+
+bool SensorSeriesStore::readChunkHeader(qint64 offset, Chunk& chunk) const
+{
+    char header[CHUNK_HEADER_SIZE];
+    if (!m_file.seek(offset) || m_file.read(header, CHUNK_HEADER_SIZE) != CHUNK_HEADER_SIZE) {
+        return false;
+    }
+    const quint32 magic = qFromLittleEndian<quint32>(header);
+    if (magic != CHUNK_MAGIC && magic != SEALED_MAGIC) {
+        return false;
+    }
+    
+    chunk.offset = offset;
+    chunk.sealed = magic == SEALED_MAGIC;
+    chunk.count = static_cast<int>(qFromLittleEndian<quint32>(header + 4));
+    if (chunk.count < 0 || chunk.count > CHUNK_SAMPLES) {
+        return false;
+    }
+    chunk.minTimestamp = qFromLittleEndian<qint64>(header + 8);
+    chunk.maxTimestamp = qFromLittleEndian<qint64>(header + 16);
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        chunk.minValue[c] = getDouble(header + 24 + c * 8);
+        chunk.maxValue[c] = getDouble(header + 24 + (CHANNEL_COUNT + c) * 8);
+    }
+    // Both live after the min/max values; each chunk kind uses one
+    for (int column = 0; column <= CHANNEL_COUNT; ++column) {
+        chunk.columnBytes[column] = chunk.sealed ? qFromLittleEndian<quint32>(header + 88 + column * 4) : 0;
+    }
+    chunk.sealedBefore = chunk.sealed ? 0 : static_cast<int>(qFromLittleEndian<quint32>(header + 88));
+    return true;
+}
+
+bool SensorSeriesStore::writeChunkHeader(const Chunk& chunk)
+{
+    char header[CHUNK_HEADER_SIZE] = {};
+    qToLittleEndian<quint32>(chunk.sealed ? SEALED_MAGIC : CHUNK_MAGIC, header);
+    qToLittleEndian<quint32>(static_cast<quint32>(chunk.count), header + 4);
+    qToLittleEndian<qint64>(chunk.minTimestamp, header + 8);
+    qToLittleEndian<qint64>(chunk.maxTimestamp, header + 16);
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        putDouble(header + 24 + c * 8, chunk.minValue[c]);
+        putDouble(header + 24 + (CHANNEL_COUNT + c) * 8, chunk.maxValue[c]);
+    }
+    if (chunk.sealed) {
+        for (int column = 0; column <= CHANNEL_COUNT; ++column) {
+            qToLittleEndian<quint32>(chunk.columnBytes[column], header + 88 + column * 4);
+        }
+    } else {
+        qToLittleEndian<quint32>(static_cast<quint32>(chunk.sealedBefore), header + 88);
+    }
+    return m_file.seek(chunk.offset) && m_file.write(header, CHUNK_HEADER_SIZE) == CHUNK_HEADER_SIZE;
+}
+
+bool SensorSeriesStore::readColumn(const Chunk& chunk, int column, int begin, int end, void* out) const
+{
+    const int count = end - begin;
+    if (count <= 0) {
+        return true;
+    }
+    
+    // The tail is authoritative in memory, flushed or not
+    const bool isTail = !chunk.sealed && &chunk == &m_chunks.last() && m_tailTimestamps.size() == chunk.count;
+    if (isTail) {
+        const void* source = column == 0
+            ? static_cast<const void*>(m_tailTimestamps.constData() + begin)
+            : static_cast<const void*>(m_tailValues[column - 1].constData() + begin);
+        std::memcpy(out, source, size_t(count) * 8);
+        return true;
+    }
+    
+    if (!chunk.sealed) {
+        const qint64 bytes = qint64(count) * 8;
+        if (!m_file.seek(columnOffset(chunk, column, begin))
+            || m_file.read(static_cast<char*>(out), bytes) != bytes) {
+            std::memset(out, 0, size_t(bytes));
+            return false;
+        }
+        qFromLittleEndian<quint64>(out, count, out);
+        return true;
+    }
+    
+    // Sealed columns decode from their start
+    const QByteArray bytes = m_file.seek(columnOffset(chunk, column, 0))
+        ? m_file.read(chunk.columnBytes[column]) : QByteArray();
+    int index = 0;
+    if (column == 0) {
+        qint64* timestamps = static_cast<qint64*>(out);
+        GorillaTimestampDecoder decoder(bytes.constData(), bytes.size(), end);
+        qint64 timestamp = 0;
+        for (; decoder.next(timestamp); ++index) {
+            if (index >= begin) {
+                timestamps[index - begin] = timestamp;
+            }
+        }
+    } else {
+        double* values = static_cast<double*>(out);
+        GorillaValueDecoder decoder(bytes.constData(), bytes.size(), end);
+        double value = 0.0;
+        for (; decoder.next(value); ++index) {
+            if (index >= begin) {
+                values[index - begin] = value;
+            }
+        }
+    }
+    if (index < end) {
+        std::memset(static_cast<char*>(out) + size_t(qMax(0, index - begin)) * 8, 0,
+                    size_t(end - qMax(begin, index)) * 8);
+        return false;
+    }
+    return true;
+}
+
+bool SensorSeriesStore::matchRange(int chunkIndex, qint64 since, qint64 until,
+                                   QVector<qint64>& timestamps, int& begin, int& end) const
+{
+    const Chunk& chunk = m_chunks[chunkIndex];
+    if (chunk.count == 0 || chunk.maxTimestamp < since || chunk.minTimestamp > until) {
+        return false;
+    }
+    
+    timestamps.resize(chunk.count);
+    readColumn(chunk, 0, 0, chunk.count, timestamps.data());
+    
+    begin = 0;
+    while (begin < chunk.count && (timestamps[begin] < since || timestamps[begin] > until)) {
+        ++begin;
+    }
+    end = chunk.count;
+    while (end > begin && (timestamps[end - 1] < since || timestamps[end - 1] > until)) {
+        --end;
+    }
+    return begin < end;
+}
+
+int SensorSeriesStore::firstCandidate(qint64 since) const
+{
+    if (!m_ordered) {
+        return 0;
+    }
+    auto it = std::lower_bound(m_chunks.begin(), m_chunks.end(), since,
+                               [](const Chunk& chunk, qint64 value) { return chunk.maxTimestamp < value; });
+    return static_cast<int>(it - m_chunks.begin());
+}
+
+bool SensorSeriesStore::hasTail() const
+{
+    return !m_chunks.isEmpty() && !m_chunks.last().sealed;
+}
+
+void SensorSeriesStore::startChunk()
+{
+    Chunk chunk;
+    chunk.offset = FILE_HEADER_SIZE;
+    chunk.sealed = false;
+    chunk.count = 0;
+    chunk.minTimestamp = 0;
+    chunk.maxTimestamp = 0;
+    std::fill(chunk.minValue, chunk.minValue + CHANNEL_COUNT, 0.0);
+    std::fill(chunk.maxValue, chunk.maxValue + CHANNEL_COUNT, 0.0);
+    std::fill(chunk.columnBytes, chunk.columnBytes + CHANNEL_COUNT + 1, 0u);
+    chunk.sealedBefore = m_chunks.size();
+    m_chunks.append(chunk);
+    
+    m_tailTimestamps.clear();
+    m_tailTimestamps.reserve(CHUNK_SAMPLES);
+    for (QVector<double>& column : m_tailValues) {
+        column.clear();
+        column.reserve(CHUNK_SAMPLES);
+    }
+    m_tailFlushed = 0;
+}
+
+bool SensorSeriesStore::sealTail()
+{
+    Chunk sealed = m_chunks.last();
+    sealed.offset = m_sealedEnd;
+    sealed.sealed = true;
+    
+    GorillaTimestampEncoder timestamps;
+    for (qint64 timestamp : m_tailTimestamps) {
+        timestamps.append(timestamp);
+    }
+    QByteArray payload = timestamps.finish();
+    sealed.columnBytes[0] = static_cast<quint32>(payload.size());
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        GorillaValueEncoder values;
+        for (double value : m_tailValues[c]) {
+            values.append(value);
+        }
+        const QByteArray column = values.finish();
+        sealed.columnBytes[1 + c] = static_cast<quint32>(column.size());
+        payload.append(column);
+    }
+    
+    // Payload, then header, then the emptied tail slot; see the class comment
+    Chunk emptyTail = m_chunks.last();
+    emptyTail.count = 0;
+    emptyTail.sealedBefore = m_chunks.size();
+    if (!m_file.seek(sealed.offset + CHUNK_HEADER_SIZE) || m_file.write(payload) != payload.size()
+        || !writeChunkHeader(sealed) || !m_file.flush() || !writeChunkHeader(emptyTail)) {
+        qWarning() << "Failed to write sensor series file:" << m_file.fileName();
+        return false;
+    }
+    m_file.flush();
+    
+    m_chunks.last() = sealed;
+    m_sealedEnd += CHUNK_HEADER_SIZE + payload.size();
+    m_tailTimestamps.clear();
+    for (QVector<double>& column : m_tailValues) {
+        column.clear();
+    }
+    m_tailFlushed = 0;
+    m_sinceFlush.restart();
+    return true;
+}
@@ -0,0 +1,171 @@
+#ifndef SENSORSERIESSTORE_H
+#define SENSORSERIESSTORE_H
+
+#include <QFile>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+#include <limits>
+
+enum class SensorChannel {
+    Temperature,
+    Humidity,
+    Pressure,
+    Light
+};
+
+struct SensorSample {
+    static const int CHANNEL_COUNT = 4;
+    
+    qint64 timestamp = 0;               // ms since epoch
+    double values[CHANNEL_COUNT] = {};  // Indexed by SensorChannel
+    
+    double value(SensorChannel channel) const { return values[static_cast<int>(channel)]; }
+    void setValue(SensorChannel channel, double value) { values[static_cast<int>(channel)] = value; }
+};
+
+// Aggregate over a time range; count == 0 means no samples matched
+struct SensorRangeSummary {
+    qint64 count = 0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// Append-only columnar time-series file for sensor samples.
+//
+// Samples are grouped in chunks of CHUNK_SAMPLES. Each chunk starts with a
+// header (sample count, timestamp range, per-channel min/max) and stores the
+// timestamps and each channel as separate columns, so a read touches only
+// the columns it needs:
+//
+//   file   : "ADTS", version u32, chunk samples u32, channels u32, padding
+//   tail   : header (CHUNK_HEADER_SIZE bytes), i64 timestamps[CHUNK_SAMPLES],
+//            f64 values[CHUNK_SAMPLES] per channel, little-endian
+//   sealed : header, then the Gorilla-compressed columns (see
+//            SensorGorilla.h), their byte sizes in the header
+//
+// The tail slot right after the file header holds the chunk still growing.
+// Appends go to its in-memory copy; flushing writes only the samples added
+// since the last flush, then the slot header, so a crash loses at most the
+// unflushed samples. A full tail is compressed and appended after the last
+// sealed chunk (payload first, header last), then the slot is marked empty.
+// The slot header records how many sealed chunks preceded it, so a crash
+// between the two steps cannot replay the same samples twice.
+//
+// Time-range reads use the chunk headers (kept in memory) to skip every
+// chunk outside the range, and summarize() answers fully covered chunks from
+// their headers alone. A sealed column is decoded from its start, which at
+// CHUNK_SAMPLES values costs a few microseconds.
+//
+// Version 1 files (every chunk raw, back to back) are rewritten to the
+// current layout on open, or read as they are when opened ReadOnly.
+//
+// Not thread-safe.
+class SensorSeriesStore
+{
+public:
+    static const int CHUNK_SAMPLES = 1024;
+    
+    enum OpenMode {
+        ReadWrite,
+        // Never writes: the file must exist, a torn tail is skipped instead
+        // of cut off, and appends are ignored
+        ReadOnly
+    };
+    
+    SensorSeriesStore();
+    ~SensorSeriesStore();
+    
+    // Opens or creates the file; an existing file is validated and its
+    // chunk headers loaded
+    bool open(const QString& filePath, OpenMode mode = ReadWrite);
+    void close();
+    bool isOpen() const;
+    QString filePath() const;
+    
+    void append(const SensorSample& sample);
+    void flush();
+    // Flush when the last flush is older than FLUSH_INTERVAL_MS
+    void flushIfDue();
+    
+    qint64 size() const;
+    int chunkCount() const;
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const;
+    
+    // Samples with since <= timestamp <= until, in append order
+    QVector<SensorSample> read(qint64 since = std::numeric_limits<qint64>::min(),
+                               qint64 until = std::numeric_limits<qint64>::max()) const;
+    // Reads only the timestamp column and one channel column
+    void readChannel(SensorChannel channel, qint64 since, qint64 until,
+                     QVector<qint64>& timestamps, QVector<double>& values) const;
+    SensorRangeSummary summarize(SensorChannel channel,
+                                 qint64 since = std::numeric_limits<qint64>::min(),
+                                 qint64 until = std::numeric_limits<qint64>::max()) const;
+    
+    // Chunk-at-a-time access for sequential readers. findChunk() is the
+    // first chunk that can hold a sample at or after timestamp (always 0
+    // when chunk time ranges overlap).
+    QVector<SensorSample> readChunk(int index) const;
+    int findChunk(qint64 timestamp) const;
+    
+    // Migration from the old config/sensor_data.json array of
+    // {timestamp, temperature, humidity, pressure, light_level} objects.
+    // Returns the number of samples imported, or -1 if the file is unreadable.
+    int importJson(const QString& jsonPath);
+
+private:
+    static const int CHANNEL_COUNT = SensorSample::CHANNEL_COUNT;
+    static const int FILE_HEADER_SIZE = 64;
+    static const int CHUNK_HEADER_SIZE = 128;
+    static const qint64 CHUNK_BYTES = CHUNK_HEADER_SIZE + qint64(CHUNK_SAMPLES) * 8 * (1 + CHANNEL_COUNT);
+    static const quint32 VERSION = 2;
+    static const int FLUSH_INTERVAL_MS = 1000;
+    
+    struct Chunk {
+        qint64 offset;
+        bool sealed;
+        int count;
+        qint64 minTimestamp;
+        qint64 maxTimestamp;
+        double minValue[CHANNEL_COUNT];
+        double maxValue[CHANNEL_COUNT];
+        quint32 columnBytes[1 + CHANNEL_COUNT];    // Sealed only
+        int sealedBefore;                           // Tail only
+    };
+    
+    // Column 0 holds timestamps, column 1 + c channel c. For the tail,
+    // the offset of value index; for sealed chunks, of the column's start.
+    static qint64 columnOffset(const Chunk& chunk, int column, int index);
+    static qint64 payloadBytes(const Chunk& chunk);
+    bool loadChunks();
+    void loadVersion1();
+    bool upgradeVersion1();
+    bool writeFileHeader();
+    bool readChunkHeader(qint64 offset, Chunk& chunk) const;
+    bool writeChunkHeader(const Chunk& chunk);
+    bool readColumn(const Chunk& chunk, int column, int begin, int end, void* out) const;
+    // Indices in [begin, end) of the chunk's samples inside the range;
+    // false if none
+    bool matchRange(int chunkIndex, qint64 since, qint64 until,
+                    QVector<qint64>& timestamps, int& begin, int& end) const;
+    int firstCandidate(qint64 since) const;
+    bool hasTail() const;
+    void startChunk();
+    bool sealTail();
+    
+    mutable QFile m_file;
+    bool m_readOnly;
+    QVector<Chunk> m_chunks;
+    bool m_ordered;     // Chunk time ranges do not overlap, so they can be binary searched
+    qint64 m_size;
+    qint64 m_sealedEnd;     // Where the next sealed chunk goes
+    
+    // Columns of the last chunk, which is the only one still growing
+    QVector<qint64> m_tailTimestamps;
+    QVector<double> m_tailValues[CHANNEL_COUNT];
+    int m_tailFlushed;
+    QElapsedTimer m_sinceFlush;
+};
+
+#endif // SENSORSERIESSTORE_H
@@ -0,0 +1,290 @@
+#include "SensorSignalModel.h"
+#include <QDateTime>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const double TWO_PI = 6.283185307179586;
+static const double MS_PER_HOUR = 3600.0 * 1000.0;
+static const qint64 MS_PER_DAY = 24LL * 3600 * 1000;
+static const qint64 MS_PER_QUARTER_HOUR = 15LL * 60 * 1000;
+
+// Typical cabin readings; models start from or oscillate around these
+static const double BASE_VALUES[SensorSample::CHANNEL_COUNT] = {21.0, 45.0, 1013.25, 400.0};
+
+// Magnus formula coefficients (Alduchov and Eskridge)
+static const double MAGNUS_A = 17.625;
+static const double MAGNUS_B = 243.04;
+
+static int channelIndex(SensorChannel channel)
+{
+    return static_cast<int>(channel);
+}
+
+SensorSignalModel::SensorSignalModel(quint64 seed)
+    : m_generator(seed)
+    , m_seed(seed)
+    , m_lastTimestamp(0)
+    , m_started(false)
+    , m_localTime(false)
+    , m_offsetSlot(std::numeric_limits<qint64>::min())
+    , m_utcOffsetMs(0)
+{
+}
+
+void SensorSignalModel::setHvac(const HvacState&)
+{
+}
+
+quint64 SensorSignalModel::seed() const
+{
+    return m_seed;
+}
+
+std::unique_ptr<SensorSignalModel> SensorSignalModel::create(const QString& name, quint64 seed)
+{
+    if (name == "walk") {
+        return std::make_unique<RandomWalkModel>(seed);
+    }
+    if (name == "diurnal") {
+        return std::make_unique<DiurnalModel>(seed);
+    }
+    if (name == "cabin") {
+        return std::make_unique<CabinThermalModel>(seed);
+    }
+    if (name == "climate") {
+        return std::make_unique<CorrelatedClimateModel>(seed);
+    }
+    return nullptr;
+}
+
+QStringList SensorSignalModel::names()
+{
+    return {"walk", "diurnal", "cabin", "climate"};
+}
+
+double SensorSignalModel::relativeHumidity(double temperature, double dewPoint)
+{
+    const double rh = 100.0 * std::exp(MAGNUS_A * dewPoint / (MAGNUS_B + dewPoint)
+                                       - MAGNUS_A * temperature / (MAGNUS_B + temperature));
+    return qMin(rh, 100.0);
+}
+
+double SensorSignalModel::advance(qint64 timestamp)
+{
+    double dt = 0.0;
+    if (m_started) {
+        dt = qMax<qint64>(0, timestamp - m_lastTimestamp) / 1000.0;
+    }
+    m_started = true;
+    m_lastTimestamp = timestamp;
+    return dt;
+}
+
+double SensorSignalModel::gaussian()
+{
+    return m_normal(m_generator);
+}
+
+double SensorSignalModel::meanReverting(double value, double mean, double tauS, double sigma, double dt)
+{
+    if (dt <= 0.0) {
+        return value;
+    }
+    const double decay = std::exp(-dt / tauS);
+    const double spread = sigma * std::sqrt(tauS / 2.0 * (1.0 - decay * decay));
+    return mean + (value - mean) * decay + spread * gaussian();
+}
+
+void SensorSignalModel::setLocalTime(bool enabled)
+{
+    m_localTime = enabled;
+    m_offsetSlot = std::numeric_limits<qint64>::min();
+    m_utcOffsetMs = 0;
+}
+
+double SensorSignalModel::hourOfDay(qint64 timestamp)
+{
+    if (m_localTime) {
+        // The zone lookup is slow; offsets are whole quarter hours and
+        // change on quarter hour boundaries, so one lookup per quarter hour
+        // is exact
+        const qint64 slot = timestamp / MS_PER_QUARTER_HOUR - (timestamp % MS_PER_QUARTER_HOUR < 0 ? 1 : 0);
+        if (slot != m_offsetSlot) {
+            m_offsetSlot = slot;
+            m_utcOffsetMs = QDateTime::fromMSecsSinceEpoch(timestamp).offsetFromUtc() * 1000LL;
+        }
+        timestamp += m_utcOffsetMs;
+    }
+    const qint64 msOfDay = ((timestamp % MS_PER_DAY) + MS_PER_DAY) % MS_PER_DAY;
+    return msOfDay / MS_PER_HOUR;
+}
+
+double SensorSignalModel::daylight(double hour)
+{
+    // Sunrise at 06:00, sunset at 20:00, 50 klux at noon-ish
+    static const double SUNRISE = 6.0;
+    static const double DAY_LENGTH = 14.0;
+    static const double PEAK_LUX = 50000.0;
+    if (hour <= SUNRISE || hour >= SUNRISE + DAY_LENGTH) {
+        return 0.0;
+    }
+    return PEAK_LUX * std::sin(TWO_PI / 2.0 * (hour - SUNRISE) / DAY_LENGTH);
+}
+
+RandomWalkModel::RandomWalkModel(quint64 seed)
+    : SensorSignalModel(seed)
+{
+    std::copy(BASE_VALUES, BASE_VALUES + SensorSample::CHANNEL_COUNT, m_values);
+}
+
+const char* RandomWalkModel::name() const
+{
+    return "walk";
+}
+
+void RandomWalkModel::generate(SensorSample& sample)
+{
+    // Long-run spread around the start values: 1.5 C, 5 %, 1 hPa, 150 lux
+    static const double SPREAD[SensorSample::CHANNEL_COUNT] = {1.5, 5.0, 1.0, 150.0};
+    static const double TAU_S = 3600.0;
+    
+    const double dt = advance(sample.timestamp);
+    for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+        const double sigma = SPREAD[c] * std::sqrt(2.0 / TAU_S);
+        m_values[c] = meanReverting(m_values[c], BASE_VALUES[c], TAU_S, sigma, dt);
+        sample.values[c] = m_values[c];
+    }
+    sample.values[channelIndex(SensorChannel::Light)] = qMax(0.0, m_values[channelIndex(SensorChannel::Light)]);
+}
+
+DiurnalModel::DiurnalModel(quint64 seed)
+    : SensorSignalModel(seed)
+{
+}
+
+const char* DiurnalModel::name() const
+{
+    return "diurnal";
+}
+
+void DiurnalModel::generate(SensorSample& sample)
+{
+    const double hour = hourOfDay(sample.timestamp);
+    // 1 at 15:00, -1 at 03:00
+    const double daily = std::cos(TWO_PI * (hour - 15.0) / 24.0);
+    // The atmospheric tide peaks around 10:00 and 22:00
+    const double tide = std::cos(TWO_PI * (hour - 10.0) / 12.0);
+    
+    sample.setValue(SensorChannel::Temperature, BASE_VALUES[0] + 4.0 * daily + 0.05 * gaussian());
+    sample.setValue(SensorChannel::Humidity, 50.0 - 10.0 * daily + 0.3 * gaussian());
+    sample.setValue(SensorChannel::Pressure, BASE_VALUES[2] + 0.8 * tide + 0.02 * gaussian());
+    sample.setValue(SensorChannel::Light, qMax(0.0, 0.1 * daylight(hour) + 5.0 * gaussian()));
+}
+
+CabinThermalModel::CabinThermalModel(quint64 seed)
+    : SensorSignalModel(seed)
+    , m_temperature(0.0)
+    , m_dewPoint(0.0)
+    , m_pressure(BASE_VALUES[2])
+    , m_cloudCover(0.3)
+    , m_initialized(false)
+{
+}
+
+const char* CabinThermalModel::name() const
+{
+    return "cabin";
+}
+
+void CabinThermalModel::setHvac(const HvacState& state)
+{
+    m_hvac = state;
+    m_hvac.fanLevel = qBound(0.0, state.fanLevel, 1.0);
+}
+
+void CabinThermalModel::generate(SensorSample& sample)
+{
+    static const double CABIN_TAU_S = 900.0;        // Cabin to outdoor equilibration
+    static const double DEW_TAU_S = 1200.0;
+    static const double HEAT_RATE = 0.03;           // C/s at full fan
+    static const double COOL_RATE = 0.025;
+    static const double SOLAR_GAIN = 2e-7;          // C/s per outdoor lux
+    static const double OUTDOOR_DEW_POINT = 10.0;
+    static const double OCCUPANT_MOISTURE = 1.5;    // Dew point rise from breathing
+    static const double EVAPORATOR_DEW_POINT = 5.0;
+    static const double PROPORTIONAL_BAND = 2.0;    // Full HVAC power this far from the setpoint
+    static const int MAX_SUBSTEPS = 100;
+    
+    const double hour = hourOfDay(sample.timestamp);
+    const double outdoor = 15.0 + 7.0 * std::cos(TWO_PI * (hour - 15.0) / 24.0);
+    if (!m_initialized) {
+        m_temperature = outdoor;
+        m_dewPoint = qMin(OUTDOOR_DEW_POINT, outdoor);
+        m_initialized = true;
+    }
+    const double dt = advance(sample.timestamp);
+    
+    m_cloudCover = qBound(0.0, meanReverting(m_cloudCover, 0.3, 1800.0, 0.2 * std::sqrt(2.0 / 1800.0), dt), 1.0);
+    const double sun = daylight(hour) * (1.0 - 0.75 * m_cloudCover);
+    
+    // HVAC output depends on the cabin temperature, so integrate in steps of
+    // a second (longer only across gaps over MAX_SUBSTEPS seconds), each
+    // exact for inputs held constant over the step
+    double drive = 0.0;
+    const int steps = qMin(MAX_SUBSTEPS, qMax(1, static_cast<int>(std::ceil(dt))));
+    const double step = dt / steps;
+    for (int i = 0; i < steps && dt > 0.0; ++i) {
+        drive = qBound(-1.0, (m_hvac.setpoint - m_temperature) / PROPORTIONAL_BAND, 1.0);
+        switch (m_hvac.mode) {
+            case HvacState::Mode::Off: drive = 0.0; break;
+            case HvacState::Mode::Heat: drive = qMax(drive, 0.0); break;
+            case HvacState::Mode::Cool: drive = qMin(drive, 0.0); break;
+            case HvacState::Mode::Auto: break;
+        }
+        const double hvacRate = m_hvac.fanLevel * (drive > 0.0 ? drive * HEAT_RATE : drive * COOL_RATE);
+        const double equilibrium = outdoor + CABIN_TAU_S * (SOLAR_GAIN * sun + hvacRate);
+        m_temperature = equilibrium + (m_temperature - equilibrium) * std::exp(-step / CABIN_TAU_S);
+    }
+    
+    double dewTarget = OUTDOOR_DEW_POINT + OCCUPANT_MOISTURE;
+    if (drive < 0.0) {
+        dewTarget = qMin(dewTarget, EVAPORATOR_DEW_POINT);
+    }
+    m_dewPoint = qMin(meanReverting(m_dewPoint, dewTarget, DEW_TAU_S, 0.01, dt), m_temperature);
+    m_pressure = meanReverting(m_pressure, BASE_VALUES[2], 3600.0, std::sqrt(2.0 / 3600.0), dt);
+    
+    // Measurement noise on top of the modelled state
+    sample.setValue(SensorChannel::Temperature, m_temperature + 0.05 * gaussian());
+    sample.setValue(SensorChannel::Humidity, qBound(0.0, relativeHumidity(m_temperature, m_dewPoint) + 0.2 * gaussian(), 100.0));
+    sample.setValue(SensorChannel::Pressure, m_pressure + 0.02 * gaussian());
+    sample.setValue(SensorChannel::Light, qMax(0.0, 0.1 * sun + 5.0 * gaussian()));
+}
+
+CorrelatedClimateModel::CorrelatedClimateModel(quint64 seed)
+    : SensorSignalModel(seed)
+    , m_temperature(BASE_VALUES[0])
+    , m_dewPoint(8.0)
+    , m_pressure(BASE_VALUES[2])
+    , m_light(BASE_VALUES[3])
+{
+}
+
+const char* CorrelatedClimateModel::name() const
+{
+    return "climate";
+}
+
+void CorrelatedClimateModel::generate(SensorSample& sample)
+{
+    const double dt = advance(sample.timestamp);
+    m_temperature = meanReverting(m_temperature, BASE_VALUES[0], 1800.0, 2.0 * std::sqrt(2.0 / 1800.0), dt);
+    m_dewPoint = qMin(meanReverting(m_dewPoint, 8.0, 7200.0, 1.5 * std::sqrt(2.0 / 7200.0), dt), m_temperature);
+    m_pressure = meanReverting(m_pressure, BASE_VALUES[2], 3600.0, std::sqrt(2.0 / 3600.0), dt);
+    m_light = meanReverting(m_light, BASE_VALUES[3], 600.0, 150.0 * std::sqrt(2.0 / 600.0), dt);
+    
+    sample.setValue(SensorChannel::Temperature, m_temperature);
+    sample.setValue(SensorChannel::Humidity, relativeHumidity(m_temperature, m_dewPoint));
+    sample.setValue(SensorChannel::Pressure, m_pressure);
+    sample.setValue(SensorChannel::Light, qMax(0.0, m_light));
+}
@@ -0,0 +1,147 @@
+#ifndef SENSORSIGNALMODEL_H
+#define SENSORSIGNALMODEL_H
+
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <random>
+
+#include "SensorSeriesStore.h"
+
+// HVAC command fed to models that respond to it (CabinThermalModel)
+struct HvacState {
+    enum class Mode {
+        Off,
+        Heat,
+        Cool,
+        Auto    // Heats or cools towards the setpoint
+    };
+    
+    Mode mode = Mode::Off;
+    double setpoint = 21.0;     // Celsius
+    double fanLevel = 0.5;      // 0..1, scales heating and cooling power
+};
+
+// Source of raw (uncalibrated) sensor values.
+//
+// A model's output depends only on its seed and the sample timestamps it is
+// given, never on the wall clock, so the same seed and timestamps reproduce
+// the same stream. State advances by the time since the previous sample;
+// timestamps must not go backwards. Not thread-safe.
+class SensorSignalModel
+{
+public:
+    explicit SensorSignalModel(quint64 seed);
+    virtual ~SensorSignalModel() = default;
+    
+    virtual const char* name() const = 0;
+    // Fills sample.values for sample.timestamp
+    virtual void generate(SensorSample& sample) = 0;
+    virtual void setHvac(const HvacState& state);
+    
+    // Daily cycles follow UTC by default, so the stream depends on nothing
+    // but the seed and timestamps. With local time they follow this
+    // machine's time zone, DST included.
+    void setLocalTime(bool enabled);
+    
+    quint64 seed() const;
+    
+    // "walk", "diurnal", "cabin" or "climate"; nullptr for an unknown name
+    static std::unique_ptr<SensorSignalModel> create(const QString& name, quint64 seed);
+    static QStringList names();
+    
+    // Relative humidity (%) of air at temperature with the given dew point,
+    // by the Magnus formula
+    static double relativeHumidity(double temperature, double dewPoint);
+
+protected:
+    // Seconds since the previous sample, 0 on the first
+    double advance(qint64 timestamp);
+    double gaussian();
+    // Ornstein-Uhlenbeck step: a random walk pulled back towards mean with
+    // time constant tau seconds; sigma is the walk's spread per sqrt(second).
+    // Exact for any dt, so a 5 s timer tick and a 1 ms acquisition tick give
+    // the same statistics.
+    double meanReverting(double value, double mean, double tauS, double sigma, double dt);
+    double hourOfDay(qint64 timestamp);
+    // Outdoor daylight (lux) for the hour of day, 0 at night
+    static double daylight(double hour);
+    
+    std::mt19937_64 m_generator;
+
+private:
+    std::normal_distribution<double> m_normal;
+    quint64 m_seed;
+    qint64 m_lastTimestamp;
+    bool m_started;
+    bool m_localTime;
+    qint64 m_offsetSlot;        // UTC quarter hour m_utcOffsetMs was looked up for
+    qint64 m_utcOffsetMs;
+};
+
+// Each channel wanders from a start value as a random walk with a weak pull
+// back to it, so readings change smoothly and stay in a plausible range.
+class RandomWalkModel : public SensorSignalModel
+{
+public:
+    explicit RandomWalkModel(quint64 seed);
+    const char* name() const override;
+    void generate(SensorSample& sample) override;
+
+private:
+    double m_values[SensorSample::CHANNEL_COUNT];
+};
+
+// Daily cycles: temperature peaking mid-afternoon, humidity moving
+// opposite to it, the semi-diurnal atmospheric pressure tide and daylight,
+// plus small measurement noise.
+class DiurnalModel : public SensorSignalModel
+{
+public:
+    explicit DiurnalModel(quint64 seed);
+    const char* name() const override;
+    void generate(SensorSample& sample) override;
+};
+
+// Cabin air as a first-order thermal system.
+//
+// The cabin relaxes towards the outdoor temperature (itself diurnal) plus
+// solar gain, while the HVAC adds or removes heat in proportion to the fan
+// level. Humidity follows from the cabin dew point, which drifts towards the
+// outdoor dew point and drops while cooling as the evaporator condenses
+// water, so it moves with temperature the way a real cabin's does.
+class CabinThermalModel : public SensorSignalModel
+{
+public:
+    explicit CabinThermalModel(quint64 seed);
+    const char* name() const override;
+    void generate(SensorSample& sample) override;
+    void setHvac(const HvacState& state) override;
+
+private:
+    HvacState m_hvac;
+    double m_temperature;
+    double m_dewPoint;
+    double m_pressure;
+    double m_cloudCover;    // 0..1
+    bool m_initialized;
+};
+
+// Temperature and dew point as independent random walks, with humidity
+// derived from both, so humidity falls when temperature rises at constant
+// moisture.
+class CorrelatedClimateModel : public SensorSignalModel
+{
+public:
+    explicit CorrelatedClimateModel(quint64 seed);
+    const char* name() const override;
+    void generate(SensorSample& sample) override;
+
+private:
+    double m_temperature;
+    double m_dewPoint;
+    double m_pressure;
+    double m_light;
+};
+
+#endif // SENSORSIGNALMODEL_H
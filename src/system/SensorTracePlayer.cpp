@@ -0,0 +1,136 @@
+#include "SensorTracePlayer.h"
+
+SensorTracePlayer::SensorTracePlayer()
+    : m_chunk(0)
+    , m_index(0)
+    , m_speed(1.0)
+    , m_anchored(false)
+    , m_anchorTimestamp(0)
+    , m_anchorNs(0)
+{
+}
+
+bool SensorTracePlayer::open(const QString& tracePath)
+{
+    close();
+    // Read-only, so replay works from read-only media and never alters the
+    // trace it plays
+    if (!m_store.open(tracePath, SensorSeriesStore::ReadOnly)) {
+        return false;
+    }
+    m_chunk = -1;
+    fillBuffer();
+    return true;
+}
+
+void SensorTracePlayer::close()
+{
+    m_store.close();
+    m_buffer.clear();
+    m_chunk = 0;
+    m_index = 0;
+    m_anchored = false;
+}
+
+bool SensorTracePlayer::isOpen() const
+{
+    return m_store.isOpen();
+}
+
+qint64 SensorTracePlayer::size() const
+{
+    return m_store.size();
+}
+
+qint64 SensorTracePlayer::firstTimestamp() const
+{
+    return m_store.firstTimestamp();
+}
+
+qint64 SensorTracePlayer::lastTimestamp() const
+{
+    return m_store.lastTimestamp();
+}
+
+void SensorTracePlayer::setSpeed(double speed)
+{
+    m_speed = speed > 0.0 ? speed : AS_FAST_AS_POSSIBLE;
+    m_anchored = false;
+}
+
+double SensorTracePlayer::speed() const
+{
+    return m_speed;
+}
+
+bool SensorTracePlayer::seek(qint64 timestamp)
+{
+    m_anchored = false;
+    m_chunk = m_store.findChunk(timestamp) - 1;
+    m_buffer.clear();
+    m_index = 0;
+    while (fillBuffer()) {
+        while (m_index < m_buffer.size()) {
+            if (m_buffer[m_index].timestamp >= timestamp) {
+                return true;
+            }
+            ++m_index;
+        }
+    }
+    return false;
+}
+
+qint64 SensorTracePlayer::position() const
+{
+    return m_index < m_buffer.size() ? m_buffer[m_index].timestamp : lastTimestamp();
+}
+
+bool SensorTracePlayer::atEnd() const
+{
+    return m_index >= m_buffer.size() && m_chunk >= m_store.chunkCount() - 1;
+}
+
+int SensorTracePlayer::takeDue(qint64 monotonicNs, QVector<SensorSample>& out, int maxSamples)
+{
+    int taken = 0;
+    while (taken < maxSamples && fillBuffer()) {
+        const SensorSample& sample = m_buffer[m_index];
+        if (m_speed > 0.0) {
+            if (!m_anchored) {
+                m_anchored = true;
+                m_anchorTimestamp = sample.timestamp;
+                m_anchorNs = monotonicNs;
+            }
+            const double dueNs = m_anchorNs + (sample.timestamp - m_anchorTimestamp) * 1e6 / m_speed;
+            if (dueNs > monotonicNs) {
+                break;
+            }
+        }
+        out.append(sample);
+        ++m_index;
+        ++taken;
+    }
+    return taken;
+}
+
+bool SensorTracePlayer::next(SensorSample& sample)
+{
+    if (!fillBuffer()) {
+        return false;
+    }
+    sample = m_buffer[m_index++];
+    return true;
+}
+
+bool SensorTracePlayer::fillBuffer()
+{
+    // Skips empty chunks; false at the end of the trace
+    while (m_index >= m_buffer.size()) {
+        if (m_chunk + 1 >= m_store.chunkCount()) {
+            return false;
+        }
+        m_buffer = m_store.readChunk(++m_chunk);
+        m_index = 0;
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef SENSORTRACEPLAYER_H
+#define SENSORTRACEPLAYER_H
+
+#include <QString>
+#include <QVector>
+
+#include "SensorSeriesStore.h"
+
+// Reads a recorded sensor trace (a SensorSeriesStore file, see
+// MockI2C::startRecording()) back in order, paced against a monotonic clock.
+//
+// One chunk is held in memory at a time. Seeking jumps straight to the
+// chunk covering the timestamp through the chunk time ranges. Pacing is
+// re-anchored at the first sample played after open, a seek or a speed
+// change, so playback continues from there instead of trying to catch up.
+// Not thread-safe.
+class SensorTracePlayer
+{
+public:
+    static constexpr double AS_FAST_AS_POSSIBLE = 0.0;
+    
+    SensorTracePlayer();
+    
+    bool open(const QString& tracePath);
+    void close();
+    bool isOpen() const;
+    
+    qint64 size() const;
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const;
+    
+    // 1.0 plays in real time, 10.0 ten times faster; AS_FAST_AS_POSSIBLE
+    // (or any speed <= 0) ignores the recorded timing
+    void setSpeed(double speed);
+    double speed() const;
+    
+    // The next sample played is the first at or after timestamp; false if
+    // there is none
+    bool seek(qint64 timestamp);
+    // Timestamp of the next sample to play
+    qint64 position() const;
+    bool atEnd() const;
+    
+    // Appends the samples due at monotonicNs to out, at most maxSamples;
+    // returns how many were appended
+    int takeDue(qint64 monotonicNs, QVector<SensorSample>& out, int maxSamples);
+    bool next(SensorSample& sample);
+
+private:
+    bool fillBuffer();
+    
+    SensorSeriesStore m_store;
+    QVector<SensorSample> m_buffer;
+    int m_chunk;        // Index of the chunk in m_buffer
+    int m_index;        // Next sample in m_buffer
+    double m_speed;
+    
+    // Pacing anchor: m_anchorTimestamp plays at m_anchorNs
+    bool m_anchored;
+    qint64 m_anchorTimestamp;
+    qint64 m_anchorNs;
+};
+
+#endif // SENSORTRACEPLAYER_H
@@ -0,0 +1,91 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded single-producer/single-consumer ring buffer.
+//
+// Cheaper than LockFreeQueue when there is exactly one thread on each side:
+// each index is written by one thread only, so a push or pop is a plain
+// store plus one release, with no compare-and-swap. Each side caches the
+// other's index and only reloads it when the ring looks full or empty.
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacity)
+        : m_capacity(roundUpToPowerOfTwo(capacity))
+        , m_mask(m_capacity - 1)
+        , m_slots(new T[m_capacity])
+        , m_head(0)
+        , m_cachedTail(0)
+        , m_tail(0)
+        , m_cachedHead(0)
+    {
+    }
+    
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    
+    // Producer side
+    bool tryPush(const T& item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == m_capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == m_capacity) {
+                return false; // Full
+            }
+        }
+        m_slots[head & m_mask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer side
+    bool tryPop(T& item)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) {
+                return false; // Empty
+            }
+        }
+        item = m_slots[tail & m_mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Approximate from either side; exact when the other side is idle.
+    size_t size() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+    
+    size_t capacity() const { return m_capacity; }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+    
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<T[]> m_slots;
+    
+    // Producer-owned and consumer-owned state on separate cache lines
+    alignas(64) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+    alignas(64) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+};
+
+#endif // SPSCRING_H
@@ -1,4 +1,6 @@
 #include "USBMonitor.h"
+#include "MediaScanner.h"
+#include "MediaLibraryIndex.h"
 #include "Logger.h"
 #include <QStandardPaths>
 #include <QStorageInfo>
@@ -10,8 +12,12 @@
 #include <QRegularExpression>
 #include <QUrl>
 #include <QUrlQuery>
+#include <QSet>
+#include <QElapsedTimer>
+#include <algorithm>
 
-const QString USBMonitor::CONFIG_FILE = "config/usb_devices.json";
+const QString USBMonitor::LIBRARY_FILE = "config/media_library.idx";
+const QString USBMonitor::LEGACY_DEVICE_LIST_FILE = "config/usb_devices.json";
 const QStringList USBMonitor::DEFAULT_SUPPORTED_FORMATS = {
     "mp3", "wav", "flac", "aac", "ogg", "wma", "m4a",
     "mp4", "avi", "mkv", "mov", "wmv", "flv", "webm"
@@ -20,6 +26,8 @@ const QStringList USBMonitor::DEFAULT_SUPPORTED_FORMATS = {
 USBMonitor::USBMonitor()
     : m_fileSystemWatcher(std::make_unique<QFileSystemWatcher>(this))
     , m_scanTimer(std::make_unique<QTimer>(this))
+    , m_mediaScanner(std::make_unique<MediaScanner>(this))
+    , m_library(std::make_unique<MediaLibraryIndex>())
     , m_isMonitoring(false)
     , m_autoScan(true)
     , m_simulateMountError(false)
@@ -33,6 +41,16 @@ USBMonitor::USBMonitor()
     // Connect signals
     connect(m_fileSystemWatcher.get(), &QFileSystemWatcher::directoryChanged,
             this, &USBMonitor::scanDirectory);
+    connect(m_mediaScanner.get(), &MediaScanner::filesFound, this, &USBMonitor::onMediaFilesFound);
+    connect(m_mediaScanner.get(), &MediaScanner::scanFinished, this, &USBMonitor::onScanFinished);
+    connect(m_mediaScanner.get(), &MediaScanner::scanProgress, this,
+            [this](const QString& deviceId, const MediaScanStats& stats) {
+        LOG_DEBUG("USBMonitor", QString("Scanning device %1: %2 files in %3 directories (%4 files/s)")
+                                    .arg(deviceId).arg(stats.files).arg(stats.directories)
+                                    .arg(stats.filesPerSecond, 0, 'f', 0));
+        emit mediaScanProgress(deviceId, stats.files, stats.filesPerSecond);
+    });
+    m_mediaScanner->setSupportedFormats(m_supportedFormats);
     connect(m_scanTimer.get(), &QTimer::timeout, this, [this]() {
         for (const auto& device : m_connectedDevices) {
             if (device.isConnected) {
@@ -41,8 +59,8 @@ USBMonitor::USBMonitor()
         }
     });
     
-    // Load saved device list
-    loadDeviceList();
+    // Load the libraries of known volumes
+    loadLibrary();
     
     LOG_INFO("USBMonitor", "USB Monitor system initialized");
 }
@@ -50,7 +68,9 @@ USBMonitor::USBMonitor()
 USBMonitor::~USBMonitor()
 {
     stopMonitoring();
-    saveDeviceList();
+    for (const auto& device : m_connectedDevices) {
+        saveLibrary(device);
+    }
     LOG_INFO("USBMonitor", "USB Monitor system shutdown");
 }
 
@@ -109,6 +129,9 @@ void USBMonitor::simulateUSBInsertion(const QString& deviceName)
     // Create mount directory
     QDir().mkpath(mountPoint);
     
+    // A known volume's library is available at once; the scan only validates it
+    device.volumeId = volumeIdentity(device);
+    restoreLibrary(device);
     m_connectedDevices.append(device);
     
     LOG_INFO("USBMonitor", QString("USB device inserted: %1 at %2").arg(deviceName).arg(mountPoint));
@@ -117,6 +140,7 @@ void USBMonitor::simulateUSBInsertion(const QString& deviceName)
     // Start monitoring the new directory
     if (m_isMonitoring) {
         m_fileSystemWatcher->addPath(mountPoint);
+        scanMediaFiles(deviceId);
     }
 }
 
@@ -137,6 +161,9 @@ void USBMonitor::simulateUSBRemoval(const QString& deviceId)
                 m_fileSystemWatcher->removePath(it->mountPoint);
             }
             
+            m_mediaScanner->cancel(targetDeviceId);
+            m_mediaIndex.remove(targetDeviceId);
+            saveLibrary(*it);
             m_connectedDevices.erase(it);
             break;
         }
@@ -153,17 +180,26 @@ void USBMonitor::mountDevice(const QString& deviceId, const QString& mountPoint)
     
     for (auto& device : m_connectedDevices) {
         if (device.deviceId == deviceId) {
+            // Cached paths are under the old mount point
+            m_mediaScanner->cancel(deviceId);
+            m_mediaIndex.remove(deviceId);
             device.mountPoint = mountPoint;
             device.isConnected = true;
             
             // Create mount directory
             QDir().mkpath(mountPoint);
             
+            device.volumeId = volumeIdentity(device);
+            device.mediaFiles.clear();
+            restoreLibrary(device);
+            
             LOG_INFO("USBMonitor", QString("Device %1 mounted at %2").arg(deviceId).arg(mountPoint));
+            emit mediaFilesChanged(deviceId, device.mediaFiles);
             
             // Start monitoring the new mount point
             if (m_isMonitoring) {
                 m_fileSystemWatcher->addPath(mountPoint);
+                scanMediaFiles(deviceId);
             }
             
             return;
@@ -178,6 +214,7 @@ void USBMonitor::unmountDevice(const QString& deviceId)
     for (auto& device : m_connectedDevices) {
         if (device.deviceId == deviceId) {
             device.isConnected = false;
+            m_mediaScanner->cancel(deviceId);
             
             // Remove from file system watcher
             if (m_isMonitoring) {
@@ -195,6 +232,7 @@ void USBMonitor::addMediaFile(const QString& deviceId, const MediaFile& file)
     for (auto& device : m_connectedDevices) {
         if (device.deviceId == deviceId) {
             device.mediaFiles.append(file);
+            m_mediaIndex.remove(deviceId);
             LOG_INFO("USBMonitor", QString("Added media file: %1 to device %2").arg(file.fileName).arg(deviceId));
             emit mediaFileAdded(deviceId, file);
             emit mediaFilesChanged(deviceId, device.mediaFiles);
@@ -210,6 +248,7 @@ void USBMonitor::removeMediaFile(const QString& deviceId, const QString& fileNam
             for (auto it = device.mediaFiles.begin(); it != device.mediaFiles.end(); ++it) {
                 if (it->fileName == fileName) {
                     device.mediaFiles.erase(it);
+                    m_mediaIndex.remove(deviceId);
                     LOG_INFO("USBMonitor", QString("Removed media file: %1 from device %2").arg(fileName).arg(deviceId));
                     emit mediaFileRemoved(deviceId, fileName);
                     emit mediaFilesChanged(deviceId, device.mediaFiles);
@@ -222,56 +261,17 @@ void USBMonitor::removeMediaFile(const QString& deviceId, const QString& fileNam
 
 void USBMonitor::scanMediaFiles(const QString& deviceId)
 {
-    for (auto& device : m_connectedDevices) {
+    for (const auto& device : m_connectedDevices) {
         if (device.deviceId == deviceId && device.isConnected) {
-            QDir dir(device.mountPoint);
-            if (!dir.exists()) {
+            if (!QDir(device.mountPoint).exists()) {
                 continue;
             }
             
-            QStringList filters;
-            for (const QString& format : m_supportedFormats) {
-                filters << QString("*.%1").arg(format);
-            }
-            
-            QFileInfoList files = dir.entryInfoList(filters, QDir::Files);
-            QList<MediaFile> mediaFiles;
-            
-            for (const QFileInfo& fileInfo : files) {
-                if (isMediaFile(fileInfo.fileName())) {
-                    MediaFile mediaFile;
-                    mediaFile.fileName = fileInfo.fileName();
-                    mediaFile.filePath = fileInfo.absoluteFilePath();
-                    mediaFile.fileSize = fileInfo.size();
-                    mediaFile.fileType = fileInfo.suffix().toLower();
-                    mediaFile.lastModified = fileInfo.lastModified();
-                    
-                    // Try to extract metadata
-                    QString metadata = getFileMetadataInternal(fileInfo.absoluteFilePath());
-                    if (!metadata.isEmpty()) {
-                        QJsonDocument doc = QJsonDocument::fromJson(metadata.toUtf8());
-                        QJsonObject obj = doc.object();
-                        mediaFile.title = obj["title"].toString();
-                        mediaFile.artist = obj["artist"].toString();
-                        mediaFile.album = obj["album"].toString();
-                        mediaFile.duration = obj["duration"].toString();
-                    } else {
-                        // Fallback to filename
-                        mediaFile.title = fileInfo.baseName();
-                        mediaFile.artist = "Unknown Artist";
-                        mediaFile.album = "Unknown Album";
-                        mediaFile.duration = "00:00";
-                    }
-                    
-                    mediaFiles.append(mediaFile);
-                }
+            // Files loaded from the saved device list only need checking
+            if (!m_mediaScanner->isKnown(deviceId)) {
+                m_mediaScanner->prime(deviceId, device.mediaFiles);
             }
-            
-            device.mediaFiles = mediaFiles;
-            updateDeviceSpace(deviceId);
-            
-            LOG_INFO("USBMonitor", QString("Scanned %1 media files from device %2").arg(mediaFiles.size()).arg(deviceId));
-            emit mediaFilesChanged(deviceId, mediaFiles);
+            m_mediaScanner->scan(deviceId, device.mountPoint);
         }
     }
 }
@@ -344,6 +344,7 @@ void USBMonitor::setWatchDirectories(const QStringList& directories)
 void USBMonitor::setSupportedFormats(const QStringList& formats)
 {
     m_supportedFormats = formats;
+    m_mediaScanner->setSupportedFormats(formats);
     LOG_INFO("USBMonitor", QString("Supported formats updated: %1").arg(formats.join(", ")));
 }
 
@@ -423,30 +424,7 @@ void USBMonitor::processMediaFile(const QString& filePath)
         // Find which device this file belongs to
         for (auto& device : m_connectedDevices) {
             if (filePath.startsWith(device.mountPoint)) {
-                MediaFile mediaFile;
-                mediaFile.fileName = fileInfo.fileName();
-                mediaFile.filePath = filePath;
-                mediaFile.fileSize = fileInfo.size();
-                mediaFile.fileType = fileInfo.suffix().toLower();
-                mediaFile.lastModified = fileInfo.lastModified();
-                
-                // Extract metadata
-                QString metadata = getFileMetadataInternal(filePath);
-                if (!metadata.isEmpty()) {
-                    QJsonDocument doc = QJsonDocument::fromJson(metadata.toUtf8());
-                    QJsonObject obj = doc.object();
-                    mediaFile.title = obj["title"].toString();
-                    mediaFile.artist = obj["artist"].toString();
-                    mediaFile.album = obj["album"].toString();
-                    mediaFile.duration = obj["duration"].toString();
-                } else {
-                    mediaFile.title = fileInfo.baseName();
-                    mediaFile.artist = "Unknown Artist";
-                    mediaFile.album = "Unknown Album";
-                    mediaFile.duration = "00:00";
-                }
-                
-                addMediaFile(device.deviceId, mediaFile);
+                addMediaFile(device.deviceId, MediaScanner::describe(fileInfo));
                 break;
             }
         }
@@ -468,136 +446,202 @@ void USBMonitor::updateDeviceSpace(const QString& deviceId)
     }
 }
 
-void USBMonitor::saveDeviceList()
+void USBMonitor::onMediaFilesFound(const QString& deviceId, const QList<MediaFile>& files)
 {
-    QJsonArray deviceArray;
-    for (const auto& device : m_connectedDevices) {
-        QJsonObject deviceObj;
-        deviceObj["deviceId"] = device.deviceId;
-        deviceObj["deviceName"] = device.deviceName;
-        deviceObj["mountPoint"] = device.mountPoint;
-        deviceObj["totalSpace"] = device.totalSpace;
-        deviceObj["freeSpace"] = device.freeSpace;
-        deviceObj["fileSystem"] = device.fileSystem;
-        deviceObj["isConnected"] = device.isConnected;
-        deviceObj["connectedTime"] = device.connectedTime.toString(Qt::ISODate);
+    for (auto& device : m_connectedDevices) {
+        if (device.deviceId != deviceId) {
+            continue;
+        }
         
-        QJsonArray mediaArray;
-        for (const auto& media : device.mediaFiles) {
-            QJsonObject mediaObj;
-            mediaObj["fileName"] = media.fileName;
-            mediaObj["filePath"] = media.filePath;
-            mediaObj["title"] = media.title;
-            mediaObj["artist"] = media.artist;
-            mediaObj["album"] = media.album;
-            mediaObj["duration"] = media.duration;
-            mediaObj["fileSize"] = media.fileSize;
-            mediaObj["fileType"] = media.fileType;
-            mediaObj["lastModified"] = media.lastModified.toString(Qt::ISODate);
-            mediaArray.append(mediaObj);
+        auto index = m_mediaIndex.find(deviceId);
+        if (index == m_mediaIndex.end()) {
+            index = m_mediaIndex.insert(deviceId, QHash<QString, int>());
+            index->reserve(device.mediaFiles.size() + files.size());
+            for (int i = 0; i < device.mediaFiles.size(); ++i) {
+                index->insert(device.mediaFiles[i].filePath, i);
+            }
         }
-        deviceObj["mediaFiles"] = mediaArray;
         
-        deviceArray.append(deviceObj);
-    }
-    
-    QFile file(CONFIG_FILE);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(QJsonDocument(deviceArray).toJson());
-        LOG_DEBUG("USBMonitor", "Device list saved");
+        // New files are appended, changed ones replaced in place
+        for (const MediaFile& file : files) {
+            auto position = index->constFind(file.filePath);
+            if (position != index->constEnd()) {
+                device.mediaFiles[*position] = file;
+            } else {
+                index->insert(file.filePath, device.mediaFiles.size());
+                device.mediaFiles.append(file);
+            }
+        }
+        emit mediaFilesChanged(deviceId, device.mediaFiles);
+        return;
     }
 }
 
-void USBMonitor::loadDeviceList()
+void USBMonitor::onScanFinished(const QString& deviceId, const QStringList& removedPaths, const MediaScanStats& stats)
 {
-    QFile file(CONFIG_FILE);
-    if (file.open(QIODevice::ReadOnly)) {
-        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-        QJsonArray deviceArray = doc.array();
+    for (auto& device : m_connectedDevices) {
+        if (device.deviceId != deviceId) {
+            continue;
+        }
         
-        for (const QJsonValue& value : deviceArray) {
-            QJsonObject deviceObj = value.toObject();
-            USBDevice device;
-            device.deviceId = deviceObj["deviceId"].toString();
-            device.deviceName = deviceObj["deviceName"].toString();
-            device.mountPoint = deviceObj["mountPoint"].toString();
-            device.totalSpace = deviceObj["totalSpace"].toVariant().toLongLong();
-            device.freeSpace = deviceObj["freeSpace"].toVariant().toLongLong();
-            device.fileSystem = deviceObj["fileSystem"].toString();
-            device.isConnected = deviceObj["isConnected"].toBool();
-            device.connectedTime = QDateTime::fromString(deviceObj["connectedTime"].toString(), Qt::ISODate);
-            
-            QJsonArray mediaArray = deviceObj["mediaFiles"].toArray();
-            for (const QJsonValue& mediaValue : mediaArray) {
-                QJsonObject mediaObj = mediaValue.toObject();
-                MediaFile media;
-                media.fileName = mediaObj["fileName"].toString();
-                media.filePath = mediaObj["filePath"].toString();
-                media.title = mediaObj["title"].toString();
-                media.artist = mediaObj["artist"].toString();
-                media.album = mediaObj["album"].toString();
-                media.duration = mediaObj["duration"].toString();
-                media.fileSize = mediaObj["fileSize"].toVariant().toLongLong();
-                media.fileType = mediaObj["fileType"].toString();
-                media.lastModified = QDateTime::fromString(mediaObj["lastModified"].toString(), Qt::ISODate);
-                device.mediaFiles.append(media);
-            }
-            
-            m_connectedDevices.append(device);
+        if (!removedPaths.isEmpty()) {
+            const QSet<QString> removed(removedPaths.begin(), removedPaths.end());
+            device.mediaFiles.erase(std::remove_if(device.mediaFiles.begin(), device.mediaFiles.end(),
+                                                   [&removed](const MediaFile& file) {
+                                                       return removed.contains(file.filePath);
+                                                   }),
+                                    device.mediaFiles.end());
+            m_mediaIndex.remove(deviceId);
+            emit mediaFilesChanged(deviceId, device.mediaFiles);
+        }
+        updateDeviceSpace(deviceId);
+        if (stats.added + stats.changed + stats.removed > 0) {
+            saveLibrary(device);
         }
         
-        LOG_DEBUG("USBMonitor", QString("Loaded %1 devices from config").arg(m_connectedDevices.size()));
+        emit mediaScanProgress(deviceId, stats.files, stats.filesPerSecond);
+        if (!stats.complete) {
+            LOG_WARNING("USBMonitor", QString("Some directories on device %1 could not be read").arg(deviceId));
+        }
+        
+        const QString summary = QString("Scanned %1 media files in %2 directories from device %3 in %4 ms, "
+                                        "%5 files/s (%6 new, %7 changed, %8 removed)")
+                                    .arg(stats.files).arg(stats.directories).arg(deviceId).arg(stats.elapsedMs)
+                                    .arg(stats.filesPerSecond, 0, 'f', 0)
+                                    .arg(stats.added).arg(stats.changed).arg(stats.removed);
+        if (stats.added + stats.changed + stats.removed > 0) {
+            LOG_INFO("USBMonitor", summary);
+        } else {
+            LOG_DEBUG("USBMonitor", summary);
+        }
+        return;
     }
 }
 
-QString USBMonitor::generateDeviceId() const
+void USBMonitor::saveLibrary(const USBDevice& device)
 {
-    return QString("USB_%1").arg(QDateTime::currentMSecsSinceEpoch());
+    if (device.volumeId.isEmpty()) {
+        return;
+    }
+    m_library->store(device, device.volumeId);
+    if (m_library->save()) {
+        LOG_DEBUG("USBMonitor", QString("Saved %1 media files of volume %2")
+                                    .arg(m_library->fileCount(device.volumeId)).arg(device.volumeId));
+    } else {
+        LOG_WARNING("USBMonitor", QString("Could not save the media library to %1").arg(LIBRARY_FILE));
+    }
 }
 
-QString USBMonitor::getFileDuration(const QString& filePath) const
+void USBMonitor::loadLibrary()
 {
-    // Simulate duration extraction
-    QFileInfo fileInfo(filePath);
-    qint64 size = fileInfo.size();
-    
-    // Rough estimation based on file size and type
-    QString extension = fileInfo.suffix().toLower();
-    if (extension == "mp3") {
-        // Assume ~128kbps
-        int durationSeconds = (size * 8) / (128 * 1024);
-        return QString("%1:%2").arg(durationSeconds / 60, 2, 10, QChar('0'))
-                               .arg(durationSeconds % 60, 2, 10, QChar('0'));
-    } else if (extension == "wav") {
-        // Assume 44.1kHz, 16-bit, stereo
-        int durationSeconds = size / (44100 * 2 * 2);
-        return QString("%1:%2").arg(durationSeconds / 60, 2, 10, QChar('0'))
-                               .arg(durationSeconds % 60, 2, 10, QChar('0'));
+    QElapsedTimer timer;
+    timer.start();
+    if (!m_library->load(LIBRARY_FILE)) {
+        migrateLegacyDeviceList();
+        return;
+    }
+    LOG_DEBUG("USBMonitor", QString("Loaded the media libraries of %1 volumes in %2 ms")
+                                .arg(m_library->volumes().size()).arg(timer.elapsed()));
+}
+
+void USBMonitor::restoreLibrary(USBDevice& device)
+{
+    if (!m_library->contains(device.volumeId)) {
+        return;
     }
     
-    return "00:00";
+    QElapsedTimer timer;
+    timer.start();
+    device.mediaFiles = m_library->files(device.volumeId, device.mountPoint);
+    LOG_INFO("USBMonitor", QString("Restored %1 media files of %2 from the media library in %3 ms")
+                               .arg(device.mediaFiles.size()).arg(device.deviceName).arg(timer.elapsed()));
 }
 
-QString USBMonitor::getFileMetadataInternal(const QString& filePath) const
+void USBMonitor::migrateLegacyDeviceList()
 {
-    QFileInfo fileInfo(filePath);
-    QString fileName = fileInfo.baseName();
+    QFile file(LEGACY_DEVICE_LIST_FILE);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
     
-    // Simulate metadata extraction
-    QJsonObject metadata;
-    metadata["title"] = fileName;
-    metadata["artist"] = "Unknown Artist";
-    metadata["album"] = "Unknown Album";
-    metadata["duration"] = getFileDuration(filePath);
+    // Devices are no longer restored, only their libraries
+    const QJsonArray deviceArray = QJsonDocument::fromJson(file.readAll()).array();
+    file.close();
+    int imported = 0;
+    for (const QJsonValue& value : deviceArray) {
+        QJsonObject deviceObj = value.toObject();
+        USBDevice device;
+        device.deviceId = deviceObj["deviceId"].toString();
+        device.deviceName = deviceObj["deviceName"].toString();
+        device.mountPoint = deviceObj["mountPoint"].toString();
+        device.totalSpace = deviceObj["totalSpace"].toVariant().toLongLong();
+        device.fileSystem = deviceObj["fileSystem"].toString();
+        
+        QJsonArray mediaArray = deviceObj["mediaFiles"].toArray();
+        for (const QJsonValue& mediaValue : mediaArray) {
+            QJsonObject mediaObj = mediaValue.toObject();
+            MediaFile media;
+            media.fileName = mediaObj["fileName"].toString();
+            media.filePath = QFileInfo(mediaObj["filePath"].toString()).absoluteFilePath();
+            media.title = mediaObj["title"].toString();
+            media.artist = mediaObj["artist"].toString();
+            media.album = mediaObj["album"].toString();
+            media.duration = mediaObj["duration"].toString();
+            media.fileSize = mediaObj["fileSize"].toVariant().toLongLong();
+            media.fileType = mediaObj["fileType"].toString();
+            media.lastModified = QDateTime::fromString(mediaObj["lastModified"].toString(), Qt::ISODate);
+            device.mediaFiles.append(media);
+        }
+        
+        device.volumeId = volumeIdentity(device);
+        m_library->store(device, device.volumeId);
+        imported += device.mediaFiles.size();
+    }
+    if (!m_library->save()) {
+        LOG_WARNING("USBMonitor", QString("Could not migrate %1").arg(LEGACY_DEVICE_LIST_FILE));
+        return;
+    }
     
-    // Simulate some realistic metadata for common patterns
-    if (fileName.contains(" - ")) {
-        QStringList parts = fileName.split(" - ");
-        if (parts.size() >= 2) {
-            metadata["artist"] = parts[0].trimmed();
-            metadata["title"] = parts[1].trimmed();
+    const QString migratedPath = LEGACY_DEVICE_LIST_FILE + ".migrated";
+    QFile::remove(migratedPath);
+    QFile::rename(LEGACY_DEVICE_LIST_FILE, migratedPath);
+    LOG_INFO("USBMonitor", QString("Migrated %1 media files from %2 to %3")
+                               .arg(imported).arg(LEGACY_DEVICE_LIST_FILE).arg(LIBRARY_FILE));
+}
+
+QString USBMonitor::volumeIdentity(const USBDevice& device) const
+{
+    // A real mount is identified by its file system UUID when udev lists it,
+    // else by its label, type and size
+    const QStorageInfo storage(device.mountPoint);
+    if (storage.isValid() && storage.rootPath() == QDir(device.mountPoint).absolutePath()) {
+        const QString devicePath = QFileInfo(QString::fromLocal8Bit(storage.device())).canonicalFilePath();
+        const QFileInfoList uuids = QDir("/dev/disk/by-uuid").entryInfoList(QDir::Files | QDir::System);
+        for (const QFileInfo& uuid : uuids) {
+            if (!devicePath.isEmpty() && uuid.canonicalFilePath() == devicePath) {
+                return QString("uuid:%1").arg(uuid.fileName());
+            }
         }
+        return QString("volume:%1:%2:%3").arg(storage.name(), QString::fromLocal8Bit(storage.fileSystemType()))
+                                         .arg(storage.bytesTotal());
     }
     
+    // Simulated sticks are directories; their name, file system and size stand in
+    return QString("volume:%1:%2:%3").arg(device.deviceName, device.fileSystem).arg(device.totalSpace);
+}
+
+QString USBMonitor::generateDeviceId() const
+{
+    return QString("USB_%1").arg(QDateTime::currentMSecsSinceEpoch());
+}
+
+QString USBMonitor::getFileMetadataInternal(const QString& filePath) const
+{
+    const MediaFile mediaFile = MediaScanner::describe(QFileInfo(filePath));
+    QJsonObject metadata;
+    metadata["title"] = mediaFile.title;
+    metadata["artist"] = mediaFile.artist;
+    metadata["album"] = mediaFile.album;
+    metadata["duration"] = mediaFile.duration;
     return QJsonDocument(metadata).toJson();
-} 
\ No newline at end of file
+}
@@ -10,8 +10,13 @@
 #include <QJsonDocument>
 #include <QFile>
 #include <QTimer>
+#include <QHash>
 #include <memory>
 
+class MediaScanner;
+class MediaLibraryIndex;
+struct MediaScanStats;
+
 struct MediaFile {
     QString fileName;
     QString filePath;
@@ -26,6 +31,7 @@ struct MediaFile {
 
 struct USBDevice {
     QString deviceId;
+    QString volumeId;       // Stable across insertions; keys the saved media library
     QString deviceName;
     QString mountPoint;
     qint64 totalSpace;
@@ -84,6 +90,7 @@ signals:
     void deviceConnected(const USBDevice& device);
     void deviceDisconnected(const QString& deviceId);
     void mediaFilesChanged(const QString& deviceId, const QList<MediaFile>& files);
+    void mediaScanProgress(const QString& deviceId, int filesScanned, double filesPerSecond);
     void mountError(const QString& deviceId, const QString& error);
     void fileSystemError(const QString& deviceId, const QString& error);
     void mediaFileAdded(const QString& deviceId, const MediaFile& file);
@@ -99,16 +106,24 @@ private:
     void scanDirectory(const QString& path);
     void processMediaFile(const QString& filePath);
     void updateDeviceSpace(const QString& deviceId);
-    void saveDeviceList();
-    void loadDeviceList();
+    void onMediaFilesFound(const QString& deviceId, const QList<MediaFile>& files);
+    void onScanFinished(const QString& deviceId, const QStringList& removedPaths, const MediaScanStats& stats);
+    void saveLibrary(const USBDevice& device);
+    void loadLibrary();
+    void restoreLibrary(USBDevice& device);
+    void migrateLegacyDeviceList();
+    QString volumeIdentity(const USBDevice& device) const;
     QString generateDeviceId() const;
-    QString getFileDuration(const QString& filePath) const;
     QString getFileMetadataInternal(const QString& filePath) const;
     
     std::unique_ptr<QFileSystemWatcher> m_fileSystemWatcher;
     std::unique_ptr<QTimer> m_scanTimer;
+    std::unique_ptr<MediaScanner> m_mediaScanner;
+    std::unique_ptr<MediaLibraryIndex> m_library;
     
     QList<USBDevice> m_connectedDevices;
+    // Position of each file in its device's mediaFiles, by path; rebuilt on demand
+    QHash<QString, QHash<QString, int>> m_mediaIndex;
     QStringList m_watchDirectories;
     QStringList m_supportedFormats;
     
@@ -118,7 +133,8 @@ private:
     bool m_simulateFileSystemError;
     bool m_simulateCorruptedFiles;
     
-    static const QString CONFIG_FILE;
+    static const QString LIBRARY_FILE;
+    static const QString LEGACY_DEVICE_LIST_FILE;
     static const QStringList DEFAULT_SUPPORTED_FORMATS;
 };
 
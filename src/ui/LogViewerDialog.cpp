@@ -0,0 +1,136 @@
+#include "LogViewerDialog.h"
+#include "../system/Logger.h"
+#include <QDateTime>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+LogViewerDialog::LogViewerDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_model(new LogViewerModel(this))
+    , m_searchDebounce(new QTimer(this))
+    , m_cancelImport(false)
+{
+    setWindowTitle("Log Viewer");
+    resize(1000, 600);
+    setupUI();
+    
+    m_searchDebounce->setSingleShot(true);
+    m_searchDebounce->setInterval(SEARCH_DEBOUNCE_MS);
+    connect(m_searchDebounce, &QTimer::timeout, this, &LogViewerDialog::applyFilter);
+    connect(m_model, &LogViewerModel::queryFinished, this, &LogViewerDialog::onQueryFinished);
+    
+    // Subscribed before the import starts so nothing logged meanwhile is lost
+    m_model->setLivePaused(true);
+    connect(&Logger::getInstance(), &Logger::logMessagesAdded,
+            m_model, &LogViewerModel::appendLiveRecords, Qt::QueuedConnection);
+    
+    startImport();
+}
+
+LogViewerDialog::~LogViewerDialog()
+{
+    // The import checks the flag per line, so this returns promptly
+    if (m_importThread) {
+        m_cancelImport = true;
+        m_importThread->wait();
+    }
+}
+
+void LogViewerDialog::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    QHBoxLayout *filterLayout = new QHBoxLayout();
+    
+    m_levelCombo = new QComboBox(this);
+    m_levelCombo->addItems({"DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL"});
+    connect(m_levelCombo, &QComboBox::currentIndexChanged, this, &LogViewerDialog::applyFilter);
+    
+    m_moduleCombo = new QComboBox(this);
+    m_moduleCombo->addItem("All modules");
+    connect(m_moduleCombo, &QComboBox::currentIndexChanged, this, &LogViewerDialog::applyFilter);
+    
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText("Search messages...");
+    connect(m_searchEdit, &QLineEdit::textChanged, m_searchDebounce, qOverload<>(&QTimer::start));
+    
+    filterLayout->addWidget(new QLabel("Level:", this));
+    filterLayout->addWidget(m_levelCombo);
+    filterLayout->addWidget(new QLabel("Module:", this));
+    filterLayout->addWidget(m_moduleCombo);
+    filterLayout->addWidget(m_searchEdit, 1);
+    
+    // Uniform item sizes let the view lay out millions of rows without
+    // asking the model for each one
+    m_listView = new QListView(this);
+    m_listView->setModel(m_model);
+    m_listView->setUniformItemSizes(true);
+    m_listView->setLayoutMode(QListView::Batched);
+    m_listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_listView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_listView->setStyleSheet("font-family: monospace;");
+    
+    m_statusLabel = new QLabel("Loading logs...", this);
+    
+    mainLayout->addLayout(filterLayout);
+    mainLayout->addWidget(m_listView, 1);
+    mainLayout->addWidget(m_statusLabel);
+}
+
+void LogViewerDialog::startImport()
+{
+    const QString logFile = Logger::getInstance().getLogFilePath();
+    Logger::getInstance().flush();
+    
+    // Capped like the model's own store, so a long history evicts its
+    // oldest chunks while importing instead of piling up
+    const qint64 since = QDateTime::currentMSecsSinceEpoch() - IMPORT_WINDOW_MS;
+    m_importedStore = std::make_unique<LogStore>(qint64(LogViewerModel::MAX_ENTRIES));
+    LogStore *store = m_importedStore.get();
+    const std::atomic<bool> *cancel = &m_cancelImport;
+    m_importThread.reset(QThread::create([store, logFile, since, cancel]() {
+        if (!logFile.isEmpty()) {
+            store->importLogFiles(logFile, since, cancel);
+        }
+    }));
+    connect(m_importThread.get(), &QThread::finished, this, &LogViewerDialog::onImportFinished);
+    m_importThread->start(QThread::LowPriority);
+}
+
+void LogViewerDialog::onImportFinished()
+{
+    m_model->replaceStore(std::move(*m_importedStore));
+    m_importedStore.reset();
+    m_model->setLivePaused(false);
+    refreshModules();
+}
+
+void LogViewerDialog::refreshModules()
+{
+    const QString current = m_moduleCombo->currentText();
+    QStringList modules = m_model->store().modules();
+    modules.sort();
+    
+    m_moduleCombo->blockSignals(true);
+    m_moduleCombo->clear();
+    m_moduleCombo->addItem("All modules");
+    m_moduleCombo->addItems(modules);
+    m_moduleCombo->setCurrentIndex(qMax(0, m_moduleCombo->findText(current)));
+    m_moduleCombo->blockSignals(false);
+}
+
+void LogViewerDialog::applyFilter()
+{
+    LogFilter filter;
+    filter.levelMask = LogFilter::levelsAtLeast(static_cast<LogLevel>(m_levelCombo->currentIndex()));
+    if (m_moduleCombo->currentIndex() > 0) {
+        filter.modules << m_moduleCombo->currentText();
+    }
+    filter.text = m_searchEdit->text().trimmed();
+    m_model->setFilter(filter);
+}
+
+void LogViewerDialog::onQueryFinished(int matches, qint64 total, qint64 elapsedNs)
+{
+    m_statusLabel->setText(QString("%1 of %2 entries (query %3 ms)")
+                           .arg(matches).arg(total).arg(elapsedNs / 1e6, 0, 'f', 1));
+}
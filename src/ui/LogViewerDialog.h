@@ -0,0 +1,53 @@
+#ifndef LOGVIEWERDIALOG_H
+#define LOGVIEWERDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QListView>
+#include <QLabel>
+#include <QTimer>
+#include <QThread>
+#include <atomic>
+#include <memory>
+
+#include "LogViewerModel.h"
+
+// Tools > Log Viewer. Imports the current log file and the segments rotated
+// within the last IMPORT_WINDOW_MS on a background thread, then follows new
+// messages live. Closing the dialog cancels an import still running.
+class LogViewerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit LogViewerDialog(QWidget *parent = nullptr);
+    ~LogViewerDialog();
+
+private slots:
+    void applyFilter();
+    void onImportFinished();
+    void onQueryFinished(int matches, qint64 total, qint64 elapsedNs);
+
+private:
+    void setupUI();
+    void startImport();
+    void refreshModules();
+    
+    LogViewerModel *m_model;
+    QListView *m_listView;
+    QComboBox *m_levelCombo;
+    QComboBox *m_moduleCombo;
+    QLineEdit *m_searchEdit;
+    QLabel *m_statusLabel;
+    QTimer *m_searchDebounce;
+    
+    std::unique_ptr<QThread> m_importThread;
+    std::unique_ptr<LogStore> m_importedStore;
+    std::atomic<bool> m_cancelImport;
+    
+    static const int SEARCH_DEBOUNCE_MS = 250;
+    static const qint64 IMPORT_WINDOW_MS = 24LL * 60 * 60 * 1000;
+};
+
+#endif // LOGVIEWERDIALOG_H
@@ -0,0 +1,187 @@
+#include "LogViewerModel.h"
+#include "../system/FastClock.h"
+#include <QBrush>
+#include <QColor>
+
+namespace {
+
+const char* const LEVEL_NAMES[] = {"DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL"};
+
+} // namespace
+
+LogViewerModel::LogViewerModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_store(MAX_ENTRIES)
+    , m_flushTimer(new QTimer(this))
+    , m_livePaused(false)
+    , m_lastQueryTimeNs(0)
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &LogViewerModel::flushPending);
+}
+
+int LogViewerModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_selection.count();
+}
+
+QVariant LogViewerModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_selection.count()) {
+        return QVariant();
+    }
+    
+    const LogStoreEntry entry = m_store.entry(m_selection.entryAt(index.row()));
+    const QString timestamp = FastClock::formatTimestamp(entry.timestamp);
+    const QString level = LEVEL_NAMES[static_cast<int>(entry.level)];
+    
+    switch (role) {
+        case Qt::DisplayRole:
+            return QString("[%1] [%2] [%3] %4").arg(timestamp, level, entry.module, entry.message);
+        case Qt::ForegroundRole:
+            switch (entry.level) {
+                case LogLevel::DEBUG:    return QBrush(QColor("#888888"));
+                case LogLevel::WARNING:  return QBrush(QColor("#e0a030"));
+                case LogLevel::ERROR:
+                case LogLevel::CRITICAL: return QBrush(QColor("#e05050"));
+                default:                 return QVariant();
+            }
+        case TimestampRole:
+            return entry.timestamp;
+        case LevelRole:
+            return level;
+        case ModuleRole:
+            return entry.module;
+        case MessageRole:
+            return entry.message;
+        default:
+            return QVariant();
+    }
+}
+
+void LogViewerModel::setFilter(const LogFilter &filter)
+{
+    m_filter = filter;
+    requery();
+}
+
+LogFilter LogViewerModel::filter() const
+{
+    return m_filter;
+}
+
+void LogViewerModel::replaceStore(LogStore store)
+{
+    qint64 lastImported = std::numeric_limits<qint64>::min();
+    if (store.size() > 0) {
+        lastImported = store.entry(store.endEntryId() - 1).timestamp;
+    }
+    
+    // Live lines from the import's last millisecond may or may not have made
+    // it into the file, so those are matched against the imported ones by
+    // content, each imported line standing in for one live line
+    QVector<LogStoreEntry> lastMillisecond;
+    for (quint64 id = store.endEntryId(); id > store.firstEntryId(); --id) {
+        LogStoreEntry entry = store.entry(id - 1);
+        if (entry.timestamp != lastImported) {
+            break;
+        }
+        lastMillisecond.append(std::move(entry));
+    }
+    auto imported = [&lastMillisecond](const LogStoreEntry &live) {
+        for (int i = 0; i < lastMillisecond.size(); ++i) {
+            const LogStoreEntry &entry = lastMillisecond[i];
+            if (entry.level == live.level && entry.module == live.module && entry.message == live.message) {
+                lastMillisecond.remove(i);
+                return true;
+            }
+        }
+        return false;
+    };
+    
+    m_store = std::move(store);
+    for (const LogStoreEntry &entry : m_pending) {
+        if (entry.timestamp > lastImported || (entry.timestamp == lastImported && !imported(entry))) {
+            m_store.append(entry.timestamp, entry.level, entry.module, entry.message);
+        }
+    }
+    m_pending.clear();
+    requery();
+}
+
+void LogViewerModel::setLivePaused(bool paused)
+{
+    m_livePaused = paused;
+    if (!paused && !m_pending.isEmpty()) {
+        m_flushTimer->start();
+    }
+}
+
+const LogStore &LogViewerModel::store() const
+{
+    return m_store;
+}
+
+qint64 LogViewerModel::lastQueryTimeNs() const
+{
+    return m_lastQueryTimeNs;
+}
+
+void LogViewerModel::appendLiveRecords(const QVector<LogRecord> &records)
+{
+    for (const LogRecord &record : records) {
+        LogStoreEntry entry;
+        entry.timestamp = record.timestamp;
+        entry.level = record.level;
+        entry.module = record.module;
+        entry.message = record.message;
+        m_pending.append(entry);
+    }
+    
+    if (!m_livePaused && !m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void LogViewerModel::flushPending()
+{
+    if (m_livePaused || m_pending.isEmpty()) {
+        return;
+    }
+    
+    for (const LogStoreEntry &entry : m_pending) {
+        m_store.append(entry.timestamp, entry.level, entry.module, entry.message);
+    }
+    m_pending.clear();
+    
+    // Eviction of old chunks shifts every row; otherwise only append
+    if (!m_store.isValid(m_selection)) {
+        requery();
+        return;
+    }
+    
+    LogSelection extended = m_selection;
+    m_store.extend(extended, m_filter);
+    if (extended.count() > m_selection.count()) {
+        beginInsertRows(QModelIndex(), m_selection.count(), extended.count() - 1);
+        m_selection = extended;
+        endInsertRows();
+    } else {
+        m_selection = extended;
+    }
+}
+
+void LogViewerModel::requery()
+{
+    QElapsedTimer timer;
+    timer.start();
+    LogSelection selection = m_store.query(m_filter);
+    m_lastQueryTimeNs = timer.nsecsElapsed();
+    
+    beginResetModel();
+    m_selection = selection;
+    endResetModel();
+    
+    emit queryFinished(m_selection.count(), m_store.size(), m_lastQueryTimeNs);
+}
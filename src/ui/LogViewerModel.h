@@ -0,0 +1,73 @@
+#ifndef LOGVIEWERMODEL_H
+#define LOGVIEWERMODEL_H
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+
+#include "../system/LogStore.h"
+
+// List model over a LogStore query. rowCount() is the number of matching
+// entries, and data() decodes a row only when the view asks for it, so with
+// uniform item sizes a view over millions of rows touches only the visible
+// ones. Live records arrive in batches from Logger::logMessagesAdded and are
+// merged on a short timer, so a burst of log messages becomes one
+// rowsInserted notification.
+class LogViewerModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        TimestampRole = Qt::UserRole + 1,
+        LevelRole,
+        ModuleRole,
+        MessageRole
+    };
+    
+    explicit LogViewerModel(QObject *parent = nullptr);
+    
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    
+    void setFilter(const LogFilter &filter);
+    LogFilter filter() const;
+    
+    // Takes over an imported store, which must be capped at MAX_ENTRIES;
+    // live entries received meanwhile are kept unless the import already
+    // contains them
+    void replaceStore(LogStore store);
+    void setLivePaused(bool paused);
+    
+    const LogStore &store() const;
+    qint64 lastQueryTimeNs() const;
+    
+    // Entries kept in memory; imported stores should be built with the same
+    // cap, see replaceStore()
+    static const int MAX_ENTRIES = 10000000;
+
+public slots:
+    void appendLiveRecords(const QVector<LogRecord> &records);
+
+signals:
+    void queryFinished(int matches, qint64 total, qint64 elapsedNs);
+
+private slots:
+    void flushPending();
+
+private:
+    void requery();
+    
+    LogStore m_store;
+    LogFilter m_filter;
+    LogSelection m_selection;
+    QVector<LogStoreEntry> m_pending;
+    QTimer *m_flushTimer;
+    bool m_livePaused;
+    qint64 m_lastQueryTimeNs;
+    
+    static const int FLUSH_INTERVAL_MS = 100;
+};
+
+#endif // LOGVIEWERMODEL_H
@@ -447,8 +447,13 @@ void MainWindow::showSystemInfo()
 
 void MainWindow::showLogViewer()
 {
-    // TODO: Implement log viewer
-    QMessageBox::information(this, "Log Viewer", "Log viewer not implemented yet.");
+    if (!m_logViewer) {
+        m_logViewer = new LogViewerDialog(this);
+        m_logViewer->setAttribute(Qt::WA_DeleteOnClose);
+    }
+    m_logViewer->show();
+    m_logViewer->raise();
+    m_logViewer->activateWindow();
 }
 
 void MainWindow::showDebugPanel()
@@ -32,11 +32,13 @@
 #include <QPainter>
 #include <QStyle>
 #include <QApplication>
+#include <QPointer>
 
 #include "MediaPlayer.h"
 #include "BluetoothPanel.h"
 #include "ClimateControl.h"
 #include "CameraModule.h"
+#include "LogViewerDialog.h"
 
 class MainWindow : public QMainWindow
 {
@@ -90,6 +92,7 @@ private:
     BluetoothPanel *m_bluetoothPanel;
     ClimateControl *m_climateControl;
     CameraModule *m_cameraModule;
+    QPointer<LogViewerDialog> m_logViewer;
     
     // Status components
     QLabel *m_timeLabel;
@@ -0,0 +1,721 @@
+#include <catch2/catch_test_macros.hpp>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+#include "../src/system/Logger.h"
+#include "../src/system/LockFreeQueue.h"
+#include "../src/system/LogRingBuffer.h"
+#include "../src/system/ModuleLogLevels.h"
+#include "../src/system/LogStore.h"
+#include "../src/system/LogRateLimiter.h"
+#include "../src/system/FastClock.h"
+#include "../src/system/BinaryLogSink.h"
+#include "../src/system/BinaryLogReader.h"
+#include "../src/system/BinaryLogFormat.h"
+#include "../src/system/BlackBoxLog.h"
+
+TEST_CASE("Lock-free log queue", "[logger]") {
+    SECTION("Capacity is rounded up to a power of two") {
+        LockFreeQueue<int> queue(1000);
+        REQUIRE(queue.capacity() == 1024);
+    }
+    
+    SECTION("FIFO order and full/empty detection") {
+        LockFreeQueue<int> queue(4);
+        for (int i = 0; i < 4; ++i) {
+            int value = i;
+            REQUIRE(queue.tryPush(value));
+        }
+        int overflow = 99;
+        REQUIRE_FALSE(queue.tryPush(overflow));
+        REQUIRE(overflow == 99);
+        
+        for (int i = 0; i < 4; ++i) {
+            int value = -1;
+            REQUIRE(queue.tryPop(value));
+            REQUIRE(value == i);
+        }
+        int value = -1;
+        REQUIRE_FALSE(queue.tryPop(value));
+        REQUIRE(queue.isEmpty());
+    }
+    
+    SECTION("Concurrent producers lose nothing") {
+        LockFreeQueue<int> queue(256);
+        const int producerCount = 4;
+        const int perProducer = 10000;
+        QVector<QThread*> producers;
+        for (int p = 0; p < producerCount; ++p) {
+            producers.append(QThread::create([&queue]() {
+                for (int i = 1; i <= perProducer; ++i) {
+                    int value = i;
+                    while (!queue.tryPush(value)) {
+                        QThread::yieldCurrentThread();
+                    }
+                }
+            }));
+            producers.last()->start();
+        }
+        
+        qint64 sum = 0;
+        int received = 0;
+        while (received < producerCount * perProducer) {
+            int value = 0;
+            if (queue.tryPop(value)) {
+                sum += value;
+                ++received;
+            }
+        }
+        for (QThread* producer : producers) {
+            producer->wait();
+            delete producer;
+        }
+        
+        REQUIRE(sum == qint64(producerCount) * perProducer * (perProducer + 1) / 2);
+    }
+}
+
+TEST_CASE("Log ring buffer", "[logger]") {
+    SECTION("Bounded by entry count") {
+        LogRingBuffer buffer(3, 1024 * 1024);
+        for (int i = 0; i < 5; ++i) {
+            buffer.append(QString("line %1").arg(i));
+        }
+        REQUIRE(buffer.size() == 3);
+        REQUIRE(buffer.snapshot() == QStringList({"line 2", "line 3", "line 4"}));
+        REQUIRE(buffer.snapshot(1) == QStringList({"line 4"}));
+        REQUIRE(buffer.joined() == "line 2\nline 3\nline 4\n");
+    }
+    
+    SECTION("Bounded by bytes") {
+        // Each 10-character entry costs 20 bytes of UTF-16
+        LogRingBuffer buffer(100, 50);
+        buffer.append("aaaaaaaaaa");
+        buffer.append("bbbbbbbbbb");
+        buffer.append("cccccccccc");
+        REQUIRE(buffer.size() == 2);
+        REQUIRE(buffer.byteSize() == 40);
+        REQUIRE(buffer.snapshot().first() == "bbbbbbbbbb");
+    }
+    
+    SECTION("Clear resets state") {
+        LogRingBuffer buffer(4, 1024);
+        buffer.append("entry");
+        buffer.clear();
+        REQUIRE(buffer.size() == 0);
+        REQUIRE(buffer.byteSize() == 0);
+        REQUIRE(buffer.joined().isEmpty());
+    }
+}
+
+TEST_CASE("Module log levels", "[logger]") {
+    ModuleLogLevels levels;
+    levels.setGlobalLevel(LogLevel::INFO);
+    
+    SECTION("Global level applies without overrides") {
+        REQUIRE_FALSE(levels.isEnabled(LogLevel::DEBUG, "MockI2C"));
+        REQUIRE(levels.isEnabled(LogLevel::INFO, "MockI2C"));
+        REQUIRE(levels.isEnabled(LogLevel::ERROR, QString("USBMonitor")));
+    }
+    
+    SECTION("Module overrides in both directions") {
+        REQUIRE(levels.setModuleLevel("MockI2C", LogLevel::WARNING));
+        REQUIRE(levels.setModuleLevel("BluetoothSim", LogLevel::DEBUG));
+        
+        REQUIRE_FALSE(levels.isEnabled(LogLevel::INFO, "MockI2C"));
+        REQUIRE(levels.isEnabled(LogLevel::WARNING, "MockI2C"));
+        REQUIRE(levels.isEnabled(LogLevel::DEBUG, QString("BluetoothSim")));
+        REQUIRE_FALSE(levels.isEnabled(LogLevel::DEBUG, "USBMonitor"));
+        REQUIRE(levels.isEnabled(LogLevel::INFO, "USBMonitor"));
+        
+        levels.clearModuleLevel("MockI2C");
+        REQUIRE(levels.effectiveLevel("MockI2C") == LogLevel::INFO);
+        REQUIRE(levels.effectiveLevel("BluetoothSim") == LogLevel::DEBUG);
+    }
+    
+    SECTION("Table capacity is bounded") {
+        for (int i = 0; i < ModuleLogLevels::MAX_MODULES; ++i) {
+            REQUIRE(levels.setModuleLevel(QString("Module%1").arg(i), LogLevel::ERROR));
+        }
+        REQUIRE_FALSE(levels.setModuleLevel("OneTooMany", LogLevel::ERROR));
+        REQUIRE(levels.setModuleLevel("Module7", LogLevel::DEBUG));
+    }
+}
+
+TEST_CASE("Fast clock timestamps", "[logger]") {
+    SECTION("Cached formatting matches QDateTime") {
+        const qint64 base = QDateTime::currentMSecsSinceEpoch();
+        for (qint64 offset : {0LL, 1LL, 999LL, 1000LL, 59999LL, 3600000LL}) {
+            qint64 timestamp = base + offset;
+            REQUIRE(FastClock::formatTimestamp(timestamp)
+                    == QDateTime::fromMSecsSinceEpoch(timestamp).toString("yyyy-MM-dd hh:mm:ss.zzz"));
+        }
+    }
+    
+    SECTION("Wall time tracks the system clock") {
+        FastClock::Now now = FastClock::now();
+        REQUIRE(qAbs(now.wallMs - QDateTime::currentMSecsSinceEpoch()) < 50);
+        REQUIRE(FastClock::now().monotonicNs >= now.monotonicNs);
+    }
+}
+
+TEST_CASE("Log rate limiter", "[logger]") {
+    LogRateLimiter limiter;
+    const qint64 second = 1000000000LL;
+    
+    SECTION("No rules admits everything") {
+        REQUIRE_FALSE(limiter.hasRules());
+        REQUIRE(limiter.allow(LogLevel::DEBUG, "BluetoothSim", 0));
+    }
+    
+    SECTION("Token bucket admits the burst, then the sustained rate") {
+        REQUIRE(limiter.setRateLimit("USBMonitor", LogLevel::DEBUG, 10.0, 5));
+        
+        int admitted = 0;
+        for (int i = 0; i < 100; ++i) {
+            admitted += limiter.allow(LogLevel::DEBUG, "USBMonitor", second) ? 1 : 0;
+        }
+        REQUIRE(admitted == 5);
+        
+        // 300 ms at 10/s earns three more
+        admitted = 0;
+        for (int i = 0; i < 100; ++i) {
+            admitted += limiter.allow(LogLevel::DEBUG, QString("USBMonitor"), second + 300000000LL) ? 1 : 0;
+        }
+        REQUIRE(admitted == 3);
+        
+        // A long pause refills only up to the burst
+        admitted = 0;
+        for (int i = 0; i < 100; ++i) {
+            admitted += limiter.allow(LogLevel::DEBUG, "USBMonitor", 10 * second) ? 1 : 0;
+        }
+        REQUIRE(admitted == 5);
+        
+        // Other levels and modules are unaffected
+        REQUIRE(limiter.allow(LogLevel::INFO, "USBMonitor", 10 * second));
+        REQUIRE(limiter.allow(LogLevel::DEBUG, "MockI2C", 10 * second));
+    }
+    
+    SECTION("Sampling keeps one in N and counts the rest") {
+        REQUIRE(limiter.setSampling("BluetoothSim", LogLevel::DEBUG, 10));
+        int admitted = 0;
+        for (int i = 0; i < 1000; ++i) {
+            admitted += limiter.allow(LogLevel::DEBUG, "BluetoothSim", i) ? 1 : 0;
+        }
+        REQUIRE(admitted == 100);
+        
+        auto suppressed = limiter.takeSuppressed();
+        REQUIRE(suppressed.size() == 1);
+        REQUIRE(suppressed[0].first == "BluetoothSim");
+        REQUIRE(suppressed[0].second == 900);
+        REQUIRE(limiter.takeSuppressed().isEmpty());
+        REQUIRE(limiter.totalSuppressed() == 900);
+    }
+    
+    SECTION("Clearing rules restores the fast path and keeps pending counts") {
+        REQUIRE(limiter.setSampling("BluetoothSim", LogLevel::DEBUG, 2));
+        REQUIRE(limiter.hasRules());
+        limiter.allow(LogLevel::DEBUG, "BluetoothSim", 0);
+        limiter.allow(LogLevel::DEBUG, "BluetoothSim", 1);
+        
+        limiter.clearRules();
+        REQUIRE_FALSE(limiter.hasRules());
+        auto suppressed = limiter.takeSuppressed();
+        REQUIRE(suppressed.size() == 1);
+        REQUIRE(suppressed[0].second == 1);
+        
+        // The slot is reused, and counts as a rule again
+        REQUIRE(limiter.setRateLimit("BluetoothSim", LogLevel::DEBUG, 1.0, 1));
+        REQUIRE(limiter.hasRules());
+        REQUIRE(limiter.setRateLimit("BluetoothSim", LogLevel::DEBUG, 0.0, 1));
+        REQUIRE_FALSE(limiter.hasRules());
+    }
+}
+
+TEST_CASE("Log store queries", "[logger]") {
+    LogStore store;
+    const qint64 start = 1700000000000LL;
+    const QStringList modules = {"MockI2C", "USBMonitor", "BluetoothSim"};
+    for (int i = 0; i < 10000; ++i) {
+        store.append(start + i, static_cast<LogLevel>(i % 5), modules[i % 3], QString("message %1").arg(i));
+    }
+    
+    SECTION("Rows map back to matching entries") {
+        LogFilter filter;
+        filter.modules << "USBMonitor";
+        filter.levelMask = LogFilter::levelsAtLeast(LogLevel::ERROR);
+        LogSelection selection = store.query(filter);
+        
+        // i % 3 == 1 and i % 5 >= 3
+        REQUIRE(selection.count() == 1333);
+        for (int row = 0; row < selection.count(); row += 97) {
+            LogStoreEntry entry = store.entry(selection.entryAt(row));
+            REQUIRE(entry.module == "USBMonitor");
+            REQUIRE(entry.level >= LogLevel::ERROR);
+        }
+    }
+    
+    SECTION("Time range and text filters") {
+        LogFilter filter;
+        filter.since = start + 5000;
+        filter.until = start + 5099;
+        REQUIRE(store.query(filter).count() == 100);
+        
+        filter.text = "MESSAGE 505";
+        LogSelection selection = store.query(filter);
+        REQUIRE(selection.count() == 11);
+        REQUIRE(store.entry(selection.entryAt(0)).message == "message 505");
+    }
+    
+    SECTION("Extend picks up appended entries") {
+        LogFilter filter;
+        filter.modules << "BluetoothSim";
+        LogSelection selection = store.query(filter);
+        int before = selection.count();
+        
+        store.append(start + 20000, LogLevel::INFO, "BluetoothSim", "late");
+        store.append(start + 20001, LogLevel::INFO, "MockI2C", "late");
+        store.extend(selection, filter);
+        REQUIRE(selection.count() == before + 1);
+        REQUIRE(store.entry(selection.entryAt(before)).message == "late");
+    }
+    
+    SECTION("Unknown module matches nothing") {
+        LogFilter filter;
+        filter.modules << "Navigation";
+        REQUIRE(store.query(filter).isEmpty());
+    }
+}
+
+TEST_CASE("Log store import", "[logger]") {
+    const QString path = QDir::tempPath() + "/autodash_test_import.log";
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    for (int i = 0; i < 100; ++i) {
+        file.write(QString("[2024-01-01 12:00:%1.000] [INFO] [ImportTest] line %2\n")
+                   .arg(i % 60, 2, 10, QChar('0')).arg(i).toUtf8());
+    }
+    file.close();
+    
+    SECTION("Every line becomes an entry") {
+        LogStore store;
+        REQUIRE(store.importLogFiles(path) == 100);
+        REQUIRE(store.size() == 100);
+        REQUIRE(store.entry(store.endEntryId() - 1).message == "line 99");
+    }
+    
+    SECTION("A cancelled import stops") {
+        LogStore store;
+        std::atomic<bool> cancel(true);
+        REQUIRE(store.importLogFiles(path, std::numeric_limits<qint64>::min(), &cancel) == 0);
+        REQUIRE(store.size() == 0);
+    }
+    
+    QFile::remove(path);
+}
+
+TEST_CASE("Binary log round trip", "[logger]") {
+    const QString path = QDir::tempPath() + "/autodash_test_binary.blog";
+    QFile::remove(path);
+    
+    BinaryLogSink sink;
+    REQUIRE(sink.open(path));
+    
+    LogRecord formatted;
+    formatted.timestamp = 1700000000123;
+    formatted.monotonicNs = 5000000;
+    formatted.level = LogLevel::DEBUG;
+    formatted.module = "MockI2C";
+    formatted.format = "T=%1°C, fan=%2, mode=%3, heating=%4, odometer=%5";
+    // A placeholder inside a string argument stays as it is
+    formatted.arguments = {21.5, 3, QString("auto %2"), true, quint64(18446744073709551000ULL)};
+    sink.append(formatted);
+    
+    LogRecord text;
+    text.timestamp = 1700000000124;
+    text.monotonicNs = 6000000;
+    text.level = LogLevel::WARNING;
+    text.module = "USBMonitor";
+    text.message = "Mount error";
+    sink.append(text);
+    sink.append(formatted);
+    sink.close();
+    
+    BinaryLogReader reader;
+    REQUIRE(reader.open(path));
+    BinaryLogEntry entry;
+    
+    REQUIRE(reader.readNext(entry));
+    REQUIRE(entry.timestamp == 1700000000123);
+    REQUIRE(entry.level == LogLevel::DEBUG);
+    REQUIRE(entry.module == "MockI2C");
+    REQUIRE(entry.message == QString::fromUtf8("T=21.5°C, fan=3, mode=auto %2, heating=true, "
+                                               "odometer=18446744073709551000"));
+    REQUIRE(entry.message == formatted.renderMessage());
+    
+    REQUIRE(reader.readNext(entry));
+    REQUIRE(entry.level == LogLevel::WARNING);
+    REQUIRE(entry.module == "USBMonitor");
+    REQUIRE(entry.message == "Mount error");
+    
+    REQUIRE(reader.readNext(entry));
+    REQUIRE(entry.module == "MockI2C");
+    REQUIRE_FALSE(reader.readNext(entry));
+    REQUIRE_FALSE(reader.hasError());
+    
+    QFile::remove(path);
+}
+
+TEST_CASE("Binary log corruption is reported", "[logger]") {
+    const QString path = QDir::tempPath() + "/autodash_test_corrupt.blog";
+    QFile::remove(path);
+    
+    BinaryLogSink sink;
+    REQUIRE(sink.open(path));
+    LogRecord text;
+    text.timestamp = 1700000000000;
+    text.monotonicNs = 1000000;
+    text.module = "USBMonitor";
+    text.message = "intact";
+    sink.append(text);
+    sink.close();
+    
+    // A text record whose payload claims 2 GB, followed by ordinary bytes
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::Append));
+    QByteArray damaged;
+    damaged.append(static_cast<char>(BinaryLog::TAG_TEXT));
+    BinaryLog::appendVarint(damaged, 0);
+    damaged.append(static_cast<char>(LogLevel::INFO));
+    BinaryLog::appendVarint(damaged, 0);
+    BinaryLog::appendVarint(damaged, 0x7FFFFFFF);
+    damaged.append(QByteArray(4096, 'x'));
+    file.write(damaged);
+    file.close();
+    
+    BinaryLogReader reader;
+    REQUIRE(reader.open(path));
+    BinaryLogEntry entry;
+    REQUIRE(reader.readNext(entry));
+    REQUIRE(entry.message == "intact");
+    REQUIRE_FALSE(reader.readNext(entry));
+    REQUIRE(reader.hasError());
+    REQUIRE(reader.errorString().contains("Corrupt"));
+    
+    QFile::remove(path);
+}
+
+TEST_CASE("Black box log recovery", "[logger]") {
+    const QString path = QDir::tempPath() + "/autodash_test.blackbox";
+    QFile::remove(path);
+    QByteArray recovered;
+    
+    SECTION("Unsynced lines survive an unclean close") {
+        BlackBoxLog blackBox;
+        REQUIRE(blackBox.open(path, BlackBoxLog::MIN_CAPACITY, &recovered));
+        REQUIRE(recovered.isEmpty());
+        blackBox.append(QByteArray("synced line\n"));
+        blackBox.markSynced();
+        blackBox.append(QByteArray("lost line 1\nlost line 2\n"));
+        REQUIRE(blackBox.unsyncedBytes() == 24);
+        blackBox.close();
+        
+        REQUIRE(blackBox.open(path, BlackBoxLog::MIN_CAPACITY, &recovered));
+        REQUIRE(recovered == "lost line 1\nlost line 2\n");
+        blackBox.close();
+        
+        // Recovery hands the lines over exactly once
+        REQUIRE(blackBox.open(path, BlackBoxLog::MIN_CAPACITY, &recovered));
+        REQUIRE(recovered.isEmpty());
+    }
+    
+    SECTION("A wrapped ring resumes at a line boundary") {
+        BlackBoxLog blackBox;
+        REQUIRE(blackBox.open(path, BlackBoxLog::MIN_CAPACITY));
+        for (int i = 0; i < 5000; ++i) {
+            blackBox.append(QString("line %1 of the wrap test\n").arg(i).toUtf8());
+        }
+        blackBox.close();
+        
+        REQUIRE(blackBox.open(path, BlackBoxLog::MIN_CAPACITY, &recovered));
+        REQUIRE(recovered.size() <= BlackBoxLog::MIN_CAPACITY);
+        REQUIRE(recovered.startsWith("line "));
+        REQUIRE(recovered.endsWith("line 4999 of the wrap test\n"));
+    }
+    
+    SECTION("A different capacity recovers and then resets") {
+        BlackBoxLog blackBox;
+        REQUIRE(blackBox.open(path, BlackBoxLog::MIN_CAPACITY));
+        blackBox.append(QByteArray("before resize\n"));
+        blackBox.close();
+        
+        REQUIRE(blackBox.open(path, 2 * BlackBoxLog::MIN_CAPACITY, &recovered));
+        REQUIRE(recovered == "before resize\n");
+        REQUIRE(blackBox.capacity() == 2 * BlackBoxLog::MIN_CAPACITY);
+        REQUIRE(blackBox.unsyncedBytes() == 0);
+    }
+    
+    QFile::remove(path);
+}
+
+// Stalls the async writer inside a notification, logs count records behind
+// it and returns the message numbers that reached the sinks, plus the
+// writer's overflow warnings in reports
+static QVector<int> overflowStalledQueue(Logger& logger, LogOverflowPolicy policy, int count, QStringList& reports)
+{
+    QSemaphore stalled;
+    QSemaphore release;
+    QVector<int> received;
+    QMetaObject::Connection connection = QObject::connect(&logger, &Logger::logMessageAdded,
+        [&](const QString&, const QString&, const QString& module, const QString& message) {
+            if (module == "Logger" && message.startsWith("Async queue overflow")) {
+                reports.append(message);
+            }
+            if (module != "OverflowTest") {
+                return;
+            }
+            if (message == "stall") {
+                stalled.release();
+                release.acquire();
+            } else {
+                received.append(message.toInt());
+            }
+        });
+    
+    logger.setOverflowPolicy(policy);
+    logger.setAsyncMode(true);
+    LOG_INFO("OverflowTest", "stall");
+    stalled.acquire();
+    for (int i = 0; i < count; ++i) {
+        LOG_INFO("OverflowTest", QString::number(i));
+    }
+    release.release();
+    logger.flush();
+    logger.setAsyncMode(false);
+    
+    QObject::disconnect(connection);
+    logger.setOverflowPolicy(LogOverflowPolicy::BLOCK);
+    return received;
+}
+
+TEST_CASE("Logger async mode", "[logger]") {
+    int argc = 1;
+    char* argv[] = {(char*)"test"};
+    QCoreApplication app(argc, argv);
+    
+    Logger& logger = Logger::getInstance();
+    logger.setConsoleOutput(false);
+    logger.setLogLevel(LogLevel::DEBUG);
+    
+    SECTION("Flush makes async records visible") {
+        logger.setAsyncMode(true);
+        REQUIRE(logger.isAsyncMode());
+        
+        for (int i = 0; i < 100; ++i) {
+            LOG_INFO("AsyncTest", QString("async message %1").arg(i));
+        }
+        logger.flush();
+        
+        REQUIRE(logger.getLogBuffer().contains("async message 99"));
+        logger.setAsyncMode(false);
+        REQUIRE_FALSE(logger.isAsyncMode());
+    }
+    
+    SECTION("Message is not evaluated when the level is disabled") {
+        int evaluations = 0;
+        auto message = [&evaluations]() {
+            ++evaluations;
+            return QString("expensive");
+        };
+        
+        logger.setLogLevel(LogLevel::WARNING);
+        LOG_DEBUG("LazyTest", message());
+        REQUIRE(evaluations == 0);
+        
+        logger.setModuleLogLevel("LazyTest", LogLevel::DEBUG);
+        LOG_DEBUG("LazyTest", message());
+        REQUIRE(evaluations == 1);
+        
+        logger.clearModuleLogLevel("LazyTest");
+        logger.setLogLevel(LogLevel::DEBUG);
+    }
+    
+    SECTION("Size-based rotation keeps N segments") {
+        QDir dir(QDir::tempPath() + "/autodash_test_rotation");
+        dir.removeRecursively();
+        dir.mkpath(".");
+        const QString path = dir.filePath("rotating.log");
+        
+        logger.setLogFile(path);
+        LogRotationPolicy policy;
+        policy.maxBytes = 4096;
+        policy.keepCount = 2;
+        logger.setRotationPolicy(policy);
+        
+        // Rotation happens on the archiver thread, so give it a turn after
+        // every 100 lines (about 7 KB)
+        for (int round = 0; round < 5; ++round) {
+            for (int i = 0; i < 100; ++i) {
+                LOG_INFO("RotationTest", QString("rotation filler message %1").arg(round * 100 + i));
+            }
+            logger.flush();
+            logger.waitForArchiver();
+        }
+        
+        REQUIRE(QFile::exists(path));
+        REQUIRE(LogArchiver::rotatedSegments(path).size() == 2);
+        REQUIRE(QFileInfo(path).size() < 4096 + 256);
+        
+        logger.setRotationPolicy(LogRotationPolicy());
+        dir.removeRecursively();
+    }
+    
+    SECTION("Batched notifications coalesce bursts") {
+        int batches = 0;
+        int received = 0;
+        int perEntry = 0;
+        QMetaObject::Connection batchConnection = QObject::connect(&logger, &Logger::logMessagesAdded,
+            [&](const QVector<LogRecord>& records) {
+                ++batches;
+                for (const LogRecord& record : records) {
+                    if (record.module == "BatchTest") {
+                        ++received;
+                    }
+                }
+            });
+        QMetaObject::Connection entryConnection = QObject::connect(&logger, &Logger::logMessageAdded,
+            [&]() { ++perEntry; });
+        
+        logger.setNotificationInterval(20);
+        for (int i = 0; i < 1000; ++i) {
+            LOG_INFO("BatchTest", QString("burst %1").arg(i));
+        }
+        
+        QElapsedTimer timer;
+        timer.start();
+        while (received < 1000 && timer.elapsed() < 2000) {
+            QCoreApplication::processEvents();
+        }
+        
+        REQUIRE(received == 1000);
+        REQUIRE(batches < 10);
+        REQUIRE(perEntry == 0);
+        
+        QObject::disconnect(batchConnection);
+        QObject::disconnect(entryConnection);
+        logger.setNotificationInterval(0);
+    }
+    
+    SECTION("Black box tail is appended to the log on startup") {
+        const QString previousLog = logger.getLogFilePath();
+        const QString logPath = QDir::tempPath() + "/autodash_test_recovery.log";
+        const QString boxPath = QDir::tempPath() + "/autodash_test_recovery.blackbox";
+        QFile::remove(logPath);
+        QFile::remove(boxPath);
+        
+        {
+            // A session that died before flushing its last line
+            BlackBoxLog crashed;
+            REQUIRE(crashed.open(boxPath, BlackBoxLog::MIN_CAPACITY));
+            crashed.append(QByteArray("[2024-01-01 00:00:00.000] [ERROR] [Crash] last words\n"));
+        }
+        
+        logger.setLogFile(logPath);
+        REQUIRE(logger.setBlackBoxFile(boxPath, BlackBoxLog::MIN_CAPACITY));
+        REQUIRE(logger.getBlackBoxFilePath() == boxPath);
+        LOG_INFO("BlackBoxTest", "written through the mapping");
+        logger.flush();
+        
+        QFile log(logPath);
+        REQUIRE(log.open(QIODevice::ReadOnly));
+        const QByteArray contents = log.readAll();
+        REQUIRE(contents.contains("[Crash] last words"));
+        REQUIRE(contents.indexOf("[Crash] last words") < contents.indexOf("Recovered"));
+        REQUIRE(contents.contains("written through the mapping"));
+        log.close();
+        
+        REQUIRE_FALSE(logger.setBlackBoxFile(QString()));
+        REQUIRE(logger.getBlackBoxFilePath().isEmpty());
+        logger.setLogFile(previousLog);
+        QFile::remove(logPath);
+        QFile::remove(boxPath);
+    }
+    
+    SECTION("Black box text reaches the file once logging goes quiet") {
+        const QString previousLog = logger.getLogFilePath();
+        const QString logPath = QDir::tempPath() + "/autodash_test_quiet.log";
+        const QString boxPath = QDir::tempPath() + "/autodash_test_quiet.blackbox";
+        QFile::remove(logPath);
+        QFile::remove(boxPath);
+        
+        logger.setLogFile(logPath);
+        REQUIRE(logger.setBlackBoxFile(boxPath, BlackBoxLog::MIN_CAPACITY));
+        LOG_INFO("BlackBoxTest", "last line before going quiet");
+        
+        // No further log() calls, only the event loop
+        QElapsedTimer waited;
+        waited.start();
+        QByteArray contents;
+        while (!contents.contains("last line before going quiet") && waited.elapsed() < 5000) {
+            QCoreApplication::processEvents();
+            QThread::msleep(10);
+            QFile log(logPath);
+            if (log.open(QIODevice::ReadOnly)) {
+                contents = log.readAll();
+            }
+        }
+        REQUIRE(contents.contains("last line before going quiet"));
+        
+        REQUIRE_FALSE(logger.setBlackBoxFile(QString()));
+        logger.setLogFile(previousLog);
+        QFile::remove(logPath);
+        QFile::remove(boxPath);
+    }
+    
+    SECTION("Overflow policy is configurable") {
+        logger.setOverflowPolicy(LogOverflowPolicy::DROP_NEWEST);
+        REQUIRE(logger.getOverflowPolicy() == LogOverflowPolicy::DROP_NEWEST);
+        logger.setOverflowPolicy(LogOverflowPolicy::BLOCK);
+        REQUIRE(logger.getOverflowPolicy() == LogOverflowPolicy::BLOCK);
+    }
+    
+    // Twice the queue capacity, so both policies have to drop
+    const int overflowCount = 16384;
+    
+    SECTION("DROP_NEWEST discards and counts the new records") {
+        const quint64 droppedBefore = logger.getDroppedMessageCount();
+        QStringList reports;
+        const QVector<int> received = overflowStalledQueue(logger, LogOverflowPolicy::DROP_NEWEST, overflowCount, reports);
+        const quint64 dropped = logger.getDroppedMessageCount() - droppedBefore;
+        
+        REQUIRE(dropped > 0);
+        REQUIRE(quint64(received.size()) + dropped == quint64(overflowCount));
+        // The records already queued survive, in order
+        for (int i = 0; i < received.size(); ++i) {
+            REQUIRE(received[i] == i);
+        }
+        REQUIRE(reports == QStringList({QString("Async queue overflow: dropped %1 messages").arg(dropped)}));
+    }
+    
+    SECTION("DROP_OLDEST evicts the oldest queued records") {
+        const quint64 droppedBefore = logger.getDroppedMessageCount();
+        QStringList reports;
+        const QVector<int> received = overflowStalledQueue(logger, LogOverflowPolicy::DROP_OLDEST, overflowCount, reports);
+        const quint64 dropped = logger.getDroppedMessageCount() - droppedBefore;
+        
+        REQUIRE(dropped > 0);
+        REQUIRE(quint64(received.size()) + dropped == quint64(overflowCount));
+        // What is left is the newest run, in order
+        for (int i = 0; i < received.size(); ++i) {
+            REQUIRE(received[i] == overflowCount - received.size() + i);
+        }
+        REQUIRE(reports == QStringList({QString("Async queue overflow: dropped %1 messages").arg(dropped)}));
+    }
+}
@@ -0,0 +1,1010 @@
+#include <catch2/catch_test_macros.hpp>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../src/system/SensorSeriesStore.h"
+#include "../src/system/SpscRing.h"
+#include "../src/system/I2CBus.h"
+#include "../src/system/SensorHistory.h"
+#include "../src/system/SensorBatch.h"
+#include "../src/system/SensorTracePlayer.h"
+#include "../src/system/SensorSignalModel.h"
+#include "../src/system/SensorGorilla.h"
+#include "../src/system/SensorPublishFilter.h"
+#include "../src/system/SensorScheduler.h"
+#include "../src/system/MockI2C.h"
+#include "../src/system/Logger.h"
+
+static SensorSample makeSample(qint64 timestamp, double temperature)
+{
+    SensorSample sample;
+    sample.timestamp = timestamp;
+    sample.setValue(SensorChannel::Temperature, temperature);
+    sample.setValue(SensorChannel::Humidity, 50.0);
+    sample.setValue(SensorChannel::Pressure, 1013.25);
+    sample.setValue(SensorChannel::Light, 400.0);
+    return sample;
+}
+
+TEST_CASE("Sensor series store", "[mocki2c]") {
+    const QString path = QDir::tempPath() + "/autodash_test_sensor.series";
+    QFile::remove(path);
+    const qint64 base = 1700000000000LL;
+    const int sampleCount = 3 * SensorSeriesStore::CHUNK_SAMPLES + 100;
+    
+    SensorSeriesStore store;
+    REQUIRE(store.open(path));
+    for (int i = 0; i < sampleCount; ++i) {
+        store.append(makeSample(base + i * 1000LL, 20.0 + (i % 100) * 0.1));
+    }
+    
+    SECTION("Appends are chunked and readable before and after reopening") {
+        REQUIRE(store.size() == sampleCount);
+        REQUIRE(store.chunkCount() == 4);
+        REQUIRE(store.read().size() == sampleCount);
+        
+        store.close();
+        REQUIRE(store.open(path));
+        REQUIRE(store.size() == sampleCount);
+        REQUIRE(store.firstTimestamp() == base);
+        REQUIRE(store.lastTimestamp() == base + (sampleCount - 1) * 1000LL);
+        
+        // Appending after a reopen continues the partial tail chunk
+        store.append(makeSample(base + sampleCount * 1000LL, 30.0));
+        REQUIRE(store.chunkCount() == 4);
+        
+        QVector<SensorSample> samples = store.read();
+        REQUIRE(samples.size() == sampleCount + 1);
+        REQUIRE(samples[1234].timestamp == base + 1234 * 1000LL);
+        REQUIRE(samples[1234].value(SensorChannel::Temperature) == 20.0 + 34 * 0.1);
+        REQUIRE(samples.last().value(SensorChannel::Temperature) == 30.0);
+    }
+    
+    SECTION("Time ranges select across chunk boundaries") {
+        const qint64 since = base + 1000 * 1000LL;
+        const qint64 until = base + 2100 * 1000LL;
+        QVector<SensorSample> samples = store.read(since, until);
+        REQUIRE(samples.size() == 1101);
+        REQUIRE(samples.first().timestamp == since);
+        REQUIRE(samples.last().timestamp == until);
+        
+        QVector<qint64> timestamps;
+        QVector<double> values;
+        store.readChannel(SensorChannel::Pressure, since, until, timestamps, values);
+        REQUIRE(values.size() == 1101);
+        REQUIRE(values[0] == 1013.25);
+        
+        REQUIRE(store.read(base - 10, base - 1).isEmpty());
+    }
+    
+    SECTION("Summaries combine chunk headers and partial chunks") {
+        SensorRangeSummary all = store.summarize(SensorChannel::Temperature);
+        REQUIRE(all.count == sampleCount);
+        REQUIRE(all.min == 20.0);
+        REQUIRE(all.max == 20.0 + 99 * 0.1);
+        
+        SensorRangeSummary partial = store.summarize(SensorChannel::Temperature,
+                                                     base + 10 * 1000LL, base + 20 * 1000LL);
+        REQUIRE(partial.count == 11);
+        REQUIRE(partial.min == 20.0 + 10 * 0.1);
+        REQUIRE(partial.max == 20.0 + 20 * 0.1);
+    }
+    
+    SECTION("Read-only opens never change the file") {
+        store.close();
+        {
+            // A torn write after the last sealed chunk
+            QFile file(path);
+            REQUIRE(file.open(QIODevice::Append));
+            file.write(QByteArray(100, 'x'));
+        }
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        const QByteArray before = file.readAll();
+        file.close();
+        
+        REQUIRE(store.open(path, SensorSeriesStore::ReadOnly));
+        REQUIRE(store.size() == sampleCount);
+        REQUIRE(store.read().size() == sampleCount);
+        store.append(makeSample(base + sampleCount * 1000LL, 30.0));
+        REQUIRE(store.size() == sampleCount);
+        store.close();
+        
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        REQUIRE(file.readAll() == before);
+        file.close();
+        REQUIRE_FALSE(store.open(path + ".missing", SensorSeriesStore::ReadOnly));
+        REQUIRE_FALSE(QFile::exists(path + ".missing"));
+    }
+    
+    store.close();
+    QFile::remove(path);
+}
+
+TEST_CASE("Sensor series version 1 upgrade", "[mocki2c]") {
+    const QString path = QDir::tempPath() + "/autodash_test_sensor_v1.series";
+    QFile::remove(path);
+    QFile::remove(path + ".v1");
+    const qint64 base = 1700000000000LL;
+    
+    // A file holding only a tail chunk has the version 1 layout apart from
+    // its version field
+    {
+        SensorSeriesStore store;
+        REQUIRE(store.open(path));
+        for (int i = 0; i < 100; ++i) {
+            store.append(makeSample(base + i * 1000LL, 20.0 + i * 0.1));
+        }
+    }
+    auto setVersion = [&path](quint32 version) {
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::ReadWrite));
+        REQUIRE(file.seek(4));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    };
+    auto version = [&path]() {
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        const QByteArray header = file.read(8);
+        quint32 value = 0;
+        std::memcpy(&value, header.constData() + 4, sizeof(value));
+        return value;
+    };
+    setVersion(1);
+    
+    SensorSeriesStore store;
+    SECTION("Read-only opens read it as it is") {
+        REQUIRE(store.open(path, SensorSeriesStore::ReadOnly));
+        REQUIRE(store.read().size() == 100);
+        REQUIRE(store.read().last().value(SensorChannel::Temperature) == 20.0 + 99 * 0.1);
+        store.close();
+        REQUIRE(version() == 1);
+    }
+    
+    SECTION("Opening it upgrades the file and leaves nothing behind") {
+        REQUIRE(store.open(path));
+        REQUIRE(store.size() == 100);
+        REQUIRE(store.read().last().value(SensorChannel::Temperature) == 20.0 + 99 * 0.1);
+        store.close();
+        REQUIRE(version() == 2);
+        REQUIRE_FALSE(QFile::exists(path + ".v2.tmp"));
+        REQUIRE(store.open(path));
+        REQUIRE(store.size() == 100);
+    }
+    
+    SECTION("A backup left by an interrupted in-place upgrade is restored") {
+        REQUIRE(QFile::copy(path, path + ".v1"));
+        QFile partial(path);
+        REQUIRE(partial.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        partial.close();
+        REQUIRE(store.open(path));
+        REQUIRE(store.size() == 100);
+        REQUIRE_FALSE(QFile::exists(path + ".v1"));
+    }
+    
+    store.close();
+    QFile::remove(path);
+}
+
+TEST_CASE("Sensor series JSON migration", "[mocki2c]") {
+    const QString jsonPath = QDir::tempPath() + "/autodash_test_sensor_data.json";
+    const QString path = QDir::tempPath() + "/autodash_test_migrated.series";
+    QFile::remove(path);
+    
+    QJsonArray points;
+    for (int i = 0; i < 3; ++i) {
+        QJsonObject point;
+        point["timestamp"] = QString("2024-05-01 12:00:0%1.250").arg(i);
+        point["temperature"] = 21.0 + i;
+        point["humidity"] = 45.0;
+        point["pressure"] = 1013.0;
+        point["light_level"] = 300.0;
+        points.append(point);
+    }
+    QJsonObject broken;
+    broken["timestamp"] = "not a time";
+    points.append(broken);
+    
+    QFile json(jsonPath);
+    REQUIRE(json.open(QIODevice::WriteOnly));
+    json.write(QJsonDocument(points).toJson());
+    json.close();
+    
+    SensorSeriesStore store;
+    REQUIRE(store.open(path));
+    REQUIRE(store.importJson(jsonPath) == 3);
+    REQUIRE(store.importJson(QDir::tempPath() + "/autodash_missing.json") == -1);
+    
+    QVector<SensorSample> samples = store.read();
+    REQUIRE(samples.size() == 3);
+    REQUIRE(samples[2].value(SensorChannel::Temperature) == 23.0);
+    REQUIRE(samples[1].timestamp - samples[0].timestamp == 1000);
+    
+    store.close();
+    QFile::remove(path);
+    QFile::remove(jsonPath);
+}
+
+TEST_CASE("SPSC sample ring", "[mocki2c]") {
+    SpscRing<SensorSample> ring(1000);
+    REQUIRE(ring.capacity() == 1024);
+    
+    SECTION("FIFO order and full/empty detection") {
+        for (int i = 0; i < 1024; ++i) {
+            REQUIRE(ring.tryPush(makeSample(i, 0.0)));
+        }
+        REQUIRE_FALSE(ring.tryPush(makeSample(-1, 0.0)));
+        REQUIRE(ring.size() == 1024);
+        
+        SensorSample sample;
+        for (int i = 0; i < 1024; ++i) {
+            REQUIRE(ring.tryPop(sample));
+            REQUIRE(sample.timestamp == i);
+        }
+        REQUIRE_FALSE(ring.tryPop(sample));
+    }
+    
+    SECTION("Producer and consumer threads") {
+        const int count = 200000;
+        QThread* producer = QThread::create([&ring]() {
+            for (int i = 0; i < count; ++i) {
+                while (!ring.tryPush(makeSample(i, 0.0))) {
+                    QThread::yieldCurrentThread();
+                }
+            }
+        });
+        producer->start();
+        
+        SensorSample sample;
+        qint64 expected = 0;
+        bool ordered = true;
+        while (expected < count) {
+            if (ring.tryPop(sample)) {
+                ordered = ordered && sample.timestamp == expected;
+                ++expected;
+            }
+        }
+        producer->wait();
+        delete producer;
+        REQUIRE(ordered);
+    }
+}
+
+TEST_CASE("Simulated I2C bus", "[mocki2c]") {
+    I2CBus bus(I2CBusSpeed::Fast);
+    const QVector<I2CRegisterSpec> registers = {
+        {0x00, "STATUS", 1, I2CAccess::ReadOnly, 0x01},
+        {0x01, "DATA", 4, I2CAccess::ReadOnly, 0},
+        {0x10, "CONTROL", 2, I2CAccess::ReadWrite, 0x1234}
+    };
+    REQUIRE(bus.attach(std::make_unique<I2CDevice>(0x40, "adc", registers)));
+    REQUIRE(bus.attach(std::make_unique<I2CDevice>(0x41, "adc2", registers)));
+    REQUIRE_FALSE(bus.attach(std::make_unique<I2CDevice>(0x40, "duplicate", registers)));
+    REQUIRE(bus.scan() == QVector<quint8>({0x40, 0x41}));
+    
+    SECTION("Burst reads auto-increment across registers") {
+        REQUIRE(bus.device(0x40)->setValue("DATA", 0xDEADBEEF));
+        quint8 data[6] = {};
+        REQUIRE(bus.read(0x40, 0x00, data, 6) == I2CStatus::Ok);
+        REQUIRE(data[0] == 0x01);
+        REQUIRE(data[1] == 0xDE);
+        REQUIRE(data[4] == 0xEF);
+        REQUIRE(data[5] == 0xFF);   // Unmapped
+    }
+    
+    SECTION("Access rules and missing devices NACK") {
+        const quint8 control[2] = {0xAB, 0xCD};
+        REQUIRE(bus.write(0x40, 0x10, control, 2) == I2CStatus::Ok);
+        REQUIRE(bus.device(0x40)->value(0x10) == 0xABCD);
+        REQUIRE(bus.device(0x41)->value(0x10) == 0x1234);
+        REQUIRE(bus.write(0x40, 0x00, control, 1) == I2CStatus::DataNack);
+        
+        quint8 byte = 0;
+        REQUIRE(bus.read(0x40, 0x20, &byte, 1) == I2CStatus::DataNack);
+        REQUIRE(bus.read(0x50, 0x00, &byte, 1) == I2CStatus::AddressNack);
+        REQUIRE(bus.stats().nacks == 3);
+    }
+    
+    SECTION("Wire time follows the bus clock") {
+        // 30 overhead clocks + 9 per byte: 48 clocks for 2 bytes
+        REQUIRE(bus.readDurationNs(2) == 120000);
+        bus.setSpeed(I2CBusSpeed::Standard);
+        REQUIRE(bus.readDurationNs(2) == 480000);
+        
+        quint8 data[2];
+        const qint64 before = bus.busTimeNs();
+        bus.read(0x40, 0x10, data, 2);
+        REQUIRE(bus.busTimeNs() - before == 480000);
+    }
+    
+    SECTION("Polling plans are checked against bandwidth") {
+        const qint64 ms = 1000000;
+        QVector<I2CPoll> plan = {
+            {0x40, 0x01, 4, 1 * ms},
+            {0x41, 0x01, 4, 1 * ms}
+        };
+        // 2 x 66 clocks per ms = 33% of a 400 kHz bus
+        I2CScheduleReport report = bus.simulateSchedule(plan, 100 * ms);
+        REQUIRE(report.fits);
+        REQUIRE(report.polls[0].completed == 100);
+        REQUIRE(report.utilization > 0.3);
+        REQUIRE(report.utilization < 0.35);
+        
+        bus.setSpeed(I2CBusSpeed::Standard);
+        report = bus.simulateSchedule(plan, 100 * ms);
+        REQUIRE_FALSE(report.fits);
+        REQUIRE(report.utilization > 0.99);
+    }
+}
+
+TEST_CASE("Rolling sensor history", "[mocki2c]") {
+    const qint64 windowMs = 10000;
+    SensorHistory history(64, {windowMs, 60000});
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> temperature(15.0, 30.0);
+    
+    // 1 Hz for 5000 s: the short window holds the last 10 samples, the ring
+    // the last 64, and the long window's sums are recomputed on the way
+    QVector<double> values;
+    for (int i = 0; i < 5000; ++i) {
+        SensorSample sample;
+        sample.timestamp = 1000LL * i;
+        sample.setValue(SensorChannel::Temperature, temperature(rng));
+        values.append(sample.value(SensorChannel::Temperature));
+        history.add(sample);
+    }
+    REQUIRE(history.size() == 64);
+    REQUIRE(history.latest().timestamp == 4999000);
+    REQUIRE(history.at(0).timestamp == 4936000);
+    REQUIRE(history.recent(3).size() == 3);
+    
+    auto expected = [&values](int count) {
+        std::vector<double> window(values.end() - count, values.end());
+        double sum = 0.0;
+        for (double value : window) {
+            sum += value;
+        }
+        const double mean = sum / count;
+        double squares = 0.0;
+        for (double value : window) {
+            squares += (value - mean) * (value - mean);
+        }
+        std::sort(window.begin(), window.end());
+        return std::make_tuple(mean, std::sqrt(squares / (count - 1)), window);
+    };
+    
+    const int windowCounts[] = {10, 60};
+    for (int w = 0; w < 2; ++w) {
+        const auto [mean, stddev, sorted] = expected(windowCounts[w]);
+        SensorWindowStats stats = history.stats(SensorChannel::Temperature, w);
+        REQUIRE(stats.count == windowCounts[w]);
+        REQUIRE(std::abs(stats.mean - mean) < 1e-9);
+        REQUIRE(std::abs(stats.stddev - stddev) < 1e-9);
+        REQUIRE(stats.min == sorted.front());
+        REQUIRE(stats.max == sorted.back());
+        
+        // Within one histogram bin of the exact median
+        double low, high;
+        SensorHistory::histogramRange(SensorChannel::Temperature, low, high);
+        const double binWidth = (high - low) / SensorHistory::HISTOGRAM_BINS;
+        const double median = history.percentile(SensorChannel::Temperature, 0.5, w);
+        REQUIRE(median >= sorted[(sorted.size() - 1) / 2] - binWidth);
+        REQUIRE(median <= sorted[sorted.size() / 2] + binWidth);
+        REQUIRE(history.percentile(SensorChannel::Temperature, 0.0, w) == sorted.front());
+        REQUIRE(history.percentile(SensorChannel::Temperature, 1.0, w) == sorted.back());
+    }
+    
+    const SensorWindowStats stats = history.stats(SensorChannel::Temperature);
+    REQUIRE(std::abs(history.zScore(SensorChannel::Temperature, stats.mean + 3 * stats.stddev) - 3.0) < 1e-9);
+    
+    history.clear();
+    REQUIRE(history.isEmpty());
+    REQUIRE(history.stats(SensorChannel::Humidity).count == 0);
+    
+    // Pressure read on every 10th sample and repeated in between: the
+    // repeats stay in the ring but out of its statistics
+    const quint32 temperatureOnly = 1u << static_cast<int>(SensorChannel::Temperature);
+    for (int i = 0; i < 50; ++i) {
+        SensorSample sample;
+        sample.timestamp = 100LL * i;
+        sample.setValue(SensorChannel::Temperature, 20.0 + i % 3);
+        sample.setValue(SensorChannel::Pressure, 1000.0 + i / 10);
+        history.add(sample, i % 10 == 0 ? SensorHistory::ALL_CHANNELS : temperatureOnly);
+    }
+    REQUIRE(history.size() == 50);
+    REQUIRE(history.stats(SensorChannel::Temperature).count == 50);
+    const SensorWindowStats pressure = history.stats(SensorChannel::Pressure);
+    REQUIRE(pressure.count == 5);
+    REQUIRE(std::abs(pressure.mean - 1002.0) < 1e-9);
+    REQUIRE(std::abs(pressure.stddev - std::sqrt(2.5)) < 1e-9);
+    REQUIRE(pressure.min == 1000.0);
+    REQUIRE(pressure.max == 1004.0);
+    REQUIRE(history.percentile(SensorChannel::Pressure, 1.0) == 1004.0);
+}
+
+TEST_CASE("Batch calibration and filtering", "[mocki2c]") {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> value(-100.0, 1300.0);
+    SensorBlock source;
+    for (int i = 0; i < 1003; ++i) {
+        SensorSample sample;
+        sample.timestamp = i;
+        for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+            sample.values[c] = value(rng);
+        }
+        source.append(sample);
+    }
+    source.values[0][7] = std::nan("");
+    
+    SensorCalibration calibration;
+    calibration.offsets[0] = 1.5;
+    calibration.offsets[2] = -20.0;
+    
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX};
+    for (SimdLevel level : levels) {
+        SensorBatch::setSimdLevel(level);
+        
+        SECTION(std::string("Calibration matches the per-sample path: ") + SensorBatch::simdLevelName(level)) {
+            SensorBlock block = source;
+            SensorBatch::calibrate(block, calibration);
+            for (int i = 0; i < source.size(); ++i) {
+                SensorSample expected = source.sample(i);
+                SensorBatch::calibrate(expected, calibration);
+                for (int c = 0; c < SensorSample::CHANNEL_COUNT; ++c) {
+                    if (std::isnan(expected.values[c])) {
+                        REQUIRE(std::isnan(block.values[c][i]));
+                    } else {
+                        REQUIRE(block.values[c][i] == expected.values[c]);
+                    }
+                }
+            }
+        }
+        
+        SECTION(std::string("FIR output is independent of block boundaries: ") + SensorBatch::simdLevelName(level)) {
+            const QVector<double> coefficients = {0.1, 0.2, 0.4, 0.2, 0.1};
+            SensorBlock whole = source;
+            SensorFilter::fir(coefficients).process(whole);
+            
+            SensorFilter streamed = SensorFilter::fir(coefficients);
+            int offset = 0;
+            for (int size : {1, 2, 3, 500, 497}) {
+                SensorBlock block;
+                for (int i = offset; i < offset + size; ++i) {
+                    block.append(source.sample(i));
+                }
+                streamed.process(block);
+                for (int i = 0; i < size; ++i) {
+                    // Direct form, with the history seeded from sample 0
+                    double expected = 0.0;
+                    for (int k = 0; k < coefficients.size(); ++k) {
+                        expected += coefficients[k] * source.values[1][qMax(offset + i - k, 0)];
+                    }
+                    REQUIRE(std::abs(block.values[1][i] - expected) < 1e-9);
+                    REQUIRE(std::abs(block.values[1][i] - whole.values[1][offset + i]) < 1e-9);
+                }
+                offset += size;
+            }
+        }
+    }
+    SensorBatch::setSimdLevel(SensorBatch::detectedSimdLevel());
+    
+    SECTION("Exponential smoothing") {
+        SensorBlock block;
+        for (int i = 0; i < 4; ++i) {
+            block.append(makeSample(i, i == 0 ? 10.0 : 20.0));
+        }
+        SensorFilter filter = SensorFilter::exponential(0.5);
+        filter.process(block);
+        REQUIRE(block.values[0][0] == 10.0);
+        REQUIRE(block.values[0][1] == 15.0);
+        REQUIRE(block.values[0][3] == 18.75);
+        REQUIRE(block.values[1][3] == 50.0);
+        REQUIRE(SensorFilter::exponential(1.0).type() == SensorFilter::Type::None);
+    }
+}
+
+TEST_CASE("Sensor trace replay", "[mocki2c]") {
+    const QString path = QDir::tempPath() + "/autodash_test_trace.series";
+    QFile::remove(path);
+    {
+        // Three chunks at 10 Hz
+        SensorSeriesStore store;
+        REQUIRE(store.open(path));
+        for (int i = 0; i < 3000; ++i) {
+            store.append(makeSample(100000 + i * 100LL, 20.0 + i * 0.001));
+        }
+        store.close();
+    }
+    
+    SensorTracePlayer player;
+    REQUIRE_FALSE(player.open(QDir::tempPath() + "/autodash_missing_trace.series"));
+    REQUIRE(player.open(path));
+    REQUIRE(player.size() == 3000);
+    REQUIRE(player.position() == 100000);
+    
+    SECTION("Seek by timestamp") {
+        REQUIRE(player.seek(100000 + 2500 * 100LL + 50));
+        SensorSample sample;
+        REQUIRE(player.next(sample));
+        REQUIRE(sample.timestamp == 100000 + 2501 * 100LL);
+        REQUIRE(sample.value(SensorChannel::Temperature) == 20.0 + 2501 * 0.001);
+        
+        REQUIRE(player.seek(0));
+        REQUIRE(player.position() == 100000);
+        REQUIRE_FALSE(player.seek(100000 + 3000 * 100LL));
+        REQUIRE(player.atEnd());
+    }
+    
+    SECTION("Paced playback") {
+        QVector<SensorSample> due;
+        const qint64 start = 5000000000LL;
+        player.setSpeed(1.0);
+        REQUIRE(player.takeDue(start, due, 1000) == 1);             // Anchors on the first sample
+        REQUIRE(player.takeDue(start + 250000000LL, due, 1000) == 2);  // 250 ms: two more at 10 Hz
+        
+        player.setSpeed(10.0);
+        REQUIRE(player.takeDue(start + 300000000LL, due, 1000) == 1);  // Re-anchored
+        REQUIRE(player.takeDue(start + 400000000LL, due, 1000) == 10); // 100 ms at 10x
+        REQUIRE(due.last().timestamp == 100000 + 13 * 100LL);
+        
+        player.setSpeed(SensorTracePlayer::AS_FAST_AS_POSSIBLE);
+        REQUIRE(player.takeDue(start, due, 5000) == 3000 - 14);
+        REQUIRE(player.atEnd());
+    }
+    
+    QFile::remove(path);
+}
+
+TEST_CASE("MockI2C trace record and replay", "[mocki2c]") {
+    int argc = 1;
+    char* argv[] = {(char*)"test"};
+    QCoreApplication app(argc, argv);
+    Logger::getInstance().setConsoleOutput(false);
+    
+    const QString path = QDir::tempPath() + "/autodash_test_mocki2c_trace.series";
+    MockI2C& i2c = MockI2C::getInstance();
+    REQUIRE(i2c.begin(0x48));
+    
+    // Record a 200 Hz stream
+    QVector<SensorData> recorded;
+    QMetaObject::Connection connection = QObject::connect(&i2c, &MockI2C::dataUpdated,
+        [&recorded](const SensorData& data) { recorded.append(data); });
+    REQUIRE(i2c.startRecording(path));
+    REQUIRE(i2c.startAcquisition(200, 50));
+    QElapsedTimer timer;
+    timer.start();
+    while (recorded.size() < 20 && timer.elapsed() < 5000) {
+        QCoreApplication::processEvents();
+        QThread::msleep(1);
+    }
+    i2c.stopAcquisition();
+    i2c.stopRecording();
+    QObject::disconnect(connection);
+    REQUIRE(recorded.size() >= 20);
+    
+    // Replay reproduces the published values exactly
+    QVector<SensorData> replayed;
+    bool finished = false;
+    connection = QObject::connect(&i2c, &MockI2C::dataUpdated,
+        [&replayed](const SensorData& data) { replayed.append(data); });
+    QMetaObject::Connection finishedConnection = QObject::connect(&i2c, &MockI2C::replayFinished,
+        [&finished]() { finished = true; });
+    REQUIRE(i2c.startReplay(path, SensorTracePlayer::AS_FAST_AS_POSSIBLE));
+    REQUIRE(i2c.isReplaying());
+    timer.start();
+    while (!finished && timer.elapsed() < 5000) {
+        QCoreApplication::processEvents();
+    }
+    REQUIRE(finished);
+    REQUIRE_FALSE(i2c.isReplaying());
+    REQUIRE(replayed.size() == recorded.size());
+    for (int i = 0; i < recorded.size(); ++i) {
+        REQUIRE(replayed[i].temperature == recorded[i].temperature);
+        REQUIRE(replayed[i].lightLevel == recorded[i].lightLevel);
+        REQUIRE(replayed[i].timestamp == recorded[i].timestamp);
+    }
+    
+    QObject::disconnect(connection);
+    QObject::disconnect(finishedConnection);
+    QFile::remove(path);
+}
+
+TEST_CASE("Sensor signal models", "[mocki2c]") {
+    // 02:00 UTC
+    const qint64 night = 1700000000000LL - 1700000000000LL % (24 * 3600 * 1000LL) + 2 * 3600 * 1000LL;
+    
+    SECTION("Same seed and timestamps give the same stream") {
+        for (const QString& name : SensorSignalModel::names()) {
+            std::unique_ptr<SensorSignalModel> first = SensorSignalModel::create(name, 7);
+            std::unique_ptr<SensorSignalModel> second = SensorSignalModel::create(name, 7);
+            std::unique_ptr<SensorSignalModel> other = SensorSignalModel::create(name, 8);
+            REQUIRE(first);
+            bool differs = false;
+            for (int i = 0; i < 100; ++i) {
+                SensorSample a, b, c;
+                a.timestamp = b.timestamp = c.timestamp = night + i * 1000LL;
+                first->generate(a);
+                second->generate(b);
+                other->generate(c);
+                for (int ch = 0; ch < SensorSample::CHANNEL_COUNT; ++ch) {
+                    REQUIRE(a.values[ch] == b.values[ch]);
+                    differs = differs || a.values[ch] != c.values[ch];
+                }
+            }
+            REQUIRE(differs);
+        }
+        REQUIRE_FALSE(SensorSignalModel::create("unknown", 1));
+    }
+    
+    SECTION("Random walk moves smoothly") {
+        RandomWalkModel model(3);
+        SensorSample sample;
+        sample.timestamp = night;
+        model.generate(sample);
+        double previous = sample.value(SensorChannel::Temperature);
+        for (int i = 1; i <= 1000; ++i) {
+            sample.timestamp = night + i;
+            model.generate(sample);
+            // 1 ms steps: a few hundredths of a degree at most
+            REQUIRE(std::abs(sample.value(SensorChannel::Temperature) - previous) < 0.05);
+            previous = sample.value(SensorChannel::Temperature);
+        }
+    }
+    
+    SECTION("Diurnal cycle peaks in the afternoon") {
+        DiurnalModel model(1);
+        SensorSample dawn, afternoon;
+        dawn.timestamp = night + 2 * 3600 * 1000LL;
+        afternoon.timestamp = night + 13 * 3600 * 1000LL;
+        model.generate(dawn);
+        model.generate(afternoon);
+        REQUIRE(afternoon.value(SensorChannel::Temperature) > dawn.value(SensorChannel::Temperature) + 5.0);
+        REQUIRE(afternoon.value(SensorChannel::Humidity) < dawn.value(SensorChannel::Humidity));
+        REQUIRE(dawn.value(SensorChannel::Light) < 50.0);
+        REQUIRE(afternoon.value(SensorChannel::Light) > 1000.0);
+        
+        // In local time the same hours come that zone's offset earlier
+        DiurnalModel local(1);
+        local.setLocalTime(true);
+        for (const SensorSample& utc : {dawn, afternoon}) {
+            SensorSample sample;
+            // No zone changes its offset on this day in November
+            sample.timestamp = utc.timestamp - QDateTime::fromMSecsSinceEpoch(utc.timestamp).offsetFromUtc() * 1000LL;
+            local.generate(sample);
+            REQUIRE(sample.value(SensorChannel::Temperature) == utc.value(SensorChannel::Temperature));
+        }
+    }
+    
+    SECTION("Cabin responds to HVAC") {
+        auto run = [night](HvacState::Mode mode) {
+            CabinThermalModel model(5);
+            HvacState hvac;
+            hvac.mode = mode;
+            hvac.setpoint = 22.0;
+            hvac.fanLevel = 1.0;
+            model.setHvac(hvac);
+            SensorSample sample;
+            for (int i = 0; i <= 1800; ++i) {
+                sample.timestamp = night + i * 1000LL;
+                model.generate(sample);
+            }
+            return sample;
+        };
+        const SensorSample off = run(HvacState::Mode::Off);
+        const SensorSample heated = run(HvacState::Mode::Heat);
+        REQUIRE(off.value(SensorChannel::Temperature) < 12.0);
+        REQUIRE(heated.value(SensorChannel::Temperature) > 19.0);
+        // Same moisture in warmer air
+        REQUIRE(heated.value(SensorChannel::Humidity) < off.value(SensorChannel::Humidity));
+    }
+    
+    SECTION("Humidity falls as temperature rises") {
+        CorrelatedClimateModel model(9);
+        QVector<double> temperatures, humidities;
+        for (int i = 0; i < 20000; ++i) {
+            SensorSample sample;
+            sample.timestamp = night + i * 1000LL;
+            model.generate(sample);
+            temperatures.append(sample.value(SensorChannel::Temperature));
+            humidities.append(sample.value(SensorChannel::Humidity));
+        }
+        const double meanT = std::accumulate(temperatures.begin(), temperatures.end(), 0.0) / temperatures.size();
+        const double meanH = std::accumulate(humidities.begin(), humidities.end(), 0.0) / humidities.size();
+        double covariance = 0.0;
+        for (int i = 0; i < temperatures.size(); ++i) {
+            covariance += (temperatures[i] - meanT) * (humidities[i] - meanH);
+        }
+        REQUIRE(covariance < 0.0);
+        REQUIRE(SensorSignalModel::relativeHumidity(20.0, 20.0) == 100.0);
+    }
+}
+
+TEST_CASE("Gorilla sensor compression", "[mocki2c]") {
+    const qint64 base = 1700000000000LL;
+    
+    SECTION("Samples round-trip bit for bit") {
+        std::mt19937_64 rng(7);
+        QVector<SensorSample> samples;
+        qint64 timestamp = base;
+        for (int i = 0; i < 3000; ++i) {
+            // Steady, jittered, backwards and arbitrary timestamp steps
+            switch (i % 4) {
+                case 0: timestamp += 1000; break;
+                case 1: timestamp += 990 + static_cast<qint64>(rng() % 20); break;
+                case 2: timestamp -= static_cast<qint64>(rng() % 5000); break;
+                default: timestamp = i % 400 == 3 ? static_cast<qint64>(rng()) : timestamp + 1000; break;
+            }
+            SensorSample sample = makeSample(timestamp, 20.0 + (rng() % 1000) * 0.01);
+            if (i % 7 == 0) {
+                sample.setValue(SensorChannel::Humidity, std::nan(""));
+            }
+            if (i % 11 == 0) {
+                const quint64 bits = rng();
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                sample.setValue(SensorChannel::Light, value);
+            }
+            samples.append(sample);
+        }
+        
+        SensorGorillaEncoder encoder;
+        for (const SensorSample& sample : samples) {
+            encoder.append(sample);
+        }
+        const QVector<QByteArray> columns = encoder.finish();
+        REQUIRE(columns.size() == SensorGorillaEncoder::COLUMN_COUNT);
+        
+        SensorGorillaDecoder decoder(columns, samples.size());
+        SensorSample sample;
+        int decoded = 0;
+        bool identical = true;
+        while (decoder.next(sample)) {
+            identical = identical && sample.timestamp == samples[decoded].timestamp
+                && std::memcmp(sample.values, samples[decoded].values, sizeof(sample.values)) == 0;
+            ++decoded;
+        }
+        REQUIRE(decoded == samples.size());
+        REQUIRE(identical);
+        
+        // A truncated stream ends early instead of inventing values
+        GorillaTimestampDecoder truncated(columns[0].constData(), columns[0].size() / 2, samples.size());
+        qint64 value = 0;
+        int count = 0;
+        while (truncated.next(value)) {
+            ++count;
+        }
+        REQUIRE(count < samples.size());
+    }
+    
+    SECTION("Steady timestamps and repeated values cost about a bit each") {
+        GorillaTimestampEncoder timestamps;
+        GorillaValueEncoder values;
+        for (int i = 0; i < 1024; ++i) {
+            timestamps.append(base + i * 1000LL);
+            values.append(21.5);
+        }
+        // 64 bits for the first, 16 for the first delta, then one bit each
+        REQUIRE(timestamps.finish().size() == (64 + 16 + 1022 + 7) / 8);
+        REQUIRE(values.finish().size() == (64 + 1023 + 7) / 8);
+    }
+    
+    SECTION("The series store seals full chunks compressed") {
+        const QString path = QDir::tempPath() + "/autodash_test_gorilla.series";
+        QFile::remove(path);
+        const int sampleCount = 4 * SensorSeriesStore::CHUNK_SAMPLES + 10;
+        
+        SensorSeriesStore store;
+        REQUIRE(store.open(path));
+        for (int i = 0; i < sampleCount; ++i) {
+            store.append(makeSample(base + i * 1000LL, 21.0 + (i / 60) * 0.5));
+        }
+        store.close();
+        
+        // Raw, every sample would take 40 bytes
+        REQUIRE(QFileInfo(path).size() < qint64(sampleCount) * 40 / 2);
+        
+        REQUIRE(store.open(path));
+        REQUIRE(store.size() == sampleCount);
+        REQUIRE(store.chunkCount() == 5);
+        const QVector<SensorSample> samples = store.read(base + 2000 * 1000LL, base + 2999 * 1000LL);
+        REQUIRE(samples.size() == 1000);
+        REQUIRE(samples[500].timestamp == base + 2500 * 1000LL);
+        REQUIRE(samples[500].value(SensorChannel::Temperature) == 21.0 + (2500 / 60) * 0.5);
+        REQUIRE(store.summarize(SensorChannel::Temperature).max == 21.0 + ((sampleCount - 1) / 60) * 0.5);
+        store.close();
+        QFile::remove(path);
+    }
+}
+
+TEST_CASE("Sensor publish policies", "[mocki2c]") {
+    const qint64 base = 1700000000000LL;
+    SensorPublishFilter filter;
+    
+    SECTION("The default policy publishes every sample") {
+        for (int i = 0; i < 5; ++i) {
+            REQUIRE(filter.accept(makeSample(base + i, 21.0)));
+        }
+        REQUIRE(filter.stats().published == 5);
+        REQUIRE(filter.stats().suppressed == 0);
+    }
+    
+    SECTION("Deadbands compare against the last published value") {
+        SensorPublishPolicy policy;
+        policy.deadband = 0.5;
+        filter.setPolicy(policy);
+        
+        REQUIRE(filter.accept(makeSample(base, 21.0)));
+        // A slow drift publishes once it adds up to the deadband
+        REQUIRE_FALSE(filter.accept(makeSample(base + 1000, 21.2)));
+        REQUIRE_FALSE(filter.accept(makeSample(base + 2000, 21.4)));
+        REQUIRE(filter.accept(makeSample(base + 3000, 21.6)));
+        REQUIRE_FALSE(filter.accept(makeSample(base + 4000, 21.3)));
+        
+        SensorSample sample = makeSample(base + 5000, 21.6);
+        sample.setValue(SensorChannel::Humidity, std::nan(""));
+        REQUIRE(filter.accept(sample));
+        
+        const SensorPublishStats stats = filter.stats();
+        REQUIRE(stats.published == 3);
+        REQUIRE(stats.suppressed == 3);
+        REQUIRE(stats.suppressedByDeadband == 3);
+        REQUIRE(stats.suppressedByInterval == 0);
+    }
+    
+    SECTION("Minimum intervals and heartbeats") {
+        SensorPublishPolicy quiet;
+        quiet.deadband = 1000.0;
+        filter.setPolicy(quiet);
+        SensorPublishPolicy temperature;
+        temperature.deadband = 0.1;
+        temperature.minIntervalMs = 1000;
+        temperature.heartbeatMs = 10000;
+        filter.setPolicy(SensorChannel::Temperature, temperature);
+        REQUIRE(filter.policy(SensorChannel::Temperature).heartbeatMs == 10000);
+        
+        REQUIRE(filter.accept(makeSample(base, 21.0)));
+        REQUIRE_FALSE(filter.accept(makeSample(base + 500, 22.0)));
+        REQUIRE(filter.stats().suppressedByInterval == 1);
+        REQUIRE(filter.accept(makeSample(base + 1000, 22.0)));
+        
+        // Unchanged readings still go out on the heartbeat
+        REQUIRE_FALSE(filter.accept(makeSample(base + 10999, 22.0)));
+        REQUIRE(filter.accept(makeSample(base + 11000, 22.0)));
+        
+        // Going back in time (a replay seek) is an expired interval
+        REQUIRE(filter.accept(makeSample(base, 21.0)));
+        
+        filter.reset();
+        REQUIRE(filter.accept(makeSample(base + 1, 21.0)));
+        filter.resetStats();
+        REQUIRE(filter.stats().published == 0);
+    }
+}
+
+TEST_CASE("Per-channel sampling schedules", "[mocki2c]") {
+    const quint32 temperature = 1u << static_cast<int>(SensorChannel::Temperature);
+    const quint32 humidity = 1u << static_cast<int>(SensorChannel::Humidity);
+    const quint32 pressure = 1u << static_cast<int>(SensorChannel::Pressure);
+    const quint32 light = 1u << static_cast<int>(SensorChannel::Light);
+    
+    SensorScheduler scheduler;
+    REQUIRE(scheduler.nextDeadline() == std::numeric_limits<qint64>::max());
+    scheduler.setInterval(SensorChannel::Temperature, 1000);
+    scheduler.setInterval(SensorChannel::Humidity, 1000);
+    scheduler.setInterval(SensorChannel::Pressure, 5000);
+    scheduler.setInterval(SensorChannel::Light, 200);
+    scheduler.start(0);
+    
+    // Everything is due at the start
+    REQUIRE(scheduler.nextDeadline() == 0);
+    REQUIRE(scheduler.takeDue(0) == SensorScheduler::ALL_CHANNELS);
+    REQUIRE(scheduler.nextDeadline() == 200);
+    
+    SECTION("Each channel keeps its own interval") {
+        int lightReads = 0;
+        int temperatureReads = 0;
+        int pressureReads = 0;
+        for (qint64 now = 1; now <= 10000; ++now) {
+            if (now < scheduler.nextDeadline()) {
+                continue;
+            }
+            const quint32 due = scheduler.takeDue(now);
+            lightReads += (due & light) != 0;
+            temperatureReads += (due & temperature) != 0;
+            pressureReads += (due & pressure) != 0;
+            // Equal intervals fall due together
+            REQUIRE(((due & temperature) != 0) == ((due & humidity) != 0));
+        }
+        REQUIRE(lightReads == 50);
+        REQUIRE(temperatureReads == 10);
+        REQUIRE(pressureReads == 2);
+        REQUIRE(scheduler.missedDeadlines() == 0);
+    }
+    
+    SECTION("Late service skips missed slots instead of bursting") {
+        REQUIRE(scheduler.takeDue(1100) == (temperature | humidity | light));
+        // Light skips its 400 to 1000 ms slots and stays on its 200 ms grid
+        REQUIRE(scheduler.missedDeadlines() == 4);
+        REQUIRE(scheduler.nextDeadline() == 1200);
+        REQUIRE(scheduler.takeDue(1200) == light);
+    }
+    
+    SECTION("Interval changes count from the channel's last sample") {
+        scheduler.takeDue(500);
+        scheduler.setInterval(SensorChannel::Pressure, 600);
+        REQUIRE(scheduler.takeDue(600) == (pressure | light));
+        scheduler.setInterval(SensorChannel::Light, 0);
+        REQUIRE(scheduler.interval(SensorChannel::Light) == 0);
+        REQUIRE((scheduler.takeDue(5000) & light) == 0);
+        scheduler.stop();
+        REQUIRE_FALSE(scheduler.isActive());
+        REQUIRE(scheduler.takeDue(10000) == 0);
+    }
+}
+
+TEST_CASE("MockI2C high-rate acquisition", "[mocki2c]") {
+    int argc = 1;
+    char* argv[] = {(char*)"test"};
+    QCoreApplication app(argc, argv);
+    Logger::getInstance().setConsoleOutput(false);
+    
+    MockI2C& i2c = MockI2C::getInstance();
+    REQUIRE(i2c.begin(0x48));
+    REQUIRE_FALSE(i2c.startAcquisition(5000));
+    
+    int deliveries = 0;
+    QMetaObject::Connection connection = QObject::connect(&i2c, &MockI2C::dataUpdated,
+        [&deliveries](const SensorData& data) {
+            if (data.isValid) {
+                ++deliveries;
+            }
+        });
+    
+    REQUIRE(i2c.startAcquisition(500, 20));
+    REQUIRE(i2c.isAcquiring());
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 500) {
+        QCoreApplication::processEvents();
+        QThread::msleep(1);
+    }
+    i2c.stopAcquisition();
+    const qint64 elapsedMs = timer.elapsed();
+    REQUIRE_FALSE(i2c.isAcquiring());
+    
+    // Loose bounds: this runs on shared CI machines
+    AcquisitionStats stats = i2c.getAcquisitionStats();
+    REQUIRE(stats.samples > 100);
+    REQUIRE(stats.droppedSamples == 0);
+    REQUIRE(deliveries > 2);
+    // At most one per 50 ms delivery tick over however long the loop really
+    // ran, with slack for coarse timers, plus the hand-over on stop
+    REQUIRE(deliveries <= elapsedMs / 40 + 2);
+    REQUIRE(i2c.getTemperature() >= -40.0);
+    REQUIRE(i2c.getTemperature() <= 80.0);
+    
+    // Register traffic goes through the simulated bus
+    REQUIRE(i2c.readRegister(0x0F) == 0xA5);
+    REQUIRE_FALSE(i2c.writeRegister(0x0F, 0x00));
+    REQUIRE(i2c.writeRegister(0x10, 0x3C));
+    REQUIRE(i2c.readRegister(0x10) == 0x3C);
+    REQUIRE(i2c.bus().stats().transactions > 0);
+    
+    QObject::disconnect(connection);
+}
@@ -0,0 +1,558 @@
+#include <catch2/catch_test_macros.hpp>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QtEndian>
+#include <atomic>
+
+#include "../src/system/DirectoryWalker.h"
+#include "../src/system/MediaDurationReader.h"
+#include "../src/system/MediaLibraryIndex.h"
+#include "../src/system/MediaTagReader.h"
+#include "../src/system/MediaScanner.h"
+
+struct ScanResult {
+    QList<MediaFile> found;
+    QStringList removed;
+    MediaScanStats stats;
+    int batches = 0;
+    bool finished = false;
+};
+
+static ScanResult runScan(MediaScanner& scanner, const QString& deviceId, const QString& root)
+{
+    ScanResult result;
+    QMetaObject::Connection found = QObject::connect(&scanner, &MediaScanner::filesFound,
+        [&result](const QString&, const QList<MediaFile>& files) {
+            result.found += files;
+            ++result.batches;
+        });
+    QMetaObject::Connection finished = QObject::connect(&scanner, &MediaScanner::scanFinished,
+        [&result](const QString&, const QStringList& removedPaths, const MediaScanStats& stats) {
+            result.removed = removedPaths;
+            result.stats = stats;
+            result.finished = true;
+        });
+    scanner.scan(deviceId, root);
+    scanner.waitForDone();
+    QCoreApplication::processEvents();
+    QObject::disconnect(found);
+    QObject::disconnect(finished);
+    return result;
+}
+
+static void writeFile(const QString& path, int size)
+{
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(size, '\0'));
+}
+
+static void writeBytes(const QString& path, const QByteArray& bytes)
+{
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(bytes);
+}
+
+static QByteArray bigEndian32(quint32 value)
+{
+    QByteArray bytes(4, '\0');
+    qToBigEndian(value, bytes.data());
+    return bytes;
+}
+
+static QByteArray littleEndian32(quint32 value)
+{
+    QByteArray bytes(4, '\0');
+    qToLittleEndian(value, bytes.data());
+    return bytes;
+}
+
+static QByteArray vorbisComment(const QList<QByteArray>& comments)
+{
+    QByteArray data = littleEndian32(4) + "test" + littleEndian32(comments.size());
+    for (const QByteArray& comment : comments) {
+        data += littleEndian32(comment.size()) + comment;
+    }
+    return data;
+}
+
+static QByteArray atom(const char* type, const QByteArray& body)
+{
+    return bigEndian32(8 + body.size()) + QByteArray(type, 4) + body;
+}
+
+// MPEG-1 layer III, 48 kHz, joint stereo: 384-byte frames at 128 kbit/s
+static QByteArray mpegFrame(int bitrateIndex, const QByteArray& body = QByteArray())
+{
+    static const int BITRATES[15] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320};
+    const int length = 144 * BITRATES[bitrateIndex] * 1000 / 48000;
+    const QByteArray header = bigEndian32(0xfffb0440 | (quint32(bitrateIndex) << 12));
+    return header + body.leftJustified(length - 4, '\0', true);
+}
+
+TEST_CASE("Media scanner incremental rescans", "[usb]") {
+    int argc = 1;
+    char* argv[] = {(char*)"test"};
+    QCoreApplication app(argc, argv);
+    
+    const QString root = QDir::tempPath() + "/autodash_test_media_scan";
+    QDir(root).removeRecursively();
+    REQUIRE(QDir().mkpath(root));
+    const int trackCount = 300;
+    for (int i = 0; i < trackCount; ++i) {
+        writeFile(QString("%1/Artist %2 - Track %2.mp3").arg(root).arg(i), 1000 + i);
+    }
+    writeFile(root + "/notes.txt", 10);
+    
+    MediaScanner scanner;
+    scanner.setSupportedFormats({"mp3", "wav"});
+    
+    const ScanResult cold = runScan(scanner, "USB_TEST", root);
+    REQUIRE(cold.finished);
+    REQUIRE(cold.found.size() == trackCount);
+    REQUIRE(cold.stats.added == trackCount);
+    REQUIRE(cold.stats.files == trackCount);
+    REQUIRE(cold.removed.isEmpty());
+    // Batches start small and grow
+    REQUIRE(cold.batches > 1);
+    REQUIRE(cold.batches < trackCount / MediaScanner::FIRST_BATCH_SIZE + 1);
+    
+    SECTION("Metadata comes from the file name") {
+        const MediaFile track = MediaScanner::describe(QFileInfo(root + "/Artist 7 - Track 7.mp3"));
+        REQUIRE(track.artist == "Artist 7");
+        REQUIRE(track.title == "Track 7");
+        REQUIRE(track.fileType == "mp3");
+        REQUIRE(track.fileSize == 1007);
+    }
+    
+    SECTION("An unchanged device reports nothing") {
+        const ScanResult rescan = runScan(scanner, "USB_TEST", root);
+        REQUIRE(rescan.finished);
+        REQUIRE(rescan.found.isEmpty());
+        REQUIRE(rescan.removed.isEmpty());
+        REQUIRE(rescan.stats.files == trackCount);
+        REQUIRE(rescan.stats.added + rescan.stats.changed + rescan.stats.removed == 0);
+    }
+    
+    SECTION("Only new, changed and removed files are reported") {
+        writeFile(root + "/Artist 3 - Track 3.mp3", 5000);
+        writeFile(root + "/new.wav", 100);
+        REQUIRE(QFile::remove(root + "/Artist 5 - Track 5.mp3"));
+        
+        const ScanResult rescan = runScan(scanner, "USB_TEST", root);
+        REQUIRE(rescan.stats.added == 1);
+        REQUIRE(rescan.stats.changed == 1);
+        REQUIRE(rescan.stats.removed == 1);
+        REQUIRE(rescan.found.size() == 2);
+        REQUIRE(rescan.removed == QStringList{QFileInfo(root + "/Artist 5 - Track 5.mp3").absoluteFilePath()});
+    }
+    
+    SECTION("Primed files are only checked") {
+        MediaScanner primed;
+        primed.setSupportedFormats({"mp3", "wav"});
+        MediaFile stale = cold.found.first();
+        stale.filePath = root + "/gone.mp3";
+        primed.prime("USB_TEST", cold.found + QList<MediaFile>{stale});
+        REQUIRE(primed.isKnown("USB_TEST"));
+        
+        const ScanResult rescan = runScan(primed, "USB_TEST", root);
+        REQUIRE(rescan.found.isEmpty());
+        REQUIRE(rescan.removed == QStringList{stale.filePath});
+    }
+    
+    SECTION("A cancelled scan reports nothing and forgets the device") {
+        bool reported = false;
+        QObject::connect(&scanner, &MediaScanner::scanFinished, [&reported]() { reported = true; });
+        scanner.scan("USB_TEST", root);
+        scanner.cancel("USB_TEST");
+        REQUIRE_FALSE(scanner.isScanning("USB_TEST"));
+        REQUIRE_FALSE(scanner.isKnown("USB_TEST"));
+        scanner.waitForDone();
+        QCoreApplication::processEvents();
+        REQUIRE_FALSE(reported);
+    }
+    
+    QDir(root).removeRecursively();
+}
+
+TEST_CASE("Directory walker", "[usb]") {
+    const QString root = QDir::tempPath() + "/autodash_test_directory_walker";
+    QDir(root).removeRecursively();
+    REQUIRE(QDir().mkpath(root + "/Artist/Album/Disc 1"));
+    REQUIRE(QDir().mkpath(root + "/.hidden"));
+    writeFile(root + "/top.MP3", 10);
+    writeFile(root + "/Artist/one.mp3", 20);
+    writeFile(root + "/Artist/cover.jpg", 30);
+    writeFile(root + "/Artist/Album/two.wav", 40);
+    writeFile(root + "/Artist/Album/Disc 1/three.mp3", 50);
+    writeFile(root + "/.hidden/skipped.mp3", 60);
+    // A link back to the root must not loop
+    REQUIRE(QFile::link(root, root + "/Artist/Album/loop"));
+    
+    auto walk = [&root](int maxDepth, DirectoryWalkStats& stats) {
+        DirectoryWalker walker(root);
+        walker.setMaxDepth(maxDepth);
+        walker.setSuffixes({"mp3", "wav"});
+        QMap<QString, DirectoryEntry> found;
+        REQUIRE(walker.walk([&found, &root](const DirectoryEntry& entry) {
+            found.insert(entry.path.mid(root.size() + 1), entry);
+        }));
+        stats = walker.stats();
+        return found;
+    };
+    
+    SECTION("Breadth first to any depth") {
+        DirectoryWalkStats stats;
+        const QMap<QString, DirectoryEntry> found = walk(DirectoryWalker::UNLIMITED_DEPTH, stats);
+        REQUIRE(found.keys() == QStringList{"Artist/Album/Disc 1/three.mp3", "Artist/Album/two.wav",
+                                            "Artist/one.mp3", "top.MP3"});
+        REQUIRE(found["Artist/Album/two.wav"].size == 40);
+        REQUIRE(found["Artist/Album/two.wav"].depth == 2);
+        REQUIRE(found["Artist/Album/two.wav"].mtimeMs
+                == QFileInfo(root + "/Artist/Album/two.wav").lastModified().toMSecsSinceEpoch());
+        REQUIRE(stats.files == 4);
+        REQUIRE(stats.directories == 4);
+        REQUIRE(stats.skippedLoops == 1);
+    }
+    
+    SECTION("Depth limit") {
+        DirectoryWalkStats stats;
+        const QMap<QString, DirectoryEntry> found = walk(1, stats);
+        REQUIRE(found.keys() == QStringList{"Artist/one.mp3", "top.MP3"});
+        REQUIRE(stats.skippedDepth == 1);
+        REQUIRE(walk(0, stats).keys() == QStringList{"top.MP3"});
+    }
+
+#ifdef Q_OS_LINUX
+    SECTION("Links off the root's file system are not followed") {
+        // /proc is always a file system of its own
+        REQUIRE(QFile::link("/proc", root + "/Artist/host"));
+        DirectoryWalkStats stats;
+        REQUIRE(walk(DirectoryWalker::UNLIMITED_DEPTH, stats).size() == 4);
+        REQUIRE(stats.skippedOutside == 1);
+        REQUIRE(stats.directories == 4);
+    }
+#endif
+
+    SECTION("Cancelled walks stop") {
+        std::atomic<bool> cancelled{true};
+        DirectoryWalker walker(root);
+        walker.setCancelFlag(&cancelled);
+        int visited = 0;
+        REQUIRE_FALSE(walker.walk([&visited](const DirectoryEntry&) { ++visited; }));
+        REQUIRE(visited == 0);
+    }
+    
+    SECTION("Media scans recurse to the scanner's depth") {
+        int argc = 1;
+        char* argv[] = {(char*)"test"};
+        QCoreApplication app(argc, argv);
+        MediaScanner scanner;
+        scanner.setSupportedFormats({"mp3", "wav"});
+        scanner.setMaxDepth(2);
+        const ScanResult result = runScan(scanner, "USB_TEST", root);
+        REQUIRE(result.stats.files == 3);
+        REQUIRE(result.stats.directories == 3);
+        REQUIRE(result.stats.complete);
+        REQUIRE(result.found.size() == 3);
+    }
+    
+    QDir(root).removeRecursively();
+}
+
+TEST_CASE("Media library index", "[usb]") {
+    const QString path = QDir::tempPath() + "/autodash_test_media_library.idx";
+    QFile::remove(path);
+    
+    USBDevice device;
+    device.deviceName = "USB_DRIVE_01";
+    device.mountPoint = "/mnt/usb/USB_DRIVE_01";
+    device.totalSpace = 32000000000LL;
+    device.fileSystem = "FAT32";
+    for (int i = 0; i < 3; ++i) {
+        MediaFile file;
+        file.fileName = QString("Artist - Track %1.mp3").arg(i);
+        file.filePath = device.mountPoint + (i == 0 ? "/" : "/Artist/Album/") + file.fileName;
+        file.title = QString("Track %1").arg(i);
+        file.artist = "Artist";
+        file.album = i == 0 ? QString() : QString("Album");
+        file.duration = "03:30";
+        file.fileSize = 1000 + i;
+        file.fileType = "mp3";
+        file.lastModified = QDateTime::fromMSecsSinceEpoch(1700000000000LL + i);
+        device.mediaFiles.append(file);
+    }
+    
+    MediaLibraryIndex writer;
+    REQUIRE_FALSE(writer.load(path));
+    writer.store(device, "uuid:1A2B-3C4D");
+    REQUIRE(writer.save());
+    
+    SECTION("Libraries follow the volume to a new mount point") {
+        MediaLibraryIndex reader;
+        REQUIRE(reader.load(path));
+        REQUIRE(reader.volumes() == QStringList{"uuid:1A2B-3C4D"});
+        REQUIRE(reader.fileCount("uuid:1A2B-3C4D") == 3);
+        
+        const QList<MediaFile> files = reader.files("uuid:1A2B-3C4D", "/media/stick");
+        REQUIRE(files.size() == 3);
+        REQUIRE(files[0].filePath == "/media/stick/Artist - Track 0.mp3");
+        REQUIRE(files[2].filePath == "/media/stick/Artist/Album/Artist - Track 2.mp3");
+        REQUIRE(files[2].fileName == device.mediaFiles[2].fileName);
+        REQUIRE(files[2].title == "Track 2");
+        REQUIRE(files[2].album == "Album");
+        REQUIRE(files[0].album.isEmpty());
+        REQUIRE(files[2].fileSize == 1002);
+        REQUIRE(files[2].lastModified == device.mediaFiles[2].lastModified);
+        REQUIRE(reader.files("uuid:FFFF-0000", "/media/stick").isEmpty());
+    }
+    
+    SECTION("Files that are not an index load empty") {
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write("[{\"deviceId\": \"USB_1\"}]");
+        file.close();
+        MediaLibraryIndex reader;
+        REQUIRE_FALSE(reader.load(path));
+        REQUIRE(reader.volumes().isEmpty());
+    }
+    
+    SECTION("Volumes beyond the limit are forgotten") {
+        device.mediaFiles.clear();
+        for (int i = 0; i < MediaLibraryIndex::MAX_VOLUMES + 1; ++i) {
+            writer.store(device, QString("volume:%1").arg(i));
+        }
+        REQUIRE(writer.volumes().size() == MediaLibraryIndex::MAX_VOLUMES);
+    }
+    
+    QFile::remove(path);
+}
+
+TEST_CASE("Media tag reader", "[usb]") {
+    const QString root = QDir::tempPath() + "/autodash_test_media_tags";
+    QDir(root).removeRecursively();
+    REQUIRE(QDir().mkpath(root));
+    const QByteArray audio(4096, '\x55');
+    
+    SECTION("ID3v2.4 with ID3v1 filling the gaps") {
+        // Cover art first; a UTF-8 title with a second value; an album
+        // artist only; the album only in ID3v1
+        auto frame = [](const char* id, const QByteArray& body) {
+            QByteArray size(4, '\0');
+            for (int i = 0; i < 4; ++i) {
+                size[i] = char((body.size() >> (7 * (3 - i))) & 0x7f);
+            }
+            return QByteArray(id) + size + QByteArray(2, '\0') + body;
+        };
+        const QByteArray frames = frame("APIC", QByteArray(70000, '\x11'))
+                                + frame("TIT2", QByteArray("\3Caf\xc3\xa9 Song\0Second", 18))
+                                + frame("TPE2", "\3The Band") + QByteArray(256, '\0');
+        QByteArray header("ID3\4\0\0", 6);
+        for (int i = 0; i < 4; ++i) {
+            header += char((frames.size() >> (7 * (3 - i))) & 0x7f);
+        }
+        const QByteArray id3v1 = "TAG" + QByteArray("V1 Title").leftJustified(30, '\0')
+                               + QByteArray(30, '\0') + QByteArray("V1 Album").leftJustified(30, ' ')
+                               + QByteArray(35, '\0');
+        writeBytes(root + "/song.mp3", header + frames + audio + id3v1);
+        
+        const MediaTags tags = MediaTagReader::read(root + "/song.mp3");
+        REQUIRE(tags.title == QString::fromUtf8("Caf\xc3\xa9 Song"));
+        REQUIRE(tags.artist.isEmpty());
+        REQUIRE(tags.albumArtist == "The Band");
+        REQUIRE(tags.album == "V1 Album");
+    }
+    
+    SECTION("FLAC Vorbis comments after a picture") {
+        auto block = [](int type, const QByteArray& body, bool last) {
+            QByteArray header = bigEndian32(body.size());
+            header[0] = char(type | (last ? 0x80 : 0));
+            return header + body;
+        };
+        writeBytes(root + "/song.flac", "fLaC" + block(0, QByteArray(34, '\0'), false)
+                   + block(6, QByteArray(70000, '\x22'), false)
+                   + block(4, vorbisComment({"title=Flac Title", "ARTIST=Flac Artist", "Album=Flac Album"}), true)
+                   + audio);
+        
+        const MediaTags tags = MediaTagReader::read(root + "/song.flac");
+        REQUIRE(tags.title == "Flac Title");
+        REQUIRE(tags.artist == "Flac Artist");
+        REQUIRE(tags.album == "Flac Album");
+    }
+    
+    SECTION("Ogg Vorbis comments spanning pages") {
+        auto page = [](quint32 serial, quint32 sequence, const QByteArray& lacing, const QByteArray& body) {
+            const char flags = sequence == 0 ? '\x02' : '\0';
+            return QByteArray("OggS\0", 5) + flags + QByteArray(8, '\0') + littleEndian32(serial)
+                 + littleEndian32(sequence) + QByteArray(4, '\0') + char(lacing.size()) + lacing + body;
+        };
+        const QByteArray identification = QByteArray("\x01vorbis", 7) + QByteArray(23, '\0');
+        QByteArray comments = QByteArray("\x03vorbis", 7)
+                            + vorbisComment({"ARTIST=Ogg Artist", "TITLE=Ogg Title", "ALBUM=Ogg Album"});
+        comments += QByteArray(2 * 255 - comments.size() + 10, '\0');
+        const QByteArray otherComments = QByteArray("\x03vorbis", 7) + vorbisComment({"TITLE=Other Stream"});
+        
+        // Two full segments on the second page, the rest on the third. A
+        // second stream's pages are interleaved, as in a multiplexed file.
+        writeBytes(root + "/song.ogg", page(1, 0, QByteArray(1, char(identification.size())), identification)
+                   + page(2, 0, QByteArray(1, char(identification.size())), identification)
+                   + page(1, 1, QByteArray(2, '\xff'), comments.left(2 * 255))
+                   + page(2, 1, QByteArray(1, char(otherComments.size())), otherComments)
+                   + page(1, 2, QByteArray(1, char(comments.size() - 2 * 255)), comments.mid(2 * 255)) + audio);
+        
+        const MediaTags tags = MediaTagReader::read(root + "/song.ogg");
+        REQUIRE(tags.title == "Ogg Title");
+        REQUIRE(tags.artist == "Ogg Artist");
+        REQUIRE(tags.album == "Ogg Album");
+    }
+    
+    SECTION("M4A ilst items after mdat") {
+        auto item = [](const char* type, quint32 valueType, const QByteArray& value) {
+            return atom(type, atom("data", bigEndian32(valueType) + bigEndian32(0) + value));
+        };
+        const QByteArray ilst = atom("ilst", item("\xa9nam", 1, "M4A Title")
+                                           + item("covr", 13, QByteArray(70000, '\x44'))
+                                           + item("\xa9" "ART", 1, "M4A Artist")
+                                           + item("\xa9" "alb", 2, QByteArray("\0M\0\x34\0A", 6)));
+        const QByteArray meta = atom("meta", QByteArray(4, '\0') + atom("hdlr", QByteArray(25, '\0')) + ilst);
+        writeBytes(root + "/song.m4a", atom("ftyp", "M4A " + QByteArray(4, '\0')) + atom("mdat", audio)
+                   + atom("moov", atom("mvhd", QByteArray(100, '\0')) + atom("udta", meta)));
+        
+        const MediaTags tags = MediaTagReader::read(root + "/song.m4a");
+        REQUIRE(tags.title == "M4A Title");
+        REQUIRE(tags.artist == "M4A Artist");
+        REQUIRE(tags.album == "M4A");
+    }
+    
+    SECTION("Untagged and damaged files") {
+        writeFile(root + "/silence.mp3", 4096);
+        REQUIRE(MediaTagReader::read(root + "/silence.mp3").isEmpty());
+        REQUIRE(MediaTagReader::read(root + "/missing.mp3").isEmpty());
+        
+        // A frame claiming more than the tag holds
+        writeBytes(root + "/broken.mp3", QByteArray("ID3\3\0\0\0\0\0\x14TIT2", 14) + bigEndian32(9999)
+                   + QByteArray(12, '\0'));
+        REQUIRE(MediaTagReader::read(root + "/broken.mp3").isEmpty());
+    }
+    
+    SECTION("Tags win over file names") {
+        writeBytes(root + "/Name Artist - Name Title.flac", "fLaC"
+                   + QByteArray("\x84\0\0", 3) + char(vorbisComment({"TITLE=Tag Title"}).size())
+                   + vorbisComment({"TITLE=Tag Title"}));
+        const MediaFile file = MediaScanner::describe(QFileInfo(root + "/Name Artist - Name Title.flac"));
+        REQUIRE(file.title == "Tag Title");
+        REQUIRE(file.artist == "Name Artist");
+        REQUIRE(file.album == "Unknown Album");
+    }
+    
+    QDir(root).removeRecursively();
+}
+
+TEST_CASE("Media duration reader", "[usb]") {
+    const QString root = QDir::tempPath() + "/autodash_test_media_duration";
+    QDir(root).removeRecursively();
+    REQUIRE(QDir().mkpath(root));
+    
+    SECTION("Constant bitrate MP3 between ID3 tags") {
+        QByteArray frames;
+        for (int i = 0; i < 1000; ++i) {
+            frames += mpegFrame(9);
+        }
+        writeBytes(root + "/cbr.mp3", QByteArray("ID3\3\0\0\0\0\x08\0", 10) + QByteArray(1024, '\0')
+                   + frames + "TAG" + QByteArray(125, '\0'));
+        // 1000 frames of 1152 samples at 48 kHz
+        REQUIRE(MediaDurationReader::read(root + "/cbr.mp3") == 24000);
+    }
+    
+    SECTION("Xing frame count less the LAME encoder delay and padding") {
+        const QByteArray xing = QByteArray(32, '\0') + "Xing" + bigEndian32(0x0f) + bigEndian32(2000)
+                              + bigEndian32(1000000) + QByteArray(100, '\0') + bigEndian32(50)
+                              + "LAME3.100" + QByteArray(12, '\0') + QByteArray("\x24\x03\xe8", 3);
+        QByteArray frames = mpegFrame(9, xing);
+        for (int i = 0; i < 20; ++i) {
+            frames += mpegFrame(i % 2 ? 11 : 14);
+        }
+        writeBytes(root + "/vbr.mp3", frames);
+        // 2000 * 1152 samples less 576 + 1000
+        REQUIRE(MediaDurationReader::read(root + "/vbr.mp3") == (2000 * 1152 - 1576) * 1000LL / 48000);
+    }
+    
+    SECTION("VBRI frame count") {
+        const QByteArray vbri = QByteArray(32, '\0') + "VBRI" + QByteArray(10, '\0') + bigEndian32(1500);
+        writeBytes(root + "/vbri.mp3", mpegFrame(9, vbri) + mpegFrame(12) + mpegFrame(10));
+        REQUIRE(MediaDurationReader::read(root + "/vbri.mp3") == 36000);
+    }
+    
+    SECTION("Variable bitrate MP3 without a header is sampled") {
+        QByteArray frames;
+        for (int i = 0; i < 2000; ++i) {
+            frames += mpegFrame(i % 2 ? 9 : 11);
+        }
+        writeBytes(root + "/sampled.mp3", frames);
+        const qint64 durationMs = MediaDurationReader::read(root + "/sampled.mp3");
+        REQUIRE(durationMs > 48000 * 95 / 100);
+        REQUIRE(durationMs < 48000 * 105 / 100);
+    }
+    
+    SECTION("FLAC STREAMINFO") {
+        // 44.1 kHz, stereo, 16 bits, 61.1 s of samples
+        const quint64 samples = 44100ULL * 61 + 4410;
+        QByteArray info(34, '\0');
+        info[10] = char(44100 >> 12);
+        info[11] = char((44100 >> 4) & 0xff);
+        info[12] = char(((44100 & 0x0f) << 4) | (1 << 1));
+        info[13] = char((15 << 4) | (samples >> 32));
+        info.replace(14, 4, bigEndian32(quint32(samples)));
+        writeBytes(root + "/song.flac", "fLaC" + QByteArray("\x80\0\0\x22", 4) + info + QByteArray(4096, '\0'));
+        REQUIRE(MediaDurationReader::read(root + "/song.flac") == 61100);
+    }
+    
+    SECTION("WAV fmt and data chunks") {
+        auto chunk = [](const char* id, const QByteArray& body) {
+            return QByteArray(id, 4) + littleEndian32(body.size()) + body + (body.size() % 2 ? QByteArray(1, '\0') : QByteArray());
+        };
+        auto format = [](quint16 tag, quint16 channels, quint32 rate, quint32 byteRate, quint16 align, quint16 bits) {
+            QByteArray fmt(16, '\0');
+            qToLittleEndian(tag, fmt.data());
+            qToLittleEndian(channels, fmt.data() + 2);
+            qToLittleEndian(rate, fmt.data() + 4);
+            qToLittleEndian(byteRate, fmt.data() + 8);
+            qToLittleEndian(align, fmt.data() + 12);
+            qToLittleEndian(bits, fmt.data() + 14);
+            return fmt;
+        };
+        // 48 kHz, 24-bit stereo behind an odd-sized chunk
+        writeBytes(root + "/pcm.wav", "RIFF" + littleEndian32(0) + "WAVE" + chunk("LIST", "odd")
+                   + chunk("fmt ", format(1, 2, 48000, 288000, 6, 24)) + chunk("data", QByteArray(288000 * 2 + 28800, '\0')));
+        REQUIRE(MediaDurationReader::read(root + "/pcm.wav") == 2100);
+        
+        // IMA ADPCM is timed by its fact samples; a streamed data size
+        writeBytes(root + "/adpcm.wav", "RIFF" + littleEndian32(0) + "WAVE"
+                   + chunk("fmt ", format(0x11, 1, 22050, 11100, 512, 4)) + chunk("fact", littleEndian32(22050 * 3))
+                   + "data" + littleEndian32(0xffffffff) + QByteArray(2048, '\0'));
+        REQUIRE(MediaDurationReader::read(root + "/adpcm.wav") == 3000);
+    }
+    
+    SECTION("MP4 mvhd after mdat") {
+        QByteArray mvhd(4, '\0');
+        mvhd[0] = 1;
+        mvhd += QByteArray(16, '\0') + bigEndian32(600) + bigEndian32(0) + bigEndian32(600 * 185) + QByteArray(80, '\0');
+        writeBytes(root + "/song.m4a", atom("ftyp", "M4A " + QByteArray(4, '\0')) + atom("mdat", QByteArray(8192, '\0'))
+                   + atom("moov", atom("mvhd", mvhd)));
+        REQUIRE(MediaDurationReader::read(root + "/song.m4a") == 185000);
+        REQUIRE(MediaScanner::describe(QFileInfo(root + "/song.m4a")).duration == "03:05");
+    }
+    
+    SECTION("Unknown lengths") {
+        writeFile(root + "/silence.mp3", 8192);
+        REQUIRE(MediaDurationReader::read(root + "/silence.mp3") == -1);
+        REQUIRE(MediaDurationReader::read(root + "/missing.mp3") == -1);
+        REQUIRE(MediaScanner::describe(QFileInfo(root + "/silence.mp3")).duration == "00:00");
+    }
+    
+    QDir(root).removeRecursively();
+}
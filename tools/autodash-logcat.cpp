@@ -0,0 +1,181 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QDateTime>
+#include <QStringList>
+#include <QThread>
+#include <QTextStream>
+#include <QVector>
+#include <cstdio>
+
+#include "BinaryLogReader.h"
+
+// autodash-logcat - decode, filter and tail binary logs written by
+// Logger::setBinaryLogFile()
+//
+//   autodash-logcat autodash.blog
+//   autodash-logcat -l WARNING -m MockI2C -m USBMonitor autodash.blog
+//   autodash-logcat -n 100 -f autodash.blog
+
+static const char* TIMESTAMP_FORMAT = "yyyy-MM-dd hh:mm:ss.zzz";
+static const int FOLLOW_POLL_MS = 200;
+
+static QString levelToString(LogLevel level)
+{
+    switch (level) {
+        case LogLevel::DEBUG:   return "DEBUG";
+        case LogLevel::INFO:    return "INFO";
+        case LogLevel::WARNING: return "WARNING";
+        case LogLevel::ERROR:   return "ERROR";
+        case LogLevel::CRITICAL: return "CRITICAL";
+        default:               return "UNKNOWN";
+    }
+}
+
+static bool parseLevel(const QString& text, LogLevel& level)
+{
+    const QString upper = text.toUpper();
+    for (LogLevel candidate : {LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARNING,
+                               LogLevel::ERROR, LogLevel::CRITICAL}) {
+        if (levelToString(candidate) == upper) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct EntryFilter {
+    LogLevel minLevel = LogLevel::DEBUG;
+    QStringList modules;
+    QString text;
+    qint64 since = 0;
+    qint64 until = 0;
+    
+    bool matches(const BinaryLogEntry& entry) const
+    {
+        if (entry.level < minLevel) {
+            return false;
+        }
+        if (!modules.isEmpty() && !modules.contains(entry.module)) {
+            return false;
+        }
+        if (since > 0 && entry.timestamp < since) {
+            return false;
+        }
+        if (until > 0 && entry.timestamp > until) {
+            return false;
+        }
+        return text.isEmpty() || entry.message.contains(text, Qt::CaseInsensitive);
+    }
+};
+
+static QString formatEntry(const BinaryLogEntry& entry)
+{
+    return QString("[%1] [%2] [%3] %4")
+        .arg(QDateTime::fromMSecsSinceEpoch(entry.timestamp).toString(TIMESTAMP_FORMAT),
+             levelToString(entry.level), entry.module, entry.message);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("autodash-logcat");
+    app.setApplicationVersion("1.0.0");
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decode and filter AutoDash OS binary log files");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("file", "Binary log file to read");
+    
+    QCommandLineOption levelOption(QStringList() << "l" << "level",
+                                   "Minimum level (DEBUG, INFO, WARNING, ERROR, CRITICAL)", "level");
+    QCommandLineOption moduleOption(QStringList() << "m" << "module",
+                                    "Only show this module (repeatable)", "module");
+    QCommandLineOption grepOption(QStringList() << "g" << "grep",
+                                  "Only show messages containing text", "text");
+    QCommandLineOption sinceOption("since", "Only show entries at or after time (ISO 8601)", "time");
+    QCommandLineOption untilOption("until", "Only show entries at or before time (ISO 8601)", "time");
+    QCommandLineOption tailOption(QStringList() << "n" << "tail",
+                                  "Only show the last N matching entries", "count");
+    QCommandLineOption followOption(QStringList() << "f" << "follow",
+                                    "Keep reading as the file grows");
+    parser.addOption(levelOption);
+    parser.addOption(moduleOption);
+    parser.addOption(grepOption);
+    parser.addOption(sinceOption);
+    parser.addOption(untilOption);
+    parser.addOption(tailOption);
+    parser.addOption(followOption);
+    parser.process(app);
+    
+    QTextStream err(stderr);
+    const QStringList positional = parser.positionalArguments();
+    if (positional.size() != 1) {
+        parser.showHelp(1);
+    }
+    
+    EntryFilter filter;
+    if (parser.isSet(levelOption) && !parseLevel(parser.value(levelOption), filter.minLevel)) {
+        err << "Unknown level: " << parser.value(levelOption) << Qt::endl;
+        return 1;
+    }
+    filter.modules = parser.values(moduleOption);
+    filter.text = parser.value(grepOption);
+    if (parser.isSet(sinceOption)) {
+        filter.since = QDateTime::fromString(parser.value(sinceOption), Qt::ISODate).toMSecsSinceEpoch();
+    }
+    if (parser.isSet(untilOption)) {
+        filter.until = QDateTime::fromString(parser.value(untilOption), Qt::ISODate).toMSecsSinceEpoch();
+    }
+    int tailCount = parser.isSet(tailOption) ? parser.value(tailOption).toInt() : -1;
+    
+    BinaryLogReader reader;
+    if (!reader.open(positional.first())) {
+        err << reader.errorString() << Qt::endl;
+        return 1;
+    }
+    
+    QTextStream out(stdout);
+    BinaryLogEntry entry;
+    
+    if (tailCount >= 0) {
+        // Keep only the last N matches in a ring while scanning
+        QVector<QString> ring(qMax(1, tailCount));
+        qint64 matched = 0;
+        while (reader.readNext(entry)) {
+            if (tailCount > 0 && filter.matches(entry)) {
+                ring[matched % ring.size()] = formatEntry(entry);
+                ++matched;
+            }
+        }
+        qint64 shown = qMin<qint64>(matched, tailCount);
+        for (qint64 i = matched - shown; i < matched; ++i) {
+            out << ring[i % ring.size()] << '\n';
+        }
+    } else {
+        while (reader.readNext(entry)) {
+            if (filter.matches(entry)) {
+                out << formatEntry(entry) << '\n';
+            }
+        }
+    }
+    out.flush();
+    
+    while (parser.isSet(followOption) && !reader.hasError()) {
+        QThread::msleep(FOLLOW_POLL_MS);
+        while (reader.readNext(entry)) {
+            if (filter.matches(entry)) {
+                out << formatEntry(entry) << '\n';
+            }
+        }
+        out.flush();
+    }
+    
+    if (reader.hasError()) {
+        err << reader.errorString() << Qt::endl;
+        return 2;
+    }
+    return 0;
+}